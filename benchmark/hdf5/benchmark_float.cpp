@@ -96,6 +96,37 @@ class Benchmark_float : public Benchmark_knowhere, public ::testing::Test {
         printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
     }
 
+    void
+    test_hnsw_early_stop(const knowhere::Json& cfg) {
+        auto conf = cfg;
+        auto M = conf[knowhere::indexparam::HNSW_M].get<int64_t>();
+        auto efConstruction = conf[knowhere::indexparam::EFCONSTRUCTION].get<int64_t>();
+
+        printf("\n[%0.3f s] %s | %s | M=%ld | efConstruction=%ld | early stop\n", get_time_diff(),
+               ann_test_name_.c_str(), index_type_.c_str(), M, efConstruction);
+        printf("================================================================================\n");
+        for (auto ef : EFs_) {
+            conf[knowhere::indexparam::EF] = ef;
+            for (auto patience : PATIENCEs_) {
+                conf[knowhere::indexparam::EARLY_STOP_PATIENCE] = patience;
+                for (auto nq : NQs_) {
+                    auto ds_ptr = knowhere::GenDataSet(nq, dim_, xq_);
+                    for (auto k : TOPKs_) {
+                        conf[knowhere::meta::TOPK] = k;
+                        CALC_TIME_SPAN(auto result = index_.value().Search(ds_ptr, conf, nullptr));
+                        auto ids = result.value()->GetIds();
+                        float recall = CalcRecall(ids, nq, k);
+                        printf("  ef = %4d, patience = %4d, nq = %4d, k = %4d, elapse = %6.3fs, R@ = %.4f\n", ef,
+                               patience, nq, k, t_diff, recall);
+                        std::fflush(stdout);
+                    }
+                }
+            }
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
+
 #ifdef KNOWHERE_WITH_DISKANN
     void
     test_diskann(const knowhere::Json& cfg) {
@@ -121,6 +152,36 @@ class Benchmark_float : public Benchmark_knowhere, public ::testing::Test {
         printf("================================================================================\n");
         printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
     }
+
+    void
+    test_diskann_early_stop(const knowhere::Json& cfg) {
+        auto conf = cfg;
+
+        printf("\n[%0.3f s] %s | %s | early stop\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+        printf("================================================================================\n");
+        for (auto search_list_size : SEARCH_LISTs_) {
+            conf["search_list_size"] = search_list_size;
+            for (auto patience : PATIENCEs_) {
+                conf[knowhere::indexparam::EARLY_STOP_PATIENCE] = patience;
+                for (auto nq : NQs_) {
+                    auto ds_ptr = knowhere::GenDataSet(nq, dim_, xq_);
+                    for (auto k : TOPKs_) {
+                        conf[knowhere::meta::TOPK] = k;
+                        CALC_TIME_SPAN(auto result = index_.value().Search(ds_ptr, conf, nullptr));
+                        auto ids = result.value()->GetIds();
+                        float recall = CalcRecall(ids, nq, k);
+                        printf(
+                            "  search_list_size = %4d, patience = %4d, nq = %4d, k = %4d, elapse = %6.3fs, "
+                            "R@ = %.4f\n",
+                            search_list_size, patience, nq, k, t_diff, recall);
+                        std::fflush(stdout);
+                    }
+                }
+            }
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
 #endif
 
  protected:
@@ -160,6 +221,9 @@ class Benchmark_float : public Benchmark_knowhere, public ::testing::Test {
 
     // DISKANN index params
     const std::vector<int32_t> SEARCH_LISTs_ = {100, 200, 400};
+
+    // early termination params, 0 disables it and gives the baseline row
+    const std::vector<int32_t> PATIENCEs_ = {0, 8, 16, 32, 64};
 };
 
 TEST_F(Benchmark_float, TEST_IDMAP) {
@@ -234,6 +298,21 @@ TEST_F(Benchmark_float, TEST_HNSW) {
     }
 }
 
+TEST_F(Benchmark_float, TEST_HNSW_EARLY_STOP) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW;
+
+    knowhere::Json conf = cfg_;
+    for (auto M : HNSW_Ms_) {
+        conf[knowhere::indexparam::HNSW_M] = M;
+        for (auto efc : EFCONs_) {
+            conf[knowhere::indexparam::EFCONSTRUCTION] = efc;
+            std::string index_file_name = get_index_name({M, efc});
+            create_index(index_file_name, conf);
+            test_hnsw_early_stop(conf);
+        }
+    }
+}
+
 #ifdef KNOWHERE_WITH_DISKANN
 TEST_F(Benchmark_float, TEST_DISKANN) {
     index_type_ = knowhere::IndexEnum::INDEX_DISKANN;
@@ -268,5 +347,6 @@ TEST_F(Benchmark_float, TEST_DISKANN) {
     index_.value().Deserialize(binset, conf);
 
     test_diskann(conf);
+    test_diskann_early_stop(conf);
 }
 #endif
@@ -87,6 +87,38 @@ class Benchmark_float_bitset : public Benchmark_knowhere, public ::testing::Test
         printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
     }
 
+    void
+    test_hnsw_two_hop(const knowhere::Json& cfg) {
+        auto conf = cfg;
+
+        printf("\n[%0.3f s] %s | %s \n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+        printf("================================================================================\n");
+        for (auto per : HIGH_PERCENTs_) {
+            auto bitset_data = GenRandomBitset(nb_, nb_ * per / 100);
+            knowhere::BitsetView bitset(bitset_data.data(), nb_);
+
+            for (auto nq : NQs_) {
+                auto ds_ptr = knowhere::GenDataSet(nq, dim_, xq_);
+                for (auto k : TOPKs_) {
+                    conf[knowhere::meta::TOPK] = k;
+                    auto g_result = golden_index_.value().Search(ds_ptr, conf, bitset);
+                    auto g_ids = g_result.value()->GetIds();
+                    for (auto two_hop : {false, true}) {
+                        conf[knowhere::indexparam::FILTER_TWO_HOP] = two_hop;
+                        CALC_TIME_SPAN(auto result = index_.value().Search(ds_ptr, conf, bitset));
+                        auto ids = result.value()->GetIds();
+                        float recall = CalcRecall(g_ids, ids, nq, k);
+                        printf("  bitset_per = %3d%%, two_hop = %d, nq = %4d, k = %4d, elapse = %6.3fs, R@ = %.4f\n",
+                               per, two_hop, nq, k, t_diff, recall);
+                        std::fflush(stdout);
+                    }
+                }
+            }
+        }
+        printf("================================================================================\n");
+        printf("[%.3f s] Test '%s/%s' done\n\n", get_time_diff(), ann_test_name_.c_str(), index_type_.c_str());
+    }
+
 #ifdef KNOWHERE_WITH_DISKANN
     void
     test_diskann(const knowhere::Json& cfg) {
@@ -141,6 +173,8 @@ class Benchmark_float_bitset : public Benchmark_knowhere, public ::testing::Test
     const std::vector<int32_t> NQs_ = {10000};
     const std::vector<int32_t> TOPKs_ = {100};
     const std::vector<int32_t> PERCENTs_ = {0, 10, 20, 30, 40, 50, 60, 70, 80, 90, 100};
+    // filter ratios where HNSW may switch between plain, two-hop and brute force search
+    const std::vector<int32_t> HIGH_PERCENTs_ = {50, 80, 90, 95, 98, 99};
 
     // IVF index params
     // const std::vector<int32_t> NLISTs_ = {1024};
@@ -200,6 +234,15 @@ TEST_F(Benchmark_float_bitset, TEST_HNSW) {
     test_hnsw(conf);
 }
 
+TEST_F(Benchmark_float_bitset, TEST_HNSW_TWO_HOP) {
+    index_type_ = knowhere::IndexEnum::INDEX_HNSW;
+
+    knowhere::Json conf = cfg_;
+    std::string index_file_name = get_index_name({});
+    create_index(index_file_name, conf);
+    test_hnsw_two_hop(conf);
+}
+
 #ifdef KNOWHERE_WITH_DISKANN
 TEST_F(Benchmark_float_bitset, TEST_DISKANN) {
     index_type_ = knowhere::IndexEnum::INDEX_DISKANN;
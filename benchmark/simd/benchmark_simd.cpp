@@ -0,0 +1,285 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "knowhere/comp/knowhere_config.h"
+#include "simd/distances_ref.h"
+#include "simd/hook.h"
+
+// Times the distance kernels picked by fvec_hook for this cpu against the _ref ones, on the shapes of k-means
+// assignment and pq encoding: one query against ny centroids or sub-centroids of d dims.
+class Benchmark_simd : public ::testing::Test {
+ public:
+    // ns per call of func, best of a few rounds of about 20ms each
+    template <typename Func>
+    double
+    time_ns(Func&& func) {
+        using clock = std::chrono::steady_clock;
+        size_t calls = 1;
+        double best = 1e30;
+        for (int32_t round = 0; round < 5;) {
+            auto start = clock::now();
+            for (size_t i = 0; i < calls; i++) {
+                func();
+            }
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+            if (ns < 2e7) {
+                calls *= 2;
+                continue;
+            }
+            best = std::min(best, ns / calls);
+            round++;
+        }
+        return best;
+    }
+
+    template <typename Func, typename RefFunc>
+    void
+    test_kernel(const std::string& kernel, Func&& func, RefFunc&& ref_func) {
+        printf("\n%s | %s\n", simd_type_.c_str(), kernel.c_str());
+        printf("================================================================================\n");
+        for (auto d : DIMs_) {
+            for (auto ny : NYs_) {
+                double ns = time_ns([&]() { func(d, ny); });
+                double ref_ns = time_ns([&]() { ref_func(d, ny); });
+                printf("  d = %4zu, ny = %5zu, hook = %10.1f ns, ref = %10.1f ns, speedup = %5.2fx\n", d, ny, ns,
+                       ref_ns, ref_ns / ns);
+                std::fflush(stdout);
+            }
+        }
+        printf("================================================================================\n");
+    }
+
+ protected:
+    void
+    SetUp() override {
+        simd_type_ = knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
+
+        size_t max_d = DIMs_.back();
+        size_t max_ny = NYs_.back();
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+        x_.resize(max_d);
+        y_.resize(max_d * max_ny);
+        for (auto& v : x_) {
+            v = distrib(rng);
+        }
+        for (auto& v : y_) {
+            v = distrib(rng);
+        }
+        std::uniform_int_distribution<int32_t> int8_distrib(-128, 127);
+        x_int8_.resize(max_d);
+        y_int8_.resize(max_d * max_ny);
+        for (auto& v : x_int8_) {
+            v = int8_distrib(rng);
+        }
+        for (auto& v : y_int8_) {
+            v = int8_distrib(rng);
+        }
+        // the transposed kernels read y as d rows of ny, any values do for timing
+        y_sqlen_.assign(max_ny, 1.0f);
+        dis_.resize(max_ny);
+    }
+
+ protected:
+    // pq sub-vector sizes, then common embedding sizes
+    const std::vector<size_t> DIMs_ = {2, 4, 8, 16, 32, 64, 128, 256};
+    // pq8 sub-centroids, then a block of k-means centroids
+    const std::vector<size_t> NYs_ = {256, 4096};
+
+    std::string simd_type_;
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> y_sqlen_;
+    std::vector<float> dis_;
+    std::vector<int8_t> x_int8_;
+    std::vector<int8_t> y_int8_;
+};
+
+TEST_F(Benchmark_simd, TEST_L2SQR_NY) {
+    test_kernel(
+        "fvec_L2sqr_ny",
+        [&](size_t d, size_t ny) { faiss::fvec_L2sqr_ny(dis_.data(), x_.data(), y_.data(), d, ny); },
+        [&](size_t d, size_t ny) { faiss::fvec_L2sqr_ny_ref(dis_.data(), x_.data(), y_.data(), d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_INNER_PRODUCTS_NY) {
+    test_kernel(
+        "fvec_inner_products_ny",
+        [&](size_t d, size_t ny) { faiss::fvec_inner_products_ny(dis_.data(), x_.data(), y_.data(), d, ny); },
+        [&](size_t d, size_t ny) { faiss::fvec_inner_products_ny_ref(dis_.data(), x_.data(), y_.data(), d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_L2SQR_NY_TRANSPOSED) {
+    test_kernel(
+        "fvec_L2sqr_ny_transposed",
+        [&](size_t d, size_t ny) {
+            faiss::fvec_L2sqr_ny_transposed(dis_.data(), x_.data(), y_.data(), y_sqlen_.data(), d, ny, ny);
+        },
+        [&](size_t d, size_t ny) {
+            faiss::fvec_L2sqr_ny_transposed_ref(dis_.data(), x_.data(), y_.data(), y_sqlen_.data(), d, ny, ny);
+        });
+}
+
+TEST_F(Benchmark_simd, TEST_L2SQR_NY_NEAREST) {
+    test_kernel(
+        "fvec_L2sqr_ny_nearest",
+        [&](size_t d, size_t ny) { faiss::fvec_L2sqr_ny_nearest(dis_.data(), x_.data(), y_.data(), d, ny); },
+        [&](size_t d, size_t ny) { faiss::fvec_L2sqr_ny_nearest_ref(dis_.data(), x_.data(), y_.data(), d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_L2SQR_NY_NEAREST_Y_TRANSPOSED) {
+    test_kernel(
+        "fvec_L2sqr_ny_nearest_y_transposed",
+        [&](size_t d, size_t ny) {
+            faiss::fvec_L2sqr_ny_nearest_y_transposed(dis_.data(), x_.data(), y_.data(), y_sqlen_.data(), d, ny, ny);
+        },
+        [&](size_t d, size_t ny) {
+            faiss::fvec_L2sqr_ny_nearest_y_transposed_ref(dis_.data(), x_.data(), y_.data(), y_sqlen_.data(), d, ny,
+                                                          ny);
+        });
+}
+
+TEST_F(Benchmark_simd, TEST_BATCH_4) {
+    // the 4 vectors of a graph neighbor list, ny is the number of vectors swept 4 at a time
+    auto batch_4 = [&](auto func, size_t d, size_t ny) {
+        float dis0, dis1, dis2, dis3;
+        for (size_t i = 0; i + 4 <= ny; i += 4) {
+            const float* y = y_.data() + i * d;
+            func(x_.data(), y, y + d, y + 2 * d, y + 3 * d, d, dis0, dis1, dis2, dis3);
+            dis_[i] = dis0 + dis1 + dis2 + dis3;
+        }
+    };
+    test_kernel(
+        "fvec_L2sqr_batch_4", [&](size_t d, size_t ny) { batch_4(faiss::fvec_L2sqr_batch_4, d, ny); },
+        [&](size_t d, size_t ny) { batch_4(faiss::fvec_L2sqr_batch_4_ref, d, ny); });
+    test_kernel(
+        "fvec_inner_product_batch_4",
+        [&](size_t d, size_t ny) { batch_4(faiss::fvec_inner_product_batch_4, d, ny); },
+        [&](size_t d, size_t ny) { batch_4(faiss::fvec_inner_product_batch_4_ref, d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_INT8) {
+    // the sq8 codes of hnsw, ny is the number of codes compared with the query one at a time
+    auto int8 = [&](auto func, size_t d, size_t ny) {
+        int32_t sum = 0;
+        for (size_t i = 0; i < ny; i++) {
+            sum += func(x_int8_.data(), y_int8_.data() + i * d, d);
+        }
+        dis_[0] = sum;
+    };
+    test_kernel(
+        "ivec_L2sqr", [&](size_t d, size_t ny) { int8(faiss::ivec_L2sqr, d, ny); },
+        [&](size_t d, size_t ny) { int8(faiss::ivec_L2sqr_ref, d, ny); });
+    test_kernel(
+        "ivec_inner_product", [&](size_t d, size_t ny) { int8(faiss::ivec_inner_product, d, ny); },
+        [&](size_t d, size_t ny) { int8(faiss::ivec_inner_product_ref, d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_BINARY) {
+    // binary codes of d bytes for hamming and jaccard, reusing the int8 buffers
+    auto x = reinterpret_cast<const uint8_t*>(x_int8_.data());
+    auto y = reinterpret_cast<const uint8_t*>(y_int8_.data());
+    auto xor_popcount = [&](auto func, size_t d, size_t ny) {
+        int32_t sum = 0;
+        for (size_t i = 0; i < ny; i++) {
+            sum += func(x, y + i * d, d);
+        }
+        dis_[0] = sum;
+    };
+    auto and_or_popcount = [&](auto func, size_t d, size_t ny) {
+        int32_t sum = 0;
+        for (size_t i = 0; i < ny; i++) {
+            int and_count, or_count;
+            func(x, y + i * d, d, and_count, or_count);
+            sum += and_count + or_count;
+        }
+        dis_[0] = sum;
+    };
+    auto xor_popcount_batch_4 = [&](auto func, size_t d, size_t ny) {
+        int32_t sum = 0;
+        for (size_t i = 0; i + 4 <= ny; i += 4) {
+            const uint8_t* y0 = y + i * d;
+            int count0, count1, count2, count3;
+            func(x, y0, y0 + d, y0 + 2 * d, y0 + 3 * d, d, count0, count1, count2, count3);
+            sum += count0 + count1 + count2 + count3;
+        }
+        dis_[0] = sum;
+    };
+    test_kernel(
+        "bvec_xor_popcount", [&](size_t d, size_t ny) { xor_popcount(faiss::bvec_xor_popcount, d, ny); },
+        [&](size_t d, size_t ny) { xor_popcount(faiss::bvec_xor_popcount_ref, d, ny); });
+    test_kernel(
+        "bvec_and_or_popcount", [&](size_t d, size_t ny) { and_or_popcount(faiss::bvec_and_or_popcount, d, ny); },
+        [&](size_t d, size_t ny) { and_or_popcount(faiss::bvec_and_or_popcount_ref, d, ny); });
+    test_kernel(
+        "bvec_xor_popcount_batch_4",
+        [&](size_t d, size_t ny) { xor_popcount_batch_4(faiss::bvec_xor_popcount_batch_4, d, ny); },
+        [&](size_t d, size_t ny) { xor_popcount_batch_4(faiss::bvec_xor_popcount_batch_4_ref, d, ny); });
+}
+
+TEST_F(Benchmark_simd, TEST_DIM_KERNELS) {
+    // the kernels unrolled for the common embedding sizes against the generic ones of the hook, on a graph neighbor
+    // list of 32 vectors, swept one and 4 at a time
+    const size_t ny = 32;
+    std::vector<size_t> dims = {128, 384, 512, 768, 1024, 1536};
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> distrib(-1.0f, 1.0f);
+    std::vector<float> x(dims.back());
+    std::vector<float> y(dims.back() * ny);
+    for (auto& v : x) {
+        v = distrib(rng);
+    }
+    for (auto& v : y) {
+        v = distrib(rng);
+    }
+    auto generic = faiss::fvec_kernels(false);
+    auto one = [&](auto func, size_t d) {
+        float sum = 0;
+        for (size_t i = 0; i < ny; i++) {
+            sum += func(x.data(), y.data() + i * d, d);
+        }
+        dis_[0] = sum;
+    };
+    auto batch_4 = [&](auto func, size_t d) {
+        float dis0, dis1, dis2, dis3;
+        for (size_t i = 0; i + 4 <= ny; i += 4) {
+            const float* y0 = y.data() + i * d;
+            func(x.data(), y0, y0 + d, y0 + 2 * d, y0 + 3 * d, d, dis0, dis1, dis2, dis3);
+            dis_[i] = dis0 + dis1 + dis2 + dis3;
+        }
+    };
+    printf("\n%s | dim kernels, ny = %zu\n", simd_type_.c_str(), ny);
+    printf("================================================================================\n");
+    for (auto d : dims) {
+        auto kernels = faiss::fvec_kernels_for_dim(d);
+        double l2_ns = time_ns([&]() { one(kernels.L2sqr, d); });
+        double l2_generic_ns = time_ns([&]() { one(generic.L2sqr, d); });
+        double ip_ns = time_ns([&]() { one(kernels.inner_product, d); });
+        double ip_generic_ns = time_ns([&]() { one(generic.inner_product, d); });
+        double l2_4_ns = time_ns([&]() { batch_4(kernels.L2sqr_batch_4, d); });
+        double l2_4_generic_ns = time_ns([&]() { batch_4(generic.L2sqr_batch_4, d); });
+        double ip_4_ns = time_ns([&]() { batch_4(kernels.inner_product_batch_4, d); });
+        double ip_4_generic_ns = time_ns([&]() { batch_4(generic.inner_product_batch_4, d); });
+        printf("  d = %4zu, L2sqr %5.2fx, inner_product %5.2fx, L2sqr_batch_4 %5.2fx, inner_product_batch_4 %5.2fx\n",
+               d, l2_generic_ns / l2_ns, ip_generic_ns / ip_ns, l2_4_generic_ns / l2_4_ns,
+               ip_4_generic_ns / ip_4_ns);
+        std::fflush(stdout);
+    }
+    printf("================================================================================\n");
+}
@@ -27,21 +27,36 @@ if(__X86_64)
   set(UTILS_SRC src/simd/distances_ref.cc src/simd/hook.cc)
   set(UTILS_SSE_SRC src/simd/distances_sse.cc)
   set(UTILS_AVX_SRC src/simd/distances_avx.cc)
+  set(UTILS_AVX_VNNI_SRC src/simd/distances_avx_vnni.cc)
   set(UTILS_AVX512_SRC src/simd/distances_avx512.cc)
+  set(UTILS_AVX512_VNNI_SRC src/simd/distances_avx512_vnni.cc)
+  set(UTILS_AVX512_VPOPCNTDQ_SRC src/simd/distances_avx512_vpopcntdq.cc)
 
   add_library(utils_sse OBJECT ${UTILS_SSE_SRC})
   add_library(utils_avx OBJECT ${UTILS_AVX_SRC})
+  add_library(utils_avx_vnni OBJECT ${UTILS_AVX_VNNI_SRC})
   add_library(utils_avx512 OBJECT ${UTILS_AVX512_SRC})
+  add_library(utils_avx512_vnni OBJECT ${UTILS_AVX512_VNNI_SRC})
+  add_library(utils_avx512_vpopcntdq OBJECT ${UTILS_AVX512_VPOPCNTDQ_SRC})
 
   target_compile_options(utils_sse PRIVATE -msse4.2 -mpopcnt)
   target_compile_options(utils_avx PRIVATE -mfma -mf16c -mavx2 -mpopcnt)
+  target_compile_options(utils_avx_vnni PRIVATE -mfma -mf16c -mavx2 -mavxvnni
+                                                -mpopcnt)
   target_compile_options(utils_avx512 PRIVATE -mfma -mf16c -mavx512f -mavx512dq
                                               -mavx512bw -mpopcnt)
+  target_compile_options(
+    utils_avx512_vnni PRIVATE -mfma -mf16c -mavx512f -mavx512dq -mavx512bw
+                              -mavx512vnni -mpopcnt)
+  target_compile_options(
+    utils_avx512_vpopcntdq PRIVATE -mfma -mf16c -mavx512f -mavx512dq -mavx512bw
+                                   -mavx512vpopcntdq -mpopcnt)
 
   add_library(
     knowhere_utils STATIC
     ${UTILS_SRC} $<TARGET_OBJECTS:utils_sse> $<TARGET_OBJECTS:utils_avx>
-    $<TARGET_OBJECTS:utils_avx512>)
+    $<TARGET_OBJECTS:utils_avx_vnni> $<TARGET_OBJECTS:utils_avx512>
+    $<TARGET_OBJECTS:utils_avx512_vnni> $<TARGET_OBJECTS:utils_avx512_vpopcntdq>)
   target_link_libraries(knowhere_utils PUBLIC glog::glog)
 endif()
 
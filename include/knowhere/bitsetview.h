@@ -12,8 +12,10 @@
 #ifndef BITSET_H
 #define BITSET_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 #include <sstream>
 #include <string>
 
@@ -30,6 +32,16 @@ class BitsetView {
     BitsetView(const std::nullptr_t) : BitsetView() {
     }
 
+    // A filter given as the sorted, unique ids that pass it. Indexes that can iterate the allowed ids skip the scan of
+    // the whole segment, the others test ids against the bitmap when one is kept, or with a binary search otherwise.
+    static BitsetView
+    FromAllowedIds(const int64_t* allowed_ids, size_t allowed_num, size_t num_bits, const uint8_t* data = nullptr) {
+        BitsetView view(data, num_bits, num_bits - std::min(allowed_num, num_bits));
+        view.allowed_ids_ = allowed_ids;
+        view.allowed_num_ = allowed_num;
+        return view;
+    }
+
     bool
     empty() const {
         return num_bits_ == 0;
@@ -50,10 +62,68 @@ class BitsetView {
         return bits_;
     }
 
+    bool
+    has_allowed_ids() const {
+        return allowed_ids_ != nullptr;
+    }
+
+    const int64_t*
+    allowed_ids() const {
+        return allowed_ids_;
+    }
+
+    size_t
+    allowed_num() const {
+        return allowed_num_;
+    }
+
     bool
     test(int64_t index) const {
         // when index is larger than the max_offset, ignore it
-        return (index >= static_cast<int64_t>(num_bits_)) || (bits_[index >> 3] & (0x1 << (index & 0x7)));
+        if (index >= static_cast<int64_t>(num_bits_)) {
+            return true;
+        }
+        if (bits_ == nullptr) {
+            return !std::binary_search(allowed_ids_, allowed_ids_ + allowed_num_, index);
+        }
+        return bits_[index >> 3] & (0x1 << (index & 0x7));
+    }
+
+    // The filter bits of the 64 ids starting at offset, a multiple of 8, in one word. Ids past size() read as filtered
+    // out, so scans can skip whole words of filtered rows.
+    uint64_t
+    test_word(size_t offset) const {
+        if (offset >= num_bits_) {
+            return ~uint64_t(0);
+        }
+        uint64_t word = ~uint64_t(0);
+        if (bits_ == nullptr) {
+            const int64_t* end = allowed_ids_ + allowed_num_;
+            for (auto it = std::lower_bound(allowed_ids_, end, static_cast<int64_t>(offset));
+                 it != end && *it < static_cast<int64_t>(offset + 64); ++it) {
+                word &= ~(uint64_t(1) << (*it - offset));
+            }
+        } else {
+            const size_t byte_offset = offset >> 3;
+            const size_t nbytes = std::min<size_t>(sizeof(uint64_t), byte_size() - byte_offset);
+            word = 0;
+            memcpy(&word, bits_ + byte_offset, nbytes);
+        }
+        const size_t valid = num_bits_ - offset;
+        if (valid < 64) {
+            word |= ~uint64_t(0) << valid;
+        }
+        return word;
+    }
+
+    // The filter bits of up to 64 ids in one word, bit i for ids[i]
+    uint64_t
+    test_ids(const int64_t* ids, size_t n) const {
+        uint64_t word = 0;
+        for (size_t i = 0; i < n; i++) {
+            word |= uint64_t(test(ids[i])) << i;
+        }
+        return word;
     }
 
     size_t
@@ -68,6 +138,9 @@ class BitsetView {
 
     size_t
     get_filtered_out_num_() const {
+        if (bits_ == nullptr) {
+            return num_bits_ - std::min(allowed_num_, num_bits_);
+        }
         size_t ret = 0;
         auto len_uint8 = byte_size();
         auto len_uint64 = len_uint8 >> 3;
@@ -112,6 +185,8 @@ class BitsetView {
     const uint8_t* bits_ = nullptr;
     size_t num_bits_ = 0;
     size_t filtered_out_num_ = 0;
+    const int64_t* allowed_ids_ = nullptr;
+    size_t allowed_num_ = 0;
 };
 }  // namespace knowhere
 
@@ -0,0 +1,111 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef CANCELLATION_H
+#define CANCELLATION_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+namespace knowhere {
+
+// Cooperative cancellation of a search. The caller keeps the token and may Cancel() it at any time, or give it a
+// deadline up front; the search loops poll it through SearchCancelled() and stop early, and Index::Search then
+// returns search_cancelled or search_timeout instead of the partial result.
+class CancellationToken {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+
+    explicit CancellationToken(Clock::time_point deadline) : deadline_(deadline) {
+    }
+
+    static std::shared_ptr<CancellationToken>
+    WithTimeout(std::chrono::milliseconds timeout) {
+        return std::make_shared<CancellationToken>(Clock::now() + timeout);
+    }
+
+    void
+    Cancel() {
+        cancelled_.store(true, std::memory_order_relaxed);
+    }
+
+    bool
+    IsCancelled() const {
+        return cancelled_.load(std::memory_order_relaxed) || IsExpired();
+    }
+
+    bool
+    IsExpired() const {
+        if (expired_.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        if (deadline_ == Clock::time_point::max() || Clock::now() < deadline_) {
+            return false;
+        }
+        // remember it, so the checks after the deadline skip the clock read
+        expired_.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    // the token of the search running on this thread, nullptr if it has none
+    static const CancellationToken*
+    Current() {
+        return current_;
+    }
+
+ private:
+    friend class ScopedCancellation;
+
+    std::atomic<bool> cancelled_{false};
+    mutable std::atomic<bool> expired_{false};
+    const Clock::time_point deadline_ = Clock::time_point::max();
+
+    inline static thread_local const CancellationToken* current_ = nullptr;
+};
+
+using CancellationTokenPtr = std::shared_ptr<CancellationToken>;
+
+// Makes the token visible to SearchCancelled() on this thread until the scope ends. ThreadPool::push carries the
+// current token into the tasks it runs, so the scope must outlive the tasks a search fans out, as it does for the
+// searches that wait on their futures.
+class ScopedCancellation {
+ public:
+    explicit ScopedCancellation(const CancellationToken* token) : prev_(CancellationToken::current_) {
+        CancellationToken::current_ = token;
+    }
+
+    ~ScopedCancellation() {
+        CancellationToken::current_ = prev_;
+    }
+
+    ScopedCancellation(const ScopedCancellation&) = delete;
+
+    ScopedCancellation&
+    operator=(const ScopedCancellation&) = delete;
+
+ private:
+    const CancellationToken* prev_;
+};
+
+// Polled by the long search loops (graph expansions, list scans, beams), true once the search on this thread was
+// cancelled or is past its deadline. Costs a thread-local load when no token is set.
+inline bool
+SearchCancelled() {
+    const auto* token = CancellationToken::Current();
+    return token != nullptr && token->IsCancelled();
+}
+
+}  // namespace knowhere
+
+#endif /* CANCELLATION_H */
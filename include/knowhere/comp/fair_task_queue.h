@@ -0,0 +1,159 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "folly/Executor.h"
+
+namespace knowhere {
+
+// How the tasks of a request are ordered against those of other requests in a FAIR thread pool. A priority class
+// only runs when the classes above it are empty. Within a class the groups take turns, and a group runs up to weight
+// tasks per turn. A group is a tenant, or a single request when it has no group name.
+struct TaskSchedule {
+    enum Priority : int32_t { HIGH = 0, NORMAL = 1, LOW = 2 };
+    static constexpr int32_t kNumPriorities = 3;
+
+    int32_t priority = NORMAL;
+    std::string group;
+    int32_t weight = 1;
+
+    // the schedule of the request running on this thread, nullptr if it has none
+    static const TaskSchedule*
+    Current() {
+        return current_;
+    }
+
+ private:
+    friend class ScopedTaskSchedule;
+
+    inline static thread_local const TaskSchedule* current_ = nullptr;
+};
+
+// Makes the schedule apply to the tasks this thread pushes until the scope ends. Like ScopedCancellation, the scope
+// must outlive the tasks it pushes.
+class ScopedTaskSchedule {
+ public:
+    explicit ScopedTaskSchedule(const TaskSchedule* schedule) : prev_(TaskSchedule::current_) {
+        TaskSchedule::current_ = schedule;
+    }
+
+    ~ScopedTaskSchedule() {
+        TaskSchedule::current_ = prev_;
+    }
+
+    ScopedTaskSchedule(const ScopedTaskSchedule&) = delete;
+
+    ScopedTaskSchedule&
+    operator=(const ScopedTaskSchedule&) = delete;
+
+ private:
+    const TaskSchedule* prev_;
+};
+
+// Deficit round-robin over the groups of each priority class, so a request with thousands of queries can not starve
+// the small requests queued behind it. Tasks of one group run in FIFO order.
+class FairTaskQueue {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    void
+    Push(const TaskSchedule* schedule, folly::Func task) {
+        static const TaskSchedule kDefaultSchedule;
+        if (schedule == nullptr) {
+            schedule = &kDefaultSchedule;
+        }
+        std::lock_guard<std::mutex> lock(mtx_);
+        auto& cls = classes_[std::clamp<int32_t>(schedule->priority, 0, TaskSchedule::kNumPriorities - 1)];
+        auto [it, inserted] = cls.groups.try_emplace(schedule->group);
+        auto& group = it->second;
+        if (inserted) {
+            group.name = schedule->group;
+            cls.active.push_back(&group);
+        }
+        group.weight = std::max<int32_t>(schedule->weight, 1);
+        group.tasks.push_back({std::move(task), Clock::now()});
+        ++size_;
+    }
+
+    // the next task to run, empty if there is none; wait_ms is set to how long it was queued
+    folly::Func
+    Pop(double* wait_ms = nullptr) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (auto& cls : classes_) {
+            if (cls.active.empty()) {
+                continue;
+            }
+            auto* group = cls.active.front();
+            if (group->deficit == 0) {
+                // a new turn of the group
+                group->deficit = group->weight;
+            }
+            auto entry = std::move(group->tasks.front());
+            group->tasks.pop_front();
+            --group->deficit;
+            --size_;
+            if (group->tasks.empty()) {
+                cls.active.pop_front();
+                cls.groups.erase(cls.groups.find(group->name));
+            } else if (group->deficit == 0) {
+                cls.active.pop_front();
+                cls.active.push_back(group);
+            }
+            if (wait_ms != nullptr) {
+                *wait_ms = std::chrono::duration<double, std::milli>(Clock::now() - entry.enqueued).count();
+            }
+            return std::move(entry.task);
+        }
+        return nullptr;
+    }
+
+    size_t
+    Size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return size_;
+    }
+
+ private:
+    struct Entry {
+        folly::Func task;
+        Clock::time_point enqueued;
+    };
+
+    struct Group {
+        std::string name;
+        std::deque<Entry> tasks;
+        int32_t weight = 1;
+        int32_t deficit = 0;
+    };
+
+    struct PriorityClass {
+        // groups with queued tasks only, an emptied group is dropped along with its deficit
+        std::unordered_map<std::string, Group> groups;
+        std::deque<Group*> active;
+    };
+
+    mutable std::mutex mtx_;
+    std::array<PriorityClass, TaskSchedule::kNumPriorities> classes_;
+    size_t size_ = 0;
+};
+
+}  // namespace knowhere
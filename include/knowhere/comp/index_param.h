@@ -30,6 +30,8 @@ constexpr const char* INDEX_FAISS_IVFFLAT = "IVF_FLAT";
 constexpr const char* INDEX_FAISS_IVFFLAT_CC = "IVF_FLAT_CC";
 constexpr const char* INDEX_FAISS_IVFPQ = "IVF_PQ";
 constexpr const char* INDEX_FAISS_SCANN = "SCANN";
+constexpr const char* INDEX_FAISS_IVFSQ4_FS = "IVF_SQ4_FS";
+constexpr const char* INDEX_FAISS_IVFRABITQ = "IVF_RABITQ";
 constexpr const char* INDEX_FAISS_IVFSQ8 = "IVF_SQ8";
 constexpr const char* INDEX_FAISS_IVFSQ_CC = "IVF_SQ_CC";
 
@@ -85,6 +87,7 @@ constexpr const char* NUM_BUILD_THREAD = "num_build_thread";
 constexpr const char* TRACE_VISIT = "trace_visit";
 constexpr const char* JSON_INFO = "json_info";
 constexpr const char* JSON_ID_SET = "json_id_set";
+constexpr const char* SEARCH_STATS = "search_stats";
 constexpr const char* TRACE_ID = "trace_id";
 constexpr const char* SPAN_ID = "span_id";
 constexpr const char* TRACE_FLAGS = "trace_flags";
@@ -103,9 +106,14 @@ constexpr const char* M = "m";          // PQ param for IVFPQ
 constexpr const char* SSIZE = "ssize";
 constexpr const char* REORDER_K = "reorder_k";
 constexpr const char* WITH_RAW_DATA = "with_raw_data";
+constexpr const char* REFINE_TYPE = "refine_type";
 constexpr const char* ENSURE_TOPK_FULL = "ensure_topk_full";
 constexpr const char* CODE_SIZE = "code_size";
 constexpr const char* RAW_DATA_STORE_PREFIX = "raw_data_store_prefix";
+constexpr const char* CLUSTERING_TYPE = "clustering_type";
+constexpr const char* KMEANS_EARLY_STOP_THRESHOLD = "kmeans_early_stop_threshold";
+constexpr const char* MAX_POINTS_PER_CENTROID = "max_points_per_centroid";
+constexpr const char* TRAIN_SAMPLE_RATIO = "train_sample_ratio";
 // RAFT Params
 constexpr const char* REFINE_RATIO = "refine_ratio";
 constexpr const char* CACHE_DATASET_ON_DEVICE = "cache_dataset_on_device";
@@ -143,10 +151,23 @@ constexpr const char* EFCONSTRUCTION = "efConstruction";
 constexpr const char* HNSW_M = "M";
 constexpr const char* EF = "ef";
 constexpr const char* OVERVIEW_LEVELS = "overview_levels";
+constexpr const char* EMBED_NEIGHBOR_CODES = "embed_neighbor_codes";
+constexpr const char* NEIGHBOR_CODE_M = "neighbor_code_m";
+constexpr const char* NEIGHBOR_CODE_SLACK = "neighbor_code_slack";
+constexpr const char* GRAPH_REORDER = "graph_reorder";
+constexpr const char* EARLY_STOP_PATIENCE = "early_stop_patience";
+constexpr const char* FILTER_TWO_HOP = "filter_two_hop";
 
 // Sparse Params
 constexpr const char* DROP_RATIO_BUILD = "drop_ratio_build";
 constexpr const char* DROP_RATIO_SEARCH = "drop_ratio_search";
+
+// KMEANS Cluster Params, also uses KMEANS_N_ITERS and KMEANS_TRAINSET_FRACTION
+constexpr const char* NUM_CLUSTERS = "num_clusters";
+constexpr const char* KMEANS_INIT = "kmeans_init";
+constexpr const char* KMEANS_BATCH_SIZE = "kmeans_batch_size";
+constexpr const char* KMEANS_TOLERANCE = "kmeans_tolerance";
+constexpr const char* KMEANS_SEED = "kmeans_seed";
 }  // namespace indexparam
 
 using MetricType = std::string;
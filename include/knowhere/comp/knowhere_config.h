@@ -13,6 +13,7 @@
 #define COMP_KNOWHERE_CONFIG_H
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #ifdef KNOWHERE_WITH_DISKANN
@@ -30,16 +31,31 @@ class KnowhereConfig {
      * set SIMD type
      */
     enum SimdType {
-        AUTO = 0,  // enable all and depend on the system
-        AVX512,    // only enable AVX512
-        AVX2,      // only enable AVX2
-        SSE4_2,    // only enable SSE4_2
-        GENERIC,   // use arithmetic instead of SIMD
+        AUTO = 0,   // enable all and depend on the system
+        AVX512,     // only enable AVX512
+        AVX2,       // only enable AVX2
+        SSE4_2,     // only enable SSE4_2
+        GENERIC,    // use arithmetic instead of SIMD
+        AUTO_TUNE,  // benchmark the SIMD types the system supports and use the fastest per kernel family
     };
 
     static std::string
     SetSimdType(const SimdType simd_type);
 
+    /**
+     * the kernels bound for each family ("float", "int8", "fp16/bf16", "binary"), with the throughput in GB/s of
+     * each SIMD type benchmarked by SetSimdType(AUTO_TUNE). other SIMD types benchmark nothing and report 0.
+     */
+    struct SimdKernelInfo {
+        std::string family;
+        std::string simd_type;
+        double throughput_gbps = 0;
+        std::vector<std::pair<std::string, double>> candidates;
+    };
+
+    static std::vector<SimdKernelInfo>
+    GetSimdKernelInfo();
+
     /**
      *The purpose of this interface is: part of the sealed indexes default to using bf16 as the base data to achieve
      *higher capacity; to ensure consistency in computation between growing and sealed, it is necessary to maintain the
@@ -67,6 +83,7 @@ class KnowhereConfig {
      *   It is to reduce the number of iterations of K-means.
      *   Between each two iterations, if the optimization rate < early_stop_threshold, stop
      *   And if early_stop_threshold = 0, won't early stop
+     *   IVF builds that set kmeans_early_stop_threshold in their config ignore it
      */
     static void
     SetEarlyStopThreshold(const double early_stop_threshold);
@@ -76,6 +93,7 @@ class KnowhereConfig {
 
     /**
      * set Clustering type
+     *   IVF builds that set clustering_type in their config ignore it
      */
     enum ClusteringType {
         K_MEANS = 0,        // k-means (default)
@@ -101,6 +119,14 @@ class KnowhereConfig {
     static void
     SetSearchThreadPoolSize(size_t num_threads);
 
+    /**
+     * Create one search thread pool per NUMA node, with threads pinned to the cpus of the node. An index loaded with
+     * numa_node set is searched by that node's pool. Its memory is not migrated, the loading thread only prefers the
+     * node (MPOL_PREFERRED) for the pages it allocates, and the kernel falls back to other nodes when it is full.
+     */
+    static void
+    SetNumaSearchThreadPoolSize(size_t threads_per_node);
+
     /**
      * init GPU Resource
      */
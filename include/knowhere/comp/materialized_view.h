@@ -14,7 +14,11 @@
 #include <charconv>
 #include <cstdint>
 #include <nlohmann/json.hpp>
+#include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "knowhere/expected.h"
 
 namespace knowhere {
 // MaterializedViewSearchInfo is used to store the search information when performing filtered search (i.e. Materialized
@@ -44,4 +48,19 @@ to_json(nlohmann::json& j, const MaterializedViewSearchInfo& info);
 // use `auto j = j.get<MaterializedViewSearchInfo>() or j[KEY]`
 void
 from_json(const nlohmann::json& j, MaterializedViewSearchInfo& info);
+
+// OptFieldCategories holds the rows of each distinct value (category) of one optional scalar field, as written to
+// `opt_fields_path` before a build.
+struct OptFieldCategories {
+    int64_t field_id = 0;
+    // category_rows[c] lists the row offsets whose scalar value is the c-th distinct value
+    std::vector<std::vector<uint32_t>> category_rows;
+};
+
+// Reads the optional scalar fields file. The file is little-endian:
+//   uint8 version (0), uint32 number of fields, then for each field:
+//   int64 field id, uint32 number of categories, then for each category:
+//   uint32 number of rows followed by that many uint32 row offsets.
+expected<std::vector<OptFieldCategories>>
+ReadOptFields(const std::string& path);
 }  // namespace knowhere
@@ -0,0 +1,77 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace knowhere {
+
+// Thin wrappers over the Linux NUMA syscalls, so that knowhere does not depend on libnuma. On other platforms, or on
+// a machine with a single node, there is one node and the placement calls do nothing.
+namespace numa {
+
+// the number of online NUMA nodes, at least 1
+int
+NumNodes();
+
+// the cpus of the node, empty if the node is not online
+std::vector<int>
+NodeCpus(int node);
+
+// parses a kernel cpu or node list, e.g. "0-3,8,10-11"
+std::vector<int>
+ParseList(const std::string& list);
+
+// binds the calling thread to the cpus of the node
+bool
+PinCurrentThread(int node);
+
+// the node holding the page of addr, -1 if the page is not faulted in or the node is unknown
+int
+NodeOfAddress(const void* addr);
+
+// Sets the memory policy of the calling thread while in scope, so that the pages it faults in, e.g. the blocks of an
+// index it loads, come from the given nodes. The policy only applies to new pages, and is not attached to the memory,
+// which keeps its placement when freed and reused. The previous policy of the thread is restored on destruction.
+class ScopedMemoryPolicy {
+ public:
+    // prefers the node, the kernel falls back to the other nodes when it is full
+    explicit ScopedMemoryPolicy(int node);
+
+    // interleaves the pages over all online nodes
+    ScopedMemoryPolicy();
+
+    ~ScopedMemoryPolicy();
+
+    ScopedMemoryPolicy(const ScopedMemoryPolicy&) = delete;
+    ScopedMemoryPolicy&
+    operator=(const ScopedMemoryPolicy&) = delete;
+
+    // false if the policy could not be set, the thread then allocates as before
+    bool
+    Applied() const {
+        return applied_;
+    }
+
+ private:
+    void
+    Apply(int mode, const std::vector<int>& nodes);
+
+    bool applied_ = false;
+    int prev_mode_ = 0;
+    std::vector<unsigned long> prev_mask_;
+};
+
+}  // namespace numa
+}  // namespace knowhere
@@ -0,0 +1,119 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace knowhere {
+
+// A named phase of an operation, e.g. the list scan of an IVF search. A site is a static of the code it times, so the
+// sink can keep what it needs for the phase, like its histogram, in slot.
+struct PhaseSite {
+    PhaseSite(const char* operation, const char* phase) : operation(operation), phase(phase) {
+    }
+
+    const char* operation;
+    const char* phase;
+    mutable std::atomic<void*> slot{nullptr};
+};
+
+// Where timed phases go. knowhere installs a sink that exports them as the phase_latency histograms and as child
+// spans of traced requests, so faiss and hnswlib time their phases with this header alone. Without a sink nothing is
+// timed.
+class PhaseSink {
+ public:
+    virtual ~PhaseSink() = default;
+
+    // returns whether the phase opened a span, which End then closes
+    virtual bool
+    Begin(const PhaseSite& site) = 0;
+
+    virtual void
+    End(const PhaseSite& site, double ms, bool span) = 0;
+
+    static PhaseSink*
+    Get() {
+        return sink_.load(std::memory_order_acquire);
+    }
+
+    static void
+    Set(PhaseSink* sink) {
+        sink_.store(sink, std::memory_order_release);
+    }
+
+ private:
+    inline static std::atomic<PhaseSink*> sink_{nullptr};
+};
+
+// Times a phase until the scope ends, see KNOWHERE_SCOPED_PHASE.
+class ScopedPhase {
+ public:
+    explicit ScopedPhase(const PhaseSite& site) : site_(site), sink_(PhaseSink::Get()) {
+        if (sink_ != nullptr) {
+            span_ = sink_->Begin(site_);
+            begin_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedPhase() {
+        if (sink_ != nullptr) {
+            auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_).count();
+            sink_->End(site_, ms, span_);
+        }
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+
+    ScopedPhase&
+    operator=(const ScopedPhase&) = delete;
+
+ private:
+    const PhaseSite& site_;
+    PhaseSink* sink_;
+    bool span_ = false;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// records a phase that was timed by other means, e.g. the io time DiskANN measures for each query
+inline void
+ObservePhase(const PhaseSite& site, double ms) {
+    if (auto* sink = PhaseSink::Get()) {
+        sink->End(site, ms, false);
+    }
+}
+
+}  // namespace knowhere
+
+// The phase macros take string literals and compile to nothing unless KNOWHERE_WITH_PHASE_PROFILING is defined.
+#ifdef KNOWHERE_WITH_PHASE_PROFILING
+#define KNOWHERE_PHASE_CONCAT_(x, y) x##y
+#define KNOWHERE_PHASE_CONCAT(x, y) KNOWHERE_PHASE_CONCAT_(x, y)
+
+// times the rest of the enclosing scope as a phase of the operation
+#define KNOWHERE_SCOPED_PHASE(operation, phase)                                                                  \
+    static const ::knowhere::PhaseSite KNOWHERE_PHASE_CONCAT(knowhere_phase_site_, __LINE__)(operation, phase); \
+    const ::knowhere::ScopedPhase KNOWHERE_PHASE_CONCAT(knowhere_phase_, __LINE__)(                            \
+        KNOWHERE_PHASE_CONCAT(knowhere_phase_site_, __LINE__))
+
+// records ms as a phase of the operation
+#define KNOWHERE_OBSERVE_PHASE(operation, phase, ms)                              \
+    do {                                                                          \
+        static const ::knowhere::PhaseSite knowhere_phase_site(operation, phase); \
+        ::knowhere::ObservePhase(knowhere_phase_site, ms);                        \
+    } while (0)
+#else
+#define KNOWHERE_SCOPED_PHASE(operation, phase)
+#define KNOWHERE_OBSERVE_PHASE(operation, phase, ms) \
+    do {                                             \
+    } while (0)
+#endif
@@ -0,0 +1,151 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SEARCH_STATS_H
+#define SEARCH_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+namespace knowhere {
+
+// The work done by one search or range search request, summed over its queries. Index::Search attaches it to the
+// result DataSet. A counter an index type has no notion of stays 0.
+struct SearchStats {
+    // distances to vectors or codes, including those to the IVF centroids
+    int64_t distance_computations = 0;
+    // graph nodes expanded (HNSW, DiskANN)
+    int64_t nodes_visited = 0;
+    // inverted lists scanned (IVF) or posting lists walked (sparse)
+    int64_t lists_probed = 0;
+    // codes or posting list entries read
+    int64_t codes_scanned = 0;
+    // bytes read from disk (DiskANN)
+    int64_t bytes_read = 0;
+    // nodes served from the in-memory cache instead of disk (DiskANN)
+    int64_t cache_hits = 0;
+    // time the tasks of the request waited in the search thread pool
+    double queue_wait_ms = 0.0;
+    // cpu time of the calling thread and of the tasks of the request
+    double cpu_ms = 0.0;
+
+    SearchStats&
+    operator+=(const SearchStats& other) {
+        distance_computations += other.distance_computations;
+        nodes_visited += other.nodes_visited;
+        lists_probed += other.lists_probed;
+        codes_scanned += other.codes_scanned;
+        bytes_read += other.bytes_read;
+        cache_hits += other.cache_hits;
+        queue_wait_ms += other.queue_wait_ms;
+        cpu_ms += other.cpu_ms;
+        return *this;
+    }
+};
+
+// Sums the stats of the queries of one request, which run on several pool threads. Like CancellationToken, the
+// collector of the request running on a thread is reached through Current(), and ThreadPool::push carries it into the
+// tasks. The search loops keep their counts in locals and add them once per query.
+class SearchStatsCollector {
+ public:
+    void
+    Add(const SearchStats& stats) {
+        distance_computations_.fetch_add(stats.distance_computations, std::memory_order_relaxed);
+        nodes_visited_.fetch_add(stats.nodes_visited, std::memory_order_relaxed);
+        lists_probed_.fetch_add(stats.lists_probed, std::memory_order_relaxed);
+        codes_scanned_.fetch_add(stats.codes_scanned, std::memory_order_relaxed);
+        bytes_read_.fetch_add(stats.bytes_read, std::memory_order_relaxed);
+        cache_hits_.fetch_add(stats.cache_hits, std::memory_order_relaxed);
+        queue_wait_ns_.fetch_add(static_cast<int64_t>(stats.queue_wait_ms * 1e6), std::memory_order_relaxed);
+        cpu_ns_.fetch_add(static_cast<int64_t>(stats.cpu_ms * 1e6), std::memory_order_relaxed);
+    }
+
+    // only exact once the tasks of the request are done
+    SearchStats
+    Get() const {
+        SearchStats stats;
+        stats.distance_computations = distance_computations_.load(std::memory_order_relaxed);
+        stats.nodes_visited = nodes_visited_.load(std::memory_order_relaxed);
+        stats.lists_probed = lists_probed_.load(std::memory_order_relaxed);
+        stats.codes_scanned = codes_scanned_.load(std::memory_order_relaxed);
+        stats.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+        stats.cache_hits = cache_hits_.load(std::memory_order_relaxed);
+        stats.queue_wait_ms = queue_wait_ns_.load(std::memory_order_relaxed) / 1e6;
+        stats.cpu_ms = cpu_ns_.load(std::memory_order_relaxed) / 1e6;
+        return stats;
+    }
+
+    // the collector of the request running on this thread, nullptr if it has none
+    static SearchStatsCollector*
+    Current() {
+        return current_;
+    }
+
+ private:
+    friend class ScopedSearchStats;
+
+    std::atomic<int64_t> distance_computations_{0};
+    std::atomic<int64_t> nodes_visited_{0};
+    std::atomic<int64_t> lists_probed_{0};
+    std::atomic<int64_t> codes_scanned_{0};
+    std::atomic<int64_t> bytes_read_{0};
+    std::atomic<int64_t> cache_hits_{0};
+    std::atomic<int64_t> queue_wait_ns_{0};
+    std::atomic<int64_t> cpu_ns_{0};
+
+    inline static thread_local SearchStatsCollector* current_ = nullptr;
+};
+
+// Makes the collector receive the stats added on this thread until the scope ends. Like ScopedCancellation, the scope
+// must outlive the tasks it pushes.
+class ScopedSearchStats {
+ public:
+    explicit ScopedSearchStats(SearchStatsCollector* collector) : prev_(SearchStatsCollector::current_) {
+        SearchStatsCollector::current_ = collector;
+    }
+
+    ~ScopedSearchStats() {
+        SearchStatsCollector::current_ = prev_;
+    }
+
+    ScopedSearchStats(const ScopedSearchStats&) = delete;
+
+    ScopedSearchStats&
+    operator=(const ScopedSearchStats&) = delete;
+
+ private:
+    SearchStatsCollector* prev_;
+};
+
+// cpu time of the calling thread, 0 where the platform can not tell
+inline double
+ThreadCpuTimeMs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+#else
+    return 0.0;
+#endif
+}
+
+// adds the counts of a finished query to the request running on this thread, if it collects any
+inline void
+AddSearchStats(const SearchStats& stats) {
+    if (auto* collector = SearchStatsCollector::Current()) {
+        collector->Add(stats);
+    }
+}
+
+}  // namespace knowhere
+
+#endif /* SEARCH_STATS_H */
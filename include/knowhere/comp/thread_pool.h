@@ -22,59 +22,87 @@
 #endif
 
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <memory>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "folly/executors/CPUThreadPoolExecutor.h"
+#include "folly/executors/InlineExecutor.h"
 #include "folly/executors/task_queue/UnboundedBlockingQueue.h"
 #include "folly/futures/Future.h"
+#include "knowhere/comp/cancellation.h"
+#include "knowhere/comp/fair_task_queue.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/expected.h"
 #include "knowhere/log.h"
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+#include "knowhere/prometheus_client.h"
+#endif
 
 namespace knowhere {
 
 class ThreadPool {
  public:
-    enum class QueueType { LIFO, FIFO };
+    // FAIR runs the tasks in the order of their TaskSchedule, see FairTaskQueue
+    enum class QueueType { LIFO, FIFO, FAIR };
 #ifdef __linux__
  private:
     class LowPriorityThreadFactory : public folly::NamedThreadFactory {
      public:
-        using folly::NamedThreadFactory::NamedThreadFactory;
+        // the threads are pinned to the cpus of numa_node, unless it is negative
+        explicit LowPriorityThreadFactory(const std::string& thread_name_prefix, int numa_node = -1)
+            : folly::NamedThreadFactory(thread_name_prefix), numa_node_(numa_node) {
+        }
+
         std::thread
         newThread(folly::Func&& func) override {
-            return folly::NamedThreadFactory::newThread([&, func = std::move(func)]() mutable {
+            return folly::NamedThreadFactory::newThread([&, numa_node = numa_node_, func = std::move(func)]() mutable {
                 if (setpriority(PRIO_PROCESS, gettid(), 19) != 0) {
                     LOG_KNOWHERE_ERROR_ << "Failed to set priority of knowhere thread. Error is: "
                                         << std::strerror(errno);
                 } else {
                     LOG_KNOWHERE_INFO_ << "Successfully set priority of knowhere thread.";
                 }
+                if (numa_node >= 0) {
+                    numa::PinCurrentThread(numa_node);
+                }
                 func();
             });
         }
+
+     private:
+        const int numa_node_;
     };
 
  public:
-    explicit ThreadPool(uint32_t num_threads, const std::string& thread_name_prefix, QueueType queueT = QueueType::LIFO)
-        : pool_(queueT == QueueType::LIFO
+    explicit ThreadPool(uint32_t num_threads, const std::string& thread_name_prefix, QueueType queueT = QueueType::LIFO,
+                        int numa_node = -1)
+        : queue_type_(queueT),
+          pool_(queueT == QueueType::LIFO
                     ? folly::CPUThreadPoolExecutor(
                           num_threads,
                           std::make_unique<folly::LifoSemMPMCQueue<folly::CPUThreadPoolExecutor::CPUTask,
                                                                    folly::QueueBehaviorIfFull::BLOCK>>(
                               num_threads * kTaskQueueFactor),
-                          std::make_shared<LowPriorityThreadFactory>(thread_name_prefix))
+                          std::make_shared<LowPriorityThreadFactory>(thread_name_prefix, numa_node))
                     : folly::CPUThreadPoolExecutor(
                           num_threads,
                           std::make_unique<folly::UnboundedBlockingQueue<folly::CPUThreadPoolExecutor::CPUTask>>(),
-                          std::make_shared<LowPriorityThreadFactory>(thread_name_prefix))) {
+                          std::make_shared<LowPriorityThreadFactory>(thread_name_prefix, numa_node))) {
     }
 #else
  public:
-    explicit ThreadPool(uint32_t num_threads, const std::string& thread_name_prefix, QueueType queueT = QueueType::LIFO)
-        : pool_(queueT == QueueType::LIFO
+    // the threads are only pinned to a NUMA node on linux
+    explicit ThreadPool(uint32_t num_threads, const std::string& thread_name_prefix, QueueType queueT = QueueType::LIFO,
+                        [[maybe_unused]] int numa_node = -1)
+        : queue_type_(queueT),
+          pool_(queueT == QueueType::LIFO
                     ? folly::CPUThreadPoolExecutor(
                           num_threads,
                           std::make_unique<folly::LifoSemMPMCQueue<folly::CPUThreadPoolExecutor::CPUTask,
@@ -101,8 +129,48 @@ class ThreadPool {
     template <typename Func, typename... Args>
     auto
     push(Func&& func, Args&&... args) {
-        return folly::makeSemiFuture().via(&pool_).then(
-            [func = std::forward<Func>(func), &args...](auto&&) mutable { return func(std::forward<Args>(args)...); });
+        // the task polls the cancellation token of the search that pushed it, the tasks it pushes keep its schedule,
+        // and its queue wait and cpu time go to the stats of the search
+        auto stats = SearchStatsCollector::Current();
+        auto task = [func = std::forward<Func>(func), &args..., token = CancellationToken::Current(),
+                     schedule = TaskSchedule::Current(), stats,
+                     enqueued = stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point()](
+                        auto&&) mutable {
+            ScopedCancellation cancellation(token);
+            ScopedTaskSchedule scheduling(schedule);
+            ScopedSearchStats collecting(stats);
+            if (stats == nullptr) {
+                return func(std::forward<Args>(args)...);
+            }
+            SearchStats task_stats;
+            task_stats.queue_wait_ms =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - enqueued).count();
+            auto cpu_begin = ThreadCpuTimeMs();
+            auto add_stats = [&]() {
+                task_stats.cpu_ms = ThreadCpuTimeMs() - cpu_begin;
+                stats->Add(task_stats);
+            };
+            if constexpr (std::is_void_v<decltype(func(std::forward<Args>(args)...))>) {
+                func(std::forward<Args>(args)...);
+                add_stats();
+            } else {
+                auto res = func(std::forward<Args>(args)...);
+                add_stats();
+                return res;
+            }
+        };
+        if (queue_type_ != QueueType::FAIR) {
+            return folly::makeSemiFuture().via(&pool_).then(std::move(task));
+        }
+        // the pool runs one RunFairTask per push, which takes whichever task is due rather than this one
+        using R = folly::lift_unit_t<std::invoke_result_t<decltype(task)&, folly::Try<folly::Unit>&&>>;
+        folly::Promise<R> promise;
+        auto future = promise.getSemiFuture().via(&folly::InlineExecutor::instance());
+        fair_queue_.Push(TaskSchedule::Current(), [promise = std::move(promise), task = std::move(task)]() mutable {
+            promise.setTry(folly::makeTryWith([&]() { return task(folly::Try<folly::Unit>()); }));
+        });
+        pool_.add([this]() { RunFairTask(); });
+        return future;
     }
 
     [[nodiscard]] int32_t
@@ -138,6 +206,11 @@ class ThreadPool {
         return ThreadPool(num_threads, thread_name_prefix, QueueType::LIFO);
     }
 
+    static ThreadPool
+    CreateFAIR(uint32_t num_threads, const std::string& thread_name_prefix) {
+        return ThreadPool(num_threads, thread_name_prefix, QueueType::FAIR);
+    }
+
     static void
     InitGlobalBuildThreadPool(uint32_t num_threads) {
         if (num_threads <= 0) {
@@ -168,7 +241,7 @@ class ThreadPool {
         if (search_pool_ == nullptr) {
             std::lock_guard<std::mutex> lock(search_pool_mutex_);
             if (search_pool_ == nullptr) {
-                search_pool_ = std::make_shared<ThreadPool>(num_threads, "knowhere_search");
+                search_pool_ = std::make_shared<ThreadPool>(num_threads, "knowhere_search", QueueType::FAIR);
                 LOG_KNOWHERE_INFO_ << "Init global search thread pool with size " << num_threads;
                 return;
             }
@@ -202,6 +275,41 @@ class ThreadPool {
         }
     }
 
+    // one FAIR search pool per NUMA node with its threads pinned to the node, for the indexes loaded onto a node
+    static void
+    SetNumaSearchThreadPoolSize(uint32_t threads_per_node) {
+        if (threads_per_node == 0) {
+            LOG_KNOWHERE_ERROR_ << "threads_per_node should be bigger than 0";
+            return;
+        }
+        std::lock_guard<std::mutex> lock(numa_search_pools_mutex_);
+        if (!numa_search_pools_.empty()) {
+            for (auto& pool : numa_search_pools_) {
+                pool->SetNumThreads(threads_per_node);
+            }
+            LOG_KNOWHERE_INFO_ << "NUMA search thread pool size has already been set to " << threads_per_node;
+            return;
+        }
+        int num_nodes = numa::NumNodes();
+        for (int node = 0; node < num_nodes; ++node) {
+            numa_search_pools_.push_back(std::make_shared<ThreadPool>(
+                threads_per_node, "knowhere_search_n" + std::to_string(node), QueueType::FAIR, node));
+        }
+        LOG_KNOWHERE_INFO_ << "Init " << num_nodes << " NUMA search thread pools with size " << threads_per_node;
+    }
+
+    // the search pool of the node, or the global search pool when there are no NUMA pools
+    static std::shared_ptr<ThreadPool>
+    GetNumaSearchThreadPool(int node) {
+        {
+            std::lock_guard<std::mutex> lock(numa_search_pools_mutex_);
+            if (node >= 0 && static_cast<size_t>(node) < numa_search_pools_.size()) {
+                return numa_search_pools_[node];
+            }
+        }
+        return GetGlobalSearchThreadPool();
+    }
+
     static size_t
     GetSearchThreadPoolPendingTaskCount() {
         return ThreadPool::GetGlobalSearchThreadPool()->GetPendingTaskCount();
@@ -247,6 +355,21 @@ class ThreadPool {
     };
 
  private:
+    void
+    RunFairTask() {
+        double wait_ms = 0.0;
+        auto task = fair_queue_.Pop(&wait_ms);
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+        knowhere_queue_wait_latency.Observe(wait_ms);
+#endif
+        if (task) {
+            task();
+        }
+    }
+
+    const QueueType queue_type_;
+    // declared before the executor, whose threads may still be running queued tasks while it is destroyed
+    FairTaskQueue fair_queue_;
     folly::CPUThreadPoolExecutor pool_;
 
     inline static std::mutex build_pool_mutex_;
@@ -255,6 +378,9 @@ class ThreadPool {
     inline static std::mutex search_pool_mutex_;
     inline static std::shared_ptr<ThreadPool> search_pool_ = nullptr;
 
+    inline static std::mutex numa_search_pools_mutex_;
+    inline static std::vector<std::shared_ptr<ThreadPool>> numa_search_pools_;
+
     constexpr static size_t kTaskQueueFactor = 16;
 };
 
@@ -646,6 +646,13 @@ class BaseConfig : public Config {
     CFG_MATERIALIZED_VIEW_SEARCH_INFO_TYPE materialized_view_search_info;
     CFG_STRING opt_fields_path;
     CFG_FLOAT iterator_refine_ratio;
+    // order of the search tasks in the global search pool: a lower priority class only runs when the higher ones are
+    // empty, and the groups of a class (tenants, or single requests without a group) take weighted turns
+    CFG_INT search_priority;
+    CFG_STRING search_group;
+    CFG_INT search_group_weight;
+    CFG_INT numa_node;
+    CFG_BOOL numa_interleave;
     KNOHWERE_DECLARE_CONFIG(BaseConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(metric_type)
             .set_default("L2")
@@ -739,6 +746,37 @@ class BaseConfig : public Config {
             .description("refine ratio for iterator")
             .for_iterator()
             .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_priority)
+            .set_default(1)
+            .description("priority class of the search, 0 high, 1 normal and 2 low")
+            .set_range(0, 2)
+            .for_search()
+            .for_range_search()
+            .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_group)
+            .description("tenant sharing a fair turn in the search pool, each request takes its own turn if empty")
+            .allow_empty_without_default()
+            .for_search()
+            .for_range_search()
+            .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(search_group_weight)
+            .set_default(1)
+            .description("tasks the search group runs per turn")
+            .set_range(1, 1024)
+            .for_search()
+            .for_range_search()
+            .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(numa_node)
+            .set_default(-1)
+            .description("NUMA node to place the loaded index on and search it from, -1 to leave it as loaded")
+            .set_range(-1, 1023)
+            .for_deserialize()
+            .for_deserialize_from_file();
+        KNOWHERE_CONFIG_DECLARE_FIELD(numa_interleave)
+            .set_default(false)
+            .description("spread the loaded index over all NUMA nodes, ignored if numa_node is set")
+            .for_deserialize()
+            .for_deserialize_from_file();
     }
 };
 }  // namespace knowhere
@@ -16,11 +16,13 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <shared_mutex>
 #include <utility>
 #include <variant>
 
 #include "comp/index_param.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/range_util.h"
 #include "knowhere/sparse_utils.h"
 
@@ -159,6 +161,12 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         this->data_[meta::JSON_ID_SET] = Var(std::in_place_index<5>, idset);
     }
 
+    void
+    SetSearchStats(const SearchStats& stats) {
+        std::unique_lock lock(mutex_);
+        this->data_[meta::SEARCH_STATS] = Var(std::in_place_index<6>, stats);
+    }
+
     const float*
     GetDistance() const {
         std::shared_lock lock(mutex_);
@@ -247,6 +255,17 @@ class DataSet : public std::enable_shared_from_this<const DataSet> {
         return "";
     }
 
+    // the work done by the search that produced this result, if it was set
+    std::optional<SearchStats>
+    GetSearchStats() const {
+        std::shared_lock lock(mutex_);
+        auto it = this->data_.find(meta::SEARCH_STATS);
+        if (it != this->data_.end()) {
+            return std::any_cast<SearchStats>(*std::get_if<6>(&it->second));
+        }
+        return std::nullopt;
+    }
+
     void
     SetIsOwner(bool is_owner) {
         std::unique_lock lock(mutex_);
@@ -45,6 +45,8 @@ enum class Status {
     invalid_index_error = 23,
     invalid_cluster_error = 24,
     cluster_inner_error = 25,
+    search_cancelled = 26,
+    search_timeout = 27,
 };
 
 inline std::string
@@ -94,6 +96,10 @@ Status2String(knowhere::Status status) {
             return "invalid cluster type";
         case knowhere::Status::cluster_inner_error:
             return "cluster inner error";
+        case knowhere::Status::search_cancelled:
+            return "search cancelled";
+        case knowhere::Status::search_timeout:
+            return "search timeout";
         default:
             return "unexpected status";
     }
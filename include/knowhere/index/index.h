@@ -12,11 +12,15 @@
 #ifndef INDEX_H
 #define INDEX_H
 
+#include "folly/futures/Future.h"
 #include "knowhere/binaryset.h"
+#include "knowhere/comp/cancellation.h"
 #include "knowhere/config.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #include "knowhere/index/index_node.h"
+#include "knowhere/index/query_context.h"
+#include "knowhere/index/search_plan.h"
 
 namespace knowhere {
 template <typename T1>
@@ -147,14 +151,53 @@ class Index {
     Status
     Add(const DataSetPtr dataset, const Json& json);
 
+    // a search whose token is cancelled or expires stops early and returns search_cancelled or search_timeout
     expected<DataSetPtr>
-    Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
+    Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+           const CancellationTokenPtr& token = nullptr) const;
+
+    // Search deferred to the executor the caller attaches with via(), so the calling thread is free while the
+    // queries run. It must not be an executor the search itself fans out to, such as the global search pool. The
+    // future keeps the index alive, the bitset has to outlive it.
+    folly::SemiFuture<expected<DataSetPtr>>
+    SearchAsync(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+                const CancellationTokenPtr& token = nullptr) const;
 
     expected<std::vector<IndexNode::IteratorPtr>>
     AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
 
     expected<DataSetPtr>
-    RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const;
+    RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+                const CancellationTokenPtr& token = nullptr) const;
+
+    // parse and check a search config once, param_type is one of SEARCH, RANGE_SEARCH and ITERATOR
+    expected<SearchPlanPtr>
+    CompileSearchPlan(const Json& json, PARAM_TYPE param_type = knowhere::SEARCH) const;
+
+    expected<DataSetPtr>
+    Search(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset,
+           const CancellationTokenPtr& token = nullptr) const;
+
+    expected<std::vector<IndexNode::IteratorPtr>>
+    AnnIterator(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset) const;
+
+    expected<DataSetPtr>
+    RangeSearch(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset,
+                const CancellationTokenPtr& token = nullptr) const;
+
+    // derives the query-side state of the queries once, e.g. the normalized queries, sq codes or pq lookup tables,
+    // so one query fanned out to many segments of the same index type does not recompute it on each of them
+    expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Json& json) const;
+
+    // searches queries prepared by an index of the same type, the state derived from another quantizer is recomputed
+    expected<DataSetPtr>
+    Search(const QueryContext& query, const Json& json, const BitsetView& bitset,
+           const CancellationTokenPtr& token = nullptr) const;
+
+    expected<DataSetPtr>
+    Search(const QueryContext& query, const SearchPlan& plan, const BitsetView& bitset,
+           const CancellationTokenPtr& token = nullptr) const;
 
     expected<DataSetPtr>
     GetVectorByIds(const DataSetPtr dataset) const;
@@ -202,6 +245,23 @@ class Index {
         static_assert(std::is_base_of<IndexNode, T1>::value);
     }
 
+    Status
+    CheckSearchPlan(const SearchPlan& plan, PARAM_TYPE param_type, std::string* msg) const;
+
+    Status
+    CheckQueryContext(const QueryContext& query, const BaseConfig& cfg, std::string* msg) const;
+
+    expected<DataSetPtr>
+    SearchWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset,
+                     const CancellationToken* token, const QueryContext* query = nullptr) const;
+
+    expected<std::vector<IndexNode::IteratorPtr>>
+    AnnIteratorWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset) const;
+
+    expected<DataSetPtr>
+    RangeSearchWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset,
+                          const CancellationToken* token) const;
+
     T1* node;
 };
 
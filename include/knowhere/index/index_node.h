@@ -13,6 +13,7 @@
 #define INDEX_NODE_H
 
 #include <functional>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "knowhere/config.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
+#include "knowhere/index/query_context.h"
 #include "knowhere/object.h"
 #include "knowhere/operands.h"
 #include "knowhere/range_util.h"
@@ -34,6 +36,8 @@
 
 namespace knowhere {
 
+class ThreadPool;
+
 class IndexNode : public Object {
  public:
     IndexNode(const int32_t ver) : version_(ver) {
@@ -63,6 +67,20 @@ class IndexNode : public Object {
     virtual expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const = 0;
 
+    // derives the query-side state of the queries once, so it can be reused by the search of other indexes of the
+    // same type. The default only keeps the queries.
+    virtual expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Config& cfg) const {
+        const auto& base_cfg = static_cast<const BaseConfig&>(cfg);
+        return std::make_shared<const QueryContext>(dataset, Type(), base_cfg.metric_type.value());
+    }
+
+    // searches queries prepared by PrepareQuery of this or another index of the same type
+    virtual expected<DataSetPtr>
+    SearchPrepared(const QueryContext& query, const Config& cfg, const BitsetView& bitset) const {
+        return Search(query.GetQueries(), cfg, bitset);
+    }
+
     // not thread safe.
     class iterator {
      public:
@@ -175,6 +193,11 @@ class IndexNode : public Object {
     virtual Status
     DeserializeFromFile(const std::string& filename, const Config& config) = 0;
 
+    // moves the search tasks of the index to another pool, such as the pool of the NUMA node it was placed on
+    virtual void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) {
+    }
+
     virtual std::unique_ptr<BaseConfig>
     CreateConfig() const = 0;
 
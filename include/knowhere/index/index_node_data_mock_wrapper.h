@@ -38,6 +38,15 @@ class IndexNodeDataMockWrapper : public IndexNode {
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
+    expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Config& cfg) const override;
+
+    // the prepared queries were already converted by PrepareQuery
+    expected<DataSetPtr>
+    SearchPrepared(const QueryContext& query, const Config& cfg, const BitsetView& bitset) const override {
+        return index_node_->SearchPrepared(query, cfg, bitset);
+    }
+
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
@@ -52,6 +61,11 @@ class IndexNodeDataMockWrapper : public IndexNode {
         return index_node_->HasRawData(metric_type);
     }
 
+    bool
+    IsAdditionalScalarSupported() const override {
+        return index_node_->IsAdditionalScalarSupported();
+    }
+
     expected<DataSetPtr>
     GetIndexMeta(const Config& cfg) const override {
         return index_node_->GetIndexMeta(cfg);
@@ -72,6 +86,11 @@ class IndexNodeDataMockWrapper : public IndexNode {
         return index_node_->DeserializeFromFile(filename, config);
     }
 
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        index_node_->SetSearchThreadPool(std::move(pool));
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return index_node_->CreateConfig();
@@ -36,6 +36,12 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
+    expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Config& cfg) const override;
+
+    expected<DataSetPtr>
+    SearchPrepared(const QueryContext& query, const Config& cfg, const BitsetView& bitset) const override;
+
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
 
@@ -49,6 +55,11 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->HasRawData(metric_type);
     }
 
+    bool
+    IsAdditionalScalarSupported() const override {
+        return index_node_->IsAdditionalScalarSupported();
+    }
+
     expected<DataSetPtr>
     GetIndexMeta(const Config& cfg) const override {
         return index_node_->GetIndexMeta(cfg);
@@ -69,6 +80,11 @@ class IndexNodeThreadPoolWrapper : public IndexNode {
         return index_node_->DeserializeFromFile(filename, config);
     }
 
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        index_node_->SetSearchThreadPool(std::move(pool));
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return index_node_->CreateConfig();
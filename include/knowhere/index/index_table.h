@@ -42,6 +42,13 @@ static std::set<std::pair<std::string, VecType>> legal_knowhere_index = {
     {IndexEnum::INDEX_FAISS_SCANN, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_FAISS_SCANN, VecType::VECTOR_BFLOAT16},
 
+    {IndexEnum::INDEX_FAISS_IVFSQ4_FS, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_FAISS_IVFSQ4_FS, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_FAISS_IVFSQ4_FS, VecType::VECTOR_BFLOAT16},
+    {IndexEnum::INDEX_FAISS_IVFRABITQ, VecType::VECTOR_FLOAT},
+    {IndexEnum::INDEX_FAISS_IVFRABITQ, VecType::VECTOR_FLOAT16},
+    {IndexEnum::INDEX_FAISS_IVFRABITQ, VecType::VECTOR_BFLOAT16},
+
     {IndexEnum::INDEX_FAISS_IVFSQ8, VecType::VECTOR_FLOAT},
     {IndexEnum::INDEX_FAISS_IVFSQ8, VecType::VECTOR_FLOAT16},
     {IndexEnum::INDEX_FAISS_IVFSQ8, VecType::VECTOR_BFLOAT16},
@@ -0,0 +1,91 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef QUERY_CONTEXT_H
+#define QUERY_CONTEXT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "knowhere/dataset.h"
+
+namespace knowhere {
+
+// the query-side state an index derives from the queries, e.g. sq codes or pq lookup tables
+class PreparedQueries {
+ public:
+    virtual ~PreparedQueries() = default;
+};
+
+// Queries prepared once by Index::PrepareQuery, to be searched on many indexes of the same type, e.g. all the
+// segments of a collection. It is immutable and can be shared by concurrent searches.
+class QueryContext {
+ public:
+    QueryContext(DataSetPtr queries, std::string index_type, std::string metric_type, bool normalized = false,
+                 uint64_t quantizer_key = 0, std::unique_ptr<const PreparedQueries> prepared = nullptr)
+        : queries_(std::move(queries)),
+          index_type_(std::move(index_type)),
+          metric_type_(std::move(metric_type)),
+          normalized_(normalized),
+          quantizer_key_(quantizer_key),
+          prepared_(std::move(prepared)) {
+    }
+
+    // the queries, already normalized if IsNormalized()
+    const DataSetPtr&
+    GetQueries() const {
+        return queries_;
+    }
+
+    // the type of the index that prepared the queries, a context is only accepted by indexes of the same type
+    const std::string&
+    GetIndexType() const {
+        return index_type_;
+    }
+
+    const std::string&
+    GetMetricType() const {
+        return metric_type_;
+    }
+
+    // true if the queries were normalized for COSINE
+    bool
+    IsNormalized() const {
+        return normalized_;
+    }
+
+    // the prepared state, or nullptr if it was derived from another quantizer than the one of quantizer_key. The
+    // index then computes the state itself.
+    template <typename T>
+    const T*
+    GetPrepared(uint64_t quantizer_key) const {
+        if (prepared_ == nullptr || quantizer_key != quantizer_key_) {
+            return nullptr;
+        }
+        return dynamic_cast<const T*>(prepared_.get());
+    }
+
+ private:
+    const DataSetPtr queries_;
+    const std::string index_type_;
+    const std::string metric_type_;
+    const bool normalized_;
+    const uint64_t quantizer_key_;
+    const std::unique_ptr<const PreparedQueries> prepared_;
+};
+
+using QueryContextPtr = std::shared_ptr<const QueryContext>;
+
+}  // namespace knowhere
+
+#endif /* QUERY_CONTEXT_H */
@@ -0,0 +1,58 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef SEARCH_PLAN_H
+#define SEARCH_PLAN_H
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+// A search config that has been parsed and checked once by Index::CompileSearchPlan. It is immutable, so a plan can
+// be shared by concurrent requests and reused across calls to skip the json parsing on every search.
+class SearchPlan {
+ public:
+    SearchPlan(std::unique_ptr<BaseConfig> cfg, PARAM_TYPE param_type, std::string index_type)
+        : cfg_(std::move(cfg)), param_type_(param_type), index_type_(std::move(index_type)) {
+    }
+
+    const BaseConfig&
+    GetConfig() const {
+        return *cfg_;
+    }
+
+    // one of SEARCH, RANGE_SEARCH and ITERATOR, the call the plan was checked for
+    PARAM_TYPE
+    GetParamType() const {
+        return param_type_;
+    }
+
+    // the type of the index that compiled the plan, a plan is only accepted by indexes of the same type
+    const std::string&
+    GetIndexType() const {
+        return index_type_;
+    }
+
+ private:
+    const std::unique_ptr<const BaseConfig> cfg_;
+    const PARAM_TYPE param_type_;
+    const std::string index_type_;
+};
+
+using SearchPlanPtr = std::shared_ptr<const SearchPlan>;
+
+}  // namespace knowhere
+
+#endif /* SEARCH_PLAN_H */
@@ -85,6 +85,10 @@ extern const std::unique_ptr<PrometheusClient> prometheusClient;
 #define DECLARE_PROMETHEUS_GAUGE(name, module) extern prometheus::Gauge& CONCATENATE(module, name);
 #define DECLARE_PROMETHEUS_COUNTER(name, module) extern prometheus::Counter& CONCATENATE(module, name);
 #define DECLARE_PROMETHEUS_HISTOGRAM(name, module) extern prometheus::Histogram& CONCATENATE(module, name);
+#define DECLARE_PROMETHEUS_COUNTER_FAMILY(name) \
+    extern prometheus::Family<prometheus::Counter>& CONCATENATE(name, family);
+#define DECLARE_PROMETHEUS_HISTOGRAM_FAMILY(name) \
+    extern prometheus::Family<prometheus::Histogram>& CONCATENATE(name, family);
 
 DECLARE_PROMETHEUS_HISTOGRAM(build_latency, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(build_latency, PROMETHEUS_LABEL_CARDINAL);
@@ -104,6 +108,8 @@ DECLARE_PROMETHEUS_HISTOGRAM(ann_iterator_init_latency, PROMETHEUS_LABEL_CARDINA
 DECLARE_PROMETHEUS_HISTOGRAM(search_topk, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(search_topk, PROMETHEUS_LABEL_CARDINAL);
 
+DECLARE_PROMETHEUS_HISTOGRAM(queue_wait_latency, PROMETHEUS_LABEL_KNOWHERE);
+
 DECLARE_PROMETHEUS_HISTOGRAM(bitset_ratio, PROMETHEUS_LABEL_CARDINAL);
 
 DECLARE_PROMETHEUS_HISTOGRAM(hnsw_bitset_ratio, PROMETHEUS_LABEL_KNOWHERE);
@@ -112,4 +118,18 @@ DECLARE_PROMETHEUS_HISTOGRAM(hnsw_search_hops, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_bitset_ratio, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_search_hops, PROMETHEUS_LABEL_KNOWHERE);
 DECLARE_PROMETHEUS_HISTOGRAM(diskann_range_search_iters, PROMETHEUS_LABEL_KNOWHERE);
+
+// per index type, labelled with index_type, see SearchStats
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_distance_computations);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_nodes_visited);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_lists_probed);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_codes_scanned);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_bytes_read);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_cache_hits);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_queue_wait);
+DECLARE_PROMETHEUS_COUNTER_FAMILY(search_cpu_time);
+
+// labelled with operation and phase, see KNOWHERE_SCOPED_PHASE
+extern const prometheus::Histogram::BucketBoundaries phaseLatencyBuckets;
+DECLARE_PROMETHEUS_HISTOGRAM_FAMILY(phase_latency);
 }  // namespace knowhere
@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "knowhere/config.h"
 #include "opentelemetry/trace/provider.h"
@@ -65,4 +66,29 @@ EmptySpanID(const TraceContext* ctx);
 tracer::TraceContext
 GetTraceCtxFromCfg(const BaseConfig* cfg);
 
+// Makes the phases timed on this thread until the scope ends child spans of span, see KNOWHERE_SCOPED_PHASE. The
+// phases of the pool tasks of a request only go to the phase_latency histograms. A null span traces no phases.
+class ScopedPhaseSpans {
+ public:
+    explicit ScopedPhaseSpans(std::shared_ptr<trace::Span> span);
+
+    ~ScopedPhaseSpans();
+
+    ScopedPhaseSpans(const ScopedPhaseSpans&) = delete;
+
+    ScopedPhaseSpans&
+    operator=(const ScopedPhaseSpans&) = delete;
+
+ private:
+    std::vector<std::shared_ptr<trace::Span>> prev_;
+};
+
+// starts a child of the innermost phase span of this thread, false if the thread traces no phases
+bool
+StartPhaseSpan(const char* phase);
+
+// ends the span of the innermost phase of this thread
+void
+EndPhaseSpan();
+
 }  // namespace knowhere::tracer
@@ -52,6 +52,10 @@ template <typename DataType>
 extern std::unique_ptr<DataType[]>
 CopyAndNormalizeVecs(const DataType* x, size_t rows, int32_t dim);
 
+template <typename DataType>
+extern DataSetPtr
+CopyAndNormalizeDataSet(const DataSetPtr dataset);
+
 constexpr inline uint64_t seed = 0xc70f6907UL;
 
 inline uint64_t
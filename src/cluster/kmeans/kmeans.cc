@@ -0,0 +1,645 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "cluster/kmeans/kmeans_config.h"
+#include "faiss/utils/distances.h"
+#include "knowhere/cluster/cluster_factory.h"
+#include "knowhere/cluster/cluster_node.h"
+#include "knowhere/comp/thread_pool.h"
+#include "knowhere/log.h"
+#include "knowhere/utils.h"
+#include "simd/hook.h"
+
+// same integer type as faiss is built with, see cmake/libs/libfaiss.cmake
+#ifndef FINTEGER
+#define FINTEGER int
+#endif
+
+extern "C" {
+// provided by the BLAS library faiss links against
+int
+sgemm_(const char* transa, const char* transb, FINTEGER* m, FINTEGER* n, FINTEGER* k, const float* alpha,
+       const float* a, FINTEGER* lda, const float* b, FINTEGER* ldb, float* beta, float* c, FINTEGER* ldc);
+}
+
+namespace knowhere {
+
+namespace {
+
+// rows x centroids tile of one sgemm call in the assignment, 1MB of dot products
+constexpr size_t kAssignBlockRows = 256;
+constexpr size_t kAssignBlockCentroids = 1024;
+constexpr size_t kMinRowsPerTask = 4 * kAssignBlockRows;
+constexpr size_t kMinCentroidsPerTask = 64;
+// KMEANS|| runs this many sampling rounds, each drawing about 2 * num_clusters candidates
+constexpr int kKmeansParallelRounds = 5;
+constexpr size_t kKmeansParallelOversampling = 2;
+
+// run func(begin, end) over [0, n) on the build thread pool
+template <typename Func>
+Status
+ParallelFor(size_t n, size_t min_chunk, Func&& func) {
+    if (n == 0) {
+        return Status::success;
+    }
+    auto pool = ThreadPool::GetGlobalBuildThreadPool();
+    size_t chunk = std::max(min_chunk, (n + pool->size() - 1) / pool->size());
+    std::vector<folly::Future<folly::Unit>> futs;
+    futs.reserve((n + chunk - 1) / chunk);
+    for (size_t begin = 0; begin < n; begin += chunk) {
+        size_t end = std::min(n, begin + chunk);
+        futs.emplace_back(pool->push([&func, begin, end] {
+            ThreadPool::ScopedOmpSetter setter(1);
+            func(begin, end);
+        }));
+    }
+    return WaitAllSuccess(futs);
+}
+
+// counter based uniform [0, 1) so that sampling does not depend on how rows are split across threads
+inline float
+HashUniform(uint64_t seed, uint64_t round, uint64_t i) {
+    uint64_t z = seed ^ (round << 40) ^ i;
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (z >> 40) * (1.0f / (1ULL << 24));
+}
+
+// For at most kAssignBlockRows rows, find the nearest centroid and the squared distances to the nearest and the
+// second nearest one. The dot products are computed one sgemm per centroid tile.
+void
+AssignBlock(const float* x, size_t n, const float* c, const float* c_norms, size_t k, size_t d, int64_t* labels,
+            float* d1, float* d2, float* x_norms, float* ip) {
+    faiss::fvec_norms_L2sqr(x_norms, x, d, n);
+    for (size_t i = 0; i < n; ++i) {
+        labels[i] = -1;
+        d1[i] = std::numeric_limits<float>::max();
+        d2[i] = std::numeric_limits<float>::max();
+    }
+    for (size_t j0 = 0; j0 < k; j0 += kAssignBlockCentroids) {
+        size_t j1 = std::min(k, j0 + kAssignBlockCentroids);
+        {
+            float one = 1, zero = 0;
+            FINTEGER nyi = j1 - j0, nxi = n, di = d;
+            sgemm_("Transpose", "Not transpose", &nyi, &nxi, &di, &one, c + j0 * d, &di, x, &di, &zero, ip, &nyi);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            const float* ip_i = ip + i * (j1 - j0);
+            float best = d1[i], second = d2[i];
+            int64_t label = labels[i];
+            for (size_t j = j0; j < j1; ++j) {
+                float dis = x_norms[i] + c_norms[j] - 2 * ip_i[j - j0];
+                if (dis < best) {
+                    second = best;
+                    best = dis;
+                    label = j;
+                } else if (dis < second) {
+                    second = dis;
+                }
+            }
+            d1[i] = best;
+            d2[i] = second;
+            labels[i] = label;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        d1[i] = std::max(d1[i], 0.0f);
+        d2[i] = std::max(d2[i], 0.0f);
+    }
+}
+
+// Assign rows (all n rows of x, or x[idx[0..n)] when idx is given) to their nearest centroids. d2 is optional.
+Status
+AssignNearest(const float* x, const int64_t* idx, size_t n, const float* c, size_t k, size_t d, int64_t* labels,
+              float* d1, float* d2) {
+    std::vector<float> c_norms(k);
+    faiss::fvec_norms_L2sqr(c_norms.data(), c, d, k);
+    return ParallelFor(n, kMinRowsPerTask, [&](size_t begin, size_t end) {
+        std::vector<float> rows(idx == nullptr ? 0 : kAssignBlockRows * d);
+        std::vector<float> ip(kAssignBlockRows * std::min(k, kAssignBlockCentroids));
+        std::vector<float> x_norms(kAssignBlockRows);
+        std::vector<float> second(d2 == nullptr ? kAssignBlockRows : 0);
+        for (size_t i0 = begin; i0 < end; i0 += kAssignBlockRows) {
+            size_t i1 = std::min(end, i0 + kAssignBlockRows);
+            const float* xi = x + i0 * d;
+            if (idx != nullptr) {
+                for (size_t i = i0; i < i1; ++i) {
+                    std::copy_n(x + idx[i] * d, d, rows.data() + (i - i0) * d);
+                }
+                xi = rows.data();
+            }
+            AssignBlock(xi, i1 - i0, c, c_norms.data(), k, d, labels + i0, d1 + i0,
+                        d2 == nullptr ? second.data() : d2 + i0, x_norms.data(), ip.data());
+        }
+    });
+}
+
+// Bucket the rows by label: rows of centroid j are order[offsets[j] .. offsets[j + 1]).
+void
+GroupByLabel(const int64_t* labels, size_t n, size_t k, std::vector<int64_t>& offsets, std::vector<int64_t>& order) {
+    offsets.assign(k + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        offsets[labels[i] + 1]++;
+    }
+    for (size_t j = 0; j < k; ++j) {
+        offsets[j + 1] += offsets[j];
+    }
+    order.resize(n);
+    std::vector<int64_t> pos(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        order[pos[labels[i]]++] = i;
+    }
+}
+
+// D^2 sampling over weighted points, used by KMEANS++ directly and by KMEANS|| to reduce its candidates.
+Status
+KmeansPlusPlus(const float* x, const float* weights, size_t n, size_t k, size_t d, std::mt19937_64& rng,
+               float* centroids) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<float> mind(n, std::numeric_limits<float>::max());
+    auto first = std::min<size_t>(n - 1, uniform(rng) * n);
+    std::copy_n(x + first * d, d, centroids);
+    for (size_t c = 0; c < k; ++c) {
+        const float* cur = centroids + c * d;
+        auto status = ParallelFor(n, kMinRowsPerTask, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                mind[i] = std::min(mind[i], faiss::fvec_L2sqr(x + i * d, cur, d));
+            }
+        });
+        if (status != Status::success) {
+            return status;
+        }
+        if (c + 1 == k) {
+            break;
+        }
+        double total = 0;
+        for (size_t i = 0; i < n; ++i) {
+            total += (weights == nullptr ? 1.0f : weights[i]) * mind[i];
+        }
+        size_t next = 0;
+        if (total > 0) {
+            double r = uniform(rng) * total;
+            for (next = 0; next + 1 < n; ++next) {
+                r -= (weights == nullptr ? 1.0f : weights[next]) * mind[next];
+                if (r <= 0) {
+                    break;
+                }
+            }
+        } else {
+            // fewer distinct points than clusters, duplicates get split later
+            next = std::min<size_t>(n - 1, uniform(rng) * n);
+        }
+        std::copy_n(x + next * d, d, centroids + (c + 1) * d);
+    }
+    return Status::success;
+}
+
+}  // namespace
+
+template <typename DataType>
+class KmeansClusterNode : public ClusterNode {
+ public:
+    KmeansClusterNode(const Object& object) {
+    }
+
+    expected<DataSetPtr>
+    Train(const DataSet& dataset, const Config& cfg) override {
+        const KmeansConfig& kmeans_cfg = static_cast<const KmeansConfig&>(cfg);
+        auto rows = static_cast<size_t>(dataset.GetRows());
+        auto dim = static_cast<size_t>(dataset.GetDim());
+        auto k = static_cast<size_t>(kmeans_cfg.num_clusters.value());
+        if (rows < k) {
+            auto msg = "number of rows(" + std::to_string(rows) + ") should not be smaller than num_clusters(" +
+                       std::to_string(k) + ")";
+            LOG_KNOWHERE_ERROR_ << msg;
+            return expected<DataSetPtr>::Err(Status::invalid_args, msg);
+        }
+
+        auto converted = ToFloat(dataset);
+        auto x = converted == nullptr ? static_cast<const float*>(dataset.GetTensor())
+                                      : static_cast<const float*>(converted->GetTensor());
+
+        std::mt19937_64 rng(kmeans_cfg.kmeans_seed.value());
+        auto n_train = std::max(k, static_cast<size_t>(rows * kmeans_cfg.kmeans_trainset_fraction.value()));
+        std::vector<float> sample;
+        const float* xt = x;
+        if (n_train < rows) {
+            std::vector<int64_t> perm(rows);
+            std::iota(perm.begin(), perm.end(), 0);
+            for (size_t i = 0; i < n_train; ++i) {
+                std::swap(perm[i], perm[i + rng() % (rows - i)]);
+            }
+            std::sort(perm.begin(), perm.begin() + n_train);
+            sample.resize(n_train * dim);
+            for (size_t i = 0; i < n_train; ++i) {
+                std::copy_n(x + perm[i] * dim, dim, sample.data() + i * dim);
+            }
+            xt = sample.data();
+        }
+
+        std::vector<float> centroids(k * dim);
+        auto status = Init(xt, n_train, k, dim, kmeans_cfg, rng, centroids.data());
+        if (status == Status::success) {
+            status = kmeans_cfg.kmeans_batch_size.value() > 0
+                         ? MiniBatch(xt, n_train, k, dim, kmeans_cfg, rng, centroids.data())
+                         : Lloyd(xt, n_train, k, dim, kmeans_cfg, centroids.data());
+        }
+        if (status != Status::success) {
+            return expected<DataSetPtr>::Err(status, "kmeans training failed");
+        }
+        centroids_ = std::move(centroids);
+        num_clusters_ = k;
+        dim_ = dim;
+        return Assign(x, rows);
+    }
+
+    expected<DataSetPtr>
+    Assign(const DataSet& dataset) override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::cluster_inner_error, "kmeans is not trained");
+        }
+        if (static_cast<size_t>(dataset.GetDim()) != dim_) {
+            return expected<DataSetPtr>::Err(Status::invalid_args, "dim of the dataset does not match the centroids");
+        }
+        auto converted = ToFloat(dataset);
+        auto x = converted == nullptr ? static_cast<const float*>(dataset.GetTensor())
+                                      : static_cast<const float*>(converted->GetTensor());
+        return Assign(x, dataset.GetRows());
+    }
+
+    expected<DataSetPtr>
+    GetCentroids() const override {
+        if (centroids_.empty()) {
+            return expected<DataSetPtr>::Err(Status::cluster_inner_error, "kmeans is not trained");
+        }
+        auto data = new float[centroids_.size()];
+        std::copy(centroids_.begin(), centroids_.end(), data);
+        auto ds = GenResultDataSet(num_clusters_, dim_, data);
+        if constexpr (!std::is_same_v<DataType, fp32>) {
+            return data_type_conversion<float, DataType>(*ds);
+        } else {
+            return ds;
+        }
+    }
+
+    std::unique_ptr<Config>
+    CreateConfig() const override {
+        return std::make_unique<KmeansConfig>();
+    }
+
+    std::string
+    Type() const override {
+        return knowhere::ClusterEnum::CLUSTER_KMEANS;
+    }
+
+ private:
+    static DataSetPtr
+    ToFloat(const DataSet& dataset) {
+        if constexpr (!std::is_same_v<DataType, fp32>) {
+            return data_type_conversion<DataType, float>(dataset);
+        } else {
+            return nullptr;
+        }
+    }
+
+    expected<DataSetPtr>
+    Assign(const float* x, size_t rows) const {
+        std::vector<int64_t> labels(rows);
+        std::vector<float> dis(rows);
+        auto status =
+            AssignNearest(x, nullptr, rows, centroids_.data(), num_clusters_, dim_, labels.data(), dis.data(), nullptr);
+        if (status != Status::success) {
+            return expected<DataSetPtr>::Err(status, "kmeans assignment failed");
+        }
+        auto id_mapping = new uint32_t[rows];
+        std::copy(labels.begin(), labels.end(), id_mapping);
+        return GenResultDataSet(rows, 1, id_mapping);
+    }
+
+    static Status
+    Init(const float* x, size_t n, size_t k, size_t d, const KmeansConfig& cfg, std::mt19937_64& rng,
+         float* centroids) {
+        const auto& init = cfg.kmeans_init.value();
+        if (init == "RANDOM") {
+            std::vector<int64_t> perm(n);
+            std::iota(perm.begin(), perm.end(), 0);
+            for (size_t i = 0; i < k; ++i) {
+                std::swap(perm[i], perm[i + rng() % (n - i)]);
+                std::copy_n(x + perm[i] * d, d, centroids + i * d);
+            }
+            return Status::success;
+        }
+        if (init == "KMEANS++") {
+            return KmeansPlusPlus(x, nullptr, n, k, d, rng, centroids);
+        }
+        return KmeansParallel(x, n, k, d, rng, centroids);
+    }
+
+    // KMEANS|| (Bahmani et al.): a few rounds of independent oversampling with D^2 probabilities replace the k
+    // sequential passes of KMEANS++, the candidates are then weighted by their cluster sizes and reduced with
+    // KMEANS++.
+    static Status
+    KmeansParallel(const float* x, size_t n, size_t k, size_t d, std::mt19937_64& rng, float* centroids) {
+        uint64_t seed = rng();
+        const float* first = x + (rng() % n) * d;
+        std::vector<float> candidates(first, first + d);
+        std::vector<float> mind(n, std::numeric_limits<float>::max());
+        std::vector<int64_t> labels(n);
+        std::vector<float> dis(n);
+        size_t assigned = 0;
+        for (int round = 0; round <= kKmeansParallelRounds; ++round) {
+            // fold in the candidates added since last round
+            auto n_cand = candidates.size() / d;
+            auto status = AssignNearest(x, nullptr, n, candidates.data() + assigned * d, n_cand - assigned, d,
+                                        labels.data(), dis.data(), nullptr);
+            if (status != Status::success) {
+                return status;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                mind[i] = std::min(mind[i], dis[i]);
+            }
+            assigned = n_cand;
+            if (round == kKmeansParallelRounds) {
+                break;
+            }
+            double phi = std::accumulate(mind.begin(), mind.end(), 0.0);
+            if (phi <= 0) {
+                break;
+            }
+            double l = kKmeansParallelOversampling * k;
+            for (size_t i = 0; i < n; ++i) {
+                if (HashUniform(seed, round, i) < l * mind[i] / phi) {
+                    candidates.insert(candidates.end(), x + i * d, x + (i + 1) * d);
+                }
+            }
+            if (candidates.size() / d == assigned) {
+                break;
+            }
+        }
+
+        auto n_cand = candidates.size() / d;
+        if (n_cand <= k) {
+            std::copy(candidates.begin(), candidates.end(), centroids);
+            for (size_t c = n_cand; c < k; ++c) {
+                std::copy_n(x + (rng() % n) * d, d, centroids + c * d);
+            }
+            return Status::success;
+        }
+        auto status = AssignNearest(x, nullptr, n, candidates.data(), n_cand, d, labels.data(), dis.data(), nullptr);
+        if (status != Status::success) {
+            return status;
+        }
+        std::vector<float> weights(n_cand, 0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            weights[labels[i]] += 1.0f;
+        }
+        return KmeansPlusPlus(candidates.data(), weights.data(), n_cand, k, d, rng, centroids);
+    }
+
+    // Recompute the centroids as the mean of their rows, parallel over centroids so that no per-thread partial
+    // sums are needed. Empty clusters take half of the largest one. Returns the squared moves and the sum of the
+    // squared centroid norms for the convergence check.
+    static Status
+    UpdateCentroids(const float* x, const int64_t* labels, size_t n, size_t k, size_t d, float* centroids,
+                    float* moves, double& norm_sum) {
+        std::vector<int64_t> offsets, order;
+        GroupByLabel(labels, n, k, offsets, order);
+        std::vector<float> old(centroids, centroids + k * d);
+        auto status = ParallelFor(k, kMinCentroidsPerTask, [&](size_t begin, size_t end) {
+            std::vector<double> sum(d);
+            for (size_t j = begin; j < end; ++j) {
+                auto cnt = offsets[j + 1] - offsets[j];
+                if (cnt == 0) {
+                    continue;
+                }
+                std::fill(sum.begin(), sum.end(), 0.0);
+                for (auto p = offsets[j]; p < offsets[j + 1]; ++p) {
+                    const float* xi = x + order[p] * d;
+                    for (size_t t = 0; t < d; ++t) {
+                        sum[t] += xi[t];
+                    }
+                }
+                for (size_t t = 0; t < d; ++t) {
+                    centroids[j * d + t] = sum[t] / cnt;
+                }
+            }
+        });
+        if (status != Status::success) {
+            return status;
+        }
+
+        std::vector<int64_t> sizes(k);
+        for (size_t j = 0; j < k; ++j) {
+            sizes[j] = offsets[j + 1] - offsets[j];
+        }
+        size_t n_split = 0;
+        for (size_t j = 0; j < k; ++j) {
+            if (sizes[j] != 0) {
+                continue;
+            }
+            auto m = std::max_element(sizes.begin(), sizes.end()) - sizes.begin();
+            constexpr float kEps = 1.0f / 1024;
+            for (size_t t = 0; t < d; ++t) {
+                float v = centroids[m * d + t];
+                centroids[j * d + t] = v * (t % 2 == 0 ? 1 + kEps : 1 - kEps);
+                centroids[m * d + t] = v * (t % 2 == 0 ? 1 - kEps : 1 + kEps);
+            }
+            sizes[j] = sizes[m] / 2;
+            sizes[m] -= sizes[j];
+            ++n_split;
+        }
+        if (n_split > 0) {
+            LOG_KNOWHERE_DEBUG_ << "kmeans split " << n_split << " empty clusters";
+        }
+
+        norm_sum = 0;
+        for (size_t j = 0; j < k; ++j) {
+            moves[j] = faiss::fvec_L2sqr(centroids + j * d, old.data() + j * d, d);
+            norm_sum += faiss::fvec_norm_L2sqr(centroids + j * d, d);
+        }
+        return Status::success;
+    }
+
+    // Full-batch Lloyd iterations with Hamerly's bounds: every row keeps an upper bound on the distance to its own
+    // centroid and a lower bound on the distance to any other one, both loosened by how far the centroids moved.
+    // Only rows whose bounds overlap are re-assigned, and those are batched through the blocked sgemm kernel.
+    static Status
+    Lloyd(const float* x, size_t n, size_t k, size_t d, const KmeansConfig& cfg, float* centroids) {
+        std::vector<int64_t> labels(n);
+        std::vector<float> upper(n), lower(n);
+        auto status = AssignNearest(x, nullptr, n, centroids, k, d, labels.data(), upper.data(), lower.data());
+        if (status != Status::success) {
+            return status;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            upper[i] = std::sqrt(upper[i]);
+            lower[i] = std::sqrt(lower[i]);
+        }
+
+        std::vector<float> moves(k), half_gap(k);
+        std::vector<int64_t> cand, cand_labels;
+        std::vector<float> cand_d1, cand_d2;
+        auto n_iters = cfg.kmeans_n_iters.value();
+        for (int iter = 0; iter < n_iters; ++iter) {
+            double norm_sum = 0;
+            status = UpdateCentroids(x, labels.data(), n, k, d, centroids, moves.data(), norm_sum);
+            if (status != Status::success) {
+                return status;
+            }
+            double move_sum = std::accumulate(moves.begin(), moves.end(), 0.0);
+            if (move_sum <= cfg.kmeans_tolerance.value() * norm_sum || iter + 1 == n_iters) {
+                LOG_KNOWHERE_INFO_ << "kmeans stops after " << iter + 1 << " iterations";
+                break;
+            }
+
+            // half of the distance from each centroid to its closest other centroid
+            if (k > 1) {
+                std::vector<int64_t> cc_labels(k);
+                std::vector<float> cc_d1(k);
+                status = AssignNearest(centroids, nullptr, k, centroids, k, d, cc_labels.data(), cc_d1.data(),
+                                       half_gap.data());
+                if (status != Status::success) {
+                    return status;
+                }
+            } else {
+                half_gap[0] = std::numeric_limits<float>::max();
+            }
+            size_t max_j = 0;
+            for (size_t j = 0; j < k; ++j) {
+                moves[j] = std::sqrt(moves[j]);
+                half_gap[j] = std::sqrt(half_gap[j]) / 2;
+                if (moves[j] > moves[max_j]) {
+                    max_j = j;
+                }
+            }
+            float max_move = moves[max_j], second_move = 0;
+            for (size_t j = 0; j < k; ++j) {
+                if (j != max_j) {
+                    second_move = std::max(second_move, moves[j]);
+                }
+            }
+
+            cand.clear();
+            std::vector<uint8_t> need(n, 0);
+            status = ParallelFor(n, kMinRowsPerTask, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    auto a = labels[i];
+                    upper[i] += moves[a];
+                    lower[i] -= (a == static_cast<int64_t>(max_j)) ? second_move : max_move;
+                    float bound = std::max(half_gap[a], lower[i]);
+                    if (upper[i] <= bound) {
+                        continue;
+                    }
+                    upper[i] = std::sqrt(faiss::fvec_L2sqr(x + i * d, centroids + a * d, d));
+                    if (upper[i] > bound) {
+                        need[i] = 1;
+                    }
+                }
+            });
+            if (status != Status::success) {
+                return status;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                if (need[i]) {
+                    cand.push_back(i);
+                }
+            }
+            if (!cand.empty()) {
+                cand_labels.resize(cand.size());
+                cand_d1.resize(cand.size());
+                cand_d2.resize(cand.size());
+                status = AssignNearest(x, cand.data(), cand.size(), centroids, k, d, cand_labels.data(),
+                                       cand_d1.data(), cand_d2.data());
+                if (status != Status::success) {
+                    return status;
+                }
+                for (size_t p = 0; p < cand.size(); ++p) {
+                    auto i = cand[p];
+                    labels[i] = cand_labels[p];
+                    upper[i] = std::sqrt(cand_d1[p]);
+                    lower[i] = std::sqrt(cand_d2[p]);
+                }
+            }
+            LOG_KNOWHERE_DEBUG_ << "kmeans iteration " << iter << ", re-assigned " << cand.size() << " of " << n
+                                << " rows";
+        }
+        return Status::success;
+    }
+
+    // Mini-batch kmeans (Sculley): each iteration assigns a random batch and moves every centroid towards its rows
+    // with a per-centroid learning rate of 1 / (rows seen so far).
+    static Status
+    MiniBatch(const float* x, size_t n, size_t k, size_t d, const KmeansConfig& cfg, std::mt19937_64& rng,
+              float* centroids) {
+        auto batch = std::min(n, static_cast<size_t>(cfg.kmeans_batch_size.value()));
+        std::vector<int64_t> counts(k, 0);
+        std::vector<int64_t> idx(batch), labels(batch), offsets, order;
+        std::vector<float> dis(batch), old(k * d);
+        auto n_iters = cfg.kmeans_n_iters.value();
+        for (int iter = 0; iter < n_iters; ++iter) {
+            for (size_t i = 0; i < batch; ++i) {
+                idx[i] = rng() % n;
+            }
+            auto status = AssignNearest(x, idx.data(), batch, centroids, k, d, labels.data(), dis.data(), nullptr);
+            if (status != Status::success) {
+                return status;
+            }
+            GroupByLabel(labels.data(), batch, k, offsets, order);
+            std::copy_n(centroids, k * d, old.data());
+            status = ParallelFor(k, kMinCentroidsPerTask, [&](size_t begin, size_t end) {
+                for (size_t j = begin; j < end; ++j) {
+                    float* c = centroids + j * d;
+                    for (auto p = offsets[j]; p < offsets[j + 1]; ++p) {
+                        const float* xi = x + idx[order[p]] * d;
+                        float eta = 1.0f / ++counts[j];
+                        for (size_t t = 0; t < d; ++t) {
+                            c[t] += eta * (xi[t] - c[t]);
+                        }
+                    }
+                }
+            });
+            if (status != Status::success) {
+                return status;
+            }
+            double move_sum = 0, norm_sum = 0;
+            for (size_t j = 0; j < k; ++j) {
+                move_sum += faiss::fvec_L2sqr(centroids + j * d, old.data() + j * d, d);
+                norm_sum += faiss::fvec_norm_L2sqr(centroids + j * d, d);
+            }
+            if (move_sum <= cfg.kmeans_tolerance.value() * norm_sum) {
+                LOG_KNOWHERE_INFO_ << "mini-batch kmeans stops after " << iter + 1 << " iterations";
+                break;
+            }
+        }
+        return Status::success;
+    }
+
+    std::vector<float> centroids_;
+    size_t num_clusters_ = 0;
+    size_t dim_ = 0;
+};
+
+#ifndef KNOWHERE_WITH_CARDINAL
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(KMEANS, KmeansClusterNode, fp32);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(KMEANS, KmeansClusterNode, fp16);
+KNOWHERE_CLUSTER_SIMPLE_REGISTER_GLOBAL(KMEANS, KmeansClusterNode, bf16);
+#endif
+
+}  // namespace knowhere
@@ -0,0 +1,90 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef KMEANS_CONFIG_H
+#define KMEANS_CONFIG_H
+
+#include "knowhere/comp/index_param.h"
+#include "knowhere/config.h"
+
+namespace knowhere {
+
+class KmeansConfig : public Config {
+ public:
+    CFG_INT num_clusters;
+    CFG_INT kmeans_n_iters;
+    CFG_FLOAT kmeans_trainset_fraction;
+    // one of RANDOM, KMEANS++ and KMEANS||
+    CFG_STRING kmeans_init;
+    // 0 runs full-batch Lloyd iterations with Hamerly bounds, otherwise each iteration updates the centroids from a
+    // random batch of this many rows
+    CFG_INT kmeans_batch_size;
+    CFG_FLOAT kmeans_tolerance;
+    CFG_INT kmeans_seed;
+    KNOHWERE_DECLARE_CONFIG(KmeansConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(num_clusters)
+            .description("number of clusters")
+            .set_default(8)
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_n_iters)
+            .description("max number of kmeans iterations")
+            .set_default(20)
+            .set_range(1, 65536)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_trainset_fraction)
+            .description("fraction of the rows sampled to train the centroids")
+            .set_default(1.0)
+            .set_range(0.0, 1.0)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_init)
+            .description("centroid initialization, one of RANDOM, KMEANS++ and KMEANS||")
+            .set_default("KMEANS++")
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_batch_size)
+            .description("rows per mini-batch iteration, 0 means full-batch")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_tolerance)
+            .description("stop once the centroids move less than this fraction of their norm in an iteration")
+            .set_default(1e-4)
+            .set_range(0.0, 1.0)
+            .for_cluster();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_seed)
+            .description("seed of the sampling and initialization")
+            .set_default(1234)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_cluster();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::CLUSTER) {
+            const auto& init = kmeans_init.value();
+            if (init != "RANDOM" && init != "KMEANS++" && init != "KMEANS||") {
+                *err_msg = "kmeans_init(" + init + ") should be one of RANDOM, KMEANS++ and KMEANS||";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::invalid_param_in_json;
+            }
+            if (kmeans_trainset_fraction.value() <= 0.0f) {
+                *err_msg = "kmeans_trainset_fraction should be larger than 0";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::out_of_range_in_json;
+            }
+        }
+        return Status::success;
+    }
+};
+
+}  // namespace knowhere
+
+#endif /* KMEANS_CONFIG_H */
@@ -11,13 +11,16 @@
 
 #include "knowhere/comp/brute_force.h"
 
+#include <cmath>
 #include <vector>
 
 #include "common/metric.h"
 #include "faiss/MetricType.h"
 #include "faiss/utils/binary_distances.h"
+#include "faiss/utils/Heap.h"
 #include "faiss/utils/distances.h"
 #include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/phase_timer.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/config.h"
 #include "knowhere/expected.h"
@@ -26,6 +29,7 @@
 #include "knowhere/range_util.h"
 #include "knowhere/sparse_utils.h"
 #include "knowhere/utils.h"
+#include "simd/hook.h"
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
 #include "knowhere/tracer.h"
@@ -37,12 +41,96 @@ namespace knowhere {
 
 class BruteForceConfig : public BaseConfig {};
 
+namespace {
+
+template <typename DataType>
+float
+HalfInnerProduct(const DataType* x, const DataType* y, size_t d) {
+    if constexpr (std::is_same_v<DataType, fp16>) {
+        return faiss::fp16_vec_inner_product(x, y, d);
+    } else {
+        return faiss::bf16_vec_inner_product(x, y, d);
+    }
+}
+
+template <typename DataType>
+float
+HalfL2sqr(const DataType* x, const DataType* y, size_t d) {
+    if constexpr (std::is_same_v<DataType, fp16>) {
+        return faiss::fp16_vec_L2sqr(x, y, d);
+    } else {
+        return faiss::bf16_vec_L2sqr(x, y, d);
+    }
+}
+
+template <typename DataType>
+float
+HalfNormL2sqr(const DataType* x, size_t d) {
+    if constexpr (std::is_same_v<DataType, fp16>) {
+        return faiss::fp16_vec_norm_L2sqr(x, d);
+    } else {
+        return faiss::bf16_vec_norm_L2sqr(x, d);
+    }
+}
+
+template <typename C, typename DistFunc>
+void
+HalfKnnScan(size_t ny, size_t k, float* distances, int64_t* labels, const BitsetView& bitset, DistFunc&& dist) {
+    faiss::heap_heapify<C>(k, distances, labels);
+    for (size_t j = 0; j < ny; ++j) {
+        if (!bitset.empty() && bitset.test(j)) {
+            continue;
+        }
+        const float dis = dist(j);
+        if (C::cmp(distances[0], dis)) {
+            faiss::heap_replace_top<C>(k, distances, labels, dis, j);
+        }
+    }
+    faiss::heap_reorder<C>(k, distances, labels);
+}
+
+// fp16 and bf16 vectors are scanned with the half precision kernels, instead of converting the whole base to fp32
+// for every search
+template <typename DataType>
+Status
+HalfKnn(const DataType* x, const DataType* y, size_t d, size_t ny, faiss::MetricType metric_type, bool is_cosine,
+        size_t k, float* distances, int64_t* labels, const BitsetView& bitset) {
+    switch (metric_type) {
+        case faiss::METRIC_L2:
+            HalfKnnScan<faiss::CMax<float, int64_t>>(ny, k, distances, labels, bitset,
+                                                     [&](size_t j) { return HalfL2sqr(x, y + j * d, d); });
+            return Status::success;
+        case faiss::METRIC_INNER_PRODUCT:
+            if (is_cosine) {
+                const float x_norm_sqr = HalfNormL2sqr(x, d);
+                const float x_norm = x_norm_sqr > 0 ? std::sqrt(x_norm_sqr) : 1.0f;
+                HalfKnnScan<faiss::CMin<float, int64_t>>(ny, k, distances, labels, bitset, [&](size_t j) {
+                    const DataType* y_j = y + j * d;
+                    return HalfInnerProduct(x, y_j, d) / (x_norm * std::sqrt(HalfNormL2sqr(y_j, d)));
+                });
+            } else {
+                HalfKnnScan<faiss::CMin<float, int64_t>>(ny, k, distances, labels, bitset,
+                                                         [&](size_t j) { return HalfInnerProduct(x, y + j * d, d); });
+            }
+            return Status::success;
+        default:
+            return Status::invalid_metric_type;
+    }
+}
+
+}  // namespace
+
 template <typename DataType>
 expected<DataSetPtr>
 BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset, const Json& config,
                    const BitsetView& bitset) {
-    auto base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
-    auto query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
+    DataSetPtr base(base_dataset);
+    DataSetPtr query(query_dataset);
+    if constexpr (!KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+        KNOWHERE_SCOPED_PHASE("search", "bf_convert");
+        base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+        query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
+    }
 
     auto xb = base->GetTensor();
     auto nb = base->GetRows();
@@ -69,6 +157,7 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
         span->SetAttribute(meta::DIM, dim);
         span->SetAttribute(meta::NQ, nq);
     }
+    tracer::ScopedPhaseSpans phase_spans(span);
 #endif
 
     std::string metric_str = cfg.metric_type.value();
@@ -84,6 +173,7 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
     auto distances = std::make_unique<float[]>(nq * topk);
 
     auto pool = ThreadPool::GetGlobalSearchThreadPool();
+    KNOWHERE_SCOPED_PHASE("search", "bf_scan");
     std::vector<folly::Future<Status>> futs;
     futs.reserve(nq);
     for (int i = 0; i < nq; ++i) {
@@ -92,6 +182,11 @@ BruteForce::Search(const DataSetPtr base_dataset, const DataSetPtr query_dataset
             auto cur_labels = labels_ptr + topk * index;
             auto cur_distances = distances_ptr + topk * index;
 
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                return HalfKnn((const DataType*)xq + dim * index, (const DataType*)xb, dim, nb, faiss_metric_type,
+                               is_cosine, topk, cur_distances, cur_labels, bitset);
+            }
+
             BitsetViewIDSelector bw_idselector(bitset);
             faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
 
@@ -165,8 +260,12 @@ template <typename DataType>
 Status
 BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_dataset, int64_t* ids, float* dis,
                           const Json& config, const BitsetView& bitset) {
-    auto base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
-    auto query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
+    DataSetPtr base(base_dataset);
+    DataSetPtr query(query_dataset);
+    if constexpr (!KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+        base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
+        query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
+    }
 
     auto xb = base->GetTensor();
     auto nb = base->GetRows();
@@ -212,6 +311,11 @@ BruteForce::SearchWithBuf(const DataSetPtr base_dataset, const DataSetPtr query_
             auto cur_labels = labels + topk * index;
             auto cur_distances = distances + topk * index;
 
+            if constexpr (KnowhereHalfPrecisionFloatPointTypeCheck<DataType>::value) {
+                return HalfKnn((const DataType*)xq + dim * index, (const DataType*)xb, dim, nb, faiss_metric_type,
+                               is_cosine, topk, cur_distances, cur_labels, bitset);
+            }
+
             BitsetViewIDSelector bw_idselector(bitset);
             faiss::IDSelector* id_selector = (bitset.empty()) ? nullptr : &bw_idselector;
 
@@ -287,6 +391,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
     DataSetPtr query(query_dataset);
     bool is_sparse = std::is_same<DataType, knowhere::sparse::SparseRow<float>>::value;
     if (!is_sparse) {
+        KNOWHERE_SCOPED_PHASE("range_search", "bf_convert");
         base = ConvertFromDataTypeIfNeeded<DataType>(base_dataset);
         query = ConvertFromDataTypeIfNeeded<DataType>(query_dataset);
     }
@@ -318,6 +423,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
         span->SetAttribute(meta::DIM, dim);
         span->SetAttribute(meta::NQ, nq);
     }
+    tracer::ScopedPhaseSpans phase_spans(span);
 #endif
 
     std::string metric_str = cfg.metric_type.value();
@@ -424,6 +530,7 @@ BruteForce::RangeSearch(const DataSetPtr base_dataset, const DataSetPtr query_da
         return expected<DataSetPtr>::Err(ret, "failed to brute force search");
     }
 
+    KNOWHERE_SCOPED_PHASE("range_search", "merge_results");
     auto range_search_result =
         GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter);
     auto res = GenResultDataSet(nq, std::move(range_search_result));
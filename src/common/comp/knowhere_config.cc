@@ -82,14 +82,41 @@ KnowhereConfig::SetSimdType(const SimdType simd_type) {
         faiss::use_avx2 = false;
         faiss::use_sse4_2 = false;
         LOG_KNOWHERE_INFO_ << "FAISS expect simdType::GENERIC";
+    } else if (simd_type == SimdType::AUTO_TUNE) {
+        faiss::use_avx512 = true;
+        faiss::use_avx2 = true;
+        faiss::use_sse4_2 = true;
+        LOG_KNOWHERE_INFO_ << "FAISS expect simdType::AUTO_TUNE";
     }
 #endif
     std::string simd_str;
-    faiss::fvec_hook(simd_str);
+    if (simd_type == SimdType::AUTO_TUNE) {
+        faiss::fvec_hook_autotune(simd_str);
+        for (const auto& selection : faiss::simd_kernel_selection()) {
+            std::string candidates;
+            for (const auto& [type, gbps] : selection.candidates) {
+                candidates += " " + type + "=" + std::to_string(gbps);
+            }
+            LOG_KNOWHERE_INFO_ << "FAISS hook " << selection.family << " kernels " << selection.simd_type
+                               << ", GB/s:" << candidates;
+        }
+    } else {
+        faiss::fvec_hook(simd_str);
+    }
     LOG_KNOWHERE_INFO_ << "FAISS hook " << simd_str;
     return simd_str;
 }
 
+std::vector<KnowhereConfig::SimdKernelInfo>
+KnowhereConfig::GetSimdKernelInfo() {
+    std::vector<SimdKernelInfo> infos;
+    for (auto& selection : faiss::simd_kernel_selection()) {
+        infos.push_back({std::move(selection.family), std::move(selection.simd_type), selection.gbps,
+                         std::move(selection.candidates)});
+    }
+    return infos;
+}
+
 void
 KnowhereConfig::EnablePatchForComputeFP32AsBF16() {
     LOG_KNOWHERE_INFO_ << "Enable patch for compute fp32 as bf16";
@@ -156,6 +183,11 @@ KnowhereConfig::SetSearchThreadPoolSize(size_t num_threads) {
     knowhere::ThreadPool::SetGlobalSearchThreadPoolSize(num_threads);
 }
 
+void
+KnowhereConfig::SetNumaSearchThreadPoolSize(size_t threads_per_node) {
+    knowhere::ThreadPool::SetNumaSearchThreadPoolSize(threads_per_node);
+}
+
 void
 KnowhereConfig::InitGPUResource(int64_t gpu_id, int64_t res_num) {
 #ifdef KNOWHERE_WITH_GPU
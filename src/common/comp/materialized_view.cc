@@ -11,11 +11,14 @@
 
 #include "knowhere/comp/materialized_view.h"
 
+#include <fstream>
+
 namespace knowhere {
 
 constexpr std::string_view kFieldIdToTouchedCategoriesCntKey = "field_id_to_touched_categories_cnt";
 constexpr std::string_view kIsPureAndKey = "is_pure_and";
 constexpr std::string_view kHasNotKey = "has_not";
+constexpr uint8_t kOptFieldsVersion = 0;
 
 void
 to_json(nlohmann::json& j, const MaterializedViewSearchInfo& info) {
@@ -44,4 +47,43 @@ from_json(const nlohmann::json& j, MaterializedViewSearchInfo& info) {
         j.at(kHasNotKey).get_to(info.has_not);
     }
 }
+
+expected<std::vector<OptFieldCategories>>
+ReadOptFields(const std::string& path) {
+    using Ret = expected<std::vector<OptFieldCategories>>;
+    std::ifstream reader(path, std::ios::binary);
+    if (!reader.is_open()) {
+        return Ret::Err(Status::disk_file_error, "failed to open opt fields file " + path);
+    }
+    auto read = [&reader](auto& v) { return static_cast<bool>(reader.read(reinterpret_cast<char*>(&v), sizeof(v))); };
+
+    uint8_t version = 0;
+    uint32_t num_fields = 0;
+    if (!read(version) || !read(num_fields)) {
+        return Ret::Err(Status::invalid_binary_set, "truncated opt fields file " + path);
+    }
+    if (version != kOptFieldsVersion) {
+        return Ret::Err(Status::invalid_binary_set, "unsupported opt fields version " + std::to_string(version));
+    }
+    std::vector<OptFieldCategories> fields(num_fields);
+    for (auto& field : fields) {
+        uint32_t num_categories = 0;
+        if (!read(field.field_id) || !read(num_categories)) {
+            return Ret::Err(Status::invalid_binary_set, "truncated opt fields file " + path);
+        }
+        field.category_rows.resize(num_categories);
+        for (auto& rows : field.category_rows) {
+            uint32_t num_rows = 0;
+            if (!read(num_rows)) {
+                return Ret::Err(Status::invalid_binary_set, "truncated opt fields file " + path);
+            }
+            rows.resize(num_rows);
+            if (!reader.read(reinterpret_cast<char*>(rows.data()), num_rows * sizeof(uint32_t))) {
+                return Ret::Err(Status::invalid_binary_set, "truncated opt fields file " + path);
+            }
+        }
+    }
+    return fields;
+}
+
 }  // namespace knowhere
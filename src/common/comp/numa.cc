@@ -0,0 +1,189 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/numa.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "knowhere/log.h"
+
+namespace knowhere::numa {
+
+namespace {
+
+#ifdef __linux__
+// from linux/mempolicy.h, which is not always installed
+constexpr int kMpolPreferred = 1;
+constexpr int kMpolInterleave = 3;
+constexpr unsigned long kMpolFNode = 1 << 0;
+constexpr unsigned long kMpolFAddr = 1 << 1;
+
+constexpr size_t kMaxNodes = 1024;
+constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+
+std::string
+ReadSysFile(const std::string& path) {
+    std::ifstream in(path);
+    std::string content;
+    std::getline(in, content);
+    return content;
+}
+#endif
+
+}  // namespace
+
+std::vector<int>
+ParseList(const std::string& list) {
+    std::vector<int> ids;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        auto comma = list.find(',', pos);
+        if (comma == std::string::npos) {
+            comma = list.size();
+        }
+        auto item = list.substr(pos, comma - pos);
+        pos = comma + 1;
+        if (item.empty()) {
+            continue;
+        }
+        try {
+            auto dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int id = first; id <= last; ++id) {
+                ids.push_back(id);
+            }
+        } catch (const std::exception&) {
+            LOG_KNOWHERE_WARNING_ << "Failed to parse list " << list;
+            return {};
+        }
+    }
+    return ids;
+}
+
+int
+NumNodes() {
+#ifdef __linux__
+    static const int num_nodes = [] {
+        auto nodes = ParseList(ReadSysFile("/sys/devices/system/node/online"));
+        return nodes.empty() ? 1 : nodes.back() + 1;
+    }();
+    return num_nodes;
+#else
+    return 1;
+#endif
+}
+
+std::vector<int>
+NodeCpus(int node) {
+#ifdef __linux__
+    return ParseList(ReadSysFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+#else
+    return {};
+#endif
+}
+
+bool
+PinCurrentThread(int node) {
+#ifdef __linux__
+    auto cpus = NodeCpus(node);
+    if (cpus.empty()) {
+        LOG_KNOWHERE_WARNING_ << "NUMA node " << node << " has no cpus";
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set); err != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to pin thread to NUMA node " << node << ", error is: " << std::strerror(err);
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int
+NodeOfAddress(const void* addr) {
+#ifdef __linux__
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, addr, kMpolFNode | kMpolFAddr) != 0) {
+        return -1;
+    }
+    return node;
+#else
+    return -1;
+#endif
+}
+
+ScopedMemoryPolicy::ScopedMemoryPolicy(int node) {
+#ifdef __linux__
+    Apply(kMpolPreferred, {node});
+#endif
+}
+
+ScopedMemoryPolicy::ScopedMemoryPolicy() {
+#ifdef __linux__
+    Apply(kMpolInterleave, ParseList(ReadSysFile("/sys/devices/system/node/online")));
+#endif
+}
+
+void
+ScopedMemoryPolicy::Apply(int mode, const std::vector<int>& nodes) {
+#ifdef __linux__
+    std::vector<unsigned long> mask(kMaxNodes / kBitsPerWord, 0);
+    for (auto node : nodes) {
+        if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+            LOG_KNOWHERE_WARNING_ << "NUMA node " << node << " is out of range";
+            return;
+        }
+        mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+    }
+    if (nodes.empty()) {
+        return;
+    }
+    prev_mask_.assign(kMaxNodes / kBitsPerWord, 0);
+    if (syscall(SYS_get_mempolicy, &prev_mode_, prev_mask_.data(), kMaxNodes + 1, nullptr, 0) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to read the memory policy, error is: " << std::strerror(errno);
+        return;
+    }
+    if (syscall(SYS_set_mempolicy, mode, mask.data(), kMaxNodes + 1) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to set the memory policy, error is: " << std::strerror(errno);
+        return;
+    }
+    applied_ = true;
+#endif
+}
+
+ScopedMemoryPolicy::~ScopedMemoryPolicy() {
+#ifdef __linux__
+    if (applied_ && syscall(SYS_set_mempolicy, prev_mode_, prev_mask_.data(), kMaxNodes + 1) != 0) {
+        LOG_KNOWHERE_WARNING_ << "Failed to restore the memory policy, error is: " << std::strerror(errno);
+    }
+#endif
+}
+
+}  // namespace knowhere::numa
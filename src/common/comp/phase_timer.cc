@@ -0,0 +1,56 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#include "knowhere/comp/phase_timer.h"
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+#include "knowhere/prometheus_client.h"
+#include "knowhere/tracer.h"
+#endif
+
+namespace knowhere {
+
+namespace {
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+class ExportingPhaseSink : public PhaseSink {
+ public:
+    bool
+    Begin(const PhaseSite& site) override {
+        return tracer::StartPhaseSpan(site.phase);
+    }
+
+    void
+    End(const PhaseSite& site, double ms, bool span) override {
+        if (span) {
+            tracer::EndPhaseSpan();
+        }
+        auto* histogram = static_cast<prometheus::Histogram*>(site.slot.load(std::memory_order_acquire));
+        if (histogram == nullptr) {
+            // Add returns the histogram already registered for the labels, so two threads racing here get the same one
+            histogram = &phase_latency_family.Add(
+                {{"module", "knowhere"}, {"operation", site.operation}, {"phase", site.phase}}, phaseLatencyBuckets);
+            site.slot.store(histogram, std::memory_order_release);
+        }
+        histogram->Observe(ms);
+    }
+};
+
+// never destroyed, the pool threads may still time phases while the library unloads
+const bool phase_sink_installed = [] {
+    PhaseSink::Set(new ExportingPhaseSink());
+    return true;
+}();
+#endif
+
+}  // namespace
+
+}  // namespace knowhere
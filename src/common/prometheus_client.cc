@@ -52,6 +52,12 @@ DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(search_topk, "search topk")
 DEFINE_PROMETHEUS_HISTOGRAM(search_topk, PROMETHEUS_LABEL_KNOWHERE)
 DEFINE_PROMETHEUS_HISTOGRAM(search_topk, PROMETHEUS_LABEL_CARDINAL)
 
+// most tasks start within a millisecond, the tail is what matters under overload
+const prometheus::Histogram::BucketBoundaries queueWaitBuckets = {
+    0.05, 0.1, 0.25, 0.5, 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 16384};
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(queue_wait_latency, "time a task waits in a fair thread pool queue (ms)")
+DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(queue_wait_latency, PROMETHEUS_LABEL_KNOWHERE, queueWaitBuckets)
+
 DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(bitset_ratio, "bitset ratio")
 DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(bitset_ratio, PROMETHEUS_LABEL_CARDINAL, ratioBuckets)
 
@@ -72,4 +78,17 @@ DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(diskann_range_search_iters, "DISKANN range se
 DEFINE_PROMETHEUS_HISTOGRAM_WITH_BUCKETS(diskann_range_search_iters, PROMETHEUS_LABEL_KNOWHERE,
                                          diskannRangeSearchIterBuckets)
 
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_distance_computations, "distances computed by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_nodes_visited, "graph nodes expanded by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_lists_probed, "inverted or posting lists scanned by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_codes_scanned, "codes or posting list entries read by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_bytes_read, "bytes read from disk by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_cache_hits, "nodes served from the cache by searches")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_queue_wait, "time search tasks waited in the thread pool (ms)")
+DEFINE_PROMETHEUS_COUNTER_FAMILY(search_cpu_time, "cpu time of searches (ms)")
+
+const prometheus::Histogram::BucketBoundaries phaseLatencyBuckets = {
+    0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 60000, 600000};
+DEFINE_PROMETHEUS_HISTOGRAM_FAMILY(phase_latency, "latency of the phases of search, build and load (ms)")
+
 }  // namespace knowhere
@@ -151,4 +151,35 @@ GetTraceCtxFromCfg(const BaseConfig* cfg) {
     return tracer::TraceContext{trace_id.data(), span_id.data(), (uint8_t)trace_flags};
 }
 
+// the span of the request, then the spans of the phases open on this thread
+thread_local std::vector<std::shared_ptr<trace::Span>> phase_spans;
+
+ScopedPhaseSpans::ScopedPhaseSpans(std::shared_ptr<trace::Span> span) {
+    prev_.swap(phase_spans);
+    if (enable_trace && span != nullptr) {
+        phase_spans.push_back(std::move(span));
+    }
+}
+
+ScopedPhaseSpans::~ScopedPhaseSpans() {
+    phase_spans.swap(prev_);
+}
+
+bool
+StartPhaseSpan(const char* phase) {
+    if (phase_spans.empty()) {
+        return false;
+    }
+    trace::StartSpanOptions opts;
+    opts.parent = phase_spans.back()->GetContext();
+    phase_spans.push_back(GetTracer()->StartSpan(phase, opts));
+    return true;
+}
+
+void
+EndPhaseSpan() {
+    phase_spans.back()->End();
+    phase_spans.pop_back();
+}
+
 }  // namespace knowhere::tracer
@@ -96,6 +96,18 @@ CopyAndNormalizeVecs(const DataType* x, size_t rows, int32_t dim) {
     return x_normalized;
 }
 
+// copy the vectors of a dataset into a normalized dataset that owns them
+template <typename DataType>
+DataSetPtr
+CopyAndNormalizeDataSet(const DataSetPtr dataset) {
+    auto rows = dataset->GetRows();
+    auto dim = dataset->GetDim();
+    auto data = CopyAndNormalizeVecs((const DataType*)dataset->GetTensor(), rows, dim);
+    auto res = GenDataSet(rows, dim, data.release());
+    res->SetIsOwner(true);
+    return res;
+}
+
 void
 ConvertIVFFlat(const BinarySet& binset, const MetricType metric_type, const uint8_t* raw_data, const size_t raw_size) {
     std::vector<std::string> names = {"IVF",  // compatible with knowhere-1.x
@@ -169,4 +181,11 @@ template std::unique_ptr<fp16[]>
 CopyAndNormalizeVecs(const fp16* x, size_t rows, int32_t dim);
 template std::unique_ptr<bf16[]>
 CopyAndNormalizeVecs(const bf16* x, size_t rows, int32_t dim);
+
+template DataSetPtr
+CopyAndNormalizeDataSet<fp32>(const DataSetPtr dataset);
+template DataSetPtr
+CopyAndNormalizeDataSet<fp16>(const DataSetPtr dataset);
+template DataSetPtr
+CopyAndNormalizeDataSet<bf16>(const DataSetPtr dataset);
 }  // namespace knowhere
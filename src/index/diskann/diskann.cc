@@ -19,6 +19,8 @@
 #include "fmt/core.h"
 #include "index/diskann/diskann_config.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/phase_timer.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -191,6 +193,17 @@ TryDiskANNCall(std::function<void()>&& diskann_call) {
     }
 }
 
+// every io of a beam reads one sector
+SearchStats
+ToSearchStats(const diskann::QueryStats& query_stats) {
+    SearchStats stats;
+    stats.distance_computations = query_stats.n_cmps;
+    stats.nodes_visited = query_stats.n_hops;
+    stats.bytes_read = static_cast<int64_t>(query_stats.n_ios) * SECTOR_LEN;
+    stats.cache_hits = query_stats.n_cache_hits;
+    return stats;
+}
+
 std::vector<std::string>
 GetNecessaryFilenames(const std::string& prefix, const bool need_norm, const bool use_sample_cache,
                       const bool use_sample_warmup) {
@@ -311,6 +324,7 @@ DiskANNIndexNode<DataType>::Build(const DataSetPtr dataset, const Config& cfg) {
                                                        static_cast<uint32_t>(num_nodes_to_cache),
                                                        build_conf.shuffle_build.value()};
     RETURN_IF_ERROR(TryDiskANNCall([&]() {
+        KNOWHERE_SCOPED_PHASE("build", "diskann_build");
         int res = diskann::build_disk_index<DataType>(diskann_internal_build_config);
         if (res != 0)
             throw diskann::ANNException("diskann::build_disk_index returned non-zero value: " + std::to_string(res),
@@ -393,6 +407,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
 
     pq_flash_index_ = std::make_unique<diskann::PQFlashIndex<DataType>>(reader, diskann_metric);
     auto disk_ann_call = [&]() {
+        KNOWHERE_SCOPED_PHASE("load", "diskann_load");
         int res = pq_flash_index_->load(search_pool_->size(), index_prefix_.c_str());
         if (res != 0) {
             throw diskann::ANNException("pq_flash_index_->load returned non-zero value: " + std::to_string(res), -1);
@@ -430,6 +445,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
             return Status::invalid_args;
         }
         if (num_nodes_to_cache > 0) {
+            KNOWHERE_SCOPED_PHASE("load", "diskann_cache_list");
             LOG_KNOWHERE_INFO_ << "Caching " << num_nodes_to_cache << " sample nodes around medoid(s).";
             if (prep_conf.use_bfs_cache.value()) {
                 LOG_KNOWHERE_INFO_ << "Use bfs to generate cache list";
@@ -453,6 +469,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
     }
 
     if (node_list.size() > 0) {
+        KNOWHERE_SCOPED_PHASE("load", "diskann_cache");
         if (TryDiskANNCall([&]() { pq_flash_index_->load_cache_list(node_list); }) != Status::success) {
             LOG_KNOWHERE_ERROR_ << "Failed to load cache for DiskANN.";
             return Status::diskann_inner_error;
@@ -461,6 +478,7 @@ DiskANNIndexNode<DataType>::Deserialize(const BinarySet& binset, const Config& c
 
     // warmup
     if (prep_conf.warm_up.value()) {
+        KNOWHERE_SCOPED_PHASE("load", "diskann_warmup");
         LOG_KNOWHERE_INFO_ << "Warming up.";
         uint64_t warmup_L = 20;
         uint64_t warmup_num = 0;
@@ -521,6 +539,7 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg,
     auto beamwidth = static_cast<uint64_t>(search_conf.beamwidth.value());
     auto filter_ratio = static_cast<float>(search_conf.filter_threshold.value());
     auto for_tuning = static_cast<bool>(search_conf.for_tuning.value());
+    auto early_stop_patience = static_cast<uint64_t>(search_conf.early_stop_patience.value());
 
     auto nq = dataset->GetRows();
     auto dim = dataset->GetDim();
@@ -546,10 +565,13 @@ DiskANNIndexNode<DataType>::Search(const DataSetPtr dataset, const Config& cfg,
             diskann::QueryStats stats;
             pq_flash_index_->cached_beam_search(xq + (index * dim), k, lsearch, p_id_ptr + (index * k),
                                                 p_dist_ptr + (index * k), beamwidth, false, &stats, feder_result,
-                                                bitset, filter_ratio, for_tuning);
+                                                bitset, filter_ratio, for_tuning, early_stop_patience);
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_search_hops.Observe(stats.n_hops);
 #endif
+            KNOWHERE_OBSERVE_PHASE("search", "diskann_io", stats.io_us / 1000);
+            KNOWHERE_OBSERVE_PHASE("search", "diskann_compute", stats.cpu_us / 1000);
+            AddSearchStats(ToSearchStats(stats));
         }));
     }
 
@@ -613,6 +635,9 @@ DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config&
 #ifdef NOT_COMPILE_FOR_SWIG
             knowhere_diskann_range_search_iters.Observe(stats.n_iters);
 #endif
+            KNOWHERE_OBSERVE_PHASE("range_search", "diskann_io", stats.io_us / 1000);
+            KNOWHERE_OBSERVE_PHASE("range_search", "diskann_compute", stats.cpu_us / 1000);
+            AddSearchStats(ToSearchStats(stats));
             // filter range search result
             if (search_conf.range_filter.value() != defaultRangeFilter) {
                 FilterRangeSearchResultForOneNq(result_dist_array[index], result_id_array[index], is_ip, radius,
@@ -624,6 +649,7 @@ DiskANNIndexNode<DataType>::RangeSearch(const DataSetPtr dataset, const Config&
         return expected<DataSetPtr>::Err(Status::diskann_inner_error, "some search failed");
     }
 
+    KNOWHERE_SCOPED_PHASE("range_search", "merge_results");
     auto range_search_result =
         GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, search_conf.range_filter.value());
     return GenResultDataSet(nq, std::move(range_search_result));
@@ -72,6 +72,9 @@ class DiskANNConfig : public BaseConfig {
     // value should be in range of [0.0, 1.0] which means when greater or equal to x% of the bits are set,
     // use PQ + Refine. Default to -1.0f, negative vlaues will use dynamic threshold calculator given topk.
     CFG_FLOAT filter_threshold;
+    // Stop the beam search once the top-k candidates have not improved for this many search rounds, so that easy
+    // queries do not pay for a search_list_size tuned for the hard ones. 0 means disabled.
+    CFG_INT early_stop_patience;
     KNOHWERE_DECLARE_CONFIG(DiskANNConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(max_degree)
             .description("the degree of the graph index.")
@@ -138,6 +141,11 @@ class DiskANNConfig : public BaseConfig {
             .set_range(-1.0f, 1.0f)
             .for_search()
             .for_iterator();
+        KNOWHERE_CONFIG_DECLARE_FIELD(early_stop_patience)
+            .description("stop searching once the top-k has not improved for this many rounds, 0 means disabled.")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
     }
 
     Status
@@ -17,6 +17,7 @@
 #include "index/flat/flat_config.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/index/index_factory.h"
 #include "knowhere/index/index_node_data_mock_wrapper.h"
@@ -129,6 +130,7 @@ class FlatIndexNode : public IndexNode {
             }
             // wait for the completion
             WaitAllSuccess(futs);
+            AddScanStats(nq, bitset);
         } catch (const std::exception& e) {
             std::unique_ptr<int64_t[]> auto_delete_ids(ids);
             std::unique_ptr<float[]> auto_delete_dis(distances);
@@ -206,6 +208,7 @@ class FlatIndexNode : public IndexNode {
             }
             // wait for the completion
             WaitAllSuccess(futs);
+            AddScanStats(nq, bitset);
             range_search_result =
                 GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter);
         } catch (const std::exception& e) {
@@ -336,6 +339,11 @@ class FlatIndexNode : public IndexNode {
         return Status::success;
     }
 
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        search_pool_ = std::move(pool);
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return std::make_unique<FlatConfig>();
@@ -367,6 +375,15 @@ class FlatIndexNode : public IndexNode {
     }
 
  private:
+    // every query compares against all the vectors that pass the bitset
+    void
+    AddScanStats(int64_t nq, const BitsetView& bitset) const {
+        SearchStats stats;
+        stats.codes_scanned = nq * (index_->ntotal - static_cast<int64_t>(bitset.empty() ? 0 : bitset.count()));
+        stats.distance_computations = stats.codes_scanned;
+        AddSearchStats(stats);
+    }
+
     std::unique_ptr<IndexType> index_;
     std::shared_ptr<ThreadPool> search_pool_;
 };
@@ -124,8 +124,21 @@ struct GpuRaftIndexNode : public IndexNode {
                 auto rows = dataset->GetRows();
                 auto dim = dataset->GetDim();
                 auto const* data = reinterpret_cast<float const*>(dataset->GetTensor());
+                // the device filter takes a bitmap, expand an allow-list that came without one
+                auto const* bits = bitset.data();
+                auto dense_bits = std::vector<uint8_t>{};
+                if (bits == nullptr && bitset.has_allowed_ids()) {
+                    dense_bits.assign(bitset.byte_size(), 0xff);
+                    for (auto i = size_t{}; i < bitset.allowed_num(); ++i) {
+                        auto id = bitset.allowed_ids()[i];
+                        if (id < static_cast<int64_t>(bitset.size())) {
+                            dense_bits[id >> 3] &= ~(uint8_t{1} << (id & 0x7));
+                        }
+                    }
+                    bits = dense_bits.data();
+                }
                 auto search_result =
-                    index_.search(raft_cfg, data, rows, dim, bitset.data(), bitset.byte_size(), bitset.size());
+                    index_.search(raft_cfg, data, rows, dim, bits, bitset.byte_size(), bitset.size());
                 std::this_thread::yield();
                 index_.synchronize();
                 return GenResultDataSet(rows, raft_cfg.k, std::get<0>(search_result), std::get<1>(search_result));
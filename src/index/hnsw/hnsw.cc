@@ -11,6 +11,7 @@
 
 #include "knowhere/feder/HNSW.h"
 
+#include <cstring>
 #include <new>
 #include <numeric>
 
@@ -18,6 +19,7 @@
 #include "hnswlib/hnswlib.h"
 #include "index/hnsw/hnsw_config.h"
 #include "knowhere/comp/index_param.h"
+#include "knowhere/comp/phase_timer.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/config.h"
@@ -27,6 +29,7 @@
 #include "knowhere/log.h"
 #include "knowhere/range_util.h"
 #include "knowhere/utils.h"
+#include "simd/hook.h"
 
 namespace knowhere {
 
@@ -45,6 +48,17 @@ class HnswIndexNode : public IndexNode {
         auto rows = dataset->GetRows();
         auto dim = dataset->GetDim();
         auto hnsw_cfg = static_cast<const HnswConfig&>(cfg);
+        if (hnsw_cfg.embed_neighbor_codes.value()) {
+            if constexpr (!KnowhereFloatTypeCheck<DataType>::value) {
+                LOG_KNOWHERE_WARNING_ << "neighbor codes are not supported for binary vectors";
+                return Status::invalid_args;
+            }
+            if (dim % hnsw_cfg.neighbor_code_m.value() != 0) {
+                LOG_KNOWHERE_WARNING_ << "dim " << dim << " is not a multiple of neighbor_code_m "
+                                      << hnsw_cfg.neighbor_code_m.value();
+                return Status::invalid_args;
+            }
+        }
         hnswlib::SpaceInterface<DistType>* space = nullptr;
         if constexpr (KnowhereFloatTypeCheck<DataType>::value) {
             if (IsMetricType(hnsw_cfg.metric_type.value(), metric::L2)) {
@@ -82,6 +96,7 @@ class HnswIndexNode : public IndexNode {
             LOG_KNOWHERE_WARNING_ << "index not empty, deleted old index";
         }
         this->index_ = index;
+        BindFvecKernels(hnsw_cfg);
         if constexpr (quant_type != QuantType::None) {
             this->index_->trainSQuant((const DataType*)dataset->GetTensor(), rows);
         }
@@ -124,39 +139,58 @@ class HnswIndexNode : public IndexNode {
             std::shuffle(shuffle_batch_ids.begin(), shuffle_batch_ids.end(), urng);
         }
         try {
-            index_->addPoint(tensor, 0);
-
-            futures.reserve(batch_size);
-            for (int64_t round_id = 0; round_id < round_num; round_id++) {
-                int64_t start_id = (shuffle_build ? shuffle_batch_ids[round_id] : round_id) * batch_size;
-                int64_t end_id =
-                    std::min(rows - 1, ((shuffle_build ? shuffle_batch_ids[round_id] : round_id) + 1) * batch_size);
-                for (int64_t i = start_id; i < end_id; ++i) {
-                    futures.emplace_back(build_pool->push([&, idx = i + 1]() {
-                        index_->addPoint(((const char*)tensor + index_->data_size_ * idx), idx);
-                        uint64_t added = counter.fetch_add(1);
-                        if (added % one_tenth_row == 0) {
-                            LOG_KNOWHERE_INFO_ << "HNSW build progress: " << (added / one_tenth_row) << "0%";
-                        }
-                    }));
+            {
+                KNOWHERE_SCOPED_PHASE("build", "hnsw_insert");
+                index_->addPoint(tensor, 0);
+
+                futures.reserve(batch_size);
+                for (int64_t round_id = 0; round_id < round_num; round_id++) {
+                    int64_t start_id = (shuffle_build ? shuffle_batch_ids[round_id] : round_id) * batch_size;
+                    int64_t end_id =
+                        std::min(rows - 1, ((shuffle_build ? shuffle_batch_ids[round_id] : round_id) + 1) * batch_size);
+                    for (int64_t i = start_id; i < end_id; ++i) {
+                        futures.emplace_back(build_pool->push([&, idx = i + 1]() {
+                            index_->addPoint(((const char*)tensor + index_->data_size_ * idx), idx);
+                            uint64_t added = counter.fetch_add(1);
+                            if (added % one_tenth_row == 0) {
+                                LOG_KNOWHERE_INFO_ << "HNSW build progress: " << (added / one_tenth_row) << "0%";
+                            }
+                        }));
+                    }
+                    WaitAllSuccess(futures);
+                    futures.clear();
                 }
-                WaitAllSuccess(futures);
-                futures.clear();
             }
 
             build_time.RecordSection("graph build");
-            std::vector<unsigned> unreached = index_->findUnreachableVectors();
-            int unreached_num = unreached.size();
-            LOG_KNOWHERE_INFO_ << "there are " << unreached_num << " points can not be reached";
-            if (unreached_num > 0) {
-                futures.reserve(unreached_num);
-                for (int i = 0; i < unreached_num; ++i) {
-                    futures.emplace_back(
-                        build_pool->push([&, idx = i]() { index_->repairGraphConnectivity(unreached[idx]); }));
+            {
+                KNOWHERE_SCOPED_PHASE("build", "hnsw_repair");
+                std::vector<unsigned> unreached = index_->findUnreachableVectors();
+                int unreached_num = unreached.size();
+                LOG_KNOWHERE_INFO_ << "there are " << unreached_num << " points can not be reached";
+                if (unreached_num > 0) {
+                    futures.reserve(unreached_num);
+                    for (int i = 0; i < unreached_num; ++i) {
+                        futures.emplace_back(
+                            build_pool->push([&, idx = i]() { index_->repairGraphConnectivity(unreached[idx]); }));
+                    }
+                    WaitAllSuccess(futures);
                 }
-                WaitAllSuccess(futures);
             }
             build_time.RecordSection("graph repair");
+            const auto& reorder = hnsw_cfg.graph_reorder.value();
+            if (reorder != "NONE") {
+                KNOWHERE_SCOPED_PHASE("build", "hnsw_reorder");
+                index_->reorderGraph(reorder == "BFS" ? hnswlib::ReorderType::BFS : hnswlib::ReorderType::RCM);
+                build_time.RecordSection("graph reorder");
+            }
+            if constexpr (KnowhereFloatTypeCheck<DataType>::value) {
+                if (hnsw_cfg.embed_neighbor_codes.value()) {
+                    KNOWHERE_SCOPED_PHASE("build", "hnsw_neighbor_codes");
+                    index_->buildNeighborCodes((const DataType*)tensor, rows, hnsw_cfg.neighbor_code_m.value());
+                    build_time.RecordSection("neighbor codes");
+                }
+            }
             LOG_KNOWHERE_INFO_ << "HNSW built with #points num:" << index_->max_elements_ << " #M:" << index_->M_
                                << " #max level:" << index_->maxlevel_
                                << " #ef_construction:" << index_->ef_construction_
@@ -170,6 +204,70 @@ class HnswIndexNode : public IndexNode {
 
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override {
+        return SearchImpl(dataset, cfg, bitset, false, nullptr);
+    }
+
+    expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Config& cfg) const override {
+        if (!index_) {
+            LOG_KNOWHERE_WARNING_ << "prepare query on empty index";
+            return expected<QueryContextPtr>::Err(Status::empty_index, "index not loaded");
+        }
+        if constexpr (!KnowhereFloatTypeCheck<DataType>::value) {
+            return IndexNode::PrepareQuery(dataset, cfg);
+        } else {
+            const auto& hnsw_cfg = static_cast<const HnswConfig&>(cfg);
+            auto queries = dataset;
+            bool normalized = index_->metric_type_ == hnswlib::Metric::COSINE;
+            if (normalized) {
+                queries = CopyAndNormalizeDataSet<DataType>(dataset);
+            }
+            std::unique_ptr<HnswPreparedQueries> prepared = nullptr;
+            if constexpr (hnswlib::HierarchicalNSW<DataType, DistType, quant_type>::sq_enabled) {
+                auto nq = queries->GetRows();
+                auto dim = Dim();
+                auto xq = (const DataType*)queries->GetTensor();
+                prepared = std::make_unique<HnswPreparedQueries>();
+                prepared->codes = std::make_unique<int8_t[]>(nq * dim);
+                for (int64_t i = 0; i < nq; ++i) {
+                    index_->encodeSQuant(xq + i * dim, prepared->codes.get() + i * dim);
+                }
+            }
+            return std::make_shared<const QueryContext>(queries, Type(), hnsw_cfg.metric_type.value(), normalized,
+                                                        QuantizerKey(), std::move(prepared));
+        }
+    }
+
+    expected<DataSetPtr>
+    SearchPrepared(const QueryContext& query, const Config& cfg, const BitsetView& bitset) const override {
+        const HnswPreparedQueries* prepared = nullptr;
+        if (index_) {
+            prepared = query.GetPrepared<HnswPreparedQueries>(QuantizerKey());
+        }
+        return SearchImpl(query.GetQueries(), cfg, bitset, query.IsNormalized(), prepared);
+    }
+
+ private:
+    // the sq codes of the queries, dim bytes per query
+    struct HnswPreparedQueries : PreparedQueries {
+        std::unique_ptr<int8_t[]> codes;
+    };
+
+    // the sq codes of a query only depend on the scale of the quantizer and on the dim, 0 for the indexes without sq
+    uint64_t
+    QuantizerKey() const {
+        if constexpr (hnswlib::HierarchicalNSW<DataType, DistType, quant_type>::sq_enabled) {
+            uint32_t alpha_bits;
+            std::memcpy(&alpha_bits, &index_->alpha_, sizeof(alpha_bits));
+            return (uint64_t(alpha_bits) << 32) | uint32_t(Dim());
+        } else {
+            return 0;
+        }
+    }
+
+    expected<DataSetPtr>
+    SearchImpl(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset, bool normalized,
+               const HnswPreparedQueries* prepared) const {
         if (!index_) {
             LOG_KNOWHERE_WARNING_ << "search on empty index";
             return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
@@ -191,7 +289,11 @@ class HnswIndexNode : public IndexNode {
         auto p_id = std::make_unique<int64_t[]>(k * nq);
         auto p_dist = std::make_unique<DistType[]>(k * nq);
 
-        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value(), hnsw_cfg.for_tuning.value()};
+        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value(), hnsw_cfg.for_tuning.value(),
+                                   hnsw_cfg.neighbor_code_slack.value()};
+        param.early_stop_patience = hnsw_cfg.early_stop_patience.value();
+        param.filter_two_hop = hnsw_cfg.filter_two_hop.value();
+        param.query_normalized = normalized;
         bool transform =
             (index_->metric_type_ == hnswlib::Metric::INNER_PRODUCT || index_->metric_type_ == hnswlib::Metric::COSINE);
 
@@ -200,7 +302,11 @@ class HnswIndexNode : public IndexNode {
         for (int i = 0; i < nq; ++i) {
             futs.emplace_back(search_pool_->push([&, idx = i, p_id_ptr = p_id.get(), p_dist_ptr = p_dist.get()]() {
                 auto single_query = (const char*)xq + idx * index_->data_size_;
-                auto rst = index_->searchKnn(single_query, k, bitset, &param, feder_result);
+                hnswlib::SearchParam query_param = param;
+                if (prepared != nullptr) {
+                    query_param.query_sq = prepared->codes.get() + idx * Dim();
+                }
+                auto rst = index_->searchKnn(single_query, k, bitset, &query_param, feder_result);
                 size_t rst_size = rst.size();
                 auto p_single_dis = p_dist_ptr + idx * k;
                 auto p_single_id = p_id_ptr + idx * k;
@@ -230,7 +336,6 @@ class HnswIndexNode : public IndexNode {
         return res;
     }
 
- private:
     class iterator : public IndexIterator {
      public:
         iterator(const hnswlib::HierarchicalNSW<DataType, DistType, quant_type>* index, const char* query,
@@ -261,7 +366,8 @@ class HnswIndexNode : public IndexNode {
         raw_distance(int64_t id) override {
             if constexpr (hnswlib::HierarchicalNSW<DataType, DistType, quant_type>::sq_enabled &&
                           hnswlib::HierarchicalNSW<DataType, DistType, quant_type>::has_raw_data) {
-                return (transform_ ? -1 : 1) * index_->calcRefineDistance(workspace_->raw_query_data.get(), id);
+                return (transform_ ? -1 : 1) * index_->calcRefineDistance(workspace_->raw_query_data.get(),
+                                                                          index_->getInternalIdByLabel(id));
             }
             throw std::runtime_error("raw_distance not supported: index does not have raw data or sq is not enabled");
         }
@@ -331,7 +437,7 @@ class HnswIndexNode : public IndexNode {
             feder_result = std::make_unique<feder::hnsw::FederResult>();
         }
 
-        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value()};
+        hnswlib::SearchParam param{(size_t)hnsw_cfg.ef.value(), false, hnsw_cfg.neighbor_code_slack.value()};
 
         std::vector<std::vector<int64_t>> result_id_array(nq);
         std::vector<std::vector<DistType>> result_dist_array(nq);
@@ -359,10 +465,13 @@ class HnswIndexNode : public IndexNode {
         WaitAllSuccess(futs);
 
         // filter range search result
-        auto range_search_result =
-            GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius_for_filter, range_filter);
-
-        auto res = GenResultDataSet(nq, std::move(range_search_result));
+        DataSetPtr res;
+        {
+            KNOWHERE_SCOPED_PHASE("range_search", "merge_results");
+            auto range_search_result =
+                GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius_for_filter, range_filter);
+            res = GenResultDataSet(nq, std::move(range_search_result));
+        }
 
         // set visit_info json string into result dataset
         if (feder_result != nullptr) {
@@ -391,7 +500,8 @@ class HnswIndexNode : public IndexNode {
             for (int64_t i = 0; i < rows; i++) {
                 int64_t id = ids[i];
                 assert(id >= 0 && id < (int64_t)index_->cur_element_count);
-                std::copy_n(index_->getDataByInternalId(id), index_->data_size_, data + i * index_->data_size_);
+                std::copy_n(index_->getDataByInternalId(index_->getInternalIdByLabel(id)), index_->data_size_,
+                            data + i * index_->data_size_);
             }
             return GenResultDataSet(rows, dim, data);
         } catch (std::exception& e) {
@@ -470,6 +580,7 @@ class HnswIndexNode : public IndexNode {
             hnswlib::SpaceInterface<DistType>* space = nullptr;
             index_ = new (std::nothrow) hnswlib::HierarchicalNSW<DataType, DistType, quant_type>(space);
             index_->loadIndex(reader);
+            BindFvecKernels(static_cast<const HnswConfig&>(config));
             LOG_KNOWHERE_INFO_ << "Loaded HNSW index. #points num:" << index_->max_elements_ << " #M:" << index_->M_
                                << " #max level:" << index_->maxlevel_
                                << " #ef_construction:" << index_->ef_construction_
@@ -490,6 +601,7 @@ class HnswIndexNode : public IndexNode {
             hnswlib::SpaceInterface<DistType>* space = nullptr;
             index_ = new (std::nothrow) hnswlib::HierarchicalNSW<DataType, DistType, quant_type>(space);
             index_->loadIndex(filename, config);
+            BindFvecKernels(static_cast<const HnswConfig&>(config));
         } catch (std::exception& e) {
             LOG_KNOWHERE_WARNING_ << "hnsw inner error: " << e.what();
             return Status::hnsw_inner_error;
@@ -497,6 +609,11 @@ class HnswIndexNode : public IndexNode {
         return Status::success;
     }
 
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        search_pool_ = std::move(pool);
+    }
+
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return std::make_unique<HnswConfig>();
@@ -545,6 +662,14 @@ class HnswIndexNode : public IndexNode {
     }
 
  private:
+    // binds the fp32 kernels of the index at build and load, so a later switch of the global bf16 patch does not
+    // change how a loaded index computes. the kernels are the ones unrolled for the dim of the index if there are.
+    void
+    BindFvecKernels(const HnswConfig& cfg) {
+        auto bf16_patch = cfg.compute_fp32_as_bf16.value_or(faiss::patch_for_fp32_bf16_enabled());
+        index_->space_->set_fvec_kernels(faiss::fvec_kernels(bf16_patch, Dim()));
+    }
+
     void
     UpdateLevelLinkList(int32_t level, feder::hnsw::HNSWMeta& meta, std::unordered_set<int64_t>& id_set) const {
         if (!(level > 0 && level <= index_->maxlevel_)) {
@@ -31,6 +31,13 @@ class HnswConfig : public BaseConfig {
     CFG_INT efConstruction;
     CFG_INT ef;
     CFG_INT overview_levels;
+    CFG_BOOL embed_neighbor_codes;
+    CFG_INT neighbor_code_m;
+    CFG_FLOAT neighbor_code_slack;
+    CFG_STRING graph_reorder;
+    CFG_INT early_stop_patience;
+    CFG_BOOL filter_two_hop;
+    CFG_BOOL compute_fp32_as_bf16;
     KNOHWERE_DECLARE_CONFIG(HnswConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(M).description("hnsw M").set_default(30).set_range(2, 2048).for_train();
         KNOWHERE_CONFIG_DECLARE_FIELD(efConstruction)
@@ -50,11 +57,54 @@ class HnswConfig : public BaseConfig {
             .set_default(3)
             .set_range(1, 5)
             .for_feder();
+        KNOWHERE_CONFIG_DECLARE_FIELD(embed_neighbor_codes)
+            .description("store 4-bit pq codes of the neighbors next to the base layer link lists")
+            .set_default(false)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(neighbor_code_m)
+            .description("number of sub-quantizers of the neighbor codes, dim should be a multiple of it")
+            .set_default(16)
+            .set_range(1, 65536)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(neighbor_code_slack)
+            .description("relative margin over the search bound under which a neighbor is still expanded")
+            .set_default(0.1)
+            .set_range(0.0, std::numeric_limits<CFG_FLOAT::value_type>::max())
+            .for_search()
+            .for_range_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(graph_reorder)
+            .description("relabel the graph after build for memory locality, one of NONE, BFS and RCM")
+            .set_default("NONE")
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(early_stop_patience)
+            .description("stop searching once the top-k has not improved for this many hops, 0 means disabled")
+            .set_default(0)
+            .set_range(0, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(filter_two_hop)
+            .description("let highly filtered searches expand the neighbors of filtered neighbors")
+            .set_default(true)
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(compute_fp32_as_bf16)
+            .description("compute the fp32 distances of the index as bf16, follows the global patch if not set")
+            .allow_empty_without_default()
+            .for_train()
+            .for_deserialize()
+            .for_deserialize_from_file();
     }
 
     Status
     CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
         switch (param_type) {
+            case PARAM_TYPE::TRAIN: {
+                const auto& reorder = graph_reorder.value();
+                if (reorder != "NONE" && reorder != "BFS" && reorder != "RCM") {
+                    *err_msg = "graph_reorder(" + reorder + ") should be one of NONE, BFS and RCM";
+                    LOG_KNOWHERE_ERROR_ << *err_msg;
+                    return Status::invalid_param_in_json;
+                }
+                break;
+            }
             case PARAM_TYPE::SEARCH: {
                 if (!ef.has_value()) {
                     ef = std::max(k.value(), kEfMinValue);
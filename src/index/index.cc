@@ -11,11 +11,20 @@
 
 #include "knowhere/index/index.h"
 
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
 #include "fmt/format.h"
+#include "knowhere/comp/fair_task_queue.h"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/search_stats.h"
+#include "knowhere/comp/thread_pool.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
 #include "knowhere/log.h"
+#include "simd/hook.h"
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
 #include "knowhere/prometheus_client.h"
@@ -34,6 +43,139 @@ LoadConfig(BaseConfig* cfg, const Json& json, knowhere::PARAM_TYPE param_type, c
     return Config::Load(*cfg, json_, param_type, msg);
 }
 
+// the filtered out count of a dense bitmap is recounted on each request, an allow-list already knows it
+inline BitsetView
+WithFilteredOutNum(const BitsetView& bitset) {
+    if (bitset.has_allowed_ids()) {
+        return bitset;
+    }
+    return BitsetView(bitset.data(), bitset.size(), faiss::bitset_popcount(bitset.data(), bitset.byte_size()));
+}
+
+// requests without a search_group are scheduled as groups of their own
+inline TaskSchedule
+MakeTaskSchedule(const BaseConfig& cfg) {
+    static std::atomic<uint64_t> next_request{0};
+    TaskSchedule schedule;
+    schedule.priority = cfg.search_priority.value();
+    schedule.weight = cfg.search_group_weight.value();
+    if (cfg.search_group.has_value() && !cfg.search_group.value().empty()) {
+        schedule.group = cfg.search_group.value();
+    } else {
+        schedule.group = "#" + std::to_string(next_request.fetch_add(1, std::memory_order_relaxed));
+    }
+    return schedule;
+}
+
+// a search stopped by its token only holds what it found so far, which is not the result that was asked for
+template <typename R>
+inline expected<R>
+CancelledErr(const CancellationToken& token) {
+    if (token.IsExpired()) {
+        return expected<R>::Err(Status::search_timeout, "search passed its deadline");
+    }
+    return expected<R>::Err(Status::search_cancelled, "search was cancelled");
+}
+
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+// the counters of an index type, looked up in their families once rather than on every search
+struct SearchStatsCounters {
+    explicit SearchStatsCounters(const std::string& index_type) {
+        const prometheus::Labels labels = {{"module", "knowhere"}, {"index_type", index_type}};
+        distance_computations = &search_distance_computations_family.Add(labels);
+        nodes_visited = &search_nodes_visited_family.Add(labels);
+        lists_probed = &search_lists_probed_family.Add(labels);
+        codes_scanned = &search_codes_scanned_family.Add(labels);
+        bytes_read = &search_bytes_read_family.Add(labels);
+        cache_hits = &search_cache_hits_family.Add(labels);
+        queue_wait = &search_queue_wait_family.Add(labels);
+        cpu_time = &search_cpu_time_family.Add(labels);
+    }
+
+    prometheus::Counter* distance_computations;
+    prometheus::Counter* nodes_visited;
+    prometheus::Counter* lists_probed;
+    prometheus::Counter* codes_scanned;
+    prometheus::Counter* bytes_read;
+    prometheus::Counter* cache_hits;
+    prometheus::Counter* queue_wait;
+    prometheus::Counter* cpu_time;
+};
+
+// there are only a handful of index types, so the entries are never removed
+inline const SearchStatsCounters&
+GetSearchStatsCounters(const std::string& index_type) {
+    static std::shared_mutex mtx;
+    static std::unordered_map<std::string, std::unique_ptr<SearchStatsCounters>> counters;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = counters.find(index_type);
+        if (it != counters.end()) {
+            return *it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    auto& entry = counters[index_type];
+    if (entry == nullptr) {
+        entry = std::make_unique<SearchStatsCounters>(index_type);
+    }
+    return *entry;
+}
+
+inline void
+ObserveSearchStats(const std::string& index_type, const SearchStats& stats) {
+    const auto& counters = GetSearchStatsCounters(index_type);
+    counters.distance_computations->Increment(stats.distance_computations);
+    counters.nodes_visited->Increment(stats.nodes_visited);
+    counters.lists_probed->Increment(stats.lists_probed);
+    counters.codes_scanned->Increment(stats.codes_scanned);
+    counters.bytes_read->Increment(stats.bytes_read);
+    counters.cache_hits->Increment(stats.cache_hits);
+    counters.queue_wait->Increment(stats.queue_wait_ms);
+    counters.cpu_time->Increment(stats.cpu_ms);
+}
+#endif
+
+// the pool tasks add their stats as they finish, the calling thread adds its own cpu time once the search is done
+inline void
+FinishSearchStats(SearchStatsCollector& collector, double cpu_begin, const std::string& index_type,
+                  const DataSetPtr& res) {
+    SearchStats own;
+    own.cpu_ms = ThreadCpuTimeMs() - cpu_begin;
+    collector.Add(own);
+    const auto stats = collector.Get();
+    res->SetSearchStats(stats);
+#if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
+    ObserveSearchStats(index_type, stats);
+#endif
+}
+
+// the memory policy of the thread loading an index, so that the blocks it allocates land as numa_node or
+// numa_interleave ask. The placement is a hint, a full node makes the kernel fall back to the others.
+inline std::unique_ptr<numa::ScopedMemoryPolicy>
+NumaLoadPolicy(const BaseConfig& cfg) {
+    auto numa_node = cfg.numa_node.value();
+    if (numa_node >= 0) {
+        if (numa_node >= numa::NumNodes()) {
+            LOG_KNOWHERE_WARNING_ << "NUMA node " << numa_node << " is not online, index is loaded as usual";
+            return nullptr;
+        }
+        return std::make_unique<numa::ScopedMemoryPolicy>(numa_node);
+    } else if (cfg.numa_interleave.value()) {
+        return std::make_unique<numa::ScopedMemoryPolicy>();
+    }
+    return nullptr;
+}
+
+// moves the searches of an index loaded on a NUMA node to the pool of the node
+inline void
+SearchOnNumaNode(IndexNode* node, const BaseConfig& cfg) {
+    auto numa_node = cfg.numa_node.value();
+    if (numa_node >= 0 && numa_node < numa::NumNodes()) {
+        node->SetSearchThreadPool(ThreadPool::GetNumaSearchThreadPool(numa_node));
+    }
+}
+
 template <typename T>
 inline Status
 Index<T>::Build(const DataSetPtr dataset, const Json& json) {
@@ -70,140 +212,339 @@ Index<T>::Add(const DataSetPtr dataset, const Json& json) {
 
 template <typename T>
 inline expected<DataSetPtr>
-Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
+Index<T>::Search(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+                 const CancellationTokenPtr& token) const {
     auto cfg = this->node->CreateConfig();
     std::string msg;
     const Status load_status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
     if (load_status != Status::success) {
         return expected<DataSetPtr>::Err(load_status, msg);
     }
+    return SearchWithConfig(dataset, *cfg, bitset, token.get());
+}
+
+template <typename T>
+inline folly::SemiFuture<expected<DataSetPtr>>
+Index<T>::SearchAsync(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+                      const CancellationTokenPtr& token) const {
+    return folly::makeSemiFuture().deferValue([index = *this, dataset, json, bitset, token](auto&&) {
+        return index.Search(dataset, json, bitset, token);
+    });
+}
+
+template <typename T>
+inline expected<std::vector<std::shared_ptr<IndexNode::iterator>>>
+Index<T>::AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetView& bitset) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    Status status = LoadConfig(cfg.get(), json, knowhere::ITERATOR, "Iterator", &msg);
+    if (status != Status::success) {
+        return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(status, msg);
+    }
+    return AnnIteratorWithConfig(dataset, *cfg, bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset,
+                      const CancellationTokenPtr& token) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    auto status = LoadConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, std::move(msg));
+    }
+    return RangeSearchWithConfig(dataset, *cfg, bitset, token.get());
+}
+
+template <typename T>
+inline expected<SearchPlanPtr>
+Index<T>::CompileSearchPlan(const Json& json, PARAM_TYPE param_type) const {
+    if (param_type != knowhere::SEARCH && param_type != knowhere::RANGE_SEARCH && param_type != knowhere::ITERATOR) {
+        return expected<SearchPlanPtr>::Err(Status::invalid_args,
+                                            "search plan should be compiled for SEARCH, RANGE_SEARCH or ITERATOR");
+    }
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status status = LoadConfig(cfg.get(), json, param_type, "CompileSearchPlan", &msg);
+    if (status != Status::success) {
+        return expected<SearchPlanPtr>::Err(status, msg);
+    }
+    return std::make_shared<const SearchPlan>(std::move(cfg), param_type, this->node->Type());
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset,
+                 const CancellationTokenPtr& token) const {
+    std::string msg;
+    const Status status = CheckSearchPlan(plan, knowhere::SEARCH, &msg);
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+    return SearchWithConfig(dataset, plan.GetConfig(), bitset, token.get());
+}
+
+template <typename T>
+inline expected<std::vector<std::shared_ptr<IndexNode::iterator>>>
+Index<T>::AnnIterator(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset) const {
+    std::string msg;
+    const Status status = CheckSearchPlan(plan, knowhere::ITERATOR, &msg);
+    if (status != Status::success) {
+        return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(status, msg);
+    }
+    return AnnIteratorWithConfig(dataset, plan.GetConfig(), bitset);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::RangeSearch(const DataSetPtr dataset, const SearchPlan& plan, const BitsetView& bitset,
+                      const CancellationTokenPtr& token) const {
+    std::string msg;
+    const Status status = CheckSearchPlan(plan, knowhere::RANGE_SEARCH, &msg);
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+    return RangeSearchWithConfig(dataset, plan.GetConfig(), bitset, token.get());
+}
+
+template <typename T>
+inline expected<QueryContextPtr>
+Index<T>::PrepareQuery(const DataSetPtr dataset, const Json& json) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    const Status status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "PrepareQuery", &msg);
+    if (status != Status::success) {
+        return expected<QueryContextPtr>::Err(status, msg);
+    }
+    return this->node->PrepareQuery(dataset, *cfg);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const QueryContext& query, const Json& json, const BitsetView& bitset,
+                 const CancellationTokenPtr& token) const {
+    auto cfg = this->node->CreateConfig();
+    std::string msg;
+    Status status = LoadConfig(cfg.get(), json, knowhere::SEARCH, "Search", &msg);
+    if (status == Status::success) {
+        status = CheckQueryContext(query, *cfg, &msg);
+    }
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+    return SearchWithConfig(query.GetQueries(), *cfg, bitset, token.get(), &query);
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::Search(const QueryContext& query, const SearchPlan& plan, const BitsetView& bitset,
+                 const CancellationTokenPtr& token) const {
+    std::string msg;
+    Status status = CheckSearchPlan(plan, knowhere::SEARCH, &msg);
+    if (status == Status::success) {
+        status = CheckQueryContext(query, plan.GetConfig(), &msg);
+    }
+    if (status != Status::success) {
+        return expected<DataSetPtr>::Err(status, msg);
+    }
+    return SearchWithConfig(query.GetQueries(), plan.GetConfig(), bitset, token.get(), &query);
+}
+
+template <typename T>
+inline Status
+Index<T>::CheckQueryContext(const QueryContext& query, const BaseConfig& cfg, std::string* msg) const {
+    if (query.GetIndexType() != this->node->Type()) {
+        *msg = fmt::format("query was prepared for index type {}, but the index type is {}", query.GetIndexType(),
+                           this->node->Type());
+        LOG_KNOWHERE_ERROR_ << *msg;
+        return Status::invalid_args;
+    }
+    // the prepared queries may be normalized for COSINE
+    if (!IsMetricType(query.GetMetricType(), cfg.metric_type.value())) {
+        *msg = fmt::format("query was prepared for metric type {}, but the search uses {}", query.GetMetricType(),
+                           cfg.metric_type.value());
+        LOG_KNOWHERE_ERROR_ << *msg;
+        return Status::invalid_args;
+    }
+    return Status::success;
+}
+
+template <typename T>
+inline Status
+Index<T>::CheckSearchPlan(const SearchPlan& plan, PARAM_TYPE param_type, std::string* msg) const {
+    if (plan.GetParamType() != param_type) {
+        *msg = "search plan was compiled for another kind of search";
+        LOG_KNOWHERE_ERROR_ << *msg;
+        return Status::invalid_args;
+    }
+    if (plan.GetIndexType() != this->node->Type()) {
+        *msg = fmt::format("search plan was compiled for index type {}, but the index type is {}",
+                           plan.GetIndexType(), this->node->Type());
+        LOG_KNOWHERE_ERROR_ << *msg;
+        return Status::invalid_args;
+    }
+    return Status::success;
+}
+
+template <typename T>
+inline expected<DataSetPtr>
+Index<T>::SearchWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset_,
+                           const CancellationToken* token, const QueryContext* query) const {
     // when index is immutable, bitset size should always equal to data count in index
     // when index is mutable, it could happen that data count larger than bitset size, see
     // https://github.com/zilliztech/knowhere/issues/70
     // so something must be wrong at caller side when passed bitset size larger than data count
     if (bitset_.size() > (size_t)this->Count()) {
-        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
-                          bitset_.size(), this->Count());
+        std::string msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                                      bitset_.size(), this->Count());
         LOG_KNOWHERE_ERROR_ << msg;
         return expected<DataSetPtr>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    const auto bitset = WithFilteredOutNum(bitset_);
+
+    // a request that waited past its deadline does not start, the loops of a running one poll the token
+    if (token != nullptr && token->IsCancelled()) {
+        return CancelledErr<DataSetPtr>(*token);
+    }
+    ScopedCancellation cancellation(token);
+    const auto schedule = MakeTaskSchedule(cfg);
+    ScopedTaskSchedule scheduling(&schedule);
+    SearchStatsCollector stats;
+    ScopedSearchStats collecting(&stats);
+    const auto cpu_begin = ThreadCpuTimeMs();
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-    const BaseConfig& b_cfg = static_cast<const BaseConfig&>(*cfg);
     std::shared_ptr<tracer::trace::Span> span = nullptr;
-    if (b_cfg.trace_id.has_value()) {
-        auto ctx = tracer::GetTraceCtxFromCfg(&b_cfg);
+    if (cfg.trace_id.has_value()) {
+        auto ctx = tracer::GetTraceCtxFromCfg(&cfg);
         span = tracer::StartSpan("knowhere search", &ctx);
-        span->SetAttribute(meta::METRIC_TYPE, b_cfg.metric_type.value());
-        span->SetAttribute(meta::TOPK, b_cfg.k.value());
+        span->SetAttribute(meta::METRIC_TYPE, cfg.metric_type.value());
+        span->SetAttribute(meta::TOPK, cfg.k.value());
         span->SetAttribute(meta::ROWS, Count());
         span->SetAttribute(meta::DIM, Dim());
         span->SetAttribute(meta::NQ, dataset->GetRows());
     }
+    tracer::ScopedPhaseSpans phase_spans(span);
 
     TimeRecorder rc("Search");
-    auto res = this->node->Search(dataset, *cfg, bitset);
+    auto res =
+        query != nullptr ? this->node->SearchPrepared(*query, cfg, bitset) : this->node->Search(dataset, cfg, bitset);
     auto time = rc.ElapseFromBegin("done");
     time *= 0.001;  // convert to ms
     knowhere_search_latency.Observe(time);
-    knowhere_search_topk.Observe(cfg->k.value());
+    knowhere_search_topk.Observe(cfg.k.value());
 
-    if (b_cfg.trace_id.has_value()) {
+    if (cfg.trace_id.has_value()) {
         span->End();
     }
 #else
-    auto res = this->node->Search(dataset, *cfg, bitset);
+    auto res =
+        query != nullptr ? this->node->SearchPrepared(*query, cfg, bitset) : this->node->Search(dataset, cfg, bitset);
 #endif
+    if (token != nullptr && token->IsCancelled()) {
+        return CancelledErr<DataSetPtr>(*token);
+    }
+    if (res.has_value()) {
+        FinishSearchStats(stats, cpu_begin, this->node->Type(), res.value());
+    }
     return res;
 }
 
 template <typename T>
 inline expected<std::vector<std::shared_ptr<IndexNode::iterator>>>
-Index<T>::AnnIterator(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
-    auto cfg = this->node->CreateConfig();
-    std::string msg;
-    Status status = LoadConfig(cfg.get(), json, knowhere::ITERATOR, "Iterator", &msg);
-    if (status != Status::success) {
-        return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(status, msg);
-    }
+Index<T>::AnnIteratorWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset_) const {
     // when index is immutable, bitset size should always equal to data count in index
     // when index is mutable, it could happen that data count larger than bitset size, see
     // https://github.com/zilliztech/knowhere/issues/70
     // so something must be wrong at caller side when passed bitset size larger than data count
     if (bitset_.size() > (size_t)this->Count()) {
-        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
-                          bitset_.size(), this->Count());
+        std::string msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                                      bitset_.size(), this->Count());
         LOG_KNOWHERE_ERROR_ << msg;
         return expected<std::vector<std::shared_ptr<IndexNode::iterator>>>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    const auto bitset = WithFilteredOutNum(bitset_);
+    const auto schedule = MakeTaskSchedule(cfg);
+    ScopedTaskSchedule scheduling(&schedule);
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     // note that this time includes only the initial search phase of iterator.
     TimeRecorder rc("AnnIterator");
-    auto res = this->node->AnnIterator(dataset, *cfg, bitset);
+    auto res = this->node->AnnIterator(dataset, cfg, bitset);
     auto time = rc.ElapseFromBegin("done");
     time *= 0.001;  // convert to ms
     knowhere_search_latency.Observe(time);
 #else
-    auto res = this->node->AnnIterator(dataset, *cfg, bitset);
+    auto res = this->node->AnnIterator(dataset, cfg, bitset);
 #endif
     return res;
 }
 
 template <typename T>
 inline expected<DataSetPtr>
-Index<T>::RangeSearch(const DataSetPtr dataset, const Json& json, const BitsetView& bitset_) const {
-    auto cfg = this->node->CreateConfig();
-    std::string msg;
-    auto status = LoadConfig(cfg.get(), json, knowhere::RANGE_SEARCH, "RangeSearch", &msg);
-    if (status != Status::success) {
-        return expected<DataSetPtr>::Err(status, std::move(msg));
-    }
+Index<T>::RangeSearchWithConfig(const DataSetPtr dataset, const BaseConfig& cfg, const BitsetView& bitset_,
+                                const CancellationToken* token) const {
     // when index is immutable, bitset size should always equal to data count in index
     // when index is mutable, it could happen that data count larger than bitset size, see
     // https://github.com/zilliztech/knowhere/issues/70
     // so something must be wrong at caller side when passed bitset size larger than data count
     if (bitset_.size() > (size_t)this->Count()) {
-        msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
-                          bitset_.size(), this->Count());
+        std::string msg = fmt::format("bitset size should be <= data count, but we get bitset size: {}, data count: {}",
+                                      bitset_.size(), this->Count());
         LOG_KNOWHERE_ERROR_ << msg;
         return expected<DataSetPtr>::Err(Status::invalid_args, msg);
     }
 
-    const auto bitset = BitsetView(bitset_.data(), bitset_.size(), bitset_.get_filtered_out_num_());
+    const auto bitset = WithFilteredOutNum(bitset_);
+
+    // a request that waited past its deadline does not start, the loops of a running one poll the token
+    if (token != nullptr && token->IsCancelled()) {
+        return CancelledErr<DataSetPtr>(*token);
+    }
+    ScopedCancellation cancellation(token);
+    const auto schedule = MakeTaskSchedule(cfg);
+    ScopedTaskSchedule scheduling(&schedule);
+    SearchStatsCollector stats;
+    ScopedSearchStats collecting(&stats);
+    const auto cpu_begin = ThreadCpuTimeMs();
 
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-    const BaseConfig& b_cfg = static_cast<const BaseConfig&>(*cfg);
     std::shared_ptr<tracer::trace::Span> span = nullptr;
-    if (b_cfg.trace_id.has_value()) {
-        auto ctx = tracer::GetTraceCtxFromCfg(&b_cfg);
+    if (cfg.trace_id.has_value()) {
+        auto ctx = tracer::GetTraceCtxFromCfg(&cfg);
         span = tracer::StartSpan("knowhere range search", &ctx);
-        span->SetAttribute(meta::METRIC_TYPE, b_cfg.metric_type.value());
-        span->SetAttribute(meta::RADIUS, b_cfg.radius.value());
-        if (b_cfg.range_filter.value() != defaultRangeFilter) {
-            span->SetAttribute(meta::RANGE_FILTER, b_cfg.range_filter.value());
+        span->SetAttribute(meta::METRIC_TYPE, cfg.metric_type.value());
+        span->SetAttribute(meta::RADIUS, cfg.radius.value());
+        if (cfg.range_filter.value() != defaultRangeFilter) {
+            span->SetAttribute(meta::RANGE_FILTER, cfg.range_filter.value());
         }
         span->SetAttribute(meta::ROWS, Count());
         span->SetAttribute(meta::DIM, Dim());
         span->SetAttribute(meta::NQ, dataset->GetRows());
     }
+    tracer::ScopedPhaseSpans phase_spans(span);
 
     TimeRecorder rc("Range Search");
-    auto res = this->node->RangeSearch(dataset, *cfg, bitset);
+    auto res = this->node->RangeSearch(dataset, cfg, bitset);
     auto time = rc.ElapseFromBegin("done");
     time *= 0.001;  // convert to ms
     knowhere_range_search_latency.Observe(time);
 
-    if (b_cfg.trace_id.has_value()) {
+    if (cfg.trace_id.has_value()) {
         span->End();
     }
 #else
-    auto res = this->node->RangeSearch(dataset, *cfg, bitset);
+    auto res = this->node->RangeSearch(dataset, cfg, bitset);
 #endif
+    if (token != nullptr && token->IsCancelled()) {
+        return CancelledErr<DataSetPtr>(*token);
+    }
+    if (res.has_value()) {
+        FinishSearchStats(stats, cpu_begin, this->node->Type(), res.value());
+    }
     return res;
 }
 
@@ -260,6 +601,7 @@ Index<T>::Deserialize(const BinarySet& binset, const Json& json) {
         return res;
     }
 
+    auto numa_policy = NumaLoadPolicy(*cfg);
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     TimeRecorder rc("Load index", 2);
     res = this->node->Deserialize(binset, *cfg);
@@ -269,6 +611,11 @@ Index<T>::Deserialize(const BinarySet& binset, const Json& json) {
 #else
     res = this->node->Deserialize(binset, *cfg);
 #endif
+    // the caller allocates as before once the index is loaded
+    numa_policy = nullptr;
+    if (res == Status::success) {
+        SearchOnNumaNode(this->node, *cfg);
+    }
     return res;
 }
 
@@ -289,6 +636,7 @@ Index<T>::DeserializeFromFile(const std::string& filename, const Json& json) {
         return res;
     }
 
+    auto numa_policy = NumaLoadPolicy(*cfg);
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
     TimeRecorder rc("Load index from file", 2);
     res = this->node->DeserializeFromFile(filename, *cfg);
@@ -298,6 +646,11 @@ Index<T>::DeserializeFromFile(const std::string& filename, const Json& json) {
 #else
     res = this->node->DeserializeFromFile(filename, *cfg);
 #endif
+    // the caller allocates as before once the index is loaded
+    numa_policy = nullptr;
+    if (res == Status::success) {
+        SearchOnNumaNode(this->node, *cfg);
+    }
     return res;
 }
 
@@ -49,6 +49,13 @@ IndexNodeDataMockWrapper<DataType>::Search(const DataSetPtr dataset, const Confi
     return index_node_->Search(ds_ptr, cfg, bitset);
 }
 
+template <typename DataType>
+expected<QueryContextPtr>
+IndexNodeDataMockWrapper<DataType>::PrepareQuery(const DataSetPtr dataset, const Config& cfg) const {
+    auto ds_ptr = ConvertFromDataTypeIfNeeded<DataType>(dataset);
+    return index_node_->PrepareQuery(ds_ptr, cfg);
+}
+
 template <typename DataType>
 expected<DataSetPtr>
 IndexNodeDataMockWrapper<DataType>::RangeSearch(const DataSetPtr dataset, const Config& cfg,
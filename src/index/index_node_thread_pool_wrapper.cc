@@ -40,6 +40,17 @@ IndexNodeThreadPoolWrapper::Search(const DataSetPtr dataset, const Config& cfg,
     return thread_pool_->push([&]() { return this->index_node_->Search(dataset, cfg, bitset); }).get();
 }
 
+expected<QueryContextPtr>
+IndexNodeThreadPoolWrapper::PrepareQuery(const DataSetPtr dataset, const Config& cfg) const {
+    return thread_pool_->push([&]() { return this->index_node_->PrepareQuery(dataset, cfg); }).get();
+}
+
+expected<DataSetPtr>
+IndexNodeThreadPoolWrapper::SearchPrepared(const QueryContext& query, const Config& cfg,
+                                           const BitsetView& bitset) const {
+    return thread_pool_->push([&]() { return this->index_node_->SearchPrepared(query, cfg, bitset); }).get();
+}
+
 expected<DataSetPtr>
 IndexNodeThreadPoolWrapper::RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const {
     return thread_pool_->push([&]() { return this->index_node_->RangeSearch(dataset, cfg, bitset); }).get();
@@ -9,6 +9,9 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <limits>
+#include <random>
+
 #include "common/metric.h"
 #include "faiss/IndexBinaryFlat.h"
 #include "faiss/IndexBinaryIVF.h"
@@ -17,13 +20,17 @@
 #include "faiss/IndexIVFFlat.h"
 #include "faiss/IndexIVFPQ.h"
 #include "faiss/IndexIVFPQFastScan.h"
+#include "faiss/IndexIVFRaBitQ.h"
 #include "faiss/IndexIVFScalarQuantizerCC.h"
 #include "faiss/IndexScaNN.h"
 #include "faiss/IndexScalarQuantizer.h"
+#include "faiss/impl/DistanceComputer.h"
 #include "faiss/index_io.h"
 #include "index/ivf/ivf_config.h"
 #include "io/memory_io.h"
 #include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/materialized_view.h"
+#include "knowhere/comp/phase_timer.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/dataset.h"
 #include "knowhere/expected.h"
@@ -48,6 +55,28 @@ struct IndexDispatch<faiss::IndexIVFFlat> {
     using Tag = IVFFlatTag;
 };
 
+// IvfScalarPartition records how the entries of every inverted list are grouped by the value (category) of one
+// optional scalar field, so that filtered searches can skip the groups that the filter rules out as a whole.
+struct IvfScalarPartition {
+    int64_t field_id = 0;
+    size_t num_categories = 0;
+    // category c of list l covers the list offsets [offsets[l * (num_categories + 1) + c],
+    // offsets[l * (num_categories + 1) + c + 1])
+    std::vector<size_t> offsets;
+};
+
+// the coarse assignment of prepared IVF_PQ queries and their pq lookup tables, see
+// faiss::IndexIVFPQ::compute_query_tables()
+struct IvfPqPreparedQueries : PreparedQueries {
+    size_t nprobe = 0;
+    // nprobe lists per query and their distances to the query
+    std::unique_ptr<int64_t[]> keys;
+    std::unique_ptr<float[]> coarse_dis;
+    // table_size floats per query, nullptr if the tables depend on the list
+    std::unique_ptr<float[]> tables;
+    size_t table_size = 0;
+};
+
 template <typename DataType, typename IndexType>
 class IvfIndexNode : public IndexNode {
  public:
@@ -58,7 +87,9 @@ class IvfIndexNode : public IndexNode {
                           std::is_same<IndexType, faiss::IndexIVFScalarQuantizer>::value ||
                           std::is_same<IndexType, faiss::IndexBinaryIVF>::value ||
                           std::is_same<IndexType, faiss::IndexScaNN>::value ||
-                          std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value,
+                          std::is_same<IndexType, faiss::IndexSQ4FastScan>::value ||
+                          std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value ||
+                          std::is_same<IndexType, faiss::IndexIVFRaBitQ>::value,
                       "not support");
         static_assert(std::is_same_v<DataType, fp32> || std::is_same_v<DataType, bin1>,
                       "IvfIndexNode only support float/binary");
@@ -71,6 +102,10 @@ class IvfIndexNode : public IndexNode {
     Add(const DataSetPtr dataset, const Config& cfg) override;
     expected<DataSetPtr>
     Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
+    expected<QueryContextPtr>
+    PrepareQuery(const DataSetPtr dataset, const Config& cfg) const override;
+    expected<DataSetPtr>
+    SearchPrepared(const QueryContext& query, const Config& cfg, const BitsetView& bitset) const override;
     expected<DataSetPtr>
     RangeSearch(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const override;
     expected<std::vector<IndexNode::IteratorPtr>>
@@ -94,6 +129,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
             return index_->with_raw_data();
         }
+        if constexpr (std::is_same<faiss::IndexSQ4FastScan, IndexType>::value) {
+            return index_->with_raw_data();
+        }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, IndexType>::value) {
             return false;
         }
@@ -103,6 +141,14 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizerCC, IndexType>::value) {
             return index_->with_raw_data();
         }
+        if constexpr (std::is_same<faiss::IndexIVFRaBitQ, IndexType>::value) {
+            // the refine index holds the normalized vectors for COSINE
+            return index_->with_raw_data() && !IsMetricType(metric_type, metric::COSINE);
+        }
+    }
+    bool
+    IsAdditionalScalarSupported() const override {
+        return SupportsScalarPartition();
     }
     expected<DataSetPtr>
     GetIndexMeta(const Config& cfg) const override {
@@ -116,6 +162,10 @@ class IvfIndexNode : public IndexNode {
     Deserialize(const BinarySet& binset, const Config& config) override;
     Status
     DeserializeFromFile(const std::string& filename, const Config& config) override;
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        search_pool_ = std::move(pool);
+    }
     std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         if constexpr (std::is_same<faiss::IndexIVFFlat, IndexType>::value) {
@@ -130,6 +180,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
             return std::make_unique<ScannConfig>();
         }
+        if constexpr (std::is_same<faiss::IndexSQ4FastScan, IndexType>::value) {
+            return std::make_unique<IvfSq4FsConfig>();
+        }
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, IndexType>::value) {
             return std::make_unique<IvfSqConfig>();
         }
@@ -139,6 +192,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<faiss::IndexIVFScalarQuantizerCC, IndexType>::value) {
             return std::make_unique<IvfSqCcConfig>();
         }
+        if constexpr (std::is_same<faiss::IndexIVFRaBitQ, IndexType>::value) {
+            return std::make_unique<IvfRaBitQConfig>();
+        }
     };
     int64_t
     Dim() const override {
@@ -176,7 +232,7 @@ class IvfIndexNode : public IndexNode {
             auto precomputed_table = nlist * pq.M * pq.ksub * sizeof(float);
             return (capacity + centroid_table + precomputed_table);
         }
-        if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+        if constexpr (IsFastScan()) {
             return index_->size();
         }
         if constexpr (std::is_same<IndexType, faiss::IndexIVFScalarQuantizer>::value) {
@@ -197,6 +253,20 @@ class IvfIndexNode : public IndexNode {
             auto nlist = index_->nlist;
             return (nb * code_size + nb * sizeof(int64_t) + 2 * code_size + nlist * sizeof(float));
         }
+        if constexpr (std::is_same<IndexType, faiss::IndexIVFRaBitQ>::value) {
+            auto nb = index_->invlists->compute_ntotal();
+            auto code_size = index_->code_size;
+            auto nlist = index_->nlist;
+            auto d = index_->d;
+            auto d_rot = index_->d_rot;
+            // codes, ids, centroids, the rotation signs and the rotated centroids
+            auto capacity = nb * code_size + nb * sizeof(int64_t) + nlist * d * sizeof(float) +
+                            index_->rotation_signs.size() + nlist * d_rot * sizeof(float);
+            if (auto refine = dynamic_cast<const faiss::IndexFlatCodes*>(index_->refine_index)) {
+                capacity += refine->codes.size();
+            }
+            return capacity;
+        }
     };
     int64_t
     Count() const override {
@@ -219,6 +289,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_SCANN;
         }
+        if constexpr (std::is_same<IndexType, faiss::IndexSQ4FastScan>::value) {
+            return knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS;
+        }
         if constexpr (std::is_same<IndexType, faiss::IndexIVFScalarQuantizer>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_IVFSQ8;
         }
@@ -228,6 +301,9 @@ class IvfIndexNode : public IndexNode {
         if constexpr (std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
             return knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC;
         }
+        if constexpr (std::is_same<IndexType, faiss::IndexIVFRaBitQ>::value) {
+            return knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ;
+        }
     };
 
  private:
@@ -247,28 +323,70 @@ class IvfIndexNode : public IndexNode {
     Status
     TrainInternal(const DataSetPtr dataset, const Config& cfg);
 
+    expected<DataSetPtr>
+    SearchImpl(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset, bool normalized,
+               const IvfPqPreparedQueries* prepared) const;
+
+    // the prepared state of IVF_PQ queries only holds for the indexes with the same coarse centroids and pq, 0 if
+    // the index keeps no such state
+    void
+    UpdateQuantizerKey();
+
+    // add the rows category by category, so that each inverted list is grouped by the scalar value of its entries
+    Status
+    AddWithScalarPartition(const DataSetPtr dataset, const OptFieldCategories& field);
+
+    // list ranges of the categories that still have rows passing the bitset, nullptr if the search should scan the
+    // whole lists. nq queries are to probe nprobe lists each.
+    std::unique_ptr<faiss::IVFListRanges>
+    ScalarPartitionRanges(const IvfConfig& cfg, const BitsetView& bitset, size_t nq, size_t nprobe) const;
+
+    void
+    SerializeScalarPartition(BinarySet& binset) const;
+
+    Status
+    DeserializeScalarPartition(const BinarySet& binset);
+
+    static constexpr bool
+    SupportsScalarPartition() {
+        return std::is_same_v<IndexType, faiss::IndexIVFFlat> ||
+               std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer>;
+    }
+
     static constexpr bool
     IsQuantized() {
         return std::is_same_v<IndexType, faiss::IndexIVFPQ> ||
                std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizer> ||
                std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC> ||
-               std::is_same_v<IndexType, faiss::IndexScaNN>;
+               std::is_same_v<IndexType, faiss::IndexIVFRaBitQ> || IsFastScan();
+    }
+
+    // the indexes that scan pq4 fast-scan codes and refine the candidates
+    static constexpr bool
+    IsFastScan() {
+        return std::is_same_v<IndexType, faiss::IndexScaNN> || std::is_same_v<IndexType, faiss::IndexSQ4FastScan>;
     }
 
  private:
-    // only support IVFFlat and IVFFlatCC
+    // only support IVFFlat, IVFFlatCC and IVF_RABITQ
     // iterator will own the copied_norm_query
     // TODO: iterator should copy and own query data.
     class iterator : public IndexIterator {
      public:
         iterator(const IndexType* index, const float* query_data, std::unique_ptr<float[]>&& copied_norm_query,
                  const BitsetView& bitset, size_t nprobe, bool larger_is_closer, const float refine_ratio = 0.5f)
-            : IndexIterator(larger_is_closer, IsQuantized() ? refine_ratio : 0.0f),
+            : IndexIterator(larger_is_closer, CanRefine(index) ? refine_ratio : 0.0f),
               index_(index),
               copied_norm_query_(std::move(copied_norm_query)) {
             if (copied_norm_query_ != nullptr) {
                 query_data = copied_norm_query_.get();
             }
+            if constexpr (std::is_same_v<IndexType, faiss::IndexIVFRaBitQ>) {
+                if (index_->refine_index != nullptr) {
+                    refine_dc_.reset(index_->refine_index->get_distance_computer());
+                    refine_dc_->set_query(query_data);
+                }
+            }
 
             if (!bitset.empty()) {
                 bw_idselector_ = std::make_unique<BitsetViewIDSelector>(bitset);
@@ -289,15 +407,33 @@ class IvfIndexNode : public IndexNode {
             workspace_->dists.clear();
         }
 
+        float
+        raw_distance(int64_t id) override {
+            return (*refine_dc_)(id);
+        }
+
      private:
+        // the iterator can only refine the estimated distances of the indexes with a refine index
+        static bool
+        CanRefine(const IndexType* index) {
+            if constexpr (std::is_same_v<IndexType, faiss::IndexIVFRaBitQ>) {
+                return index->refine_index != nullptr;
+            }
+            return false;
+        }
+
         const IndexType* index_ = nullptr;
-        std::unique_ptr<faiss::IVFFlatIteratorWorkspace> workspace_ = nullptr;
+        std::unique_ptr<faiss::DistanceComputer> refine_dc_ = nullptr;
+        std::unique_ptr<faiss::IVFIteratorWorkspace> workspace_ = nullptr;
         std::unique_ptr<float[]> copied_norm_query_ = nullptr;
         std::unique_ptr<BitsetViewIDSelector> bw_idselector_ = nullptr;
         faiss::IVFSearchParameters ivf_search_params_;
     };
 
     std::unique_ptr<IndexType> index_;
+    // set when the index was built with opt_fields_path
+    std::unique_ptr<IvfScalarPartition> scalar_partition_;
+    uint64_t quantizer_key_ = 0;
     std::shared_ptr<ThreadPool> search_pool_;
     // Faiss uses OpenMP for training/building the index and we have no control
     // over those threads. build_pool_ is used to make sure the OMP threads
@@ -310,10 +446,12 @@ class IvfIndexNode : public IndexNode {
 
 namespace knowhere {
 
+constexpr int64_t MIN_POINTS_PER_CENTROID = 39;
+
+constexpr const char* kScalarPartitionBinaryName = "SCALAR_PARTITION";
+
 inline int64_t
 MatchNlist(int64_t size, int64_t nlist) {
-    const int64_t MIN_POINTS_PER_CENTROID = 39;
-
     if (nlist * MIN_POINTS_PER_CENTROID > size) {
         // nlist is too large, adjust to a proper value
         LOG_KNOWHERE_WARNING_ << "nlist(" << nlist << ") is too large, adjust to a proper value";
@@ -351,6 +489,41 @@ to_index_flat(std::unique_ptr<faiss::IndexFlat>&& index) {
     return std::make_unique<faiss::IndexFlat>(std::move(*index));
 }
 
+// clustering parameters of this build, set on the index so that concurrent builds do not share the faiss globals
+void
+set_clustering_params(faiss::ClusteringParameters& cp, const IvfConfig& cfg) {
+    if (cfg.kmeans_n_iters.has_value()) {
+        cp.niter = cfg.kmeans_n_iters.value();
+    }
+    cp.max_points_per_centroid = cfg.max_points_per_centroid.value();
+    if (cfg.clustering_type.has_value()) {
+        cp.clustering_type_override = cfg.clustering_type.value() == "K_MEANS_PLUS_PLUS"
+                                          ? faiss::ClusteringType::K_MEANS_PLUS_PLUS
+                                          : faiss::ClusteringType::K_MEANS;
+    }
+    if (cfg.kmeans_early_stop_threshold.has_value()) {
+        cp.early_stop_threshold_override = cfg.kmeans_early_stop_threshold.value();
+    }
+}
+
+// the seed of the training sample, fixed so that building twice on the same rows trains on the same sample
+constexpr uint64_t kTrainSampleSeed = 0xc70f6907UL;
+
+// copy a uniform random subset of sample_rows rows, in their original order, with one sequential pass over the data
+std::unique_ptr<uint8_t[]>
+sample_train_rows(const void* data, int64_t rows, size_t row_size, int64_t sample_rows, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    auto buf = std::make_unique<uint8_t[]>(sample_rows * row_size);
+    int64_t picked = 0;
+    for (int64_t i = 0; i < rows && picked < sample_rows; ++i) {
+        if (static_cast<int64_t>(rng() % (rows - i)) < sample_rows - picked) {
+            std::memcpy(buf.get() + picked * row_size, (const uint8_t*)data + i * row_size, row_size);
+            ++picked;
+        }
+    }
+    return buf;
+}
+
 expected<faiss::ScalarQuantizer::QuantizerType>
 get_ivf_sq_quantizer_type(int code_size) {
     switch (code_size) {
@@ -385,6 +558,7 @@ IvfIndexNode<DataType, IndexType>::Train(const DataSetPtr dataset, const Config&
 template <typename DataType, typename IndexType>
 Status
 IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const Config& cfg) {
+    KNOWHERE_SCOPED_PHASE("build", "ivf_train");
     const BaseConfig& base_cfg = static_cast<const IvfConfig&>(cfg);
     std::unique_ptr<ThreadPool::ScopedOmpSetter> setter;
     if (base_cfg.num_build_thread.has_value()) {
@@ -397,7 +571,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
 
     // do normalize for COSINE metric type
     if constexpr (std::is_same_v<faiss::IndexIVFPQ, IndexType> ||
-                  std::is_same_v<faiss::IndexIVFScalarQuantizer, IndexType>) {
+                  std::is_same_v<faiss::IndexIVFScalarQuantizer, IndexType> ||
+                  std::is_same_v<faiss::IndexIVFRaBitQ, IndexType>) {
         if (is_cosine) {
             Normalize(dataset);
         }
@@ -413,9 +588,25 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
     auto dim = dataset->GetDim();
     auto data = dataset->GetTensor();
 
+    // train on a subset of the rows if asked to, every row is still added afterwards
+    const IvfConfig& ivf_cfg = static_cast<const IvfConfig&>(cfg);
+    auto train_rows = rows;
+    auto train_data = data;
+    std::unique_ptr<uint8_t[]> train_buf;
+    if (ivf_cfg.train_sample_ratio.value() < 1.0f) {
+        size_t row_size = std::is_same_v<faiss::IndexBinaryIVF, IndexType> ? dim / 8 : dim * sizeof(float);
+        auto min_rows = std::min(rows, ivf_cfg.nlist.value() * MIN_POINTS_PER_CENTROID);
+        train_rows = std::max(static_cast<int64_t>(rows * ivf_cfg.train_sample_ratio.value()), min_rows);
+        if (train_rows < rows) {
+            train_buf = sample_train_rows(data, rows, row_size, train_rows, kTrainSampleSeed);
+            train_data = train_buf.get();
+        }
+        LOG_KNOWHERE_INFO_ << "train ivf on " << train_rows << " of " << rows << " rows";
+    }
+
     // faiss scann needs at least 16 rows since nbits=4
     constexpr int64_t SCANN_MIN_ROWS = 16;
-    if constexpr (std::is_same<faiss::IndexScaNN, IndexType>::value) {
+    if constexpr (IsFastScan()) {
         if (rows < SCANN_MIN_ROWS) {
             LOG_KNOWHERE_ERROR_ << rows << " rows is not enough, scann needs at least 16 rows to build index";
             return Status::faiss_inner_error;
@@ -437,7 +628,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         // create index. Index does not own qzr
         index = std::make_unique<faiss::IndexIVFFlat>(qzr.get(), dim, nlist, metric.value(), is_cosine);
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
         // transfer ownership of qzr to index
@@ -457,7 +649,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         index = std::make_unique<faiss::IndexIVFFlatCC>(qzr.get(), dim, nlist, ivf_flat_cc_cfg.ssize.value(),
                                                         metric.value(), is_cosine);
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
         // transfer ownership of qzr to index
@@ -479,7 +672,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         // create index. Index does not own qzr
         index = std::make_unique<faiss::IndexIVFPQ>(qzr.get(), dim, nlist, ivf_pq_cfg.m.value(), nbits, metric.value());
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
         // transfer ownership of qzr to index
@@ -507,7 +701,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
             index = std::make_unique<faiss::IndexScaNN>(base_index.get(), nullptr);
         }
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(base_index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // at this moment, we still own qzr.
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
@@ -518,6 +713,39 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         base_index.release();
         index->own_fields = true;
     }
+    if constexpr (std::is_same<faiss::IndexSQ4FastScan, IndexType>::value) {
+        const IvfSq4FsConfig& sq4_fs_cfg = static_cast<const IvfSq4FsConfig&>(cfg);
+        auto nlist = MatchNlist(rows, sq4_fs_cfg.nlist.value());
+        bool is_cosine = base_cfg.metric_type.value() == metric::COSINE;
+
+        const bool use_elkan = sq4_fs_cfg.use_elkan.value_or(true);
+
+        // create quantizer for the training
+        std::unique_ptr<faiss::IndexFlat> qzr =
+            std::make_unique<faiss::IndexFlatElkan>(dim, metric.value(), false, use_elkan);
+        // one 4-bit sub-quantizer per dimension, i.e. 16 trained levels for each dimension
+        auto base_index =
+            std::make_unique<faiss::IndexIVFPQFastScan>(qzr.get(), dim, nlist, dim, 4, is_cosine, metric.value());
+        std::unique_ptr<faiss::Index> refine_index;
+        if (sq4_fs_cfg.refine_type.value() == "FLAT") {
+            refine_index = std::make_unique<faiss::IndexFlat>(dim, metric.value());
+        } else if (sq4_fs_cfg.refine_type.value() == "SQ8") {
+            refine_index = std::make_unique<faiss::IndexScalarQuantizer>(
+                dim, faiss::ScalarQuantizer::QuantizerType::QT_8bit, metric.value());
+        }
+        // the index owns the refine index from here on
+        index = std::make_unique<faiss::IndexSQ4FastScan>(base_index.get(), refine_index.release());
+        // train
+        set_clustering_params(base_index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
+        // replace quantizer with a regular IndexFlat
+        qzr = to_index_flat(std::move(qzr));
+        base_index->quantizer = qzr.release();
+        base_index->own_fields = true;
+        // transfer ownership of the base index
+        base_index.release();
+        index->own_fields = true;
+    }
     if constexpr (std::is_same<faiss::IndexIVFScalarQuantizer, IndexType>::value) {
         const IvfSqConfig& ivf_sq_cfg = static_cast<const IvfSqConfig&>(cfg);
         auto nlist = MatchNlist(rows, ivf_sq_cfg.nlist.value());
@@ -531,7 +759,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         index = std::make_unique<faiss::IndexIVFScalarQuantizer>(
             qzr.get(), dim, nlist, faiss::ScalarQuantizer::QuantizerType::QT_8bit, metric.value());
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
         // transfer ownership of qzr to index
@@ -547,7 +776,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         // create index. Index does not own qzr
         index = std::make_unique<faiss::IndexBinaryIVF>(qzr.get(), dim, nlist, metric.value());
         // train
-        index->train(rows, (const uint8_t*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const uint8_t*)train_data);
         // transfer ownership of qzr to index
         qzr.release();
         index->own_fields = true;
@@ -572,7 +802,8 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
                                                                    metric.value(), is_cosine, false,
                                                                    ivf_sq_cc_cfg.raw_data_store_prefix);
         // train
-        index->train(rows, (const float*)data);
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
         // replace quantizer with a regular IndexFlat
         qzr = to_index_flat(std::move(qzr));
         // transfer ownership of qzr to index
@@ -580,7 +811,36 @@ IvfIndexNode<DataType, IndexType>::TrainInternal(const DataSetPtr dataset, const
         index->own_fields = true;
         index->make_direct_map(true, faiss::DirectMap::ConcurrentArray);
     }
+    if constexpr (std::is_same<faiss::IndexIVFRaBitQ, IndexType>::value) {
+        const IvfRaBitQConfig& rabitq_cfg = static_cast<const IvfRaBitQConfig&>(cfg);
+        auto nlist = MatchNlist(rows, rabitq_cfg.nlist.value());
+
+        const bool use_elkan = rabitq_cfg.use_elkan.value_or(true);
+
+        // create quantizer for the training
+        std::unique_ptr<faiss::IndexFlat> qzr =
+            std::make_unique<faiss::IndexFlatElkan>(dim, metric.value(), false, use_elkan);
+        std::unique_ptr<faiss::Index> refine_index;
+        if (rabitq_cfg.refine_type.value() == "FLAT") {
+            refine_index = std::make_unique<faiss::IndexFlat>(dim, metric.value());
+        } else if (rabitq_cfg.refine_type.value() == "SQ8") {
+            refine_index = std::make_unique<faiss::IndexScalarQuantizer>(
+                dim, faiss::ScalarQuantizer::QuantizerType::QT_8bit, metric.value());
+        }
+        // create index. Index does not own qzr, but owns the refine index
+        index = std::make_unique<faiss::IndexIVFRaBitQ>(qzr.get(), dim, nlist, metric.value(), refine_index.release());
+        // train
+        set_clustering_params(index->cp, ivf_cfg);
+        index->train(train_rows, (const float*)train_data);
+        // replace quantizer with a regular IndexFlat
+        qzr = to_index_flat(std::move(qzr));
+        // transfer ownership of qzr to index
+        index->quantizer = qzr.release();
+        index->own_fields = true;
+    }
     index_ = std::move(index);
+    scalar_partition_ = nullptr;
+    UpdateQuantizerKey();
 
     return Status::success;
 }
@@ -595,33 +855,270 @@ IvfIndexNode<DataType, IndexType>::Add(const DataSetPtr dataset, const Config& c
     auto data = dataset->GetTensor();
     auto rows = dataset->GetRows();
     const BaseConfig& base_cfg = static_cast<const IvfConfig&>(cfg);
+
+    std::optional<OptFieldCategories> scalar_field;
+    if constexpr (SupportsScalarPartition()) {
+        if (base_cfg.opt_fields_path.has_value() && !base_cfg.opt_fields_path.value().empty()) {
+            auto fields = ReadOptFields(base_cfg.opt_fields_path.value());
+            if (!fields.has_value()) {
+                LOG_KNOWHERE_ERROR_ << fields.what();
+                return fields.error();
+            }
+            if (index_->ntotal != 0) {
+                LOG_KNOWHERE_WARNING_ << "scalar partition needs an empty index, ignore opt_fields_path";
+            } else if (!fields.value().empty()) {
+                if (fields.value().size() > 1) {
+                    LOG_KNOWHERE_WARNING_ << "only the first of " << fields.value().size()
+                                          << " opt fields is used to partition the index";
+                }
+                scalar_field = std::move(fields.value()[0]);
+            }
+        }
+    }
+
     // use build_pool_ to make sure the OMP threads spawded by index_->add
     // can inherit the low nice value of threads in build_pool_.
     auto tryObj = build_pool_
                       ->push([&] {
+                          KNOWHERE_SCOPED_PHASE("build", "ivf_add");
                           std::unique_ptr<ThreadPool::ScopedOmpSetter> setter;
                           if (base_cfg.num_build_thread.has_value()) {
                               setter = std::make_unique<ThreadPool::ScopedOmpSetter>(base_cfg.num_build_thread.value());
                           } else {
                               setter = std::make_unique<ThreadPool::ScopedOmpSetter>();
                           }
+                          if (scalar_field.has_value()) {
+                              return AddWithScalarPartition(dataset, scalar_field.value());
+                          }
+                          if (scalar_partition_ != nullptr) {
+                              LOG_KNOWHERE_WARNING_ << "drop the scalar partition since rows are added without it";
+                              scalar_partition_ = nullptr;
+                          }
                           if constexpr (std::is_same<faiss::IndexBinaryIVF, IndexType>::value) {
                               index_->add(rows, (const uint8_t*)data);
                           } else {
                               index_->add(rows, (const float*)data);
                           }
+                          return Status::success;
                       })
                       .getTry();
     if (tryObj.hasException()) {
         LOG_KNOWHERE_WARNING_ << "faiss internal error: " << tryObj.exception().what();
         return Status::faiss_inner_error;
     }
-    return Status::success;
+    return tryObj.value();
+}
+
+template <typename DataType, typename IndexType>
+Status
+IvfIndexNode<DataType, IndexType>::AddWithScalarPartition(const DataSetPtr dataset, const OptFieldCategories& field) {
+    if constexpr (!SupportsScalarPartition()) {
+        return Status::not_implemented;
+    } else {
+        auto data = (const float*)dataset->GetTensor();
+        auto rows = dataset->GetRows();
+        auto dim = dataset->GetDim();
+
+        // rows missing from the opt field go to one extra category
+        constexpr uint32_t kNoCategory = std::numeric_limits<uint32_t>::max();
+        std::vector<uint32_t> row_categories(rows, kNoCategory);
+        for (size_t c = 0; c < field.category_rows.size(); ++c) {
+            for (auto row : field.category_rows[c]) {
+                if (row >= rows || row_categories[row] != kNoCategory) {
+                    LOG_KNOWHERE_ERROR_ << "invalid row " << row << " of category " << c << " in opt field "
+                                        << field.field_id;
+                    return Status::invalid_args;
+                }
+                row_categories[row] = c;
+            }
+        }
+        std::vector<uint32_t> uncategorized;
+        for (int64_t i = 0; i < rows; ++i) {
+            if (row_categories[i] == kNoCategory) {
+                uncategorized.push_back(i);
+            }
+        }
+
+        auto partition = std::make_unique<IvfScalarPartition>();
+        partition->field_id = field.field_id;
+        partition->num_categories = field.category_rows.size() + (uncategorized.empty() ? 0 : 1);
+        const size_t stride = partition->num_categories + 1;
+        const size_t nlist = index_->nlist;
+        partition->offsets.resize(nlist * stride);
+
+        std::vector<float> buf;
+        std::vector<faiss::idx_t> ids;
+        for (size_t c = 0; c < partition->num_categories; ++c) {
+            const auto& category_rows = c < field.category_rows.size() ? field.category_rows[c] : uncategorized;
+            for (size_t l = 0; l < nlist; ++l) {
+                partition->offsets[l * stride + c] = index_->invlists->list_size(l);
+            }
+            buf.resize(category_rows.size() * dim);
+            ids.resize(category_rows.size());
+            for (size_t i = 0; i < category_rows.size(); ++i) {
+                std::memcpy(buf.data() + i * dim, data + category_rows[i] * dim, dim * sizeof(float));
+                ids[i] = category_rows[i];
+            }
+            index_->add_with_ids(ids.size(), buf.data(), ids.data());
+        }
+        for (size_t l = 0; l < nlist; ++l) {
+            partition->offsets[l * stride + partition->num_categories] = index_->invlists->list_size(l);
+        }
+        scalar_partition_ = std::move(partition);
+        LOG_KNOWHERE_INFO_ << "partition IVF lists by " << scalar_partition_->num_categories << " categories of field "
+                           << field.field_id;
+        return Status::success;
+    }
+}
+
+template <typename DataType, typename IndexType>
+std::unique_ptr<faiss::IVFListRanges>
+IvfIndexNode<DataType, IndexType>::ScalarPartitionRanges(const IvfConfig& cfg, const BitsetView& bitset, size_t nq,
+                                                         size_t nprobe) const {
+    if constexpr (!SupportsScalarPartition()) {
+        return nullptr;
+    } else {
+        if (scalar_partition_ == nullptr || bitset.empty() || !cfg.materialized_view_search_info.has_value()) {
+            return nullptr;
+        }
+        // only worth it when the filter is known to select a few values of the partition field
+        const auto& mv_info = cfg.materialized_view_search_info.value();
+        const auto& partition = *scalar_partition_;
+        auto touched = mv_info.field_id_to_touched_categories_cnt.find(partition.field_id);
+        if (!mv_info.is_pure_and || mv_info.has_not || touched == mv_info.field_id_to_touched_categories_cnt.end() ||
+            touched->second >= partition.num_categories) {
+            return nullptr;
+        }
+
+        // the search info comes from expression analysis, so the bitset has the final say on which categories are
+        // alive, and telling them apart tests the bitset on every row of the index. that pays off only if the queries
+        // probe at least as many rows, otherwise the plain scan tests fewer rows and skips the filtered ones by words.
+        const size_t nlist = index_->nlist;
+        if (nq == 0 || nprobe < (nlist + nq - 1) / nq) {
+            return nullptr;
+        }
+        const size_t stride = partition.num_categories + 1;
+        std::vector<bool> alive(partition.num_categories, false);
+        for (size_t c = 0; c < partition.num_categories; ++c) {
+            for (size_t l = 0; l < nlist && !alive[c]; ++l) {
+                size_t begin = partition.offsets[l * stride + c];
+                size_t end = partition.offsets[l * stride + c + 1];
+                if (begin == end) {
+                    continue;
+                }
+                faiss::InvertedLists::ScopedIds ids(index_->invlists, l);
+                for (size_t j = begin; j < end; ++j) {
+                    if (!bitset.test(ids[j])) {
+                        alive[c] = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // the scan also drops the leading rows of each range that fail the bitset
+        auto ranges = std::make_unique<faiss::IVFListRanges>(nlist);
+        for (size_t l = 0; l < nlist; ++l) {
+            auto& list_ranges = (*ranges)[l];
+            for (size_t c = 0; c < partition.num_categories; ++c) {
+                size_t begin = partition.offsets[l * stride + c];
+                size_t end = partition.offsets[l * stride + c + 1];
+                if (!alive[c] || begin == end) {
+                    continue;
+                }
+                if (!list_ranges.empty() && list_ranges.back().second == begin) {
+                    list_ranges.back().second = end;
+                } else {
+                    list_ranges.emplace_back(begin, end);
+                }
+            }
+        }
+        return ranges;
+    }
+}
+
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::UpdateQuantizerKey() {
+    quantizer_key_ = 0;
+    if constexpr (std::is_same_v<IndexType, faiss::IndexIVFPQ>) {
+        auto flat = dynamic_cast<const faiss::IndexFlat*>(index_->quantizer);
+        if (flat == nullptr || !index_->is_trained) {
+            return;
+        }
+        uint64_t h = hash_vec(flat->get_xb(), flat->ntotal * flat->d);
+        h = h * 13331 + hash_vec(index_->pq.centroids.data(), index_->pq.centroids.size());
+        h = h * 13331 + index_->metric_type;
+        h = h * 13331 + (index_->by_residual ? 1 : 0) + (index_->use_precomputed_table > 0 ? 2 : 0);
+        quantizer_key_ = h;
+    }
+}
+
+template <typename DataType, typename IndexType>
+expected<QueryContextPtr>
+IvfIndexNode<DataType, IndexType>::PrepareQuery(const DataSetPtr dataset, const Config& cfg) const {
+    if (!this->index_) {
+        LOG_KNOWHERE_WARNING_ << "prepare query on empty index";
+        return expected<QueryContextPtr>::Err(Status::empty_index, "index not loaded");
+    }
+    if (!this->index_->is_trained) {
+        LOG_KNOWHERE_WARNING_ << "index not trained";
+        return expected<QueryContextPtr>::Err(Status::index_not_trained, "index not trained");
+    }
+    if constexpr (std::is_same_v<IndexType, faiss::IndexBinaryIVF>) {
+        return IndexNode::PrepareQuery(dataset, cfg);
+    } else {
+        const IvfConfig& ivf_cfg = static_cast<const IvfConfig&>(cfg);
+        bool normalized = IsMetricType(ivf_cfg.metric_type.value(), knowhere::metric::COSINE);
+        auto queries = normalized ? CopyAndNormalizeDataSet<fp32>(dataset) : dataset;
+
+        std::unique_ptr<IvfPqPreparedQueries> prepared = nullptr;
+        if constexpr (std::is_same_v<IndexType, faiss::IndexIVFPQ>) {
+            if (quantizer_key_ != 0) {
+                auto rows = queries->GetRows();
+                auto xq = (const float*)queries->GetTensor();
+                prepared = std::make_unique<IvfPqPreparedQueries>();
+                prepared->nprobe = std::min<size_t>(ivf_cfg.nprobe.value(), index_->nlist);
+                prepared->keys = std::make_unique<int64_t[]>(rows * prepared->nprobe);
+                prepared->coarse_dis = std::make_unique<float[]>(rows * prepared->nprobe);
+                prepared->table_size = index_->pq.M * index_->pq.ksub;
+                prepared->tables = std::make_unique<float[]>(rows * prepared->table_size);
+                try {
+                    index_->quantizer->search(rows, xq, prepared->nprobe, prepared->coarse_dis.get(),
+                                              prepared->keys.get());
+                    if (!index_->compute_query_tables(rows, xq, prepared->tables.get())) {
+                        prepared->tables = nullptr;
+                        prepared->table_size = 0;
+                    }
+                } catch (const std::exception& e) {
+                    LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
+                    return expected<QueryContextPtr>::Err(Status::faiss_inner_error, e.what());
+                }
+            }
+        }
+        return std::make_shared<const QueryContext>(queries, Type(), ivf_cfg.metric_type.value(), normalized,
+                                                    quantizer_key_, std::move(prepared));
+    }
+}
+
+template <typename DataType, typename IndexType>
+expected<DataSetPtr>
+IvfIndexNode<DataType, IndexType>::SearchPrepared(const QueryContext& query, const Config& cfg,
+                                                  const BitsetView& bitset) const {
+    return SearchImpl(query.GetQueries(), cfg, bitset, query.IsNormalized(),
+                      query.GetPrepared<IvfPqPreparedQueries>(quantizer_key_));
 }
 
 template <typename DataType, typename IndexType>
 expected<DataSetPtr>
 IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset) const {
+    return SearchImpl(dataset, cfg, bitset, false, nullptr);
+}
+
+template <typename DataType, typename IndexType>
+expected<DataSetPtr>
+IvfIndexNode<DataType, IndexType>::SearchImpl(const DataSetPtr dataset, const Config& cfg, const BitsetView& bitset,
+                                              bool normalized, const IvfPqPreparedQueries* prepared) const {
     if (!this->index_) {
         LOG_KNOWHERE_WARNING_ << "search on empty index";
         return expected<DataSetPtr>::Err(Status::empty_index, "index not loaded");
@@ -643,6 +1140,19 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
 
     auto ids = std::make_unique<int64_t[]>(rows * k);
     auto distances = std::make_unique<float[]>(rows * k);
+    auto list_ranges = ScalarPartitionRanges(ivf_cfg, bitset, rows, nprobe);
+    // an allow-list shorter than the probed lists is scanned directly, which is also exact
+    bool scan_allowed_ids = false;
+    size_t allowed_num = 0;
+    if constexpr (!std::is_same_v<IndexType, faiss::IndexBinaryIVF> && !IsFastScan()) {
+        if (bitset.has_allowed_ids() && index_->direct_map.type != faiss::DirectMap::NoMap) {
+            const int64_t* allowed = bitset.allowed_ids();
+            allowed_num = std::lower_bound(allowed, allowed + bitset.allowed_num(),
+                                           std::min<int64_t>(bitset.size(), index_->ntotal)) -
+                          allowed;
+            scan_allowed_ids = allowed_num < (double)nprobe * index_->ntotal / index_->nlist;
+        }
+    }
     try {
         std::vector<folly::Future<folly::Unit>> futs;
         futs.reserve(rows);
@@ -674,7 +1184,7 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
                 } else if constexpr (std::is_same<IndexType, faiss::IndexIVFFlatCC>::value ||
                                      std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
                     auto cur_query = (const float*)data + index * dim;
-                    if (is_cosine) {
+                    if (is_cosine && !normalized) {
                         copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
                         cur_query = copied_query.get();
                     }
@@ -694,10 +1204,9 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
                     }
 
                     index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &ivf_search_params);
-                } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+                } else if constexpr (IsFastScan()) {
                     auto cur_query = (const float*)data + index * dim;
-                    const ScannConfig& scann_cfg = static_cast<const ScannConfig&>(cfg);
-                    if (is_cosine) {
+                    if (is_cosine && !normalized) {
                         copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
                         cur_query = copied_query.get();
                     }
@@ -709,20 +1218,45 @@ IvfIndexNode<DataType, IndexType>::Search(const DataSetPtr dataset, const Config
 
                     faiss::IndexScaNNSearchParameters scann_search_params;
                     scann_search_params.base_index_params = &base_search_params;
-                    scann_search_params.reorder_k = scann_cfg.reorder_k.value();
+                    if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+                        scann_search_params.reorder_k = static_cast<const ScannConfig&>(cfg).reorder_k.value();
+                    } else {
+                        scann_search_params.reorder_k = static_cast<const IvfSq4FsConfig&>(cfg).reorder_k.value();
+                    }
 
                     index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &scann_search_params);
                 } else {
                     auto cur_query = (const float*)data + index * dim;
-                    if (is_cosine) {
+                    if (is_cosine && !normalized) {
                         copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
                         cur_query = copied_query.get();
                     }
 
+                    if (scan_allowed_ids) {
+                        index_->search_by_ids(1, cur_query, k, bitset.allowed_ids(), allowed_num,
+                                              distances.get() + offset, ids.get() + offset);
+                        return;
+                    }
+
                     faiss::IVFSearchParameters ivf_search_params;
                     ivf_search_params.nprobe = nprobe;
                     ivf_search_params.max_codes = 0;
                     ivf_search_params.sel = id_selector;
+                    ivf_search_params.list_ranges = list_ranges.get();
+
+                    // the prepared lists and tables skip the coarse search and the table computation
+                    if (prepared != nullptr && prepared->nprobe == std::min<size_t>(nprobe, index_->nlist)) {
+                        ivf_search_params.nprobe = prepared->nprobe;
+                        if (prepared->tables != nullptr) {
+                            ivf_search_params.query_tables = prepared->tables.get() + index * prepared->table_size;
+                            ivf_search_params.query_table_size = prepared->table_size;
+                        }
+                        auto keys = prepared->keys.get() + index * prepared->nprobe;
+                        auto coarse_dis = prepared->coarse_dis.get() + index * prepared->nprobe;
+                        index_->search_preassigned(1, cur_query, k, keys, coarse_dis, distances.get() + offset,
+                                                   ids.get() + offset, false, &ivf_search_params);
+                        return;
+                    }
 
                     index_->search(1, cur_query, k, distances.get() + offset, ids.get() + offset, &ivf_search_params);
                 }
@@ -767,6 +1301,8 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, const C
 
     std::vector<std::vector<int64_t>> result_id_array(nq);
     std::vector<std::vector<float>> result_dist_array(nq);
+    // range search probes every list
+    auto list_ranges = ScalarPartitionRanges(ivf_cfg, bitset, nq, std::numeric_limits<size_t>::max());
 
     try {
         std::vector<folly::Future<folly::Unit>> futs;
@@ -801,9 +1337,10 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, const C
                     ivf_search_params.max_codes = 0;
                     ivf_search_params.max_empty_result_buckets = ivf_cfg.max_empty_result_buckets.value();
                     ivf_search_params.sel = id_selector;
+                    ivf_search_params.list_ranges = list_ranges.get();
 
                     index_->range_search(1, cur_query, radius, &res, &ivf_search_params);
-                } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value) {
+                } else if constexpr (IsFastScan()) {
                     auto cur_query = (const float*)xq + index * dim;
                     if (is_cosine) {
                         copied_query = CopyAndNormalizeVecs(cur_query, 1, dim);
@@ -828,6 +1365,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, const C
                     ivf_search_params.max_codes = 0;
                     ivf_search_params.max_empty_result_buckets = ivf_cfg.max_empty_result_buckets.value();
                     ivf_search_params.sel = id_selector;
+                    ivf_search_params.list_ranges = list_ranges.get();
 
                     index_->range_search(1, cur_query, radius, &res, &ivf_search_params);
                 }
@@ -846,6 +1384,7 @@ IvfIndexNode<DataType, IndexType>::RangeSearch(const DataSetPtr dataset, const C
         }
         // wait for the completion
         WaitAllSuccess(futs);
+        KNOWHERE_SCOPED_PHASE("range_search", "merge_results");
         range_search_result = GetRangeSearchResult(result_dist_array, result_id_array, is_ip, nq, radius, range_filter);
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
@@ -867,10 +1406,12 @@ IvfIndexNode<DataType, IndexType>::AnnIterator(const DataSetPtr dataset, const C
         LOG_KNOWHERE_WARNING_ << "index not trained";
         return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::index_not_trained, "index not trained");
     }
-    // only support IVFFlat and IVFFlatCC;
+    // only support IVFFlat, IVFFlatCC and IVF_RABITQ;
     if constexpr (!std::is_same<faiss::IndexIVFFlatCC, IndexType>::value &&
-                  !std::is_same<faiss::IndexIVFFlat, IndexType>::value) {
-        LOG_KNOWHERE_WARNING_ << "Current index_type: " << Type() << ", only IVFFlat and IVFFlatCC support Iterator.";
+                  !std::is_same<faiss::IndexIVFFlat, IndexType>::value &&
+                  !std::is_same<faiss::IndexIVFRaBitQ, IndexType>::value) {
+        LOG_KNOWHERE_WARNING_ << "Current index_type: " << Type()
+                              << ", only IVFFlat, IVFFlatCC and IVF_RABITQ support Iterator.";
         return expected<std::vector<IndexNode::IteratorPtr>>::Err(Status::not_implemented, "index not supported");
     } else {
         auto dim = dataset->GetDim();
@@ -960,8 +1501,8 @@ IvfIndexNode<DataType, IndexType>::GetVectorByIds(const DataSetPtr dataset) cons
             LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
             return expected<DataSetPtr>::Err(Status::faiss_inner_error, e.what());
         }
-    } else if constexpr (std::is_same<IndexType, faiss::IndexScaNN>::value ||
-                         std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value) {
+    } else if constexpr (IsFastScan() || std::is_same<IndexType, faiss::IndexIVFScalarQuantizerCC>::value ||
+                         std::is_same<IndexType, faiss::IndexIVFRaBitQ>::value) {
         // we should never go here since we should call HasRawData() first
         if (!index_->with_raw_data()) {
             return expected<DataSetPtr>::Err(Status::not_implemented, "GetVectorByIds not implemented");
@@ -1038,6 +1579,7 @@ IvfIndexNode<DataType, IndexType>::SerializeImpl(BinarySet& binset, IVFBaseTag)
         }
         std::shared_ptr<uint8_t[]> data(writer.data());
         binset.Append(Type(), data, writer.tellg());
+        SerializeScalarPartition(binset);
         return Status::success;
     } catch (const std::exception& e) {
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
@@ -1060,6 +1602,7 @@ IvfIndexNode<DataType, IndexType>::SerializeImpl(BinarySet& binset, IVFFlatTag)
         }
         std::shared_ptr<uint8_t[]> index_data_ptr(writer.data());
         binset.Append(Type(), index_data_ptr, writer.tellg());
+        SerializeScalarPartition(binset);
 
         // append raw data for backward compatible
         if (this->version_ <= Version::GetMinimalVersion()) {
@@ -1088,6 +1631,67 @@ IvfIndexNode<DataType, IndexType>::SerializeImpl(BinarySet& binset, IVFFlatTag)
     }
 }
 
+template <typename DataType, typename IndexType>
+void
+IvfIndexNode<DataType, IndexType>::SerializeScalarPartition(BinarySet& binset) const {
+    if (scalar_partition_ == nullptr) {
+        return;
+    }
+    const auto& partition = *scalar_partition_;
+    MemoryIOWriter writer;
+    int64_t field_id = partition.field_id;
+    uint64_t num_categories = partition.num_categories;
+    uint64_t num_offsets = partition.offsets.size();
+    writer.write(&field_id, sizeof(field_id));
+    writer.write(&num_categories, sizeof(num_categories));
+    writer.write(&num_offsets, sizeof(num_offsets));
+    for (uint64_t offset : partition.offsets) {
+        writer.write(&offset, sizeof(offset));
+    }
+    std::shared_ptr<uint8_t[]> data(writer.data());
+    binset.Append(kScalarPartitionBinaryName, data, writer.tellg());
+}
+
+template <typename DataType, typename IndexType>
+Status
+IvfIndexNode<DataType, IndexType>::DeserializeScalarPartition(const BinarySet& binset) {
+    scalar_partition_ = nullptr;
+    auto binary = binset.GetByName(kScalarPartitionBinaryName);
+    if (binary == nullptr) {
+        return Status::success;
+    }
+    if constexpr (!SupportsScalarPartition()) {
+        LOG_KNOWHERE_ERROR_ << "scalar partition is not supported by " << Type();
+        return Status::invalid_binary_set;
+    } else {
+        if (binary->size < static_cast<int64_t>(3 * sizeof(uint64_t))) {
+            LOG_KNOWHERE_ERROR_ << "truncated scalar partition";
+            return Status::invalid_binary_set;
+        }
+        MemoryIOReader reader(binary->data.get(), binary->size);
+        auto partition = std::make_unique<IvfScalarPartition>();
+        uint64_t num_categories = 0;
+        uint64_t num_offsets = 0;
+        reader.read(&partition->field_id, sizeof(partition->field_id));
+        reader.read(&num_categories, sizeof(num_categories));
+        reader.read(&num_offsets, sizeof(num_offsets));
+        if (num_offsets != index_->nlist * (num_categories + 1) ||
+            binary->size != static_cast<int64_t>((3 + num_offsets) * sizeof(uint64_t))) {
+            LOG_KNOWHERE_ERROR_ << "scalar partition does not match the index";
+            return Status::invalid_binary_set;
+        }
+        partition->num_categories = num_categories;
+        partition->offsets.resize(num_offsets);
+        for (auto& offset : partition->offsets) {
+            uint64_t v = 0;
+            reader.read(&v, sizeof(v));
+            offset = v;
+        }
+        scalar_partition_ = std::move(partition);
+        return Status::success;
+    }
+}
+
 template <typename DataType, typename IndexType>
 Status
 IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, const Config& config) {
@@ -1102,6 +1706,7 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, const Co
 
     MemoryIOReader reader(binary->data.get(), binary->size);
     try {
+        KNOWHERE_SCOPED_PHASE("load", "ivf_read");
         if constexpr (std::is_same<IndexType, faiss::IndexIVFFlat>::value) {
             if (this->version_ <= Version::GetMinimalVersion()) {
                 auto raw_binary = binset.GetByName("RAW_DATA");
@@ -1117,8 +1722,8 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, const Co
         } else {
             index_.reset(static_cast<IndexType*>(faiss::read_index(&reader)));
         }
-        if constexpr (!std::is_same_v<IndexType, faiss::IndexScaNN> &&
-                      !std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC>) {
+        if constexpr (!IsFastScan() && !std::is_same_v<IndexType, faiss::IndexIVFScalarQuantizerCC> &&
+                      !std::is_same_v<IndexType, faiss::IndexIVFRaBitQ>) {
             const BaseConfig& base_cfg = static_cast<const BaseConfig&>(config);
             if (HasRawData(base_cfg.metric_type.value())) {
                 index_->make_direct_map(true);
@@ -1128,7 +1733,8 @@ IvfIndexNode<DataType, IndexType>::Deserialize(const BinarySet& binset, const Co
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
     }
-    return Status::success;
+    UpdateQuantizerKey();
+    return DeserializeScalarPartition(binset);
 }
 
 template <typename DataType, typename IndexType>
@@ -1140,13 +1746,16 @@ IvfIndexNode<DataType, IndexType>::DeserializeFromFile(const std::string& filena
     if (cfg.enable_mmap.value()) {
         io_flags |= faiss::IO_FLAG_MMAP;
     }
+    // the index file holds the faiss index only, searches scan whole lists
+    scalar_partition_ = nullptr;
     try {
+        KNOWHERE_SCOPED_PHASE("load", "ivf_read");
         if constexpr (std::is_same<IndexType, faiss::IndexBinaryIVF>::value) {
             index_.reset(static_cast<IndexType*>(faiss::read_index_binary(filename.data(), io_flags)));
         } else {
             index_.reset(static_cast<IndexType*>(faiss::read_index(filename.data(), io_flags)));
         }
-        if constexpr (!std::is_same_v<IndexType, faiss::IndexScaNN>) {
+        if constexpr (!IsFastScan() && !std::is_same_v<IndexType, faiss::IndexIVFRaBitQ>) {
             const BaseConfig& base_cfg = static_cast<const BaseConfig&>(config);
             if (HasRawData(base_cfg.metric_type.value())) {
                 index_->make_direct_map(true);
@@ -1156,6 +1765,7 @@ IvfIndexNode<DataType, IndexType>::DeserializeFromFile(const std::string& filena
         LOG_KNOWHERE_WARNING_ << "faiss inner error: " << e.what();
         return Status::faiss_inner_error;
     }
+    UpdateQuantizerKey();
     return Status::success;
 }
 // bin1
@@ -1167,31 +1777,37 @@ KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_FLAT, IvfIndexNode, fp32, faiss::IndexIVFFla
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVFFLATCC, IvfIndexNode, fp32, faiss::IndexIVFFlatCC);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_FLAT_CC, IvfIndexNode, fp32, faiss::IndexIVFFlatCC);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(SCANN, IvfIndexNode, fp32, faiss::IndexScaNN);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_SQ4_FS, IvfIndexNode, fp32, faiss::IndexSQ4FastScan);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVFPQ, IvfIndexNode, fp32, faiss::IndexIVFPQ);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_PQ, IvfIndexNode, fp32, faiss::IndexIVFPQ);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVFSQ, IvfIndexNode, fp32, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_SQ8, IvfIndexNode, fp32, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_SQ_CC, IvfIndexNode, fp32, faiss::IndexIVFScalarQuantizerCC);
+KNOWHERE_SIMPLE_REGISTER_GLOBAL(IVF_RABITQ, IvfIndexNode, fp32, faiss::IndexIVFRaBitQ);
 // fp16
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFFLAT, IvfIndexNode, fp16, faiss::IndexIVFFlat);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_FLAT, IvfIndexNode, fp16, faiss::IndexIVFFlat);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFFLATCC, IvfIndexNode, fp16, faiss::IndexIVFFlatCC);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_FLAT_CC, IvfIndexNode, fp16, faiss::IndexIVFFlatCC);
 KNOWHERE_MOCK_REGISTER_GLOBAL(SCANN, IvfIndexNode, fp16, faiss::IndexScaNN);
+KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ4_FS, IvfIndexNode, fp16, faiss::IndexSQ4FastScan);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFPQ, IvfIndexNode, fp16, faiss::IndexIVFPQ);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_PQ, IvfIndexNode, fp16, faiss::IndexIVFPQ);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFSQ, IvfIndexNode, fp16, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ8, IvfIndexNode, fp16, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ_CC, IvfIndexNode, fp16, faiss::IndexIVFScalarQuantizerCC);
+KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_RABITQ, IvfIndexNode, fp16, faiss::IndexIVFRaBitQ);
 // bf16
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFFLAT, IvfIndexNode, bf16, faiss::IndexIVFFlat);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_FLAT, IvfIndexNode, bf16, faiss::IndexIVFFlat);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFFLATCC, IvfIndexNode, bf16, faiss::IndexIVFFlatCC);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_FLAT_CC, IvfIndexNode, bf16, faiss::IndexIVFFlatCC);
 KNOWHERE_MOCK_REGISTER_GLOBAL(SCANN, IvfIndexNode, bf16, faiss::IndexScaNN);
+KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ4_FS, IvfIndexNode, bf16, faiss::IndexSQ4FastScan);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFPQ, IvfIndexNode, bf16, faiss::IndexIVFPQ);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_PQ, IvfIndexNode, bf16, faiss::IndexIVFPQ);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVFSQ, IvfIndexNode, bf16, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ8, IvfIndexNode, bf16, faiss::IndexIVFScalarQuantizer);
 KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_SQ_CC, IvfIndexNode, bf16, faiss::IndexIVFScalarQuantizerCC);
+KNOWHERE_MOCK_REGISTER_GLOBAL(IVF_RABITQ, IvfIndexNode, bf16, faiss::IndexIVFRaBitQ);
 }  // namespace knowhere
@@ -23,6 +23,12 @@ class IvfConfig : public BaseConfig {
     CFG_BOOL use_elkan;
     CFG_BOOL ensure_topk_full;  // only take affect on temp index(IVF_FLAT_CC) now
     CFG_INT max_empty_result_buckets;
+    // clustering of the coarse quantizer, set per build instead of through the faiss globals
+    CFG_STRING clustering_type;
+    CFG_FLOAT kmeans_early_stop_threshold;
+    CFG_INT kmeans_n_iters;
+    CFG_INT max_points_per_centroid;
+    CFG_FLOAT train_sample_ratio;
     KNOHWERE_DECLARE_CONFIG(IvfConfig) {
         KNOWHERE_CONFIG_DECLARE_FIELD(nlist)
             .set_default(128)
@@ -48,6 +54,49 @@ class IvfConfig : public BaseConfig {
             .description("the maximum of continuous buckets with empty result")
             .for_range_search()
             .set_range(1, 65536);
+        KNOWHERE_CONFIG_DECLARE_FIELD(clustering_type)
+            .description("K_MEANS or K_MEANS_PLUS_PLUS, the global clustering type is used if not set.")
+            .allow_empty_without_default()
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_early_stop_threshold)
+            .description("stop kmeans once the objective improves by less than this percent in an iteration, "
+                         "the global threshold is used if not set.")
+            .allow_empty_without_default()
+            .set_range(0.0, 100.0)
+            .for_train();
+        KNOWHERE_CONFIG_DECLARE_FIELD(kmeans_n_iters)
+            .description("number of kmeans iterations of the coarse quantizer, the faiss default is used if not set.")
+            .allow_empty_without_default()
+            .for_train()
+            .set_range(1, 1024);
+        KNOWHERE_CONFIG_DECLARE_FIELD(max_points_per_centroid)
+            .set_default(256)
+            .description("kmeans samples at most this many rows per inverted list.")
+            .for_train()
+            .set_range(1, 65536);
+        KNOWHERE_CONFIG_DECLARE_FIELD(train_sample_ratio)
+            .set_default(1.0)
+            .description("fraction of the rows handed to the index training, the rest are only added.")
+            .for_train()
+            .set_range(0.0, 1.0);
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::TRAIN) {
+            if (clustering_type.has_value() && clustering_type.value() != "K_MEANS" &&
+                clustering_type.value() != "K_MEANS_PLUS_PLUS") {
+                *err_msg = "clustering_type(" + clustering_type.value() + ") should be K_MEANS or K_MEANS_PLUS_PLUS";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::invalid_param_in_json;
+            }
+            if (train_sample_ratio.value() <= 0.0f) {
+                *err_msg = "train_sample_ratio should be larger than 0";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::out_of_range_in_json;
+            }
+        }
+        return Status::success;
     }
 };
 
@@ -122,7 +171,78 @@ class ScannConfig : public IvfFlatConfig {
                 break;
             }
         }
-        return Status::success;
+        return IvfFlatConfig::CheckAndAdjust(param_type, err_msg);
+    }
+};
+
+// IVF_SQ4_FS encodes each dimension in 4 bits and scans the codes with the pq4 fast-scan kernels, the reorder_k
+// candidates are then refined on the raw vectors (FLAT), on 8-bit codes (SQ8) or not at all (NONE)
+class IvfSq4FsConfig : public IvfFlatConfig {
+ public:
+    CFG_INT reorder_k;
+    CFG_STRING refine_type;
+    KNOHWERE_DECLARE_CONFIG(IvfSq4FsConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(reorder_k)
+            .description("reorder k used for refining")
+            .allow_empty_without_default()
+            .set_range(1, std::numeric_limits<CFG_INT::value_type>::max())
+            .for_search();
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("data the candidates are refined on, in NONE, FLAT and SQ8")
+            .set_default("FLAT")
+            .for_train();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (!faiss::support_pq_fast_scan) {
+            LOG_KNOWHERE_ERROR_ << "IVF_SQ4_FS index is not supported on the current CPU model, avx2 support is "
+                                   "needed for x86 arch.";
+            return Status::invalid_instruction_set;
+        }
+        if (param_type == PARAM_TYPE::TRAIN) {
+            auto refine = refine_type.value();
+            if (refine != "NONE" && refine != "FLAT" && refine != "SQ8") {
+                *err_msg = "refine_type " + refine + " is not supported, it should be in NONE, FLAT and SQ8";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::invalid_value_in_json;
+            }
+        }
+        if (param_type == PARAM_TYPE::SEARCH) {
+            if (!reorder_k.has_value()) {
+                reorder_k = k.value();
+            } else if (reorder_k.value() < k.value()) {
+                *err_msg = "reorder_k(" + std::to_string(reorder_k.value()) + ") should be larger than k(" +
+                           std::to_string(k.value()) + ")";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::out_of_range_in_json;
+            }
+        }
+        return IvfFlatConfig::CheckAndAdjust(param_type, err_msg);
+    }
+};
+
+class IvfRaBitQConfig : public IvfConfig {
+ public:
+    CFG_STRING refine_type;
+    KNOHWERE_DECLARE_CONFIG(IvfRaBitQConfig) {
+        KNOWHERE_CONFIG_DECLARE_FIELD(refine_type)
+            .description("data the candidates are re-ranked on, in NONE, FLAT and SQ8")
+            .set_default("FLAT")
+            .for_train();
+    }
+
+    Status
+    CheckAndAdjust(PARAM_TYPE param_type, std::string* err_msg) override {
+        if (param_type == PARAM_TYPE::TRAIN) {
+            auto refine = refine_type.value();
+            if (refine != "NONE" && refine != "FLAT" && refine != "SQ8") {
+                *err_msg = "refine_type " + refine + " is not supported, it should be in NONE, FLAT and SQ8";
+                LOG_KNOWHERE_ERROR_ << *err_msg;
+                return Status::invalid_value_in_json;
+            }
+        }
+        return IvfConfig::CheckAndAdjust(param_type, err_msg);
     }
 };
 
@@ -161,7 +281,7 @@ class IvfSqCcConfig : public IvfFlatCcConfig {
                 return Status::invalid_value_in_json;
             }
         }
-        return Status::success;
+        return IvfFlatCcConfig::CheckAndAdjust(param_type, err_msg);
     }
 };
 
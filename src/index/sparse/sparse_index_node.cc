@@ -223,6 +223,11 @@ class SparseInvertedIndexNode : public IndexNode {
         return index_->Load(map_reader, true);
     }
 
+    void
+    SetSearchThreadPool(std::shared_ptr<ThreadPool> pool) override {
+        search_pool_ = std::move(pool);
+    }
+
     [[nodiscard]] std::unique_ptr<BaseConfig>
     CreateConfig() const override {
         return std::make_unique<SparseInvertedIndexConfig>();
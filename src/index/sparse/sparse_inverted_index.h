@@ -20,6 +20,9 @@
 
 #include "io/memory_io.h"
 #include "knowhere/bitsetview.h"
+#include "knowhere/comp/cancellation.h"
+#include "knowhere/comp/phase_timer.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/expected.h"
 #include "knowhere/log.h"
 #include "knowhere/sparse_utils.h"
@@ -78,6 +81,7 @@ class InvertedIndex {
 
     Status
     Load(MemoryIOReader& reader, bool is_mmap) {
+        KNOWHERE_SCOPED_PHASE("load", "sparse_read");
         std::unique_lock<std::shared_mutex> lock(mu_);
         int64_t rows;
         readBinaryPOD(reader, rows);
@@ -146,6 +150,7 @@ class InvertedIndex {
             max_dim_ = dim;
         }
 
+        KNOWHERE_SCOPED_PHASE("build", "sparse_add");
         raw_data_.insert(raw_data_.end(), data, data + rows);
         for (size_t i = 0; i < rows; ++i) {
             add_row_to_index(data[i], current_rows + i);
@@ -178,15 +183,19 @@ class InvertedIndex {
             refine_factor = 1;
         }
         MaxMinHeap<T> heap(k * refine_factor);
-        if (!use_wand_) {
-            search_brute_force(query, q_threshold, heap, bitset);
-        } else {
-            search_wand(query, q_threshold, heap, bitset);
+        {
+            KNOWHERE_SCOPED_PHASE("search", "sparse_scan");
+            if (!use_wand_) {
+                search_brute_force(query, q_threshold, heap, bitset);
+            } else {
+                search_wand(query, q_threshold, heap, bitset);
+            }
         }
 
         if (refine_factor == 1) {
             collect_result(heap, distances, labels);
         } else {
+            KNOWHERE_SCOPED_PHASE("search", "sparse_refine");
             refine_and_collect(query, heap, k, distances, labels);
         }
     }
@@ -264,6 +273,7 @@ class InvertedIndex {
     std::vector<float>
     compute_all_distances(const SparseRow<T>& q_vec, T q_threshold) const {
         std::vector<float> scores(n_rows_internal(), 0.0f);
+        SearchStats stats;
         for (size_t idx = 0; idx < q_vec.size(); ++idx) {
             auto [i, v] = q_vec[idx];
             if (v < q_threshold || i >= n_cols_internal()) {
@@ -273,13 +283,20 @@ class InvertedIndex {
             if (lut_it == inverted_lut_.end()) {
                 continue;
             }
+            if (SearchCancelled()) {
+                break;
+            }
             // TODO: improve with SIMD
             auto& lut = lut_it->second;
             for (size_t j = 0; j < lut.size(); j++) {
                 auto [idx, val] = lut[j];
                 scores[idx] += v * float(val);
             }
+            stats.lists_probed++;
+            stats.codes_scanned += lut.size();
         }
+        stats.distance_computations = stats.codes_scanned;
+        AddSearchStats(stats);
         return scores;
     }
 
@@ -382,13 +399,19 @@ class InvertedIndex {
             return;
         }
         cursors.resize(valid_q_dim);
+        SearchStats stats;
+        stats.lists_probed = valid_q_dim;
         auto sort_cursors = [&cursors] {
             std::sort(cursors.begin(), cursors.end(),
                       [](auto& x, auto& y) { return x->cur_vec_id() < y->cur_vec_id(); });
         };
         sort_cursors();
         auto score_above_threshold = [&heap](float x) { return !heap.full() || x > heap.top().val; };
+        size_t rounds = 0;
         while (true) {
+            if ((rounds++ & 255) == 0 && SearchCancelled()) {
+                break;
+            }
             float upper_bound = 0;
             size_t pivot;
             bool found_pivot = false;
@@ -414,8 +437,10 @@ class InvertedIndex {
                     }
                     score += cursor->cur_distance() * cursor->q_value();
                     cursor->next();
+                    stats.codes_scanned++;
                 }
                 heap.push(pivot_id, score);
+                stats.distance_computations++;
                 sort_cursors();
             } else {
                 size_t next_list = pivot;
@@ -430,6 +455,7 @@ class InvertedIndex {
                 }
             }
         }
+        AddSearchStats(stats);
     }
 
     void
@@ -437,11 +463,13 @@ class InvertedIndex {
                        label_t* labels) const {
         std::priority_queue<SparseIdVal<T>, std::vector<SparseIdVal<T>>, std::greater<SparseIdVal<T>>> heap;
 
+        int64_t refined = 0;
         while (!inaccurate.empty()) {
             auto [u, d] = inaccurate.top();
             inaccurate.pop();
 
             auto dist_acc = q_vec.dot(raw_data_[u]);
+            refined++;
             if (heap.size() < k) {
                 heap.emplace(u, dist_acc);
             } else if (heap.top().val < dist_acc) {
@@ -449,6 +477,9 @@ class InvertedIndex {
                 heap.emplace(u, dist_acc);
             }
         }
+        SearchStats stats;
+        stats.distance_computations = refined;
+        AddSearchStats(stats);
         collect_result(heap, distances, labels);
     }
 
@@ -15,7 +15,11 @@
 
 #include <immintrin.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 
 #include "faiss/impl/platform_macros.h"
 #include "knowhere/operands.h"
@@ -298,28 +302,589 @@ fvec_L2sqr_batch_4_avx_bf16_patch(const float* x, const float* y0, const float*
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
-// trust the compiler to unroll this properly
+namespace {
+
+// sums each of the 8 vectors, the sum of a<i> goes to lane i
+inline __m256
+reduce_add_8x8(__m256 a0, __m256 a1, __m256 a2, __m256 a3, __m256 a4, __m256 a5, __m256 a6, __m256 a7) {
+    const __m256 t0 = _mm256_hadd_ps(a0, a1);
+    const __m256 t1 = _mm256_hadd_ps(a2, a3);
+    const __m256 t2 = _mm256_hadd_ps(a4, a5);
+    const __m256 t3 = _mm256_hadd_ps(a6, a7);
+    const __m256 u0 = _mm256_hadd_ps(t0, t1);
+    const __m256 u1 = _mm256_hadd_ps(t2, t3);
+    return _mm256_add_ps(_mm256_permute2f128_ps(u0, u1, 0x20), _mm256_permute2f128_ps(u0, u1, 0x31));
+}
+
+// mask of the first 0 <= n <= 8 lanes, for _mm256_maskload_ps
+inline __m256i
+head_mask(size_t n) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+struct ElementOpL2 {
+    static __m256
+    acc(__m256 x, __m256 y, __m256 sum) {
+        const __m256 t = _mm256_sub_ps(x, y);
+        return _mm256_fmadd_ps(t, t, sum);
+    }
+
+    static float
+    one(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr_avx(x, y, d);
+    }
+};
+
+struct ElementOpIP {
+    static __m256
+    acc(__m256 x, __m256 y, __m256 sum) {
+        return _mm256_fmadd_ps(x, y, sum);
+    }
+
+    static float
+    one(const float* x, const float* y, size_t d) {
+        return fvec_inner_product_avx(x, y, d);
+    }
+};
+
+// distances between x and the 8 contiguous vectors of y, one accumulator per vector so that x is read once. the
+// accumulators are spelled out, gcc may keep an array of them in memory
+template <class ElementOp>
+inline void
+fvec_op_batch_8(float* dis, const float* x, const float* y, size_t d) {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+    __m256 a4 = _mm256_setzero_ps(), a5 = _mm256_setzero_ps(), a6 = _mm256_setzero_ps(), a7 = _mm256_setzero_ps();
+    size_t j = 0;
+    for (; j + 8 <= d; j += 8) {
+        const __m256 mx = _mm256_loadu_ps(x + j);
+        const float* yj = y + j;
+        a0 = ElementOp::acc(mx, _mm256_loadu_ps(yj), a0);
+        a1 = ElementOp::acc(mx, _mm256_loadu_ps(yj + d), a1);
+        a2 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 2 * d), a2);
+        a3 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 3 * d), a3);
+        a4 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 4 * d), a4);
+        a5 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 5 * d), a5);
+        a6 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 6 * d), a6);
+        a7 = ElementOp::acc(mx, _mm256_loadu_ps(yj + 7 * d), a7);
+    }
+    if (j < d) {
+        const __m256i mask = head_mask(d - j);
+        const __m256 mx = _mm256_maskload_ps(x + j, mask);
+        const float* yj = y + j;
+        a0 = ElementOp::acc(mx, _mm256_maskload_ps(yj, mask), a0);
+        a1 = ElementOp::acc(mx, _mm256_maskload_ps(yj + d, mask), a1);
+        a2 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 2 * d, mask), a2);
+        a3 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 3 * d, mask), a3);
+        a4 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 4 * d, mask), a4);
+        a5 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 5 * d, mask), a5);
+        a6 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 6 * d, mask), a6);
+        a7 = ElementOp::acc(mx, _mm256_maskload_ps(yj + 7 * d, mask), a7);
+    }
+    _mm256_storeu_ps(dis, reduce_add_8x8(a0, a1, a2, a3, a4, a5, a6, a7));
+}
+
+// d = 2 and d = 4 are the usual pq sub-vector sizes, where a vector is too short for a register of its own
+template <class ElementOp>
+inline void
+fvec_op_batch_8_D2(float* dis, const float* x, const float* y) {
+    const __m256 mx = _mm256_castpd_ps(_mm256_broadcast_sd(reinterpret_cast<const double*>(x)));
+    const __m256 m0 = ElementOp::acc(mx, _mm256_loadu_ps(y), _mm256_setzero_ps());
+    const __m256 m1 = ElementOp::acc(mx, _mm256_loadu_ps(y + 8), _mm256_setzero_ps());
+    // lanes hold vectors 0 1 4 5 2 3 6 7
+    const __m256 s = _mm256_hadd_ps(m0, m1);
+    _mm256_storeu_ps(dis, _mm256_permutevar8x32_ps(s, _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7)));
+}
+
+template <class ElementOp>
+inline void
+fvec_op_batch_8_D4(float* dis, const float* x, const float* y) {
+    const __m256 mx = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(x));
+    const __m256 m0 = ElementOp::acc(mx, _mm256_loadu_ps(y), _mm256_setzero_ps());
+    const __m256 m1 = ElementOp::acc(mx, _mm256_loadu_ps(y + 8), _mm256_setzero_ps());
+    const __m256 m2 = ElementOp::acc(mx, _mm256_loadu_ps(y + 16), _mm256_setzero_ps());
+    const __m256 m3 = ElementOp::acc(mx, _mm256_loadu_ps(y + 24), _mm256_setzero_ps());
+    // lanes hold vectors 0 2 4 6 1 3 5 7
+    const __m256 s = _mm256_hadd_ps(_mm256_hadd_ps(m0, m1), _mm256_hadd_ps(m2, m3));
+    _mm256_storeu_ps(dis, _mm256_permutevar8x32_ps(s, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+}
+
+template <class ElementOp>
+void
+fvec_op_ny(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    size_t i = 0;
+    switch (d) {
+        case 2:
+            for (; i + 8 <= ny; i += 8) {
+                fvec_op_batch_8_D2<ElementOp>(dis + i, x, y + i * d);
+            }
+            break;
+        case 4:
+            for (; i + 8 <= ny; i += 8) {
+                fvec_op_batch_8_D4<ElementOp>(dis + i, x, y + i * d);
+            }
+            break;
+        default:
+            for (; i + 8 <= ny; i += 8) {
+                fvec_op_batch_8<ElementOp>(dis + i, x, y + i * d, d);
+            }
+    }
+    for (; i < ny; i++) {
+        dis[i] = ElementOp::one(x, y + i * d, d);
+    }
+}
+
+// index of the first smallest value, 0 if there is none below HUGE_VALF like fvec_L2sqr_ny_nearest_ref
+size_t
+argmin_avx(const float* v, size_t n) {
+    __m256 min = _mm256_set1_ps(HUGE_VALF);
+    __m256i min_idx = _mm256_setzero_si256();
+    __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 mv = _mm256_loadu_ps(v + i);
+        const __m256 lt = _mm256_cmp_ps(mv, min, _CMP_LT_OQ);
+        min = _mm256_blendv_ps(min, mv, lt);
+        min_idx = _mm256_blendv_epi8(min_idx, idx, _mm256_castps_si256(lt));
+        idx = _mm256_add_epi32(idx, _mm256_set1_epi32(8));
+    }
+    ALIGNED(32) float mins[8];
+    ALIGNED(32) int32_t idxs[8];
+    _mm256_store_ps(mins, min);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(idxs), min_idx);
+    float min_dis = HUGE_VALF;
+    size_t nearest_idx = 0;
+    for (size_t r = 0; r < 8; r++) {
+        if (mins[r] < min_dis || (mins[r] == min_dis && static_cast<size_t>(idxs[r]) < nearest_idx)) {
+            min_dis = mins[r];
+            nearest_idx = idxs[r];
+        }
+    }
+    for (; i < n; i++) {
+        if (v[i] < min_dis) {
+            min_dis = v[i];
+            nearest_idx = i;
+        }
+    }
+    return nearest_idx;
+}
+
+}  // namespace
+
+void
+fvec_L2sqr_ny_avx(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    fvec_op_ny<ElementOpL2>(dis, x, y, d, ny);
+}
+
+void
+fvec_inner_products_ny_avx(float* ip, const float* x, const float* y, size_t d, size_t ny) {
+    fvec_op_ny<ElementOpIP>(ip, x, y, d, ny);
+}
+
+void
+fvec_L2sqr_ny_transposed_avx(float* dis, const float* x, const float* y, const float* y_sqlen, size_t d,
+                             size_t d_offset, size_t ny) {
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+    const __m256 mx_sqlen = _mm256_set1_ps(x_sqlen);
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    // the vectors of y are the columns, so 8 of them are contiguous in each row
+    size_t i = 0;
+    for (; i + 16 <= ny; i += 16) {
+        __m256 dp0 = _mm256_setzero_ps();
+        __m256 dp1 = _mm256_setzero_ps();
+        for (size_t j = 0; j < d; j++) {
+            const __m256 xj = _mm256_set1_ps(x[j]);
+            dp0 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(y + j * d_offset + i), dp0);
+            dp1 = _mm256_fmadd_ps(xj, _mm256_loadu_ps(y + j * d_offset + i + 8), dp1);
+        }
+        const __m256 s0 = _mm256_add_ps(mx_sqlen, _mm256_loadu_ps(y_sqlen + i));
+        const __m256 s1 = _mm256_add_ps(mx_sqlen, _mm256_loadu_ps(y_sqlen + i + 8));
+        _mm256_storeu_ps(dis + i, _mm256_fnmadd_ps(two, dp0, s0));
+        _mm256_storeu_ps(dis + i + 8, _mm256_fnmadd_ps(two, dp1, s1));
+    }
+    for (; i < ny; i += 8) {
+        const __m256i mask = head_mask(std::min<size_t>(ny - i, 8));
+        __m256 dp = _mm256_setzero_ps();
+        for (size_t j = 0; j < d; j++) {
+            dp = _mm256_fmadd_ps(_mm256_set1_ps(x[j]), _mm256_maskload_ps(y + j * d_offset + i, mask), dp);
+        }
+        const __m256 s = _mm256_add_ps(mx_sqlen, _mm256_maskload_ps(y_sqlen + i, mask));
+        _mm256_maskstore_ps(dis + i, mask, _mm256_fnmadd_ps(two, dp, s));
+    }
+}
+
+size_t
+fvec_L2sqr_ny_nearest_avx(float* distances_tmp_buffer, const float* x, const float* y, size_t d, size_t ny) {
+    fvec_L2sqr_ny_avx(distances_tmp_buffer, x, y, d, ny);
+    return argmin_avx(distances_tmp_buffer, ny);
+}
+
+size_t
+fvec_L2sqr_ny_nearest_y_transposed_avx(float* distances_tmp_buffer, const float* x, const float* y,
+                                       const float* y_sqlen, size_t d, size_t d_offset, size_t ny) {
+    fvec_L2sqr_ny_transposed_avx(distances_tmp_buffer, x, y, y_sqlen, d, d_offset, ny);
+    return argmin_avx(distances_tmp_buffer, ny);
+}
+
+static inline int32_t
+reduce_add_epi32(__m256i v) {
+    __m128i r = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+// sign extends 16 int8 to int16 and multiplies pairs with madd, the int32 lanes hold 2 products each
 int32_t
 ivec_inner_product_avx(const int8_t* x, const int8_t* y, size_t d) {
-    size_t i;
-    int32_t res = 0;
-    for (i = 0; i < d; i++) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= d; i += 32) {
+        const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i)));
+        const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+        const __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i + 16)));
+        const __m256i y1 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i + 16)));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(x1, y1));
+    }
+    if (i + 16 <= d) {
+        const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i)));
+        const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(x0, y0));
+        i += 16;
+    }
+    int32_t res = reduce_add_epi32(_mm256_add_epi32(acc0, acc1));
+    for (; i < d; i++) {
         res += (int32_t)x[i] * y[i];
     }
     return res;
 }
 
-// trust the compiler to unroll this properly
 int32_t
 ivec_L2sqr_avx(const int8_t* x, const int8_t* y, size_t d) {
-    size_t i;
-    int32_t res = 0;
-    for (i = 0; i < d; i++) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= d; i += 32) {
+        const __m256i d0 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i))));
+        const __m256i d1 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i + 16))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i + 16))));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(d0, d0));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(d1, d1));
+    }
+    if (i + 16 <= d) {
+        const __m256i d0 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i))));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(d0, d0));
+        i += 16;
+    }
+    int32_t res = reduce_add_epi32(_mm256_add_epi32(acc0, acc1));
+    for (; i < d; i++) {
         const int32_t tmp = (int32_t)x[i] - (int32_t)y[i];
         res += tmp * tmp;
     }
     return res;
 }
 
+// counts the bits of each nibble with a shuffle lookup
+static inline __m256i
+popcount_epi8(__m256i v) {
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2,
+                                         3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+}
+
+// adds the bit count of v to the 64-bit lanes of acc, sad sums the byte counts
+static inline __m256i
+add_popcount(__m256i acc, __m256i v) {
+    return _mm256_add_epi64(acc, _mm256_sad_epu8(popcount_epi8(v), _mm256_setzero_si256()));
+}
+
+static inline int64_t
+reduce_add_epi64(__m256i v) {
+    const __m128i r = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return _mm_cvtsi128_si64(r) + _mm_extract_epi64(r, 1);
+}
+
+static inline __m256i
+load_si256(const uint8_t* p) {
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+static inline uint64_t
+load_u64(const uint8_t* p) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// the bytes from i on, fewer than 32, a word at a time
+static inline int
+xor_popcount_tail(const uint8_t* x, const uint8_t* y, size_t i, size_t nbytes) {
+    int res = 0;
+    for (; i + 8 <= nbytes; i += 8) {
+        res += _mm_popcnt_u64(load_u64(x + i) ^ load_u64(y + i));
+    }
+    for (; i < nbytes; i++) {
+        res += _mm_popcnt_u32(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+static inline void
+and_or_popcount_tail(const uint8_t* x, const uint8_t* y, size_t i, size_t nbytes, int& and_count, int& or_count) {
+    for (; i + 8 <= nbytes; i += 8) {
+        const uint64_t xw = load_u64(x + i), yw = load_u64(y + i);
+        and_count += _mm_popcnt_u64(xw & yw);
+        or_count += _mm_popcnt_u64(xw | yw);
+    }
+    for (; i < nbytes; i++) {
+        and_count += _mm_popcnt_u32(x[i] & y[i]);
+        or_count += _mm_popcnt_u32(x[i] | y[i]);
+    }
+}
+
+size_t
+bitset_popcount_avx(const uint8_t* data, size_t nbytes) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        acc = add_popcount(acc, load_si256(data + i));
+    }
+    size_t res = reduce_add_epi64(acc);
+    for (; i < nbytes; i++) {
+        res += __builtin_popcount(data[i]);
+    }
+    return res;
+}
+
+int
+bvec_xor_popcount_avx(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        acc = add_popcount(acc, _mm256_xor_si256(load_si256(x + i), load_si256(y + i)));
+    }
+    return reduce_add_epi64(acc) + xor_popcount_tail(x, y, i, nbytes);
+}
+
+void
+bvec_and_or_popcount_avx(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count) {
+    __m256i and_acc = _mm256_setzero_si256();
+    __m256i or_acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i xv = load_si256(x + i);
+        const __m256i yv = load_si256(y + i);
+        and_acc = add_popcount(and_acc, _mm256_and_si256(xv, yv));
+        or_acc = add_popcount(or_acc, _mm256_or_si256(xv, yv));
+    }
+    and_count = reduce_add_epi64(and_acc);
+    or_count = reduce_add_epi64(or_acc);
+    and_or_popcount_tail(x, y, i, nbytes, and_count, or_count);
+}
+
+bool
+bvec_is_subset_avx(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        // testc is set when x has no bit outside of y
+        if (!_mm256_testc_si256(load_si256(y + i), load_si256(x + i))) {
+            return false;
+        }
+    }
+    for (; i < nbytes; i++) {
+        if (x[i] & ~y[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+bvec_xor_popcount_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i acc2 = _mm256_setzero_si256();
+    __m256i acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i xv = load_si256(x + i);
+        acc0 = add_popcount(acc0, _mm256_xor_si256(xv, load_si256(y0 + i)));
+        acc1 = add_popcount(acc1, _mm256_xor_si256(xv, load_si256(y1 + i)));
+        acc2 = add_popcount(acc2, _mm256_xor_si256(xv, load_si256(y2 + i)));
+        acc3 = add_popcount(acc3, _mm256_xor_si256(xv, load_si256(y3 + i)));
+    }
+    count0 = reduce_add_epi64(acc0) + xor_popcount_tail(x, y0, i, nbytes);
+    count1 = reduce_add_epi64(acc1) + xor_popcount_tail(x, y1, i, nbytes);
+    count2 = reduce_add_epi64(acc2) + xor_popcount_tail(x, y2, i, nbytes);
+    count3 = reduce_add_epi64(acc3) + xor_popcount_tail(x, y3, i, nbytes);
+}
+
+void
+bvec_and_or_popcount_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts) {
+    __m256i and_acc0 = _mm256_setzero_si256(), or_acc0 = _mm256_setzero_si256();
+    __m256i and_acc1 = _mm256_setzero_si256(), or_acc1 = _mm256_setzero_si256();
+    __m256i and_acc2 = _mm256_setzero_si256(), or_acc2 = _mm256_setzero_si256();
+    __m256i and_acc3 = _mm256_setzero_si256(), or_acc3 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i xv = load_si256(x + i);
+        const __m256i v0 = load_si256(y0 + i);
+        const __m256i v1 = load_si256(y1 + i);
+        const __m256i v2 = load_si256(y2 + i);
+        const __m256i v3 = load_si256(y3 + i);
+        and_acc0 = add_popcount(and_acc0, _mm256_and_si256(xv, v0));
+        or_acc0 = add_popcount(or_acc0, _mm256_or_si256(xv, v0));
+        and_acc1 = add_popcount(and_acc1, _mm256_and_si256(xv, v1));
+        or_acc1 = add_popcount(or_acc1, _mm256_or_si256(xv, v1));
+        and_acc2 = add_popcount(and_acc2, _mm256_and_si256(xv, v2));
+        or_acc2 = add_popcount(or_acc2, _mm256_or_si256(xv, v2));
+        and_acc3 = add_popcount(and_acc3, _mm256_and_si256(xv, v3));
+        or_acc3 = add_popcount(or_acc3, _mm256_or_si256(xv, v3));
+    }
+    and_counts[0] = reduce_add_epi64(and_acc0);
+    or_counts[0] = reduce_add_epi64(or_acc0);
+    and_counts[1] = reduce_add_epi64(and_acc1);
+    or_counts[1] = reduce_add_epi64(or_acc1);
+    and_counts[2] = reduce_add_epi64(and_acc2);
+    or_counts[2] = reduce_add_epi64(or_acc2);
+    and_counts[3] = reduce_add_epi64(and_acc3);
+    or_counts[3] = reduce_add_epi64(or_acc3);
+    const uint8_t* ys[4] = {y0, y1, y2, y3};
+    for (int j = 0; j < 4; j++) {
+        and_or_popcount_tail(x, ys[j], i, nbytes, and_counts[j], or_counts[j]);
+    }
+}
+
+// fp16 is widened with f16c, bf16 by shifting its bits into the high half of a fp32
+template <typename T>
+static inline __m256
+load8_half(const T* x) {
+    const __m128i bits = _mm_loadu_si128((const __m128i*)x);
+    if constexpr (std::is_same_v<T, knowhere::fp16>) {
+        return _mm256_cvtph_ps(bits);
+    } else {
+        return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(bits), 16));
+    }
+}
+
+// reads 0 < d < 8 halves, the rest of the lanes are 0
+template <typename T>
+static inline __m256
+masked_read_half(size_t d, const T* x) {
+    ALIGNED(16) uint16_t buf[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    std::memcpy(buf, x, d * sizeof(uint16_t));
+    return load8_half((const T*)buf);
+}
+
+static inline float
+reduce_add_ps(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+template <typename T>
+static inline float
+half_inner_product_avx(const T* x, const T* y, size_t d) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        acc0 = _mm256_fmadd_ps(load8_half(x + i), load8_half(y + i), acc0);
+        acc1 = _mm256_fmadd_ps(load8_half(x + i + 8), load8_half(y + i + 8), acc1);
+    }
+    if (i + 8 <= d) {
+        acc0 = _mm256_fmadd_ps(load8_half(x + i), load8_half(y + i), acc0);
+        i += 8;
+    }
+    if (i < d) {
+        acc1 = _mm256_fmadd_ps(masked_read_half(d - i, x + i), masked_read_half(d - i, y + i), acc1);
+    }
+    return reduce_add_ps(_mm256_add_ps(acc0, acc1));
+}
+
+template <typename T>
+static inline float
+half_L2sqr_avx(const T* x, const T* y, size_t d) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        const __m256 diff0 = _mm256_sub_ps(load8_half(x + i), load8_half(y + i));
+        const __m256 diff1 = _mm256_sub_ps(load8_half(x + i + 8), load8_half(y + i + 8));
+        acc0 = _mm256_fmadd_ps(diff0, diff0, acc0);
+        acc1 = _mm256_fmadd_ps(diff1, diff1, acc1);
+    }
+    if (i + 8 <= d) {
+        const __m256 diff = _mm256_sub_ps(load8_half(x + i), load8_half(y + i));
+        acc0 = _mm256_fmadd_ps(diff, diff, acc0);
+        i += 8;
+    }
+    if (i < d) {
+        const __m256 diff = _mm256_sub_ps(masked_read_half(d - i, x + i), masked_read_half(d - i, y + i));
+        acc1 = _mm256_fmadd_ps(diff, diff, acc1);
+    }
+    return reduce_add_ps(_mm256_add_ps(acc0, acc1));
+}
+
+template <typename T>
+static inline float
+half_norm_L2sqr_avx(const T* x, size_t d) {
+    __m256 acc = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        const __m256 v = load8_half(x + i);
+        acc = _mm256_fmadd_ps(v, v, acc);
+    }
+    if (i < d) {
+        const __m256 v = masked_read_half(d - i, x + i);
+        acc = _mm256_fmadd_ps(v, v, acc);
+    }
+    return reduce_add_ps(acc);
+}
+
+float
+fp16_vec_inner_product_avx(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_inner_product_avx(x, y, d);
+}
+
+float
+fp16_vec_L2sqr_avx(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_L2sqr_avx(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx(const knowhere::fp16* x, size_t d) {
+    return half_norm_L2sqr_avx(x, d);
+}
+
+float
+bf16_vec_inner_product_avx(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_inner_product_avx(x, y, d);
+}
+
+float
+bf16_vec_L2sqr_avx(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_L2sqr_avx(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx(const knowhere::bf16* x, size_t d) {
+    return half_norm_L2sqr_avx(x, d);
+}
+
 }  // namespace faiss
 #endif
@@ -15,6 +15,11 @@
 #include <cstddef>
 #include <cstdint>
 
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// Squared L2 distance between two vectors
@@ -58,12 +63,69 @@ void
 fvec_L2sqr_batch_4_avx_bf16_patch(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
                                   const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
 
+/// compute ny square L2 distance between x and a set of contiguous y vectors
+void
+fvec_L2sqr_ny_avx(float* dis, const float* x, const float* y, size_t d, size_t ny);
+
+/// compute the inner product between x and a set of contiguous y vectors
+void
+fvec_inner_products_ny_avx(float* ip, const float* x, const float* y, size_t d, size_t ny);
+
+void
+fvec_L2sqr_ny_transposed_avx(float* dis, const float* x, const float* y, const float* y_sqlen, size_t d,
+                             size_t d_offset, size_t ny);
+
+size_t
+fvec_L2sqr_ny_nearest_avx(float* distances_tmp_buffer, const float* x, const float* y, size_t d, size_t ny);
+
+size_t
+fvec_L2sqr_ny_nearest_y_transposed_avx(float* distances_tmp_buffer, const float* x, const float* y,
+                                       const float* y_sqlen, size_t d, size_t d_offset, size_t ny);
+
 int32_t
 ivec_inner_product_avx(const int8_t* x, const int8_t* y, size_t d);
 
 int32_t
 ivec_L2sqr_avx(const int8_t* x, const int8_t* y, size_t d);
 
+size_t
+bitset_popcount_avx(const uint8_t* data, size_t nbytes);
+
+int
+bvec_xor_popcount_avx(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_and_or_popcount_avx(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count);
+
+bool
+bvec_is_subset_avx(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_xor_popcount_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3);
+
+void
+bvec_and_or_popcount_batch_4_avx(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts);
+
+float
+fp16_vec_inner_product_avx(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_L2sqr_avx(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_avx(const knowhere::fp16* x, size_t d);
+
+float
+bf16_vec_inner_product_avx(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_L2sqr_avx(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_avx(const knowhere::bf16* x, size_t d);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_AVX_H */
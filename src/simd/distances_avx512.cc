@@ -15,8 +15,10 @@
 #include <immintrin.h>
 
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <string>
+#include <type_traits>
 
 #include "faiss/impl/platform_macros.h"
 #include "knowhere/operands.h"
@@ -324,27 +326,528 @@ fvec_L2sqr_batch_4_avx512_bf16_patch(const float* x, const float* y0, const floa
 }
 FAISS_PRAGMA_IMPRECISE_FUNCTION_END
 
-// trust the compiler to unroll this properly
+// the dim is a multiple of 64, so the loops have no tail, and 4 accumulators hide the latency of the fma. the
+// compiler knows the trip count and unrolls further.
+template <size_t D>
+float
+fvec_inner_product_avx512_dim(const float* x, const float* y, size_t) {
+    static_assert(D % 64 == 0, "the dim of a specialized kernel is a multiple of 64");
+    __m512 m0 = _mm512_setzero_ps();
+    __m512 m1 = _mm512_setzero_ps();
+    __m512 m2 = _mm512_setzero_ps();
+    __m512 m3 = _mm512_setzero_ps();
+#pragma GCC unroll 8
+    for (size_t i = 0; i < D; i += 64) {
+        m0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), m0);
+        m1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), m1);
+        m2 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32), m2);
+        m3 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48), m3);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(m0, m1), _mm512_add_ps(m2, m3)));
+}
+
+template <size_t D>
+float
+fvec_L2sqr_avx512_dim(const float* x, const float* y, size_t) {
+    static_assert(D % 64 == 0, "the dim of a specialized kernel is a multiple of 64");
+    __m512 m0 = _mm512_setzero_ps();
+    __m512 m1 = _mm512_setzero_ps();
+    __m512 m2 = _mm512_setzero_ps();
+    __m512 m3 = _mm512_setzero_ps();
+#pragma GCC unroll 8
+    for (size_t i = 0; i < D; i += 64) {
+        const __m512 q0 = _mm512_sub_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i));
+        const __m512 q1 = _mm512_sub_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16));
+        const __m512 q2 = _mm512_sub_ps(_mm512_loadu_ps(x + i + 32), _mm512_loadu_ps(y + i + 32));
+        const __m512 q3 = _mm512_sub_ps(_mm512_loadu_ps(x + i + 48), _mm512_loadu_ps(y + i + 48));
+        m0 = _mm512_fmadd_ps(q0, q0, m0);
+        m1 = _mm512_fmadd_ps(q1, q1, m1);
+        m2 = _mm512_fmadd_ps(q2, q2, m2);
+        m3 = _mm512_fmadd_ps(q3, q3, m3);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(_mm512_add_ps(m0, m1), _mm512_add_ps(m2, m3)));
+}
+
+// x is read once for the 4 vectors, one accumulator per vector
+template <size_t D>
+void
+fvec_inner_product_batch_4_avx512_dim(const float* x, const float* y0, const float* y1, const float* y2,
+                                      const float* y3, const size_t, float& dis0, float& dis1, float& dis2,
+                                      float& dis3) {
+    static_assert(D % 64 == 0, "the dim of a specialized kernel is a multiple of 64");
+    __m512 m0 = _mm512_setzero_ps();
+    __m512 m1 = _mm512_setzero_ps();
+    __m512 m2 = _mm512_setzero_ps();
+    __m512 m3 = _mm512_setzero_ps();
+#pragma GCC unroll 8
+    for (size_t i = 0; i < D; i += 16) {
+        const __m512 mx = _mm512_loadu_ps(x + i);
+        m0 = _mm512_fmadd_ps(mx, _mm512_loadu_ps(y0 + i), m0);
+        m1 = _mm512_fmadd_ps(mx, _mm512_loadu_ps(y1 + i), m1);
+        m2 = _mm512_fmadd_ps(mx, _mm512_loadu_ps(y2 + i), m2);
+        m3 = _mm512_fmadd_ps(mx, _mm512_loadu_ps(y3 + i), m3);
+    }
+    dis0 = _mm512_reduce_add_ps(m0);
+    dis1 = _mm512_reduce_add_ps(m1);
+    dis2 = _mm512_reduce_add_ps(m2);
+    dis3 = _mm512_reduce_add_ps(m3);
+}
+
+template <size_t D>
+void
+fvec_L2sqr_batch_4_avx512_dim(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                              const size_t, float& dis0, float& dis1, float& dis2, float& dis3) {
+    static_assert(D % 64 == 0, "the dim of a specialized kernel is a multiple of 64");
+    __m512 m0 = _mm512_setzero_ps();
+    __m512 m1 = _mm512_setzero_ps();
+    __m512 m2 = _mm512_setzero_ps();
+    __m512 m3 = _mm512_setzero_ps();
+#pragma GCC unroll 8
+    for (size_t i = 0; i < D; i += 16) {
+        const __m512 mx = _mm512_loadu_ps(x + i);
+        const __m512 q0 = _mm512_sub_ps(mx, _mm512_loadu_ps(y0 + i));
+        const __m512 q1 = _mm512_sub_ps(mx, _mm512_loadu_ps(y1 + i));
+        const __m512 q2 = _mm512_sub_ps(mx, _mm512_loadu_ps(y2 + i));
+        const __m512 q3 = _mm512_sub_ps(mx, _mm512_loadu_ps(y3 + i));
+        m0 = _mm512_fmadd_ps(q0, q0, m0);
+        m1 = _mm512_fmadd_ps(q1, q1, m1);
+        m2 = _mm512_fmadd_ps(q2, q2, m2);
+        m3 = _mm512_fmadd_ps(q3, q3, m3);
+    }
+    dis0 = _mm512_reduce_add_ps(m0);
+    dis1 = _mm512_reduce_add_ps(m1);
+    dis2 = _mm512_reduce_add_ps(m2);
+    dis3 = _mm512_reduce_add_ps(m3);
+}
+
+#define INSTANTIATE_FVEC_AVX512_DIM(D)                                                                               \
+    template float fvec_inner_product_avx512_dim<D>(const float*, const float*, size_t);                             \
+    template float fvec_L2sqr_avx512_dim<D>(const float*, const float*, size_t);                                     \
+    template void fvec_inner_product_batch_4_avx512_dim<D>(const float*, const float*, const float*, const float*,   \
+                                                           const float*, const size_t, float&, float&, float&,       \
+                                                           float&);                                                  \
+    template void fvec_L2sqr_batch_4_avx512_dim<D>(const float*, const float*, const float*, const float*,           \
+                                                   const float*, const size_t, float&, float&, float&, float&);
+
+INSTANTIATE_FVEC_AVX512_DIM(128)
+INSTANTIATE_FVEC_AVX512_DIM(384)
+INSTANTIATE_FVEC_AVX512_DIM(512)
+INSTANTIATE_FVEC_AVX512_DIM(768)
+INSTANTIATE_FVEC_AVX512_DIM(1024)
+INSTANTIATE_FVEC_AVX512_DIM(1536)
+
+#undef INSTANTIATE_FVEC_AVX512_DIM
+
+namespace {
+
+// index of the first smallest value, 0 if there is none below HUGE_VALF like fvec_L2sqr_ny_nearest_ref
+size_t
+argmin_avx512(const float* v, size_t n) {
+    __m512 min = _mm512_set1_ps(HUGE_VALF);
+    __m512i min_idx = _mm512_setzero_si512();
+    __m512i idx = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512 mv = _mm512_loadu_ps(v + i);
+        const __mmask16 lt = _mm512_cmp_ps_mask(mv, min, _CMP_LT_OQ);
+        min = _mm512_mask_blend_ps(lt, min, mv);
+        min_idx = _mm512_mask_blend_epi32(lt, min_idx, idx);
+        idx = _mm512_add_epi32(idx, _mm512_set1_epi32(16));
+    }
+    __attribute__((__aligned__(64))) float mins[16];
+    __attribute__((__aligned__(64))) int32_t idxs[16];
+    _mm512_store_ps(mins, min);
+    _mm512_store_si512(idxs, min_idx);
+    float min_dis = HUGE_VALF;
+    size_t nearest_idx = 0;
+    for (size_t r = 0; r < 16; r++) {
+        if (mins[r] < min_dis || (mins[r] == min_dis && static_cast<size_t>(idxs[r]) < nearest_idx)) {
+            min_dis = mins[r];
+            nearest_idx = idxs[r];
+        }
+    }
+    for (; i < n; i++) {
+        if (v[i] < min_dis) {
+            min_dis = v[i];
+            nearest_idx = i;
+        }
+    }
+    return nearest_idx;
+}
+
+}  // namespace
+
+void
+fvec_L2sqr_ny_transposed_avx512(float* dis, const float* x, const float* y, const float* y_sqlen, size_t d,
+                                size_t d_offset, size_t ny) {
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+    const __m512 mx_sqlen = _mm512_set1_ps(x_sqlen);
+    const __m512 two = _mm512_set1_ps(2.0f);
+
+    // the vectors of y are the columns, so 16 of them are contiguous in each row
+    size_t i = 0;
+    for (; i + 32 <= ny; i += 32) {
+        __m512 dp0 = _mm512_setzero_ps();
+        __m512 dp1 = _mm512_setzero_ps();
+        for (size_t j = 0; j < d; j++) {
+            const __m512 xj = _mm512_set1_ps(x[j]);
+            dp0 = _mm512_fmadd_ps(xj, _mm512_loadu_ps(y + j * d_offset + i), dp0);
+            dp1 = _mm512_fmadd_ps(xj, _mm512_loadu_ps(y + j * d_offset + i + 16), dp1);
+        }
+        const __m512 s0 = _mm512_add_ps(mx_sqlen, _mm512_loadu_ps(y_sqlen + i));
+        const __m512 s1 = _mm512_add_ps(mx_sqlen, _mm512_loadu_ps(y_sqlen + i + 16));
+        _mm512_storeu_ps(dis + i, _mm512_fnmadd_ps(two, dp0, s0));
+        _mm512_storeu_ps(dis + i + 16, _mm512_fnmadd_ps(two, dp1, s1));
+    }
+    for (; i < ny; i += 16) {
+        const __mmask16 mask = ny - i >= 16 ? 0xffff : (1U << (ny - i)) - 1;
+        __m512 dp = _mm512_setzero_ps();
+        for (size_t j = 0; j < d; j++) {
+            dp = _mm512_fmadd_ps(_mm512_set1_ps(x[j]), _mm512_maskz_loadu_ps(mask, y + j * d_offset + i), dp);
+        }
+        const __m512 s = _mm512_add_ps(mx_sqlen, _mm512_maskz_loadu_ps(mask, y_sqlen + i));
+        _mm512_mask_storeu_ps(dis + i, mask, _mm512_fnmadd_ps(two, dp, s));
+    }
+}
+
+size_t
+fvec_L2sqr_ny_nearest_y_transposed_avx512(float* distances_tmp_buffer, const float* x, const float* y,
+                                          const float* y_sqlen, size_t d, size_t d_offset, size_t ny) {
+    fvec_L2sqr_ny_transposed_avx512(distances_tmp_buffer, x, y, y_sqlen, d, d_offset, ny);
+    return argmin_avx512(distances_tmp_buffer, ny);
+}
+
+// sign extends 32 int8 to int16 and multiplies pairs with madd, the int32 lanes hold 2 products each
 int32_t
 ivec_inner_product_avx512(const int8_t* x, const int8_t* y, size_t d) {
-    size_t i;
-    int32_t res = 0;
-    for (i = 0; i < d; i++) {
-        res += (int32_t)x[i] * y[i];
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= d; i += 64) {
+        const __m512i x0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(x + i)));
+        const __m512i y0 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(y + i)));
+        const __m512i x1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(x + i + 32)));
+        const __m512i y1 = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(y + i + 32)));
+        acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(x0, y0));
+        acc1 = _mm512_add_epi32(acc1, _mm512_madd_epi16(x1, y1));
     }
-    return res;
+    if (i < d) {
+        const __mmask64 mask = (1ULL << (d - i)) - 1;
+        const __m512i xt = _mm512_maskz_loadu_epi8(mask, x + i);
+        const __m512i yt = _mm512_maskz_loadu_epi8(mask, y + i);
+        acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(_mm512_cvtepi8_epi16(_mm512_castsi512_si256(xt)),
+                                                        _mm512_cvtepi8_epi16(_mm512_castsi512_si256(yt))));
+        acc1 = _mm512_add_epi32(acc1, _mm512_madd_epi16(_mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(xt, 1)),
+                                                        _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(yt, 1))));
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(acc0, acc1));
 }
 
-// trust the compiler to unroll this properly
 int32_t
 ivec_L2sqr_avx512(const int8_t* x, const int8_t* y, size_t d) {
-    size_t i;
-    int32_t res = 0;
-    for (i = 0; i < d; i++) {
-        const int32_t tmp = (int32_t)x[i] - (int32_t)y[i];
-        res += tmp * tmp;
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= d; i += 64) {
+        const __m512i d0 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(x + i))),
+                                            _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(y + i))));
+        const __m512i d1 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(x + i + 32))),
+                                            _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i*)(y + i + 32))));
+        acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(d0, d0));
+        acc1 = _mm512_add_epi32(acc1, _mm512_madd_epi16(d1, d1));
     }
-    return res;
+    if (i < d) {
+        const __mmask64 mask = (1ULL << (d - i)) - 1;
+        const __m512i xt = _mm512_maskz_loadu_epi8(mask, x + i);
+        const __m512i yt = _mm512_maskz_loadu_epi8(mask, y + i);
+        const __m512i d0 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm512_castsi512_si256(xt)),
+                                            _mm512_cvtepi8_epi16(_mm512_castsi512_si256(yt)));
+        const __m512i d1 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(xt, 1)),
+                                            _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(yt, 1)));
+        acc0 = _mm512_add_epi32(acc0, _mm512_madd_epi16(d0, d0));
+        acc1 = _mm512_add_epi32(acc1, _mm512_madd_epi16(d1, d1));
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(acc0, acc1));
+}
+
+// same nibble lookup as the avx2 version, cpus with VPOPCNTDQ use the kernels of distances_avx512_vpopcntdq.cc
+static inline __m512i
+popcount_epi8(__m512i v) {
+    const __m512i lut = _mm512_set4_epi32(0x04030302, 0x03020201, 0x03020201, 0x02010100);
+    const __m512i low_mask = _mm512_set1_epi8(0x0f);
+    const __m512i lo = _mm512_and_si512(v, low_mask);
+    const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), low_mask);
+    return _mm512_add_epi8(_mm512_shuffle_epi8(lut, lo), _mm512_shuffle_epi8(lut, hi));
+}
+
+// adds the bit count of v to the 64-bit lanes of acc, sad sums the byte counts
+static inline __m512i
+add_popcount(__m512i acc, __m512i v) {
+    return _mm512_add_epi64(acc, _mm512_sad_epu8(popcount_epi8(v), _mm512_setzero_si512()));
+}
+
+// the bytes past the end of the vectors read as 0, which count no bit in any of the kernels below
+static inline __mmask64
+tail_mask(size_t n) {
+    return (1ULL << n) - 1;
+}
+
+size_t
+bitset_popcount_avx512(const uint8_t* data, size_t nbytes) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        acc = add_popcount(acc, _mm512_loadu_si512((const void*)(data + i)));
+    }
+    if (i < nbytes) {
+        acc = add_popcount(acc, _mm512_maskz_loadu_epi8(tail_mask(nbytes - i), data + i));
+    }
+    return _mm512_reduce_add_epi64(acc);
+}
+
+int
+bvec_xor_popcount_avx512(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        acc = add_popcount(acc, _mm512_xor_si512(_mm512_loadu_si512((const void*)(x + i)),
+                                                 _mm512_loadu_si512((const void*)(y + i))));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        acc = add_popcount(acc, _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, x + i),
+                                                 _mm512_maskz_loadu_epi8(mask, y + i)));
+    }
+    return _mm512_reduce_add_epi64(acc);
+}
+
+void
+bvec_and_or_popcount_avx512(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count) {
+    __m512i and_acc = _mm512_setzero_si512();
+    __m512i or_acc = _mm512_setzero_si512();
+    auto accumulate = [&](__m512i xv, __m512i yv) {
+        and_acc = add_popcount(and_acc, _mm512_and_si512(xv, yv));
+        or_acc = add_popcount(or_acc, _mm512_or_si512(xv, yv));
+    };
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        accumulate(_mm512_loadu_si512((const void*)(x + i)), _mm512_loadu_si512((const void*)(y + i)));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        accumulate(_mm512_maskz_loadu_epi8(mask, x + i), _mm512_maskz_loadu_epi8(mask, y + i));
+    }
+    and_count = _mm512_reduce_add_epi64(and_acc);
+    or_count = _mm512_reduce_add_epi64(or_acc);
+}
+
+bool
+bvec_is_subset_avx512(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        // the bits of x outside of y
+        const __m512i v = _mm512_andnot_si512(_mm512_loadu_si512((const void*)(y + i)),
+                                              _mm512_loadu_si512((const void*)(x + i)));
+        if (_mm512_test_epi64_mask(v, v)) {
+            return false;
+        }
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        const __m512i v =
+            _mm512_andnot_si512(_mm512_maskz_loadu_epi8(mask, y + i), _mm512_maskz_loadu_epi8(mask, x + i));
+        if (_mm512_test_epi64_mask(v, v)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+bvec_xor_popcount_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2,
+                                 int& count3) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    __m512i acc2 = _mm512_setzero_si512();
+    __m512i acc3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        const __m512i xv = _mm512_loadu_si512((const void*)(x + i));
+        acc0 = add_popcount(acc0, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y0 + i))));
+        acc1 = add_popcount(acc1, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y1 + i))));
+        acc2 = add_popcount(acc2, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y2 + i))));
+        acc3 = add_popcount(acc3, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y3 + i))));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        const __m512i xv = _mm512_maskz_loadu_epi8(mask, x + i);
+        acc0 = add_popcount(acc0, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y0 + i)));
+        acc1 = add_popcount(acc1, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y1 + i)));
+        acc2 = add_popcount(acc2, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y2 + i)));
+        acc3 = add_popcount(acc3, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y3 + i)));
+    }
+    count0 = _mm512_reduce_add_epi64(acc0);
+    count1 = _mm512_reduce_add_epi64(acc1);
+    count2 = _mm512_reduce_add_epi64(acc2);
+    count3 = _mm512_reduce_add_epi64(acc3);
+}
+
+void
+bvec_and_or_popcount_batch_4_avx512(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                    const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts) {
+    __m512i and_acc0 = _mm512_setzero_si512(), or_acc0 = _mm512_setzero_si512();
+    __m512i and_acc1 = _mm512_setzero_si512(), or_acc1 = _mm512_setzero_si512();
+    __m512i and_acc2 = _mm512_setzero_si512(), or_acc2 = _mm512_setzero_si512();
+    __m512i and_acc3 = _mm512_setzero_si512(), or_acc3 = _mm512_setzero_si512();
+    auto accumulate = [&](__m512i xv, __m512i v0, __m512i v1, __m512i v2, __m512i v3) {
+        and_acc0 = add_popcount(and_acc0, _mm512_and_si512(xv, v0));
+        or_acc0 = add_popcount(or_acc0, _mm512_or_si512(xv, v0));
+        and_acc1 = add_popcount(and_acc1, _mm512_and_si512(xv, v1));
+        or_acc1 = add_popcount(or_acc1, _mm512_or_si512(xv, v1));
+        and_acc2 = add_popcount(and_acc2, _mm512_and_si512(xv, v2));
+        or_acc2 = add_popcount(or_acc2, _mm512_or_si512(xv, v2));
+        and_acc3 = add_popcount(and_acc3, _mm512_and_si512(xv, v3));
+        or_acc3 = add_popcount(or_acc3, _mm512_or_si512(xv, v3));
+    };
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        accumulate(_mm512_loadu_si512((const void*)(x + i)), _mm512_loadu_si512((const void*)(y0 + i)),
+                   _mm512_loadu_si512((const void*)(y1 + i)), _mm512_loadu_si512((const void*)(y2 + i)),
+                   _mm512_loadu_si512((const void*)(y3 + i)));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        accumulate(_mm512_maskz_loadu_epi8(mask, x + i), _mm512_maskz_loadu_epi8(mask, y0 + i),
+                   _mm512_maskz_loadu_epi8(mask, y1 + i), _mm512_maskz_loadu_epi8(mask, y2 + i),
+                   _mm512_maskz_loadu_epi8(mask, y3 + i));
+    }
+    and_counts[0] = _mm512_reduce_add_epi64(and_acc0);
+    or_counts[0] = _mm512_reduce_add_epi64(or_acc0);
+    and_counts[1] = _mm512_reduce_add_epi64(and_acc1);
+    or_counts[1] = _mm512_reduce_add_epi64(or_acc1);
+    and_counts[2] = _mm512_reduce_add_epi64(and_acc2);
+    or_counts[2] = _mm512_reduce_add_epi64(or_acc2);
+    and_counts[3] = _mm512_reduce_add_epi64(and_acc3);
+    or_counts[3] = _mm512_reduce_add_epi64(or_acc3);
+}
+
+// fp16 is widened with vcvtph2ps, bf16 by shifting its bits into the high half of a fp32
+template <typename T>
+static inline __m512
+widen16_half(__m256i bits) {
+    if constexpr (std::is_same_v<T, knowhere::fp16>) {
+        return _mm512_cvtph_ps(bits);
+    } else {
+        return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(bits), 16));
+    }
+}
+
+template <typename T>
+static inline __m512
+load16_half(const T* x) {
+    return widen16_half<T>(_mm256_loadu_si256((const __m256i*)x));
+}
+
+// reads 0 < d < 16 halves, the rest of the lanes are 0
+template <typename T>
+static inline __m512
+masked_read_half(size_t d, const T* x) {
+    const __mmask32 mask = (1U << d) - 1;
+    return widen16_half<T>(_mm512_castsi512_si256(_mm512_maskz_loadu_epi16(mask, x)));
+}
+
+template <typename T>
+static inline float
+half_inner_product_avx512(const T* x, const T* y, size_t d) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= d; i += 32) {
+        acc0 = _mm512_fmadd_ps(load16_half(x + i), load16_half(y + i), acc0);
+        acc1 = _mm512_fmadd_ps(load16_half(x + i + 16), load16_half(y + i + 16), acc1);
+    }
+    if (i + 16 <= d) {
+        acc0 = _mm512_fmadd_ps(load16_half(x + i), load16_half(y + i), acc0);
+        i += 16;
+    }
+    if (i < d) {
+        acc1 = _mm512_fmadd_ps(masked_read_half(d - i, x + i), masked_read_half(d - i, y + i), acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+template <typename T>
+static inline float
+half_L2sqr_avx512(const T* x, const T* y, size_t d) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= d; i += 32) {
+        const __m512 diff0 = _mm512_sub_ps(load16_half(x + i), load16_half(y + i));
+        const __m512 diff1 = _mm512_sub_ps(load16_half(x + i + 16), load16_half(y + i + 16));
+        acc0 = _mm512_fmadd_ps(diff0, diff0, acc0);
+        acc1 = _mm512_fmadd_ps(diff1, diff1, acc1);
+    }
+    if (i + 16 <= d) {
+        const __m512 diff = _mm512_sub_ps(load16_half(x + i), load16_half(y + i));
+        acc0 = _mm512_fmadd_ps(diff, diff, acc0);
+        i += 16;
+    }
+    if (i < d) {
+        const __m512 diff = _mm512_sub_ps(masked_read_half(d - i, x + i), masked_read_half(d - i, y + i));
+        acc1 = _mm512_fmadd_ps(diff, diff, acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+template <typename T>
+static inline float
+half_norm_L2sqr_avx512(const T* x, size_t d) {
+    __m512 acc = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= d; i += 16) {
+        const __m512 v = load16_half(x + i);
+        acc = _mm512_fmadd_ps(v, v, acc);
+    }
+    if (i < d) {
+        const __m512 v = masked_read_half(d - i, x + i);
+        acc = _mm512_fmadd_ps(v, v, acc);
+    }
+    return _mm512_reduce_add_ps(acc);
+}
+
+float
+fp16_vec_inner_product_avx512(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_inner_product_avx512(x, y, d);
+}
+
+float
+fp16_vec_L2sqr_avx512(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_L2sqr_avx512(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_avx512(const knowhere::fp16* x, size_t d) {
+    return half_norm_L2sqr_avx512(x, d);
+}
+
+float
+bf16_vec_inner_product_avx512(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_inner_product_avx512(x, y, d);
+}
+
+float
+bf16_vec_L2sqr_avx512(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_L2sqr_avx512(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_avx512(const knowhere::bf16* x, size_t d) {
+    return half_norm_L2sqr_avx512(x, d);
 }
 
 }  // namespace faiss
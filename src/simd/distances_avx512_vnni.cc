@@ -0,0 +1,70 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+#include "distances_avx512_vnni.h"
+
+#include <immintrin.h>
+
+namespace faiss {
+
+// vpdpbusd multiplies unsigned by signed bytes, so x is offset by 128 to unsigned (flipping its sign bit) and
+// 128 * sum(y), summed with a second vpdpbusd against ones, is taken off at the end
+int32_t
+ivec_inner_product_avx512_vnni(const int8_t* x, const int8_t* y, size_t d) {
+    const __m512i offset = _mm512_set1_epi8(-128);
+    const __m512i ones = _mm512_set1_epi8(1);
+    __m512i acc = _mm512_setzero_si512();
+    __m512i y_sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= d; i += 64) {
+        const __m512i xv = _mm512_loadu_si512((const void*)(x + i));
+        const __m512i yv = _mm512_loadu_si512((const void*)(y + i));
+        acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(xv, offset), yv);
+        y_sum = _mm512_dpbusd_epi32(y_sum, ones, yv);
+    }
+    if (i < d) {
+        // the lanes past d are 0 in both, which adds nothing to either sum
+        const __mmask64 mask = (1ULL << (d - i)) - 1;
+        const __m512i xv = _mm512_maskz_loadu_epi8(mask, x + i);
+        const __m512i yv = _mm512_maskz_loadu_epi8(mask, y + i);
+        acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(xv, offset), yv);
+        y_sum = _mm512_dpbusd_epi32(y_sum, ones, yv);
+    }
+    return _mm512_reduce_add_epi32(_mm512_sub_epi32(acc, _mm512_slli_epi32(y_sum, 7)));
+}
+
+// x - y does not fit a byte, so the differences are taken in int16 and squared with vpdpwssd
+int32_t
+ivec_L2sqr_avx512_vnni(const int8_t* x, const int8_t* y, size_t d) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    auto accumulate = [&](__m512i xv, __m512i yv) {
+        const __m512i d0 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm512_castsi512_si256(xv)),
+                                            _mm512_cvtepi8_epi16(_mm512_castsi512_si256(yv)));
+        const __m512i d1 = _mm512_sub_epi16(_mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(xv, 1)),
+                                            _mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(yv, 1)));
+        acc0 = _mm512_dpwssd_epi32(acc0, d0, d0);
+        acc1 = _mm512_dpwssd_epi32(acc1, d1, d1);
+    };
+    size_t i = 0;
+    for (; i + 64 <= d; i += 64) {
+        accumulate(_mm512_loadu_si512((const void*)(x + i)), _mm512_loadu_si512((const void*)(y + i)));
+    }
+    if (i < d) {
+        const __mmask64 mask = (1ULL << (d - i)) - 1;
+        accumulate(_mm512_maskz_loadu_epi8(mask, x + i), _mm512_maskz_loadu_epi8(mask, y + i));
+    }
+    return _mm512_reduce_add_epi32(_mm512_add_epi32(acc0, acc1));
+}
+
+}  // namespace faiss
+#endif
@@ -0,0 +1,28 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef DISTANCES_AVX512_VNNI_H
+#define DISTANCES_AVX512_VNNI_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+int32_t
+ivec_inner_product_avx512_vnni(const int8_t* x, const int8_t* y, size_t d);
+
+int32_t
+ivec_L2sqr_avx512_vnni(const int8_t* x, const int8_t* y, size_t d);
+
+}  // namespace faiss
+
+#endif /* DISTANCES_AVX512_VNNI_H */
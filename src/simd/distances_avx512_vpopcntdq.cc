@@ -0,0 +1,152 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+#include "distances_avx512_vpopcntdq.h"
+
+#include <immintrin.h>
+
+namespace faiss {
+
+// the avx512 kernels with vpopcntq in place of the nibble lookup
+static inline __m512i
+add_popcount(__m512i acc, __m512i v) {
+    return _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+}
+
+// the bytes past the end of the vectors read as 0, which count no bit
+static inline __mmask64
+tail_mask(size_t n) {
+    return (1ULL << n) - 1;
+}
+
+size_t
+bitset_popcount_avx512_vpopcntdq(const uint8_t* data, size_t nbytes) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        acc = add_popcount(acc, _mm512_loadu_si512((const void*)(data + i)));
+    }
+    if (i < nbytes) {
+        acc = add_popcount(acc, _mm512_maskz_loadu_epi8(tail_mask(nbytes - i), data + i));
+    }
+    return _mm512_reduce_add_epi64(acc);
+}
+
+int
+bvec_xor_popcount_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        acc = add_popcount(acc, _mm512_xor_si512(_mm512_loadu_si512((const void*)(x + i)),
+                                                 _mm512_loadu_si512((const void*)(y + i))));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        acc = add_popcount(acc, _mm512_xor_si512(_mm512_maskz_loadu_epi8(mask, x + i),
+                                                 _mm512_maskz_loadu_epi8(mask, y + i)));
+    }
+    return _mm512_reduce_add_epi64(acc);
+}
+
+void
+bvec_and_or_popcount_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count,
+                                      int& or_count) {
+    __m512i and_acc = _mm512_setzero_si512();
+    __m512i or_acc = _mm512_setzero_si512();
+    auto accumulate = [&](__m512i xv, __m512i yv) {
+        and_acc = add_popcount(and_acc, _mm512_and_si512(xv, yv));
+        or_acc = add_popcount(or_acc, _mm512_or_si512(xv, yv));
+    };
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        accumulate(_mm512_loadu_si512((const void*)(x + i)), _mm512_loadu_si512((const void*)(y + i)));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        accumulate(_mm512_maskz_loadu_epi8(mask, x + i), _mm512_maskz_loadu_epi8(mask, y + i));
+    }
+    and_count = _mm512_reduce_add_epi64(and_acc);
+    or_count = _mm512_reduce_add_epi64(or_acc);
+}
+
+void
+bvec_xor_popcount_batch_4_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                           const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2,
+                                           int& count3) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    __m512i acc2 = _mm512_setzero_si512();
+    __m512i acc3 = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        const __m512i xv = _mm512_loadu_si512((const void*)(x + i));
+        acc0 = add_popcount(acc0, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y0 + i))));
+        acc1 = add_popcount(acc1, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y1 + i))));
+        acc2 = add_popcount(acc2, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y2 + i))));
+        acc3 = add_popcount(acc3, _mm512_xor_si512(xv, _mm512_loadu_si512((const void*)(y3 + i))));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        const __m512i xv = _mm512_maskz_loadu_epi8(mask, x + i);
+        acc0 = add_popcount(acc0, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y0 + i)));
+        acc1 = add_popcount(acc1, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y1 + i)));
+        acc2 = add_popcount(acc2, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y2 + i)));
+        acc3 = add_popcount(acc3, _mm512_xor_si512(xv, _mm512_maskz_loadu_epi8(mask, y3 + i)));
+    }
+    count0 = _mm512_reduce_add_epi64(acc0);
+    count1 = _mm512_reduce_add_epi64(acc1);
+    count2 = _mm512_reduce_add_epi64(acc2);
+    count3 = _mm512_reduce_add_epi64(acc3);
+}
+
+void
+bvec_and_or_popcount_batch_4_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y0, const uint8_t* y1,
+                                              const uint8_t* y2, const uint8_t* y3, size_t nbytes, int* and_counts,
+                                              int* or_counts) {
+    __m512i and_acc0 = _mm512_setzero_si512(), or_acc0 = _mm512_setzero_si512();
+    __m512i and_acc1 = _mm512_setzero_si512(), or_acc1 = _mm512_setzero_si512();
+    __m512i and_acc2 = _mm512_setzero_si512(), or_acc2 = _mm512_setzero_si512();
+    __m512i and_acc3 = _mm512_setzero_si512(), or_acc3 = _mm512_setzero_si512();
+    auto accumulate = [&](__m512i xv, __m512i v0, __m512i v1, __m512i v2, __m512i v3) {
+        and_acc0 = add_popcount(and_acc0, _mm512_and_si512(xv, v0));
+        or_acc0 = add_popcount(or_acc0, _mm512_or_si512(xv, v0));
+        and_acc1 = add_popcount(and_acc1, _mm512_and_si512(xv, v1));
+        or_acc1 = add_popcount(or_acc1, _mm512_or_si512(xv, v1));
+        and_acc2 = add_popcount(and_acc2, _mm512_and_si512(xv, v2));
+        or_acc2 = add_popcount(or_acc2, _mm512_or_si512(xv, v2));
+        and_acc3 = add_popcount(and_acc3, _mm512_and_si512(xv, v3));
+        or_acc3 = add_popcount(or_acc3, _mm512_or_si512(xv, v3));
+    };
+    size_t i = 0;
+    for (; i + 64 <= nbytes; i += 64) {
+        accumulate(_mm512_loadu_si512((const void*)(x + i)), _mm512_loadu_si512((const void*)(y0 + i)),
+                   _mm512_loadu_si512((const void*)(y1 + i)), _mm512_loadu_si512((const void*)(y2 + i)),
+                   _mm512_loadu_si512((const void*)(y3 + i)));
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = tail_mask(nbytes - i);
+        accumulate(_mm512_maskz_loadu_epi8(mask, x + i), _mm512_maskz_loadu_epi8(mask, y0 + i),
+                   _mm512_maskz_loadu_epi8(mask, y1 + i), _mm512_maskz_loadu_epi8(mask, y2 + i),
+                   _mm512_maskz_loadu_epi8(mask, y3 + i));
+    }
+    and_counts[0] = _mm512_reduce_add_epi64(and_acc0);
+    or_counts[0] = _mm512_reduce_add_epi64(or_acc0);
+    and_counts[1] = _mm512_reduce_add_epi64(and_acc1);
+    or_counts[1] = _mm512_reduce_add_epi64(or_acc1);
+    and_counts[2] = _mm512_reduce_add_epi64(and_acc2);
+    or_counts[2] = _mm512_reduce_add_epi64(or_acc2);
+    and_counts[3] = _mm512_reduce_add_epi64(and_acc3);
+    or_counts[3] = _mm512_reduce_add_epi64(or_acc3);
+}
+
+}  // namespace faiss
+#endif
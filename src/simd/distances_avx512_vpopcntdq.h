@@ -0,0 +1,42 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#ifndef DISTANCES_AVX512_VPOPCNTDQ_H
+#define DISTANCES_AVX512_VPOPCNTDQ_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace faiss {
+
+size_t
+bitset_popcount_avx512_vpopcntdq(const uint8_t* data, size_t nbytes);
+
+int
+bvec_xor_popcount_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_and_or_popcount_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count,
+                                      int& or_count);
+
+void
+bvec_xor_popcount_batch_4_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                           const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2,
+                                           int& count3);
+
+void
+bvec_and_or_popcount_batch_4_avx512_vpopcntdq(const uint8_t* x, const uint8_t* y0, const uint8_t* y1,
+                                              const uint8_t* y2, const uint8_t* y3, size_t nbytes, int* and_counts,
+                                              int* or_counts);
+
+}  // namespace faiss
+
+#endif /* DISTANCES_AVX512_VPOPCNTDQ_H */
@@ -0,0 +1,94 @@
+// Copyright (C) 2019-2023 Zilliz. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not use this file except in compliance
+// with the License. You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software distributed under the License
+// is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
+// or implied. See the License for the specific language governing permissions and limitations under the License.
+
+#if defined(__x86_64__)
+#include "distances_avx_vnni.h"
+
+#include <immintrin.h>
+
+namespace faiss {
+
+static inline int32_t
+reduce_add_epi32(__m256i v) {
+    __m128i r = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(1, 0, 3, 2)));
+    r = _mm_add_epi32(r, _mm_shuffle_epi32(r, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(r);
+}
+
+// the 256-bit vpdpbusd of avx-vnni, with the same unsigned offset of x as the avx512 vnni kernel. there are no masked
+// byte loads without avx512, so the tail is a scalar loop
+int32_t
+ivec_inner_product_avx_vnni(const int8_t* x, const int8_t* y, size_t d) {
+    const __m256i offset = _mm256_set1_epi8(-128);
+    const __m256i ones = _mm256_set1_epi8(1);
+    // two sets of accumulators, so that consecutive vpdpbusd do not wait on each other
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    __m256i y_sum0 = _mm256_setzero_si256();
+    __m256i y_sum1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 64 <= d; i += 64) {
+        const __m256i x0 = _mm256_loadu_si256((const __m256i*)(x + i));
+        const __m256i y0 = _mm256_loadu_si256((const __m256i*)(y + i));
+        const __m256i x1 = _mm256_loadu_si256((const __m256i*)(x + i + 32));
+        const __m256i y1 = _mm256_loadu_si256((const __m256i*)(y + i + 32));
+        acc0 = _mm256_dpbusd_avx_epi32(acc0, _mm256_xor_si256(x0, offset), y0);
+        acc1 = _mm256_dpbusd_avx_epi32(acc1, _mm256_xor_si256(x1, offset), y1);
+        y_sum0 = _mm256_dpbusd_avx_epi32(y_sum0, ones, y0);
+        y_sum1 = _mm256_dpbusd_avx_epi32(y_sum1, ones, y1);
+    }
+    if (i + 32 <= d) {
+        const __m256i x0 = _mm256_loadu_si256((const __m256i*)(x + i));
+        const __m256i y0 = _mm256_loadu_si256((const __m256i*)(y + i));
+        acc0 = _mm256_dpbusd_avx_epi32(acc0, _mm256_xor_si256(x0, offset), y0);
+        y_sum0 = _mm256_dpbusd_avx_epi32(y_sum0, ones, y0);
+        i += 32;
+    }
+    const __m256i acc = _mm256_add_epi32(acc0, acc1);
+    const __m256i y_sum = _mm256_add_epi32(y_sum0, y_sum1);
+    int32_t res = reduce_add_epi32(_mm256_sub_epi32(acc, _mm256_slli_epi32(y_sum, 7)));
+    for (; i < d; i++) {
+        res += (int32_t)x[i] * y[i];
+    }
+    return res;
+}
+
+// the int16 differences squared with the 256-bit vpdpwssd
+int32_t
+ivec_L2sqr_avx_vnni(const int8_t* x, const int8_t* y, size_t d) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= d; i += 32) {
+        const __m256i d0 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i))));
+        const __m256i d1 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i + 16))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i + 16))));
+        acc0 = _mm256_dpwssd_avx_epi32(acc0, d0, d0);
+        acc1 = _mm256_dpwssd_avx_epi32(acc1, d1, d1);
+    }
+    if (i + 16 <= d) {
+        const __m256i d0 = _mm256_sub_epi16(_mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(x + i))),
+                                            _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i*)(y + i))));
+        acc0 = _mm256_dpwssd_avx_epi32(acc0, d0, d0);
+        i += 16;
+    }
+    int32_t res = reduce_add_epi32(_mm256_add_epi32(acc0, acc1));
+    for (; i < d; i++) {
+        const int32_t tmp = (int32_t)x[i] - (int32_t)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+}  // namespace faiss
+#endif
@@ -14,6 +14,11 @@
 
 #include <arm_neon.h>
 #include <math.h>
+
+#include <type_traits>
+
+#include "knowhere/operands.h"
+
 namespace faiss {
 float
 fvec_inner_product_neon(const float* x, const float* y, size_t d) {
@@ -377,22 +382,198 @@ fvec_norm_L2sqr_neon(const float* x, size_t d) {
     return vaddvq_f32(sum_);
 }
 
+namespace {
+
+struct ElementOpL2 {
+    static float32x4_t
+    acc(float32x4_t x, float32x4_t y, float32x4_t sum) {
+        const float32x4_t t = vsubq_f32(x, y);
+        return vfmaq_f32(sum, t, t);
+    }
+
+    static float
+    acc(float x, float y, float sum) {
+        const float t = x - y;
+        return sum + t * t;
+    }
+
+    static float
+    one(const float* x, const float* y, size_t d) {
+        return fvec_L2sqr_neon(x, y, d);
+    }
+};
+
+struct ElementOpIP {
+    static float32x4_t
+    acc(float32x4_t x, float32x4_t y, float32x4_t sum) {
+        return vfmaq_f32(sum, x, y);
+    }
+
+    static float
+    acc(float x, float y, float sum) {
+        return sum + x * y;
+    }
+
+    static float
+    one(const float* x, const float* y, size_t d) {
+        return fvec_inner_product_neon(x, y, d);
+    }
+};
+
+// distances between x and 4 vectors, one accumulator per vector so that x is read once
+template <class ElementOp>
+inline float32x4_t
+fvec_op_batch_4(const float* x, const float* y0, const float* y1, const float* y2, const float* y3, size_t d) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+    size_t j = 0;
+    for (; j + 4 <= d; j += 4) {
+        const float32x4_t mx = vld1q_f32(x + j);
+        acc0 = ElementOp::acc(mx, vld1q_f32(y0 + j), acc0);
+        acc1 = ElementOp::acc(mx, vld1q_f32(y1 + j), acc1);
+        acc2 = ElementOp::acc(mx, vld1q_f32(y2 + j), acc2);
+        acc3 = ElementOp::acc(mx, vld1q_f32(y3 + j), acc3);
+    }
+    float32x4_t sum = vpaddq_f32(vpaddq_f32(acc0, acc1), vpaddq_f32(acc2, acc3));
+    if (j < d) {
+        float tail[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (; j < d; j++) {
+            tail[0] = ElementOp::acc(x[j], y0[j], tail[0]);
+            tail[1] = ElementOp::acc(x[j], y1[j], tail[1]);
+            tail[2] = ElementOp::acc(x[j], y2[j], tail[2]);
+            tail[3] = ElementOp::acc(x[j], y3[j], tail[3]);
+        }
+        sum = vaddq_f32(sum, vld1q_f32(tail));
+    }
+    return sum;
+}
+
+template <class ElementOp>
 void
-fvec_L2sqr_ny_neon(float* dis, const float* x, const float* y, size_t d, size_t ny) {
-    for (size_t i = 0; i < ny; i++) {
-        dis[i] = fvec_L2sqr_neon(x, y, d);
-        y += d;
+fvec_op_ny(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    size_t i = 0;
+    for (; i + 4 <= ny; i += 4) {
+        const float* yi = y + i * d;
+        vst1q_f32(dis + i, fvec_op_batch_4<ElementOp>(x, yi, yi + d, yi + 2 * d, yi + 3 * d, d));
+    }
+    for (; i < ny; i++) {
+        dis[i] = ElementOp::one(x, y + i * d, d);
+    }
+}
+
+// index of the first smallest value, 0 if there is none below HUGE_VALF like fvec_L2sqr_ny_nearest_ref
+size_t
+argmin_neon(const float* v, size_t n) {
+    float32x4_t min = vdupq_n_f32(HUGE_VALF);
+    uint32x4_t min_idx = vdupq_n_u32(0);
+    uint32x4_t idx = {0, 1, 2, 3};
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const float32x4_t mv = vld1q_f32(v + i);
+        const uint32x4_t lt = vcltq_f32(mv, min);
+        min = vbslq_f32(lt, mv, min);
+        min_idx = vbslq_u32(lt, idx, min_idx);
+        idx = vaddq_u32(idx, vdupq_n_u32(4));
     }
+    float mins[4];
+    uint32_t idxs[4];
+    vst1q_f32(mins, min);
+    vst1q_u32(idxs, min_idx);
+    float min_dis = HUGE_VALF;
+    size_t nearest_idx = 0;
+    for (size_t r = 0; r < 4; r++) {
+        if (mins[r] < min_dis || (mins[r] == min_dis && idxs[r] < nearest_idx)) {
+            min_dis = mins[r];
+            nearest_idx = idxs[r];
+        }
+    }
+    for (; i < n; i++) {
+        if (v[i] < min_dis) {
+            min_dis = v[i];
+            nearest_idx = i;
+        }
+    }
+    return nearest_idx;
+}
+
+}  // namespace
+
+void
+fvec_L2sqr_ny_neon(float* dis, const float* x, const float* y, size_t d, size_t ny) {
+    fvec_op_ny<ElementOpL2>(dis, x, y, d, ny);
 }
 
 void
 fvec_inner_products_ny_neon(float* ip, const float* x, const float* y, size_t d, size_t ny) {
-    for (size_t i = 0; i < ny; i++) {
-        ip[i] = fvec_inner_product_neon(x, y, d);
-        y += d;
+    fvec_op_ny<ElementOpIP>(ip, x, y, d, ny);
+}
+
+void
+fvec_L2sqr_ny_transposed_neon(float* dis, const float* x, const float* y, const float* y_sqlen, size_t d,
+                              size_t d_offset, size_t ny) {
+    float x_sqlen = 0;
+    for (size_t j = 0; j < d; j++) {
+        x_sqlen += x[j] * x[j];
+    }
+
+    // the vectors of y are the columns, so 4 of them are contiguous in each row
+    size_t i = 0;
+    for (; i + 8 <= ny; i += 8) {
+        float32x4_t dp0 = vdupq_n_f32(0.0f);
+        float32x4_t dp1 = vdupq_n_f32(0.0f);
+        for (size_t j = 0; j < d; j++) {
+            dp0 = vfmaq_n_f32(dp0, vld1q_f32(y + j * d_offset + i), x[j]);
+            dp1 = vfmaq_n_f32(dp1, vld1q_f32(y + j * d_offset + i + 4), x[j]);
+        }
+        const float32x4_t s0 = vaddq_f32(vdupq_n_f32(x_sqlen), vld1q_f32(y_sqlen + i));
+        const float32x4_t s1 = vaddq_f32(vdupq_n_f32(x_sqlen), vld1q_f32(y_sqlen + i + 4));
+        vst1q_f32(dis + i, vfmsq_f32(s0, dp0, vdupq_n_f32(2.0f)));
+        vst1q_f32(dis + i + 4, vfmsq_f32(s1, dp1, vdupq_n_f32(2.0f)));
+    }
+    for (; i < ny; i++) {
+        float dp = 0;
+        for (size_t j = 0; j < d; j++) {
+            dp += x[j] * y[i + j * d_offset];
+        }
+        dis[i] = x_sqlen + y_sqlen[i] - 2 * dp;
     }
 }
 
+size_t
+fvec_L2sqr_ny_nearest_neon(float* distances_tmp_buffer, const float* x, const float* y, size_t d, size_t ny) {
+    fvec_L2sqr_ny_neon(distances_tmp_buffer, x, y, d, ny);
+    return argmin_neon(distances_tmp_buffer, ny);
+}
+
+size_t
+fvec_L2sqr_ny_nearest_y_transposed_neon(float* distances_tmp_buffer, const float* x, const float* y,
+                                        const float* y_sqlen, size_t d, size_t d_offset, size_t ny) {
+    fvec_L2sqr_ny_transposed_neon(distances_tmp_buffer, x, y, y_sqlen, d, d_offset, ny);
+    return argmin_neon(distances_tmp_buffer, ny);
+}
+
+void
+fvec_inner_product_batch_4_neon(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                                const size_t d, float& dis0, float& dis1, float& dis2, float& dis3) {
+    const float32x4_t dis = fvec_op_batch_4<ElementOpIP>(x, y0, y1, y2, y3, d);
+    dis0 = vgetq_lane_f32(dis, 0);
+    dis1 = vgetq_lane_f32(dis, 1);
+    dis2 = vgetq_lane_f32(dis, 2);
+    dis3 = vgetq_lane_f32(dis, 3);
+}
+
+void
+fvec_L2sqr_batch_4_neon(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                        const size_t d, float& dis0, float& dis1, float& dis2, float& dis3) {
+    const float32x4_t dis = fvec_op_batch_4<ElementOpL2>(x, y0, y1, y2, y3, d);
+    dis0 = vgetq_lane_f32(dis, 0);
+    dis1 = vgetq_lane_f32(dis, 1);
+    dis2 = vgetq_lane_f32(dis, 2);
+    dis3 = vgetq_lane_f32(dis, 3);
+}
+
 void
 fvec_madd_neon(size_t n, const float* a, float bf, const float* b, float* c) {
     size_t len = n;
@@ -658,5 +839,241 @@ ivec_L2sqr_neon(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
+size_t
+bitset_popcount_neon(const uint8_t* data, size_t nbytes) {
+    uint64x2_t acc = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        const uint8x16_t cnt = vcntq_u8(vld1q_u8(data + i));
+        acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(cnt)));
+    }
+    size_t res = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+    for (; i < nbytes; i++) {
+        res += __builtin_popcount(data[i]);
+    }
+    return res;
+}
+
+// adds the bit count of v to the 64-bit lanes of acc
+static inline uint64x2_t
+add_popcount(uint64x2_t acc, uint8x16_t v) {
+    return vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(vcntq_u8(v))));
+}
+
+static inline int
+reduce_add_u64(uint64x2_t v) {
+    return vgetq_lane_u64(v, 0) + vgetq_lane_u64(v, 1);
+}
+
+int
+bvec_xor_popcount_neon(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    uint64x2_t acc = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        acc = add_popcount(acc, veorq_u8(vld1q_u8(x + i), vld1q_u8(y + i)));
+    }
+    int res = reduce_add_u64(acc);
+    for (; i < nbytes; i++) {
+        res += __builtin_popcount(x[i] ^ y[i]);
+    }
+    return res;
+}
+
+void
+bvec_and_or_popcount_neon(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count) {
+    uint64x2_t and_acc = vdupq_n_u64(0);
+    uint64x2_t or_acc = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        const uint8x16_t xv = vld1q_u8(x + i);
+        const uint8x16_t yv = vld1q_u8(y + i);
+        and_acc = add_popcount(and_acc, vandq_u8(xv, yv));
+        or_acc = add_popcount(or_acc, vorrq_u8(xv, yv));
+    }
+    and_count = reduce_add_u64(and_acc);
+    or_count = reduce_add_u64(or_acc);
+    for (; i < nbytes; i++) {
+        and_count += __builtin_popcount(x[i] & y[i]);
+        or_count += __builtin_popcount(x[i] | y[i]);
+    }
+}
+
+bool
+bvec_is_subset_neon(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        // the bits of x outside of y
+        if (vmaxvq_u8(vbicq_u8(vld1q_u8(x + i), vld1q_u8(y + i)))) {
+            return false;
+        }
+    }
+    for (; i < nbytes; i++) {
+        if (x[i] & ~y[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+bvec_xor_popcount_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                               const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3) {
+    uint64x2_t acc0 = vdupq_n_u64(0);
+    uint64x2_t acc1 = vdupq_n_u64(0);
+    uint64x2_t acc2 = vdupq_n_u64(0);
+    uint64x2_t acc3 = vdupq_n_u64(0);
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        const uint8x16_t xv = vld1q_u8(x + i);
+        acc0 = add_popcount(acc0, veorq_u8(xv, vld1q_u8(y0 + i)));
+        acc1 = add_popcount(acc1, veorq_u8(xv, vld1q_u8(y1 + i)));
+        acc2 = add_popcount(acc2, veorq_u8(xv, vld1q_u8(y2 + i)));
+        acc3 = add_popcount(acc3, veorq_u8(xv, vld1q_u8(y3 + i)));
+    }
+    count0 = reduce_add_u64(acc0);
+    count1 = reduce_add_u64(acc1);
+    count2 = reduce_add_u64(acc2);
+    count3 = reduce_add_u64(acc3);
+    for (; i < nbytes; i++) {
+        count0 += __builtin_popcount(x[i] ^ y0[i]);
+        count1 += __builtin_popcount(x[i] ^ y1[i]);
+        count2 += __builtin_popcount(x[i] ^ y2[i]);
+        count3 += __builtin_popcount(x[i] ^ y3[i]);
+    }
+}
+
+void
+bvec_and_or_popcount_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts) {
+    const uint8_t* ys[4] = {y0, y1, y2, y3};
+    uint64x2_t and_acc[4];
+    uint64x2_t or_acc[4];
+    for (int j = 0; j < 4; j++) {
+        and_acc[j] = vdupq_n_u64(0);
+        or_acc[j] = vdupq_n_u64(0);
+    }
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        const uint8x16_t xv = vld1q_u8(x + i);
+        for (int j = 0; j < 4; j++) {
+            const uint8x16_t yv = vld1q_u8(ys[j] + i);
+            and_acc[j] = add_popcount(and_acc[j], vandq_u8(xv, yv));
+            or_acc[j] = add_popcount(or_acc[j], vorrq_u8(xv, yv));
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        and_counts[j] = reduce_add_u64(and_acc[j]);
+        or_counts[j] = reduce_add_u64(or_acc[j]);
+        for (size_t k = i; k < nbytes; k++) {
+            and_counts[j] += __builtin_popcount(x[k] & ys[j][k]);
+            or_counts[j] += __builtin_popcount(x[k] | ys[j][k]);
+        }
+    }
+}
+
+// fp16 is widened with fcvtl, bf16 by shifting its bits into the high half of a fp32
+template <typename T>
+static inline float32x4_t
+load4_half(const T* x) {
+    const uint16x4_t bits = vld1_u16((const uint16_t*)x);
+    if constexpr (std::is_same_v<T, knowhere::fp16>) {
+        return vcvt_f32_f16(vreinterpret_f16_u16(bits));
+    } else {
+        return vreinterpretq_f32_u32(vshll_n_u16(bits, 16));
+    }
+}
+
+template <typename T>
+static inline float
+half_inner_product_neon(const T* x, const T* y, size_t d) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        acc0 = vfmaq_f32(acc0, load4_half(x + i), load4_half(y + i));
+        acc1 = vfmaq_f32(acc1, load4_half(x + i + 4), load4_half(y + i + 4));
+    }
+    if (i + 4 <= d) {
+        acc0 = vfmaq_f32(acc0, load4_half(x + i), load4_half(y + i));
+        i += 4;
+    }
+    float res = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < d; i++) {
+        res += (float)x[i] * (float)y[i];
+    }
+    return res;
+}
+
+template <typename T>
+static inline float
+half_L2sqr_neon(const T* x, const T* y, size_t d) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 8 <= d; i += 8) {
+        const float32x4_t diff0 = vsubq_f32(load4_half(x + i), load4_half(y + i));
+        const float32x4_t diff1 = vsubq_f32(load4_half(x + i + 4), load4_half(y + i + 4));
+        acc0 = vfmaq_f32(acc0, diff0, diff0);
+        acc1 = vfmaq_f32(acc1, diff1, diff1);
+    }
+    if (i + 4 <= d) {
+        const float32x4_t diff = vsubq_f32(load4_half(x + i), load4_half(y + i));
+        acc0 = vfmaq_f32(acc0, diff, diff);
+        i += 4;
+    }
+    float res = vaddvq_f32(vaddq_f32(acc0, acc1));
+    for (; i < d; i++) {
+        const float tmp = (float)x[i] - (float)y[i];
+        res += tmp * tmp;
+    }
+    return res;
+}
+
+template <typename T>
+static inline float
+half_norm_L2sqr_neon(const T* x, size_t d) {
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= d; i += 4) {
+        const float32x4_t v = load4_half(x + i);
+        acc = vfmaq_f32(acc, v, v);
+    }
+    float res = vaddvq_f32(acc);
+    for (; i < d; i++) {
+        res += (float)x[i] * (float)x[i];
+    }
+    return res;
+}
+
+float
+fp16_vec_inner_product_neon(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_inner_product_neon(x, y, d);
+}
+
+float
+fp16_vec_L2sqr_neon(const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+    return half_L2sqr_neon(x, y, d);
+}
+
+float
+fp16_vec_norm_L2sqr_neon(const knowhere::fp16* x, size_t d) {
+    return half_norm_L2sqr_neon(x, d);
+}
+
+float
+bf16_vec_inner_product_neon(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_inner_product_neon(x, y, d);
+}
+
+float
+bf16_vec_L2sqr_neon(const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+    return half_L2sqr_neon(x, y, d);
+}
+
+float
+bf16_vec_norm_L2sqr_neon(const knowhere::bf16* x, size_t d) {
+    return half_norm_L2sqr_neon(x, d);
+}
+
 }  // namespace faiss
 #endif
@@ -15,6 +15,11 @@
 #include <cstdint>
 #include <cstdio>
 
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// Squared L2 distance between two vectors
@@ -41,10 +46,29 @@ fvec_norm_L2sqr_neon(const float* x, size_t d);
 void
 fvec_L2sqr_ny_neon(float* dis, const float* x, const float* y, size_t d, size_t ny);
 
-/// compute the inner product between nx vectors x and one y
+/// compute the inner product between x and a set of contiguous y vectors
 void
 fvec_inner_products_ny_neon(float* ip, const float* x, const float* y, size_t d, size_t ny);
 
+void
+fvec_L2sqr_ny_transposed_neon(float* dis, const float* x, const float* y, const float* y_sqlen, size_t d,
+                              size_t d_offset, size_t ny);
+
+size_t
+fvec_L2sqr_ny_nearest_neon(float* distances_tmp_buffer, const float* x, const float* y, size_t d, size_t ny);
+
+size_t
+fvec_L2sqr_ny_nearest_y_transposed_neon(float* distances_tmp_buffer, const float* x, const float* y,
+                                        const float* y_sqlen, size_t d, size_t d_offset, size_t ny);
+
+void
+fvec_inner_product_batch_4_neon(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                                const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
+
+void
+fvec_L2sqr_batch_4_neon(const float* x, const float* y0, const float* y1, const float* y2, const float* y3,
+                        const size_t d, float& dis0, float& dis1, float& dis2, float& dis3);
+
 void
 fvec_madd_neon(size_t n, const float* a, float bf, const float* b, float* c);
 
@@ -57,6 +81,44 @@ ivec_inner_product_neon(const int8_t* x, const int8_t* y, size_t d);
 int32_t
 ivec_L2sqr_neon(const int8_t* x, const int8_t* y, size_t d);
 
+size_t
+bitset_popcount_neon(const uint8_t* data, size_t nbytes);
+
+int
+bvec_xor_popcount_neon(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_and_or_popcount_neon(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count);
+
+bool
+bvec_is_subset_neon(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_xor_popcount_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                               const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3);
+
+void
+bvec_and_or_popcount_batch_4_neon(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                  const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts);
+
+float
+fp16_vec_inner_product_neon(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_L2sqr_neon(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_neon(const knowhere::fp16* x, size_t d);
+
+float
+bf16_vec_inner_product_neon(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_L2sqr_neon(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_neon(const knowhere::bf16* x, size_t d);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_NEON_H */
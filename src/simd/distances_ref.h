@@ -4,6 +4,11 @@
 #include <cstdint>
 #include <cstdio>
 
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// Squared L2 distance between two vectors
@@ -93,6 +98,44 @@ ivec_inner_product_ref(const int8_t* x, const int8_t* y, size_t d);
 int32_t
 ivec_L2sqr_ref(const int8_t* x, const int8_t* y, size_t d);
 
+size_t
+bitset_popcount_ref(const uint8_t* data, size_t nbytes);
+
+int
+bvec_xor_popcount_ref(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_and_or_popcount_ref(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count);
+
+bool
+bvec_is_subset_ref(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_xor_popcount_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3);
+
+void
+bvec_and_or_popcount_batch_4_ref(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts);
+
+float
+fp16_vec_inner_product_ref(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_L2sqr_ref(const knowhere::fp16* x, const knowhere::fp16* y, size_t d);
+
+float
+fp16_vec_norm_L2sqr_ref(const knowhere::fp16* x, size_t d);
+
+float
+bf16_vec_inner_product_ref(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_L2sqr_ref(const knowhere::bf16* x, const knowhere::bf16* y, size_t d);
+
+float
+bf16_vec_norm_L2sqr_ref(const knowhere::bf16* x, size_t d);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_REF_H */
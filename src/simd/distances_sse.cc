@@ -16,6 +16,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
 
 #include "distances_ref.h"
 
@@ -400,5 +401,116 @@ ivec_L2sqr_sse(const int8_t* x, const int8_t* y, size_t d) {
     return res;
 }
 
+size_t
+bitset_popcount_sse(const uint8_t* data, size_t nbytes) {
+    // independent accumulators, so that consecutive popcnt instructions do not wait on each other
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        uint64_t w[4];
+        memcpy(w, data + i, sizeof(w));
+        c0 += _mm_popcnt_u64(w[0]);
+        c1 += _mm_popcnt_u64(w[1]);
+        c2 += _mm_popcnt_u64(w[2]);
+        c3 += _mm_popcnt_u64(w[3]);
+    }
+    for (; i + 8 <= nbytes; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+        c0 += _mm_popcnt_u64(w);
+    }
+    for (; i < nbytes; i++) {
+        c0 += _mm_popcnt_u32(data[i]);
+    }
+    return c0 + c1 + c2 + c3;
+}
+
+static inline uint64_t
+load_u64(const uint8_t* p) {
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+int
+bvec_xor_popcount_sse(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    uint64_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    size_t i = 0;
+    for (; i + 32 <= nbytes; i += 32) {
+        c0 += _mm_popcnt_u64(load_u64(x + i) ^ load_u64(y + i));
+        c1 += _mm_popcnt_u64(load_u64(x + i + 8) ^ load_u64(y + i + 8));
+        c2 += _mm_popcnt_u64(load_u64(x + i + 16) ^ load_u64(y + i + 16));
+        c3 += _mm_popcnt_u64(load_u64(x + i + 24) ^ load_u64(y + i + 24));
+    }
+    for (; i + 8 <= nbytes; i += 8) {
+        c0 += _mm_popcnt_u64(load_u64(x + i) ^ load_u64(y + i));
+    }
+    for (; i < nbytes; i++) {
+        c0 += _mm_popcnt_u32(x[i] ^ y[i]);
+    }
+    return c0 + c1 + c2 + c3;
+}
+
+void
+bvec_and_or_popcount_sse(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count) {
+    uint64_t and0 = 0, and1 = 0, or0 = 0, or1 = 0;
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        const uint64_t x0 = load_u64(x + i), y0 = load_u64(y + i);
+        const uint64_t x1 = load_u64(x + i + 8), y1 = load_u64(y + i + 8);
+        and0 += _mm_popcnt_u64(x0 & y0);
+        or0 += _mm_popcnt_u64(x0 | y0);
+        and1 += _mm_popcnt_u64(x1 & y1);
+        or1 += _mm_popcnt_u64(x1 | y1);
+    }
+    for (; i + 8 <= nbytes; i += 8) {
+        const uint64_t x0 = load_u64(x + i), y0 = load_u64(y + i);
+        and0 += _mm_popcnt_u64(x0 & y0);
+        or0 += _mm_popcnt_u64(x0 | y0);
+    }
+    for (; i < nbytes; i++) {
+        and0 += _mm_popcnt_u32(x[i] & y[i]);
+        or0 += _mm_popcnt_u32(x[i] | y[i]);
+    }
+    and_count = and0 + and1;
+    or_count = or0 + or1;
+}
+
+bool
+bvec_is_subset_sse(const uint8_t* x, const uint8_t* y, size_t nbytes) {
+    size_t i = 0;
+    for (; i + 16 <= nbytes; i += 16) {
+        // testc is set when x has no bit outside of y
+        if (!_mm_testc_si128(_mm_loadu_si128((const __m128i*)(y + i)), _mm_loadu_si128((const __m128i*)(x + i)))) {
+            return false;
+        }
+    }
+    for (; i < nbytes; i++) {
+        if (x[i] & ~y[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// popcnt works a word at a time, reading x once for the 4 codes saves nothing
+void
+bvec_xor_popcount_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3) {
+    count0 = bvec_xor_popcount_sse(x, y0, nbytes);
+    count1 = bvec_xor_popcount_sse(x, y1, nbytes);
+    count2 = bvec_xor_popcount_sse(x, y2, nbytes);
+    count3 = bvec_xor_popcount_sse(x, y3, nbytes);
+}
+
+void
+bvec_and_or_popcount_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts) {
+    bvec_and_or_popcount_sse(x, y0, nbytes, and_counts[0], or_counts[0]);
+    bvec_and_or_popcount_sse(x, y1, nbytes, and_counts[1], or_counts[1]);
+    bvec_and_or_popcount_sse(x, y2, nbytes, and_counts[2], or_counts[2]);
+    bvec_and_or_popcount_sse(x, y3, nbytes, and_counts[3], or_counts[3]);
+}
+
 }  // namespace faiss
 #endif
@@ -53,6 +53,26 @@ ivec_inner_product_sse(const int8_t* x, const int8_t* y, size_t d);
 int32_t
 ivec_L2sqr_sse(const int8_t* x, const int8_t* y, size_t d);
 
+size_t
+bitset_popcount_sse(const uint8_t* data, size_t nbytes);
+
+int
+bvec_xor_popcount_sse(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_and_or_popcount_sse(const uint8_t* x, const uint8_t* y, size_t nbytes, int& and_count, int& or_count);
+
+bool
+bvec_is_subset_sse(const uint8_t* x, const uint8_t* y, size_t nbytes);
+
+void
+bvec_xor_popcount_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                              const uint8_t* y3, size_t nbytes, int& count0, int& count1, int& count2, int& count3);
+
+void
+bvec_and_or_popcount_batch_4_sse(const uint8_t* x, const uint8_t* y0, const uint8_t* y1, const uint8_t* y2,
+                                 const uint8_t* y3, size_t nbytes, int* and_counts, int* or_counts);
+
 }  // namespace faiss
 
 #endif /* DISTANCES_SSE_H */
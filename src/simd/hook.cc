@@ -13,8 +13,13 @@
 
 #include "hook.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <limits>
 #include <mutex>
+#include <vector>
 
 #include "faiss/FaissHook.h"
 
@@ -25,12 +30,16 @@
 #if defined(__x86_64__)
 #include "distances_avx.h"
 #include "distances_avx512.h"
+#include "distances_avx512_vnni.h"
+#include "distances_avx_vnni.h"
+#include "distances_avx512_vpopcntdq.h"
 #include "distances_sse.h"
 #include "instruction_set.h"
 #endif
 
 #include "distances_ref.h"
 #include "knowhere/log.h"
+#include "knowhere/operands.h"
 namespace faiss {
 
 #if defined(__x86_64__)
@@ -62,6 +71,22 @@ decltype(fvec_L2sqr_batch_4) fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
 decltype(ivec_inner_product) ivec_inner_product = ivec_inner_product_ref;
 decltype(ivec_L2sqr) ivec_L2sqr = ivec_L2sqr_ref;
 
+decltype(bitset_popcount) bitset_popcount = bitset_popcount_ref;
+
+decltype(bvec_xor_popcount) bvec_xor_popcount = bvec_xor_popcount_ref;
+decltype(bvec_and_or_popcount) bvec_and_or_popcount = bvec_and_or_popcount_ref;
+decltype(bvec_is_subset) bvec_is_subset = bvec_is_subset_ref;
+decltype(bvec_xor_popcount_batch_4) bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_ref;
+decltype(bvec_and_or_popcount_batch_4) bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_ref;
+
+decltype(fp16_vec_inner_product) fp16_vec_inner_product = fp16_vec_inner_product_ref;
+decltype(fp16_vec_L2sqr) fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+decltype(fp16_vec_norm_L2sqr) fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+
+decltype(bf16_vec_inner_product) bf16_vec_inner_product = bf16_vec_inner_product_ref;
+decltype(bf16_vec_L2sqr) bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+decltype(bf16_vec_norm_L2sqr) bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
 #if defined(__x86_64__)
 bool
 cpu_support_avx512() {
@@ -69,6 +94,24 @@ cpu_support_avx512() {
     return (instruction_set_inst.AVX512F() && instruction_set_inst.AVX512DQ() && instruction_set_inst.AVX512BW());
 }
 
+bool
+cpu_support_avx512_vnni() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx512() && instruction_set_inst.AVX512VNNI());
+}
+
+bool
+cpu_support_avx512_vpopcntdq() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (cpu_support_avx512() && instruction_set_inst.AVX512VPOPCNTDQ());
+}
+
+bool
+cpu_support_avx_vnni() {
+    InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
+    return (instruction_set_inst.AVX2() && instruction_set_inst.AVXVNNI());
+}
+
 bool
 cpu_support_avx2() {
     InstructionSet& instruction_set_inst = InstructionSet::GetInstance();
@@ -83,155 +126,500 @@ cpu_support_sse4_2() {
 #endif
 
 static std::mutex patch_bf16_mutex;
+// the fp32 kernels of the last fvec_hook, without the bf16 patch
+static FvecKernels hooked_fvec_kernels = {fvec_L2sqr_ref, fvec_inner_product_ref, fvec_norm_L2sqr_ref,
+                                          fvec_L2sqr_batch_4_ref, fvec_inner_product_batch_4_ref};
+static std::atomic<bool> patch_bf16_enabled = false;
 
-void
-enable_patch_for_fp32_bf16() {
-    std::lock_guard<std::mutex> lock(patch_bf16_mutex);
-#if defined(__x86_64__)
-    if (use_avx512 && cpu_support_avx512()) {
-        // Cloud branch
-        fvec_inner_product = fvec_inner_product_avx512_bf16_patch;
-        fvec_L2sqr = fvec_L2sqr_avx512_bf16_patch;
+static std::mutex hook_mutex;
+// the kernels of the last fvec_hook or fvec_hook_autotune, one entry per family
+static std::vector<SimdKernelSelection> hooked_selection;
+
+// the families of kernels that are bound, and benchmarked, together
+static constexpr const char* kKernelFamilies[] = {"float", "int8", "fp16/bf16", "binary"};
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512_bf16_patch;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512_bf16_patch;
+#if defined(__x86_64__)
+// the isa levels the x86 kernels are written for, from the lowest
+enum class SimdLevel { GENERIC = 0, SSE4_2, AVX2, AVX512 };
+
+static const char*
+simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            return "AVX512";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::SSE4_2:
+            return "SSE4_2";
+        default:
+            return "GENERIC";
+    }
+}
 
+// the highest level allowed by use_avx512, use_avx2 and use_sse4_2 that the cpu supports
+static SimdLevel
+max_simd_level() {
+    if (use_avx512 && cpu_support_avx512()) {
+        return SimdLevel::AVX512;
     } else if (use_avx2 && cpu_support_avx2()) {
-        fvec_inner_product = fvec_inner_product_avx_bf16_patch;
-        fvec_L2sqr = fvec_L2sqr_avx_bf16_patch;
+        return SimdLevel::AVX2;
+    } else if (use_sse4_2 && cpu_support_sse4_2()) {
+        return SimdLevel::SSE4_2;
+    }
+    return SimdLevel::GENERIC;
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx_bf16_patch;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx_bf16_patch;
+// the level the fp32 kernels are bound at, and the one of the last hook, which the bf16 patch follows
+static SimdLevel bound_fvec_level = SimdLevel::GENERIC;
+static SimdLevel hooked_fvec_level = SimdLevel::GENERIC;
+
+template <size_t D>
+static void
+set_fvec_kernels_avx512_dim(FvecKernels& kernels) {
+    kernels.L2sqr = fvec_L2sqr_avx512_dim<D>;
+    kernels.inner_product = fvec_inner_product_avx512_dim<D>;
+    kernels.L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512_dim<D>;
+    kernels.inner_product_batch_4 = fvec_inner_product_batch_4_avx512_dim<D>;
+}
 
-    } else if (use_sse4_2 && cpu_support_sse4_2()) {
-        // The branch that can't be reached
-    } else {
-        fvec_inner_product = fvec_inner_product_ref_bf16_patch;
-        fvec_L2sqr = fvec_L2sqr_ref_bf16_patch;
+static void
+specialize_fvec_kernels_avx512(FvecKernels& kernels, size_t dim) {
+    switch (dim) {
+        case 128:
+            set_fvec_kernels_avx512_dim<128>(kernels);
+            break;
+        case 384:
+            set_fvec_kernels_avx512_dim<384>(kernels);
+            break;
+        case 512:
+            set_fvec_kernels_avx512_dim<512>(kernels);
+            break;
+        case 768:
+            set_fvec_kernels_avx512_dim<768>(kernels);
+            break;
+        case 1024:
+            set_fvec_kernels_avx512_dim<1024>(kernels);
+            break;
+        case 1536:
+            set_fvec_kernels_avx512_dim<1536>(kernels);
+            break;
+        default:
+            break;
+    }
+}
+#endif
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref_bf16_patch;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref_bf16_patch;
+// replaces the exact kernels with the ones unrolled for a dim, nullptr if the hooked isa has none
+static void (*specialize_fvec_kernels)(FvecKernels&, size_t) = nullptr;
+
+static FvecKernels
+fvec_kernels_locked(bool bf16_patch, size_t dim) {
+    FvecKernels kernels = hooked_fvec_kernels;
+    if (!bf16_patch) {
+        if (specialize_fvec_kernels != nullptr) {
+            specialize_fvec_kernels(kernels, dim);
+        }
+        return kernels;
+    }
+#if defined(__x86_64__)
+    switch (hooked_fvec_level) {
+        case SimdLevel::AVX512:
+            // Cloud branch
+            kernels.inner_product = fvec_inner_product_avx512_bf16_patch;
+            kernels.L2sqr = fvec_L2sqr_avx512_bf16_patch;
+
+            kernels.inner_product_batch_4 = fvec_inner_product_batch_4_avx512_bf16_patch;
+            kernels.L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512_bf16_patch;
+            break;
+        case SimdLevel::AVX2:
+            kernels.inner_product = fvec_inner_product_avx_bf16_patch;
+            kernels.L2sqr = fvec_L2sqr_avx_bf16_patch;
+
+            kernels.inner_product_batch_4 = fvec_inner_product_batch_4_avx_bf16_patch;
+            kernels.L2sqr_batch_4 = fvec_L2sqr_batch_4_avx_bf16_patch;
+            break;
+        case SimdLevel::SSE4_2:
+            // no patched kernel, the kernels stay exact
+            break;
+        default:
+            kernels.inner_product = fvec_inner_product_ref_bf16_patch;
+            kernels.L2sqr = fvec_L2sqr_ref_bf16_patch;
+
+            kernels.inner_product_batch_4 = fvec_inner_product_batch_4_ref_bf16_patch;
+            kernels.L2sqr_batch_4 = fvec_L2sqr_batch_4_ref_bf16_patch;
+            break;
     }
 #endif
+    return kernels;
 }
 
-void
-disable_patch_for_fp32_bf16() {
+FvecKernels
+fvec_kernels(bool bf16_patch, size_t dim) {
     std::lock_guard<std::mutex> lock(patch_bf16_mutex);
-#if defined(__x86_64__)
-    if (use_avx512 && cpu_support_avx512()) {
-        // Cloud branch
-        fvec_inner_product = fvec_inner_product_avx512;
-        fvec_L2sqr = fvec_L2sqr_avx512;
+    return fvec_kernels_locked(bf16_patch, dim);
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512;
+FvecKernels
+fvec_kernels_for_dim(size_t dim) {
+    FvecKernels kernels = {fvec_L2sqr, fvec_inner_product, fvec_norm_L2sqr, fvec_L2sqr_batch_4,
+                           fvec_inner_product_batch_4};
+    if (!patch_bf16_enabled.load(std::memory_order_relaxed) && specialize_fvec_kernels != nullptr) {
+        specialize_fvec_kernels(kernels, dim);
+    }
+    return kernels;
+}
 
-    } else if (use_avx2 && cpu_support_avx2()) {
-        fvec_inner_product = fvec_inner_product_avx;
-        fvec_L2sqr = fvec_L2sqr_avx;
+static void
+patch_fp32_bf16(bool enabled) {
+    std::lock_guard<std::mutex> lock(patch_bf16_mutex);
+    auto kernels = fvec_kernels_locked(enabled, 0);
+    fvec_inner_product = kernels.inner_product;
+    fvec_L2sqr = kernels.L2sqr;
+    fvec_inner_product_batch_4 = kernels.inner_product_batch_4;
+    fvec_L2sqr_batch_4 = kernels.L2sqr_batch_4;
+    patch_bf16_enabled = enabled;
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx;
+void
+enable_patch_for_fp32_bf16() {
+    patch_fp32_bf16(true);
+}
 
-    } else if (use_sse4_2 && cpu_support_sse4_2()) {
-        // The branch that can't be reached
-    } else {
-        fvec_inner_product = fvec_inner_product_ref;
-        fvec_L2sqr = fvec_L2sqr_ref;
+void
+disable_patch_for_fp32_bf16() {
+    patch_fp32_bf16(false);
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
-    }
-#endif
+bool
+patch_for_fp32_bf16_enabled() {
+    std::lock_guard<std::mutex> lock(patch_bf16_mutex);
+    return patch_bf16_enabled;
 }
 
-void
-fvec_hook(std::string& simd_type) {
-    static std::mutex hook_mutex;
-    std::lock_guard<std::mutex> lock(hook_mutex);
 #if defined(__x86_64__)
-    if (use_avx512 && cpu_support_avx512()) {
-        fvec_inner_product = fvec_inner_product_avx512;
-        fvec_L2sqr = fvec_L2sqr_avx512;
-        fvec_L1 = fvec_L1_avx512;
-        fvec_Linf = fvec_Linf_avx512;
+static void
+hook_fvec_x86(SimdLevel level) {
+    bound_fvec_level = level;
+    switch (level) {
+        case SimdLevel::AVX512:
+            fvec_inner_product = fvec_inner_product_avx512;
+            fvec_L2sqr = fvec_L2sqr_avx512;
+            fvec_L1 = fvec_L1_avx512;
+            fvec_Linf = fvec_Linf_avx512;
+
+            fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
+            // 16 vectors per step in 512-bit registers measured slower than the 8 of the avx2 kernels
+            fvec_L2sqr_ny = fvec_L2sqr_ny_avx;
+            fvec_inner_products_ny = fvec_inner_products_ny_avx;
+            fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_avx512;
+            fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_avx;
+            fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_avx512;
+            fvec_madd = fvec_madd_avx512;
+            fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+
+            fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512;
+            fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512;
+
+            specialize_fvec_kernels = specialize_fvec_kernels_avx512;
+            break;
+        case SimdLevel::AVX2:
+            fvec_inner_product = fvec_inner_product_avx;
+            fvec_L2sqr = fvec_L2sqr_avx;
+            fvec_L1 = fvec_L1_avx;
+            fvec_Linf = fvec_Linf_avx;
+
+            fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
+            fvec_L2sqr_ny = fvec_L2sqr_ny_avx;
+            fvec_inner_products_ny = fvec_inner_products_ny_avx;
+            fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_avx;
+            fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_avx;
+            fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_avx;
+            fvec_madd = fvec_madd_avx;
+            fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+
+            fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx;
+            fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx;
+
+            specialize_fvec_kernels = nullptr;
+            break;
+        case SimdLevel::SSE4_2:
+            fvec_inner_product = fvec_inner_product_sse;
+            fvec_L2sqr = fvec_L2sqr_sse;
+            fvec_L1 = fvec_L1_sse;
+            fvec_Linf = fvec_Linf_sse;
+
+            fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
+            fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
+            fvec_inner_products_ny = fvec_inner_products_ny_sse;
+            fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_ref;
+            fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_ref;
+            fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_ref;
+            fvec_madd = fvec_madd_sse;
+            fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+
+            fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+            fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
+
+            specialize_fvec_kernels = nullptr;
+            break;
+        default:
+            fvec_inner_product = fvec_inner_product_ref;
+            fvec_L2sqr = fvec_L2sqr_ref;
+            fvec_L1 = fvec_L1_ref;
+            fvec_Linf = fvec_Linf_ref;
+
+            fvec_norm_L2sqr = fvec_norm_L2sqr_ref;
+            fvec_L2sqr_ny = fvec_L2sqr_ny_ref;
+            fvec_inner_products_ny = fvec_inner_products_ny_ref;
+            fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_ref;
+            fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_ref;
+            fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_ref;
+            fvec_madd = fvec_madd_ref;
+            fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
+
+            fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
+            fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
+
+            specialize_fvec_kernels = nullptr;
+            break;
+    }
+}
 
-        fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
-        fvec_inner_products_ny = fvec_inner_products_ny_sse;
-        fvec_madd = fvec_madd_avx512;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+static void
+hook_ivec_x86(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            if (cpu_support_avx512_vnni()) {
+                ivec_inner_product = ivec_inner_product_avx512_vnni;
+                ivec_L2sqr = ivec_L2sqr_avx512_vnni;
+            } else if (cpu_support_avx_vnni()) {
+                ivec_inner_product = ivec_inner_product_avx_vnni;
+                ivec_L2sqr = ivec_L2sqr_avx_vnni;
+            } else {
+                ivec_inner_product = ivec_inner_product_avx512;
+                ivec_L2sqr = ivec_L2sqr_avx512;
+            }
+            break;
+        case SimdLevel::AVX2:
+            if (cpu_support_avx_vnni()) {
+                ivec_inner_product = ivec_inner_product_avx_vnni;
+                ivec_L2sqr = ivec_L2sqr_avx_vnni;
+            } else {
+                ivec_inner_product = ivec_inner_product_avx;
+                ivec_L2sqr = ivec_L2sqr_avx;
+            }
+            break;
+        case SimdLevel::SSE4_2:
+            ivec_inner_product = ivec_inner_product_sse;
+            ivec_L2sqr = ivec_L2sqr_sse;
+            break;
+        default:
+            ivec_inner_product = ivec_inner_product_ref;
+            ivec_L2sqr = ivec_L2sqr_ref;
+            break;
+    }
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx512;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx512;
+static void
+hook_half_x86(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            fp16_vec_inner_product = fp16_vec_inner_product_avx512;
+            fp16_vec_L2sqr = fp16_vec_L2sqr_avx512;
+            fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx512;
+
+            bf16_vec_inner_product = bf16_vec_inner_product_avx512;
+            bf16_vec_L2sqr = bf16_vec_L2sqr_avx512;
+            bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx512;
+            break;
+        case SimdLevel::AVX2:
+            fp16_vec_inner_product = fp16_vec_inner_product_avx;
+            fp16_vec_L2sqr = fp16_vec_L2sqr_avx;
+            fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_avx;
+
+            bf16_vec_inner_product = bf16_vec_inner_product_avx;
+            bf16_vec_L2sqr = bf16_vec_L2sqr_avx;
+            bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_avx;
+            break;
+        default:
+            // no sse4.2 kernels
+            fp16_vec_inner_product = fp16_vec_inner_product_ref;
+            fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+            fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+
+            bf16_vec_inner_product = bf16_vec_inner_product_ref;
+            bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+            bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+            break;
+    }
+}
 
-        ivec_inner_product = ivec_inner_product_avx512;
-        ivec_L2sqr = ivec_L2sqr_avx512;
+static void
+hook_bvec_x86(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX512:
+            if (cpu_support_avx512_vpopcntdq()) {
+                bitset_popcount = bitset_popcount_avx512_vpopcntdq;
+                bvec_xor_popcount = bvec_xor_popcount_avx512_vpopcntdq;
+                bvec_and_or_popcount = bvec_and_or_popcount_avx512_vpopcntdq;
+                bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_avx512_vpopcntdq;
+                bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_avx512_vpopcntdq;
+            } else {
+                bitset_popcount = bitset_popcount_avx512;
+                bvec_xor_popcount = bvec_xor_popcount_avx512;
+                bvec_and_or_popcount = bvec_and_or_popcount_avx512;
+                bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_avx512;
+                bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_avx512;
+            }
+            bvec_is_subset = bvec_is_subset_avx512;
+            break;
+        case SimdLevel::AVX2:
+            bitset_popcount = bitset_popcount_avx;
+            bvec_xor_popcount = bvec_xor_popcount_avx;
+            bvec_and_or_popcount = bvec_and_or_popcount_avx;
+            bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_avx;
+            bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_avx;
+            bvec_is_subset = bvec_is_subset_avx;
+            break;
+        case SimdLevel::SSE4_2:
+            bitset_popcount = bitset_popcount_sse;
+            bvec_xor_popcount = bvec_xor_popcount_sse;
+            bvec_and_or_popcount = bvec_and_or_popcount_sse;
+            bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_sse;
+            bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_sse;
+            bvec_is_subset = bvec_is_subset_sse;
+            break;
+        default:
+            bitset_popcount = bitset_popcount_ref;
+            bvec_xor_popcount = bvec_xor_popcount_ref;
+            bvec_and_or_popcount = bvec_and_or_popcount_ref;
+            bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_ref;
+            bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_ref;
+            bvec_is_subset = bvec_is_subset_ref;
+            break;
+    }
+}
 
-        simd_type = "AVX512";
-        support_pq_fast_scan = true;
-    } else if (use_avx2 && cpu_support_avx2()) {
-        fvec_inner_product = fvec_inner_product_avx;
-        fvec_L2sqr = fvec_L2sqr_avx;
-        fvec_L1 = fvec_L1_avx;
-        fvec_Linf = fvec_Linf_avx;
+// binds the kernels of each family at its level, in the order of kKernelFamilies
+static void
+hook_x86(const SimdLevel (&levels)[4], SimdLevel max_level) {
+    hook_fvec_x86(levels[0]);
+    hook_ivec_x86(levels[1]);
+    hook_half_x86(levels[2]);
+    hook_bvec_x86(levels[3]);
+    support_pq_fast_scan = max_level >= SimdLevel::AVX2;
+}
 
-        fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
-        fvec_inner_products_ny = fvec_inner_products_ny_sse;
-        fvec_madd = fvec_madd_avx;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
+namespace {
+
+// the shapes of the benchmark: kBenchNb vectors of each dim compared to the first one. the dims of the binary
+// kernels are in bytes.
+constexpr size_t kBenchNb = 512;
+constexpr size_t kBenchDims[] = {128, 768};
+constexpr size_t kBenchBinaryDims[] = {32, 256};
+constexpr size_t kBenchMaxDim = 768;
+constexpr int kBenchRepeats = 5;
+// a level other than the highest one is only picked if it is faster by this ratio, so that noise does not flip it
+constexpr double kBenchMargin = 1.1;
+
+struct BenchData {
+    std::vector<float> f32;
+    std::vector<int8_t> i8;
+    std::vector<knowhere::fp16> f16;
+    std::vector<knowhere::bf16> b16;
+    std::vector<uint8_t> bin;
+
+    BenchData() {
+        const size_t n = kBenchNb * kBenchMaxDim;
+        f32.resize(n);
+        i8.resize(n);
+        f16.resize(n);
+        b16.resize(n);
+        bin.resize(n);
+        // any deterministic values will do, the kernels do not branch on them
+        uint32_t state = 12345;
+        for (size_t i = 0; i < n; i++) {
+            state = state * 1664525 + 1013904223;
+            float v = (state >> 8) / float(1 << 24) - 0.5f;
+            f32[i] = v;
+            i8[i] = static_cast<int8_t>(state >> 24);
+            f16[i] = v;
+            b16[i] = v;
+            bin[i] = static_cast<uint8_t>(state >> 16);
+        }
+    }
+};
+
+volatile float bench_sink = 0;
+
+// GB read per second by one kernel call per vector of each shape, the best of kBenchRepeats runs
+template <typename T, size_t N, typename Kernel>
+double
+bench_throughput(const T* data, const size_t (&dims)[N], size_t nkernels, Kernel kernel) {
+    double seconds = 0;
+    size_t bytes = 0;
+    for (size_t dim : dims) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < kBenchRepeats; r++) {
+            auto start = std::chrono::steady_clock::now();
+            float acc = 0;
+            for (size_t i = 0; i < kBenchNb; i++) {
+                acc += kernel(data, data + i * dim, dim);
+            }
+            bench_sink = bench_sink + acc;
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        seconds += best;
+        bytes += nkernels * kBenchNb * dim * sizeof(T);
+    }
+    return seconds > 0 ? bytes / seconds / 1e9 : 0;
+}
 
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_avx;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_avx;
+double
+bench_fvec(const BenchData& data) {
+    return bench_throughput(data.f32.data(), kBenchDims, 2, [](const float* x, const float* y, size_t d) {
+        return fvec_L2sqr(x, y, d) + fvec_inner_product(x, y, d);
+    });
+}
 
-        ivec_inner_product = ivec_inner_product_avx;
-        ivec_L2sqr = ivec_L2sqr_avx;
+double
+bench_ivec(const BenchData& data) {
+    return bench_throughput(data.i8.data(), kBenchDims, 2, [](const int8_t* x, const int8_t* y, size_t d) {
+        return float(ivec_L2sqr(x, y, d) + ivec_inner_product(x, y, d));
+    });
+}
 
-        simd_type = "AVX2";
-        support_pq_fast_scan = true;
-    } else if (use_sse4_2 && cpu_support_sse4_2()) {
-        fvec_inner_product = fvec_inner_product_sse;
-        fvec_L2sqr = fvec_L2sqr_sse;
-        fvec_L1 = fvec_L1_sse;
-        fvec_Linf = fvec_Linf_sse;
-
-        fvec_norm_L2sqr = fvec_norm_L2sqr_sse;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_sse;
-        fvec_inner_products_ny = fvec_inner_products_ny_sse;
-        fvec_madd = fvec_madd_sse;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_sse;
-
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
-
-        ivec_inner_product = ivec_inner_product_sse;
-        ivec_L2sqr = ivec_L2sqr_sse;
-
-        simd_type = "SSE4_2";
-        support_pq_fast_scan = false;
-    } else {
-        fvec_inner_product = fvec_inner_product_ref;
-        fvec_L2sqr = fvec_L2sqr_ref;
-        fvec_L1 = fvec_L1_ref;
-        fvec_Linf = fvec_Linf_ref;
-
-        fvec_norm_L2sqr = fvec_norm_L2sqr_ref;
-        fvec_L2sqr_ny = fvec_L2sqr_ny_ref;
-        fvec_inner_products_ny = fvec_inner_products_ny_ref;
-        fvec_madd = fvec_madd_ref;
-        fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
-
-        fvec_inner_product_batch_4 = fvec_inner_product_batch_4_ref;
-        fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_ref;
-
-        ivec_inner_product = ivec_inner_product_ref;
-        ivec_L2sqr = ivec_L2sqr_ref;
-
-        simd_type = "GENERIC";
-        support_pq_fast_scan = false;
-    }
+double
+bench_half(const BenchData& data) {
+    double fp16_gbps =
+        bench_throughput(data.f16.data(), kBenchDims, 2, [](const knowhere::fp16* x, const knowhere::fp16* y, size_t d) {
+            return fp16_vec_L2sqr(x, y, d) + fp16_vec_inner_product(x, y, d);
+        });
+    double bf16_gbps =
+        bench_throughput(data.b16.data(), kBenchDims, 2, [](const knowhere::bf16* x, const knowhere::bf16* y, size_t d) {
+            return bf16_vec_L2sqr(x, y, d) + bf16_vec_inner_product(x, y, d);
+        });
+    return (fp16_gbps + bf16_gbps) / 2;
+}
+
+double
+bench_bvec(const BenchData& data) {
+    return bench_throughput(data.bin.data(), kBenchBinaryDims, 2, [](const uint8_t* x, const uint8_t* y, size_t d) {
+        int count_and, count_or;
+        bvec_and_or_popcount(x, y, d, count_and, count_or);
+        return float(bvec_xor_popcount(x, y, d) + count_and + count_or);
+    });
+}
+
+}  // namespace
+#endif
+
+static void
+fvec_hook_locked(std::string& simd_type) {
+#if defined(__x86_64__)
+    const SimdLevel level = max_simd_level();
+    hook_x86({level, level, level, level}, level);
+    simd_type = simd_level_name(level);
 #endif
 
 #if defined(__ARM_NEON)
@@ -243,12 +631,35 @@ fvec_hook(std::string& simd_type) {
     fvec_norm_L2sqr = fvec_norm_L2sqr_neon;
     fvec_L2sqr_ny = fvec_L2sqr_ny_neon;
     fvec_inner_products_ny = fvec_inner_products_ny_neon;
+    fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_neon;
+    fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_neon;
+    fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_neon;
     fvec_madd = fvec_madd_neon;
     fvec_madd_and_argmin = fvec_madd_and_argmin_neon;
 
+    fvec_inner_product_batch_4 = fvec_inner_product_batch_4_neon;
+    fvec_L2sqr_batch_4 = fvec_L2sqr_batch_4_neon;
+
     ivec_inner_product = ivec_inner_product_neon;
     ivec_L2sqr = ivec_L2sqr_neon;
 
+    bitset_popcount = bitset_popcount_neon;
+    bvec_xor_popcount = bvec_xor_popcount_neon;
+    bvec_and_or_popcount = bvec_and_or_popcount_neon;
+    bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_neon;
+    bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_neon;
+    bvec_is_subset = bvec_is_subset_neon;
+
+    fp16_vec_inner_product = fp16_vec_inner_product_neon;
+    fp16_vec_L2sqr = fp16_vec_L2sqr_neon;
+    fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_neon;
+
+    bf16_vec_inner_product = bf16_vec_inner_product_neon;
+    bf16_vec_L2sqr = bf16_vec_L2sqr_neon;
+    bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_neon;
+
+    specialize_fvec_kernels = nullptr;
+
     simd_type = "NEON";
     support_pq_fast_scan = true;
 
@@ -264,15 +675,106 @@ fvec_hook(std::string& simd_type) {
     fvec_norm_L2sqr = fvec_norm_L2sqr_ref;
     fvec_L2sqr_ny = fvec_L2sqr_ny_ref;
     fvec_inner_products_ny = fvec_inner_products_ny_ref;
+    fvec_L2sqr_ny_transposed = fvec_L2sqr_ny_transposed_ref;
+    fvec_L2sqr_ny_nearest = fvec_L2sqr_ny_nearest_ref;
+    fvec_L2sqr_ny_nearest_y_transposed = fvec_L2sqr_ny_nearest_y_transposed_ref;
     fvec_madd = fvec_madd_ref;
     fvec_madd_and_argmin = fvec_madd_and_argmin_ref;
 
     ivec_inner_product = ivec_inner_product_ref;
     ivec_L2sqr = ivec_L2sqr_ref;
 
+    bitset_popcount = bitset_popcount_ref;
+    bvec_xor_popcount = bvec_xor_popcount_ref;
+    bvec_and_or_popcount = bvec_and_or_popcount_ref;
+    bvec_xor_popcount_batch_4 = bvec_xor_popcount_batch_4_ref;
+    bvec_and_or_popcount_batch_4 = bvec_and_or_popcount_batch_4_ref;
+    bvec_is_subset = bvec_is_subset_ref;
+
+    fp16_vec_inner_product = fp16_vec_inner_product_ref;
+    fp16_vec_L2sqr = fp16_vec_L2sqr_ref;
+    fp16_vec_norm_L2sqr = fp16_vec_norm_L2sqr_ref;
+
+    bf16_vec_inner_product = bf16_vec_inner_product_ref;
+    bf16_vec_L2sqr = bf16_vec_L2sqr_ref;
+    bf16_vec_norm_L2sqr = bf16_vec_norm_L2sqr_ref;
+
+    specialize_fvec_kernels = nullptr;
+
     simd_type = "GENERIC";
     support_pq_fast_scan = false;
 #endif
+
+    hooked_selection.clear();
+    for (const char* family : kKernelFamilies) {
+        hooked_selection.push_back({family, simd_type, 0, {}});
+    }
+}
+
+// the hooks above are exact, the patch has to be enabled again
+static void
+reset_patch_locked() {
+    std::lock_guard<std::mutex> patch_lock(patch_bf16_mutex);
+    hooked_fvec_kernels = {fvec_L2sqr, fvec_inner_product, fvec_norm_L2sqr, fvec_L2sqr_batch_4,
+                           fvec_inner_product_batch_4};
+#if defined(__x86_64__)
+    hooked_fvec_level = bound_fvec_level;
+#endif
+    patch_bf16_enabled = false;
+}
+
+void
+fvec_hook(std::string& simd_type) {
+    std::lock_guard<std::mutex> lock(hook_mutex);
+    fvec_hook_locked(simd_type);
+    reset_patch_locked();
+}
+
+void
+fvec_hook_autotune(std::string& simd_type) {
+    std::lock_guard<std::mutex> lock(hook_mutex);
+#if defined(__x86_64__)
+    const SimdLevel max_level = max_simd_level();
+    const BenchData data;
+    void (*const hooks[])(SimdLevel) = {hook_fvec_x86, hook_ivec_x86, hook_half_x86, hook_bvec_x86};
+    double (*const benches[])(const BenchData&) = {bench_fvec, bench_ivec, bench_half, bench_bvec};
+
+    SimdLevel levels[4];
+    std::vector<SimdKernelSelection> selection;
+    for (size_t f = 0; f < 4; f++) {
+        SimdKernelSelection family_selection{kKernelFamilies[f], "", 0, {}};
+        double max_level_gbps = 0;
+        levels[f] = max_level;
+        for (int l = static_cast<int>(max_level); l >= 0; l--) {
+            auto level = static_cast<SimdLevel>(l);
+            hooks[f](level);
+            double gbps = benches[f](data);
+            family_selection.candidates.emplace_back(simd_level_name(level), gbps);
+            if (level == max_level) {
+                max_level_gbps = gbps;
+                family_selection.gbps = gbps;
+            } else if (gbps > family_selection.gbps && gbps > max_level_gbps * kBenchMargin) {
+                levels[f] = level;
+                family_selection.gbps = gbps;
+            }
+        }
+        family_selection.simd_type = simd_level_name(levels[f]);
+        selection.push_back(std::move(family_selection));
+    }
+    hook_x86(levels, max_level);
+    hooked_selection = std::move(selection);
+    simd_type = simd_level_name(levels[0]);
+#else
+    // a single kernel per family to pick from
+    fvec_hook_locked(simd_type);
+#endif
+    reset_patch_locked();
+}
+
+std::vector<SimdKernelSelection>
+simd_kernel_selection() {
+    std::lock_guard<std::mutex> lock(hook_mutex);
+    return hooked_selection;
 }
 
 static int init_hook_ = []() {
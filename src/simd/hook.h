@@ -13,6 +13,14 @@
 #define HOOK_H
 
 #include <string>
+#include <utility>
+#include <vector>
+
+namespace knowhere {
+struct fp16;
+struct bf16;
+}  // namespace knowhere
+
 namespace faiss {
 
 /// inner product
@@ -30,28 +38,26 @@ extern float (*fvec_Linf)(const float*, const float*, size_t);
 /// squared norm of a vector
 extern float (*fvec_norm_L2sqr)(const float*, size_t);
 
-/// compute ny square L2 distance between x and a set of contiguous y vectors
+/// compute ny square L2 distance between x and a set of contiguous y vectors.
+/// the avx2 and avx512 versions work on batches of 8 y vectors, reading x once per batch
 extern void (*fvec_L2sqr_ny)(float*, const float*, const float*, size_t, size_t);
 
-/// compute the inner product between nx vectors x and one y
+/// compute the inner product between x and a set of contiguous y vectors
 extern void (*fvec_inner_products_ny)(float*, const float*, const float*, size_t, size_t);
 
 /// compute ny square L2 distance between x and a set of transposed contiguous
 /// y vectors. squared lengths of y should be provided as well
-/// todo aguzhva: bring non-ref versions
 extern void (*fvec_L2sqr_ny_transposed)(float*, const float*, const float*, const float*, size_t, size_t, size_t);
 
 /// compute ny square L2 distance between x and a set of contiguous y vectors
 /// and return the index of the nearest vector.
 /// return 0 if ny == 0.
-/// todo aguzhva: bring non-ref versions
 extern size_t (*fvec_L2sqr_ny_nearest)(float*, const float*, const float*, size_t, size_t);
 
 /// compute ny square L2 distance between x and a set of transposed contiguous
 /// y vectors and return the index of the nearest vector.
 /// squared lengths of y should be provided as well
 /// return 0 if ny == 0.
-/// todo aguzhva: bring non-ref versions
 extern size_t (*fvec_L2sqr_ny_nearest_y_transposed)(float*, const float*, const float*, const float*, size_t, size_t,
                                                     size_t);
 
@@ -60,13 +66,11 @@ extern int (*fvec_madd_and_argmin)(size_t, const float*, float, const float*, fl
 
 /// Special version of inner product that computes 4 distances
 /// between x and yi, which is performance oriented.
-/// todo aguzhva: bring non-ref versions
 extern void (*fvec_inner_product_batch_4)(const float*, const float*, const float*, const float*, const float*,
                                           const size_t, float&, float&, float&, float&);
 
 /// Special version of L2sqr that computes 4 distances
 /// between x and yi, which is performance oriented.
-/// todo aguzhva: bring non-ref versions
 extern void (*fvec_L2sqr_batch_4)(const float*, const float*, const float*, const float*, const float*, const size_t,
                                   float&, float&, float&, float&);
 
@@ -74,6 +78,32 @@ extern int32_t (*ivec_inner_product)(const int8_t*, const int8_t*, size_t);
 
 extern int32_t (*ivec_L2sqr)(const int8_t*, const int8_t*, size_t);
 
+// number of set bits in a byte array
+extern size_t (*bitset_popcount)(const uint8_t*, size_t);
+
+/// bit counts of two binary vectors of nbytes bytes: of x ^ y for hamming, of x & y and x | y for jaccard and
+/// tanimoto. bvec_is_subset tells whether the bits of x are a subset of those of y, for substructure and
+/// superstructure.
+extern int (*bvec_xor_popcount)(const uint8_t*, const uint8_t*, size_t);
+extern void (*bvec_and_or_popcount)(const uint8_t*, const uint8_t*, size_t, int&, int&);
+extern bool (*bvec_is_subset)(const uint8_t*, const uint8_t*, size_t);
+
+/// the counts of x against 4 vectors, reading x once
+extern void (*bvec_xor_popcount_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                         const uint8_t*, size_t, int&, int&, int&, int&);
+extern void (*bvec_and_or_popcount_batch_4)(const uint8_t*, const uint8_t*, const uint8_t*, const uint8_t*,
+                                            const uint8_t*, size_t, int*, int*);
+
+/// inner product, squared L2 distance and squared norm of fp16 and bf16 vectors,
+/// which are widened to fp32 in registers and accumulated in fp32
+extern float (*fp16_vec_inner_product)(const knowhere::fp16*, const knowhere::fp16*, size_t);
+extern float (*fp16_vec_L2sqr)(const knowhere::fp16*, const knowhere::fp16*, size_t);
+extern float (*fp16_vec_norm_L2sqr)(const knowhere::fp16*, size_t);
+
+extern float (*bf16_vec_inner_product)(const knowhere::bf16*, const knowhere::bf16*, size_t);
+extern float (*bf16_vec_L2sqr)(const knowhere::bf16*, const knowhere::bf16*, size_t);
+extern float (*bf16_vec_norm_L2sqr)(const knowhere::bf16*, size_t);
+
 #if defined(__x86_64__)
 extern bool use_avx512;
 extern bool use_avx2;
@@ -86,20 +116,71 @@ extern bool support_pq_fast_scan;
 bool
 cpu_support_avx512();
 bool
+cpu_support_avx512_vnni();
+bool
+cpu_support_avx512_vpopcntdq();
+bool
+cpu_support_avx_vnni();
+bool
 cpu_support_avx2();
 bool
 cpu_support_sse4_2();
 #endif
 
+/// the fp32 kernels an index binds once, at build or load, instead of reading the global hooks on each call. so an
+/// index keeps computing as it was bound when the global patch is switched later, and indexes with and without the
+/// bf16 patch can live in one process.
+struct FvecKernels {
+    decltype(fvec_L2sqr) L2sqr;
+    decltype(fvec_inner_product) inner_product;
+    decltype(fvec_norm_L2sqr) norm_L2sqr;
+    decltype(fvec_L2sqr_batch_4) L2sqr_batch_4;
+    decltype(fvec_inner_product_batch_4) inner_product_batch_4;
+};
+
+/// the kernels fvec_hook picked for this cpu, computing fp32 as bf16 if bf16_patch is set and the cpu has a patched
+/// kernel. without the patch, the kernels are the ones unrolled for dim if the cpu has them for it.
+FvecKernels
+fvec_kernels(bool bf16_patch, size_t dim = 0);
+
+/// the kernels of the global hooks, unrolled for dim unless the bf16 patch is enabled. cheap enough to be picked once
+/// per query by the faiss scans.
+FvecKernels
+fvec_kernels_for_dim(size_t dim);
+
+/// enables or disables the bf16 patch of the global hooks, which also becomes the default of the indexes bound
+/// afterwards
 void
 enable_patch_for_fp32_bf16();
 
 void
 disable_patch_for_fp32_bf16();
 
+bool
+patch_for_fp32_bf16_enabled();
+
 void
 fvec_hook(std::string&);
 
+/// the kernels bound for one family, "float", "int8", "fp16/bf16" or "binary", with the throughput in GB/s of each
+/// simd type benchmarked by fvec_hook_autotune. fvec_hook benchmarks nothing and leaves the throughputs at 0.
+struct SimdKernelSelection {
+    std::string family;
+    std::string simd_type;
+    double gbps = 0;
+    std::vector<std::pair<std::string, double>> candidates;
+};
+
+/// like fvec_hook, but benchmarks each family at every simd type up to the one fvec_hook would pick, and binds the
+/// fastest. a lower simd type only wins by a margin, so noise leaves the fvec_hook choice. simd_type is the one of the
+/// float family.
+void
+fvec_hook_autotune(std::string&);
+
+/// the selection of the last fvec_hook or fvec_hook_autotune
+std::vector<SimdKernelSelection>
+simd_kernel_selection();
+
 }  // namespace faiss
 
 #endif /* HOOK_H */
@@ -46,6 +46,19 @@ TEST_CASE("Test Kmeans With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto kmeans_parallel_gen = [&]() {
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::KMEANS_INIT] = "KMEANS||";
+        return json;
+    };
+
+    auto mini_batch_gen = [&]() {
+        knowhere::Json json = base_gen();
+        json[knowhere::indexparam::KMEANS_BATCH_SIZE] = 256;
+        json[knowhere::indexparam::KMEANS_N_ITERS] = 50;
+        return json;
+    };
+
     const auto train_ds = GenDataSet(nb, dim);
     const auto query_ds = GenDataSet(nq, dim);
 
@@ -58,7 +71,9 @@ TEST_CASE("Test Kmeans With Float Vector", "[float metrics]") {
     SECTION("Test Kmeans result") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>(
-            {make_tuple(knowhere::ClusterEnum::CLUSTER_KMEANS, base_gen)}));
+            {make_tuple(knowhere::ClusterEnum::CLUSTER_KMEANS, base_gen),
+             make_tuple(knowhere::ClusterEnum::CLUSTER_KMEANS, kmeans_parallel_gen),
+             make_tuple(knowhere::ClusterEnum::CLUSTER_KMEANS, mini_batch_gen)}));
         auto cluster = knowhere::ClusterFactory::Instance().Create<knowhere::fp32>(name).value();
         auto cfg_json = gen().dump();
         CAPTURE(name, cfg_json);
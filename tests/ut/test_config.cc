@@ -172,6 +172,8 @@ TEST_CASE("Test config json parse", "[config]") {
         CHECK(s == knowhere::Status::success);
         CHECK(train_cfg.metric_type.value() == "L2");
         CHECK(train_cfg.nlist.value() == 128);
+        // faiss keeps its own number of kmeans iterations unless one is given
+        CHECK(train_cfg.kmeans_n_iters.has_value() == false);
 
         knowhere::IvfFlatConfig search_cfg;
         s = knowhere::Config::Load(search_cfg, json, knowhere::SEARCH);
@@ -235,6 +237,8 @@ TEST_CASE("Test config json parse", "[config]") {
         CHECK(train_cfg.metric_type.value() == "L2");
         CHECK(train_cfg.M.value() == 32);
         CHECK(train_cfg.efConstruction.value() == 100);
+        // the fp32 kernels follow the global bf16 patch unless the index is told otherwise
+        CHECK(train_cfg.compute_fp32_as_bf16.has_value() == false);
 
         {
             knowhere::HnswConfig search_cfg;
@@ -48,6 +48,8 @@ constexpr uint32_t kDim = 128;
 constexpr uint32_t kLargeDim = 1536;
 constexpr uint32_t kK = 10;
 constexpr float kKnnRecall = 0.9;
+// a search that stops early gives up some recall for latency
+constexpr float kKnnRecallThreshold = 0.6;
 constexpr float kL2RangeAp = 0.9;
 constexpr float kIpRangeAp = 0.9;
 constexpr float kCosineRangeAp = 0.9;
@@ -293,6 +295,21 @@ base_search() {
                 REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) >= kKnnRecall);
             }
 
+            // knn search that stops once the top-k has not improved for a few rounds
+            for (const int64_t patience : {1, 4}) {
+                CAPTURE(patience);
+                knowhere::Json early_stop_json = knowhere::Json::parse(knn_search_json);
+                early_stop_json["early_stop_patience"] = patience;
+                auto res = diskann.Search(query_ds, early_stop_json, nullptr);
+                REQUIRE(res.has_value());
+                auto ids = res.value()->GetIds();
+                for (uint32_t i = 0; i < kNumQueries * kK; ++i) {
+                    REQUIRE(ids[i] >= 0);
+                    REQUIRE(ids[i] < kNumRows);
+                }
+                REQUIRE(GetKNNRecall(*knn_gt_ptr, *res.value()) > kKnnRecallThreshold);
+            }
+
             // knn search with bitset
             std::vector<std::function<std::vector<uint8_t>(size_t, size_t)>> gen_bitset_funcs = {
                 GenerateBitsetWithFirstTbitsSet, GenerateBitsetWithRandomTbitsSet};
@@ -3,8 +3,12 @@
 #include <catch2/matchers/catch_matchers_floating_point.hpp>
 #include <random>
 
+#include "knowhere/operands.h"
 #include "simd/distances_ref.h"
 #include "simd/hook.h"
+#if defined(__x86_64__)
+#include "simd/distances_avx_vnni.h"
+#endif
 TEST_CASE("Test Distance Compute", "[distance]") {
     std::mt19937 rng;
     std::uniform_int_distribution<> distrib(1, 100000);
@@ -108,4 +112,255 @@ TEST_CASE("Test Distance Compute", "[distance]") {
             }
         }
     }
+
+    SECTION("Test Half Precision Compute") {
+        // lengths that leave every tail of the vectorized loops
+        std::uniform_int_distribution<> len_distrib(1, 1000);
+        std::uniform_real_distribution<float> half_distrib(0.1, 1);
+        auto test_half = [&](auto ip, auto ip_gold, auto l2, auto l2_gold, auto norm, auto norm_gold, auto type) {
+            using T = decltype(type);
+            for (int i = 0; i < 200; ++i) {
+                CAPTURE(i);
+                auto len = len_distrib(rng);
+                std::vector<T> a(len);
+                std::vector<T> b(len);
+                for (int i = 0; i < len; ++i) {
+                    a[i] = half_distrib(rng);
+                    b[i] = half_distrib(rng);
+                }
+                REQUIRE_THAT(ip(a.data(), b.data(), len),
+                             Catch::Matchers::WithinRel(ip_gold(a.data(), b.data(), len), 0.001f));
+                REQUIRE_THAT(l2(a.data(), b.data(), len),
+                             Catch::Matchers::WithinRel(l2_gold(a.data(), b.data(), len), 0.001f));
+                REQUIRE_THAT(norm(a.data(), len), Catch::Matchers::WithinRel(norm_gold(a.data(), len), 0.001f));
+            }
+        };
+        test_half(faiss::fp16_vec_inner_product, faiss::fp16_vec_inner_product_ref, faiss::fp16_vec_L2sqr,
+                  faiss::fp16_vec_L2sqr_ref, faiss::fp16_vec_norm_L2sqr, faiss::fp16_vec_norm_L2sqr_ref,
+                  knowhere::fp16{});
+        test_half(faiss::bf16_vec_inner_product, faiss::bf16_vec_inner_product_ref, faiss::bf16_vec_L2sqr,
+                  faiss::bf16_vec_L2sqr_ref, faiss::bf16_vec_norm_L2sqr, faiss::bf16_vec_norm_L2sqr_ref,
+                  knowhere::bf16{});
+    }
+
+    SECTION("Test Ny Compute") {
+        // dims and counts that leave every tail of the blocked loops
+        std::uniform_int_distribution<> dim_distrib(1, 200);
+        std::uniform_int_distribution<> ny_distrib(1, 300);
+        std::uniform_real_distribution<float> ny_fill_distrib(0, 1);
+        for (int i = 0; i < 200; ++i) {
+            CAPTURE(i);
+            size_t d = dim_distrib(rng);
+            size_t ny = ny_distrib(rng);
+            std::vector<float> x(d);
+            std::vector<float> y(d * ny);
+            for (auto& v : x) {
+                v = ny_fill_distrib(rng);
+            }
+            for (auto& v : y) {
+                v = ny_fill_distrib(rng);
+            }
+            // y read as d rows of ny, the layout of the transposed kernels
+            std::vector<float> y_sqlen(ny);
+            for (size_t k = 0; k < ny; ++k) {
+                for (size_t j = 0; j < d; ++j) {
+                    y_sqlen[k] += y[j * ny + k] * y[j * ny + k];
+                }
+            }
+
+            std::vector<float> dis(ny);
+            std::vector<float> dis_gold(ny);
+            auto check = [&]() {
+                for (size_t k = 0; k < ny; ++k) {
+                    REQUIRE_THAT(dis[k], Catch::Matchers::WithinRel(dis_gold[k], 0.001f));
+                }
+            };
+            faiss::fvec_L2sqr_ny(dis.data(), x.data(), y.data(), d, ny);
+            faiss::fvec_L2sqr_ny_ref(dis_gold.data(), x.data(), y.data(), d, ny);
+            check();
+            faiss::fvec_inner_products_ny(dis.data(), x.data(), y.data(), d, ny);
+            faiss::fvec_inner_products_ny_ref(dis_gold.data(), x.data(), y.data(), d, ny);
+            check();
+            faiss::fvec_L2sqr_ny_transposed(dis.data(), x.data(), y.data(), y_sqlen.data(), d, ny, ny);
+            faiss::fvec_L2sqr_ny_transposed_ref(dis_gold.data(), x.data(), y.data(), y_sqlen.data(), d, ny, ny);
+            check();
+
+            // the kernels round differently, so only a tie may pick another vector
+            auto nearest = faiss::fvec_L2sqr_ny_nearest(dis.data(), x.data(), y.data(), d, ny);
+            auto nearest_gold = faiss::fvec_L2sqr_ny_nearest_ref(dis_gold.data(), x.data(), y.data(), d, ny);
+            REQUIRE_THAT(dis_gold[nearest], Catch::Matchers::WithinRel(dis_gold[nearest_gold], 0.001f));
+            nearest = faiss::fvec_L2sqr_ny_nearest_y_transposed(dis.data(), x.data(), y.data(), y_sqlen.data(), d,
+                                                                ny, ny);
+            nearest_gold = faiss::fvec_L2sqr_ny_nearest_y_transposed_ref(dis_gold.data(), x.data(), y.data(),
+                                                                         y_sqlen.data(), d, ny, ny);
+            REQUIRE_THAT(dis_gold[nearest], Catch::Matchers::WithinRel(dis_gold[nearest_gold], 0.001f));
+
+            if (ny >= 4) {
+                float dis0, dis1, dis2, dis3;
+                faiss::fvec_L2sqr_batch_4(x.data(), y.data(), y.data() + d, y.data() + 2 * d, y.data() + 3 * d, d,
+                                          dis0, dis1, dis2, dis3);
+                faiss::fvec_L2sqr_ny_ref(dis_gold.data(), x.data(), y.data(), d, 4);
+                REQUIRE_THAT(dis0, Catch::Matchers::WithinRel(dis_gold[0], 0.001f));
+                REQUIRE_THAT(dis3, Catch::Matchers::WithinRel(dis_gold[3], 0.001f));
+                faiss::fvec_inner_product_batch_4(x.data(), y.data(), y.data() + d, y.data() + 2 * d,
+                                                  y.data() + 3 * d, d, dis0, dis1, dis2, dis3);
+                faiss::fvec_inner_products_ny_ref(dis_gold.data(), x.data(), y.data(), d, 4);
+                REQUIRE_THAT(dis0, Catch::Matchers::WithinRel(dis_gold[0], 0.001f));
+                REQUIRE_THAT(dis3, Catch::Matchers::WithinRel(dis_gold[3], 0.001f));
+            }
+        }
+    }
+
+    SECTION("Test Int8 Compute") {
+        typedef int32_t (*FUNC)(const int8_t*, const int8_t*, size_t);
+        auto [real_func, gold_func] = GENERATE(table<FUNC, FUNC>({
+            make_tuple(faiss::ivec_inner_product, faiss::ivec_inner_product_ref),
+            make_tuple(faiss::ivec_L2sqr, faiss::ivec_L2sqr_ref),
+        }));
+        std::uniform_int_distribution<> dim_distrib(1, 1000);
+        std::uniform_int_distribution<> int8_distrib(-128, 127);
+        for (int i = 0; i < 1000; ++i) {
+            CAPTURE(i);
+            auto len = dim_distrib(rng);
+            std::vector<int8_t> a(len);
+            std::vector<int8_t> b(len);
+            for (int j = 0; j < len; ++j) {
+                a[j] = int8_distrib(rng);
+                b[j] = int8_distrib(rng);
+            }
+            // the extremes, where the unsigned offset of the vnni kernels is most likely to overflow
+            a[0] = -128;
+            b[0] = i % 2 ? 127 : -128;
+            REQUIRE(real_func(a.data(), b.data(), len) == gold_func(a.data(), b.data(), len));
+        }
+    }
+
+#if defined(__x86_64__)
+    SECTION("Test Int8 Compute AVX-VNNI") {
+        // the hook prefers the avx512 vnni kernels, so the 256-bit ones are checked on their own
+        if (!faiss::cpu_support_avx_vnni()) {
+            return;
+        }
+        typedef int32_t (*FUNC)(const int8_t*, const int8_t*, size_t);
+        auto [real_func, gold_func] = GENERATE(table<FUNC, FUNC>({
+            make_tuple(faiss::ivec_inner_product_avx_vnni, faiss::ivec_inner_product_ref),
+            make_tuple(faiss::ivec_L2sqr_avx_vnni, faiss::ivec_L2sqr_ref),
+        }));
+        std::uniform_int_distribution<> dim_distrib(1, 1000);
+        std::uniform_int_distribution<> int8_distrib(-128, 127);
+        for (int i = 0; i < 1000; ++i) {
+            CAPTURE(i);
+            auto len = dim_distrib(rng);
+            std::vector<int8_t> a(len);
+            std::vector<int8_t> b(len);
+            for (int j = 0; j < len; ++j) {
+                a[j] = int8_distrib(rng);
+                b[j] = int8_distrib(rng);
+            }
+            a[0] = -128;
+            b[0] = i % 2 ? 127 : -128;
+            REQUIRE(real_func(a.data(), b.data(), len) == gold_func(a.data(), b.data(), len));
+        }
+    }
+#endif
+
+    SECTION("Test Bound Kernels") {
+        auto exact = faiss::fvec_kernels(false);
+        auto patched = faiss::fvec_kernels(true);
+        std::vector<float> a(1000);
+        std::vector<float> b(1000);
+        for (size_t i = 0; i < a.size(); ++i) {
+            a[i] = fill_distrib(rng);
+            b[i] = fill_distrib(rng);
+        }
+        REQUIRE_THAT(exact.L2sqr(a.data(), b.data(), a.size()),
+                     Catch::Matchers::WithinRel(faiss::fvec_L2sqr_ref(a.data(), b.data(), a.size()), 0.001f));
+        REQUIRE_THAT(patched.inner_product(a.data(), b.data(), a.size()),
+                     Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(a.data(), b.data(), a.size()), 0.01f));
+
+        // the global patch switches the hooks, not the kernels already bound
+        faiss::enable_patch_for_fp32_bf16();
+        REQUIRE(faiss::patch_for_fp32_bf16_enabled());
+        REQUIRE(faiss::fvec_L2sqr == patched.L2sqr);
+        REQUIRE(faiss::fvec_kernels(false).L2sqr == exact.L2sqr);
+        faiss::disable_patch_for_fp32_bf16();
+        REQUIRE_FALSE(faiss::patch_for_fp32_bf16_enabled());
+        REQUIRE(faiss::fvec_L2sqr == exact.L2sqr);
+        REQUIRE(faiss::fvec_inner_product_batch_4 == exact.inner_product_batch_4);
+    }
+
+    SECTION("Test Dim Kernels") {
+        // the dims with unrolled kernels, and one without
+        for (size_t dim : {128, 384, 512, 768, 1024, 1536, 100}) {
+            CAPTURE(dim);
+            std::vector<float> x(dim);
+            std::vector<float> y(4 * dim);
+            for (auto& v : x) {
+                v = fill_distrib(rng);
+            }
+            for (auto& v : y) {
+                v = fill_distrib(rng);
+            }
+            const float* y0 = y.data();
+            for (auto kernels : {faiss::fvec_kernels(false, dim), faiss::fvec_kernels_for_dim(dim)}) {
+                REQUIRE_THAT(kernels.L2sqr(x.data(), y0, dim),
+                             Catch::Matchers::WithinRel(faiss::fvec_L2sqr_ref(x.data(), y0, dim), 0.001f));
+                REQUIRE_THAT(kernels.inner_product(x.data(), y0, dim),
+                             Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(x.data(), y0, dim), 0.001f));
+                float l2[4], ip[4];
+                kernels.L2sqr_batch_4(x.data(), y0, y0 + dim, y0 + 2 * dim, y0 + 3 * dim, dim, l2[0], l2[1], l2[2],
+                                      l2[3]);
+                kernels.inner_product_batch_4(x.data(), y0, y0 + dim, y0 + 2 * dim, y0 + 3 * dim, dim, ip[0], ip[1],
+                                              ip[2], ip[3]);
+                for (size_t i = 0; i < 4; ++i) {
+                    const float* yi = y0 + i * dim;
+                    REQUIRE_THAT(l2[i], Catch::Matchers::WithinRel(faiss::fvec_L2sqr_ref(x.data(), yi, dim), 0.001f));
+                    REQUIRE_THAT(ip[i],
+                                 Catch::Matchers::WithinRel(faiss::fvec_inner_product_ref(x.data(), yi, dim), 0.001f));
+                }
+            }
+        }
+    }
+
+    SECTION("Test Bit Vector Compute") {
+        std::uniform_int_distribution<> size_distrib(1, 600);
+        std::uniform_int_distribution<> byte_distrib(0, 255);
+        for (int i = 0; i < 1000; ++i) {
+            CAPTURE(i);
+            auto nbytes = size_distrib(rng);
+            // 5 codes, shifted by a byte so the kernels also see unaligned ones
+            std::vector<uint8_t> buf(5 * nbytes + 1);
+            for (auto& v : buf) {
+                v = byte_distrib(rng);
+            }
+            const uint8_t* x = buf.data() + 1;
+            const uint8_t* y[4];
+            for (int t = 0; t < 4; ++t) {
+                y[t] = x + (t + 1) * nbytes;
+            }
+            // a superset of x, so is_subset also gets true cases
+            for (int j = 0; j < nbytes; ++j) {
+                buf[1 + nbytes + j] |= x[j];
+            }
+
+            REQUIRE(faiss::bitset_popcount(x, nbytes) == faiss::bitset_popcount_ref(x, nbytes));
+            int counts[4], and_counts[4], or_counts[4];
+            faiss::bvec_xor_popcount_batch_4(x, y[0], y[1], y[2], y[3], nbytes, counts[0], counts[1], counts[2],
+                                             counts[3]);
+            faiss::bvec_and_or_popcount_batch_4(x, y[0], y[1], y[2], y[3], nbytes, and_counts, or_counts);
+            for (int t = 0; t < 4; ++t) {
+                auto gold_xor = faiss::bvec_xor_popcount_ref(x, y[t], nbytes);
+                int gold_and, gold_or, and_count, or_count;
+                faiss::bvec_and_or_popcount_ref(x, y[t], nbytes, gold_and, gold_or);
+                faiss::bvec_and_or_popcount(x, y[t], nbytes, and_count, or_count);
+                REQUIRE(faiss::bvec_xor_popcount(x, y[t], nbytes) == gold_xor);
+                REQUIRE(counts[t] == gold_xor);
+                REQUIRE(and_count == gold_and);
+                REQUIRE(or_count == gold_or);
+                REQUIRE(and_counts[t] == gold_and);
+                REQUIRE(or_counts[t] == gold_or);
+                REQUIRE(faiss::bvec_is_subset(x, y[t], nbytes) == faiss::bvec_is_subset_ref(x, y[t], nbytes));
+            }
+        }
+    }
 }
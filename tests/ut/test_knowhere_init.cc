@@ -52,6 +52,14 @@ TEST_CASE("Knowhere SIMD config", "[simd]") {
     REQUIRE(s.find(res) != s.end());
     res = knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::GENERIC);
     REQUIRE(s.find(res) != s.end());
+    res = knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO_TUNE);
+    REQUIRE(s.find(res) != s.end());
+    auto infos = knowhere::KnowhereConfig::GetSimdKernelInfo();
+    REQUIRE(infos.size() == 4);
+    for (const auto& info : infos) {
+        REQUIRE(s.find(info.simd_type) != s.end());
+    }
+    REQUIRE(infos[0].simd_type == res);
     res = knowhere::KnowhereConfig::SetSimdType(knowhere::KnowhereConfig::SimdType::AUTO);
     REQUIRE(s.find(res) != s.end());
 }
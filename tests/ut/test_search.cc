@@ -9,15 +9,30 @@
 // is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <thread>
+
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
 #include "catch2/generators/catch_generators.hpp"
+#include "faiss/IndexFlat.h"
+#include "faiss/IndexIVFRaBitQ.h"
+#include "faiss/impl/DistanceComputer.h"
 #include "faiss/utils/binary_distances.h"
 #include "hnswlib/hnswalg.h"
 #include "knowhere/bitsetview.h"
 #include "knowhere/comp/brute_force.h"
+#include "knowhere/comp/cancellation.h"
 #include "knowhere/comp/index_param.h"
 #include "knowhere/comp/knowhere_config.h"
+#include "knowhere/comp/thread_pool.h"
 #include "knowhere/index/index_factory.h"
 #include "knowhere/log.h"
 #include "utils.h"
@@ -25,6 +40,8 @@
 namespace {
 constexpr float kKnnRecallThreshold = 0.6f;
 constexpr float kBruteForceRecallThreshold = 0.95f;
+// 1-bit RaBitQ estimates without re-ranking
+constexpr float kRaBitQRecallThreshold = 0.25f;
 }  // namespace
 
 TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
@@ -54,6 +71,16 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto ivfflat_clustering_gen = [ivfflat_gen]() {
+        knowhere::Json json = ivfflat_gen();
+        json[knowhere::indexparam::CLUSTERING_TYPE] = "K_MEANS_PLUS_PLUS";
+        json[knowhere::indexparam::KMEANS_EARLY_STOP_THRESHOLD] = 1.0;
+        json[knowhere::indexparam::KMEANS_N_ITERS] = 20;
+        json[knowhere::indexparam::MAX_POINTS_PER_CENTROID] = 64;
+        json[knowhere::indexparam::TRAIN_SAMPLE_RATIO] = 0.5;
+        return json;
+    };
+
     auto ivfflatcc_gen = [ivfflat_gen]() {
         knowhere::Json json = ivfflat_gen();
         json[knowhere::indexparam::SSIZE] = 48;
@@ -113,6 +140,44 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto ivfsq4fs_gen = [ivfflat_gen]() {
+        knowhere::Json json = ivfflat_gen();
+        json[knowhere::indexparam::NPROBE] = 14;
+        json[knowhere::indexparam::REORDER_K] = 200;
+        json[knowhere::indexparam::REFINE_TYPE] = "FLAT";
+        return json;
+    };
+
+    auto ivfsq4fs_sq8_gen = [ivfsq4fs_gen]() {
+        knowhere::Json json = ivfsq4fs_gen();
+        json[knowhere::indexparam::REFINE_TYPE] = "SQ8";
+        return json;
+    };
+
+    auto ivfsq4fs_none_gen = [ivfsq4fs_gen]() {
+        knowhere::Json json = ivfsq4fs_gen();
+        json[knowhere::indexparam::REFINE_TYPE] = "NONE";
+        return json;
+    };
+
+    auto ivfrabitq_gen = [ivfflat_gen]() {
+        knowhere::Json json = ivfflat_gen();
+        json[knowhere::indexparam::REFINE_TYPE] = "FLAT";
+        return json;
+    };
+
+    auto ivfrabitq_sq8_gen = [ivfrabitq_gen]() {
+        knowhere::Json json = ivfrabitq_gen();
+        json[knowhere::indexparam::REFINE_TYPE] = "SQ8";
+        return json;
+    };
+
+    auto ivfrabitq_none_gen = [ivfrabitq_gen]() {
+        knowhere::Json json = ivfrabitq_gen();
+        json[knowhere::indexparam::REFINE_TYPE] = "NONE";
+        return json;
+    };
+
     auto hnsw_gen = [base_gen]() {
         knowhere::Json json = base_gen();
         json[knowhere::indexparam::HNSW_M] = 32;
@@ -121,6 +186,25 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         return json;
     };
 
+    auto hnsw_nc_gen = [hnsw_gen]() {
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::indexparam::EMBED_NEIGHBOR_CODES] = true;
+        json[knowhere::indexparam::NEIGHBOR_CODE_M] = 32;
+        return json;
+    };
+
+    auto hnsw_bfs_gen = [hnsw_gen]() {
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::indexparam::GRAPH_REORDER] = "BFS";
+        return json;
+    };
+
+    auto hnsw_rcm_gen = [hnsw_gen]() {
+        knowhere::Json json = hnsw_gen();
+        json[knowhere::indexparam::GRAPH_REORDER] = "RCM";
+        return json;
+    };
+
     const auto train_ds = GenDataSet(nb, dim);
     const auto query_ds = GenDataSet(nq, dim);
 
@@ -135,6 +219,7 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_clustering_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT_CC, ivfflatcc_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
@@ -144,9 +229,19 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC, ivfsqcc_code_size_16_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen2),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_none_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_none_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_nc_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_nc_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_bfs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_rcm_gen),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
         auto cfg_json = gen().dump();
@@ -166,14 +261,27 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         float recall = GetKNNRecall(*gt.value(), *results.value());
         bool scann_without_raw_data =
             (name == knowhere::IndexEnum::INDEX_FAISS_SCANN && scann_gen2().dump() == cfg_json);
-        if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ && !scann_without_raw_data) {
+        bool sq4fs_without_raw_data =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS && ivfsq4fs_gen().dump() != cfg_json);
+        bool sq4fs_without_refine =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS && ivfsq4fs_none_gen().dump() == cfg_json);
+        bool rabitq_without_raw_data =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && ivfrabitq_gen().dump() != cfg_json);
+        bool rabitq_without_refine =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && ivfrabitq_none_gen().dump() == cfg_json);
+        if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ && !scann_without_raw_data && !sq4fs_without_refine &&
+            !rabitq_without_refine) {
             REQUIRE(recall > kKnnRecallThreshold);
         }
+        if (rabitq_without_refine) {
+            REQUIRE(recall > kRaBitQRecallThreshold);
+        }
 
         if (metric == knowhere::metric::COSINE) {
             if (name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ8 && name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ &&
                 name != knowhere::IndexEnum::INDEX_HNSW_SQ8 && name != knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE &&
-                name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && !scann_without_raw_data) {
+                name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && !scann_without_raw_data &&
+                !sq4fs_without_raw_data && !rabitq_without_raw_data) {
                 REQUIRE(CheckDistanceInScope(*results.value(), topk, -1.00001, 1.00001));
             }
         }
@@ -190,6 +298,10 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC, ivfsq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen2),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_sq8_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_gen),
@@ -211,8 +323,13 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         auto lims = results.value()->GetLims();
         bool scann_without_raw_data =
             (name == knowhere::IndexEnum::INDEX_FAISS_SCANN && scann_gen2().dump() == cfg_json);
+        bool sq4fs_without_raw_data =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS && ivfsq4fs_gen().dump() != cfg_json);
+        bool rabitq_without_raw_data =
+            (name == knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ && ivfrabitq_gen().dump() != cfg_json);
         if (name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ && name != knowhere::IndexEnum::INDEX_FAISS_SCANN &&
-            name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC) {
+            name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS &&
+            name != knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ) {
             for (int i = 0; i < nq; ++i) {
                 CHECK(ids[lims[i]] == i);
             }
@@ -221,7 +338,8 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         if (metric == knowhere::metric::COSINE) {
             if (name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ8 && name != knowhere::IndexEnum::INDEX_FAISS_IVFPQ &&
                 name != knowhere::IndexEnum::INDEX_HNSW_SQ8 && name != knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE &&
-                name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && !scann_without_raw_data) {
+                name != knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC && !scann_without_raw_data &&
+                !sq4fs_without_raw_data && !rabitq_without_raw_data) {
                 REQUIRE(CheckDistanceInScope(*results.value(), -1.00001, 1.00001));
             }
         }
@@ -313,6 +431,8 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen, hnswlib::kHnswSearchKnnBFFilterThreshold),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen, hnswlib::kHnswSearchKnnBFFilterThreshold),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_gen, hnswlib::kHnswSearchKnnBFFilterThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_bfs_gen, hnswlib::kHnswSearchKnnBFFilterThreshold),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_rcm_gen, hnswlib::kHnswSearchKnnBFFilterThreshold),
         }));
         auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
         auto cfg_json = gen().dump();
@@ -341,6 +461,340 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         }
     }
 
+    SECTION("Test Search with early stop") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_gen),
+        }));
+        auto patience = GENERATE(as<int64_t>{}, 1, 4);
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json, patience);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        json[knowhere::indexparam::EARLY_STOP_PATIENCE] = patience;
+        auto results = idx.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        auto ids = results.value()->GetIds();
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(ids[i] >= 0);
+            REQUIRE(ids[i] < nb);
+        }
+        REQUIRE(GetKNNRecall(*gt.value(), *results.value()) > kKnnRecallThreshold);
+    }
+
+    SECTION("Test Search with compiled plan") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto plan = idx.CompileSearchPlan(json);
+        REQUIRE(plan.has_value());
+        auto range_plan = idx.CompileSearchPlan(json, knowhere::RANGE_SEARCH);
+        REQUIRE(range_plan.has_value());
+
+        auto expected_res = idx.Search(query_ds, json, nullptr);
+        REQUIRE(expected_res.has_value());
+        for (int i = 0; i < 3; ++i) {
+            auto res = idx.Search(query_ds, *plan.value(), nullptr);
+            REQUIRE(res.has_value());
+            REQUIRE(GetKNNRecall(*expected_res.value(), *res.value()) == 1.0f);
+        }
+        auto expected_range_res = idx.RangeSearch(query_ds, json, nullptr);
+        auto range_res = idx.RangeSearch(query_ds, *range_plan.value(), nullptr);
+        REQUIRE(range_res.has_value());
+        REQUIRE(GetRangeSearchRecall(*expected_range_res.value(), *range_res.value()) == 1.0f);
+
+        // a plan is only accepted by the kind of search and the index type it was compiled for
+        REQUIRE(idx.RangeSearch(query_ds, *plan.value(), nullptr).error() == knowhere::Status::invalid_args);
+        REQUIRE(idx.Search(query_ds, *range_plan.value(), nullptr).error() == knowhere::Status::invalid_args);
+        auto other = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(
+            name == knowhere::IndexEnum::INDEX_HNSW ? knowhere::IndexEnum::INDEX_FAISS_IDMAP
+                                                    : knowhere::IndexEnum::INDEX_HNSW,
+            version).value();
+        REQUIRE(other.Build(train_ds, json) == knowhere::Status::success);
+        REQUIRE(other.Search(query_ds, *plan.value(), nullptr).error() == knowhere::Status::invalid_args);
+        REQUIRE(idx.CompileSearchPlan(json, knowhere::TRAIN).error() == knowhere::Status::invalid_args);
+    }
+
+    SECTION("Test Search with prepared queries") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, ivfpq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto query = idx.PrepareQuery(query_ds, json);
+        REQUIRE(query.has_value());
+        auto expected_res = idx.Search(query_ds, json, nullptr);
+        auto res = idx.Search(*query.value(), json, nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*expected_res.value(), *res.value()) == 1.0f);
+        auto plan = idx.CompileSearchPlan(json);
+        res = idx.Search(*query.value(), *plan.value(), nullptr);
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*expected_res.value(), *res.value()) == 1.0f);
+
+        // a segment trained on other rows recomputes what depends on its own quantizer, hnsw may start the second
+        // search from the entry point cached by the first one
+        auto other = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(other.Build(GenDataSet(nb, dim, 7), json) == knowhere::Status::success);
+        auto other_expected_res = other.Search(query_ds, json, nullptr);
+        auto other_res = other.Search(*query.value(), json, nullptr);
+        REQUIRE(other_res.has_value());
+        REQUIRE(GetKNNRecall(*other_expected_res.value(), *other_res.value()) > kKnnRecallThreshold);
+
+        // prepared queries are only accepted by the index type they were prepared for
+        auto flat = knowhere::IndexFactory::Instance()
+                        .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IDMAP, version)
+                        .value();
+        REQUIRE(flat.Build(train_ds, json) == knowhere::Status::success);
+        REQUIRE(flat.Search(*query.value(), json, nullptr).error() == knowhere::Status::invalid_args);
+    }
+
+    SECTION("Test Search stats") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto res = idx.Search(query_ds, json, nullptr);
+        REQUIRE(res.has_value());
+        auto stats = res.value()->GetSearchStats();
+        REQUIRE(stats.has_value());
+        REQUIRE(stats->distance_computations > 0);
+        REQUIRE(stats->cpu_ms >= 0.0);
+        if (name == knowhere::IndexEnum::INDEX_FAISS_IVFFLAT) {
+            REQUIRE(stats->lists_probed > 0);
+        } else if (name == knowhere::IndexEnum::INDEX_HNSW) {
+            REQUIRE(stats->nodes_visited > 0);
+        }
+
+        auto range_res = idx.RangeSearch(query_ds, json, nullptr);
+        REQUIRE(range_res.has_value());
+        REQUIRE(range_res.value()->GetSearchStats().has_value());
+    }
+
+    SECTION("Test Search with cancellation") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+
+        auto expected_res = idx.Search(query_ds, json, nullptr);
+        REQUIRE(expected_res.has_value());
+
+        // a live token does not change the result, and the deferred search runs on the executor given to it
+        auto token = std::make_shared<knowhere::CancellationToken>();
+        folly::CPUThreadPoolExecutor executor(1);
+        auto res = idx.SearchAsync(query_ds, json, nullptr, token).via(&executor).get();
+        REQUIRE(res.has_value());
+        REQUIRE(GetKNNRecall(*expected_res.value(), *res.value()) == 1.0f);
+
+        token->Cancel();
+        REQUIRE(idx.Search(query_ds, json, nullptr, token).error() == knowhere::Status::search_cancelled);
+        REQUIRE(idx.RangeSearch(query_ds, json, nullptr, token).error() == knowhere::Status::search_cancelled);
+        auto expired = knowhere::CancellationToken::WithTimeout(std::chrono::milliseconds(0));
+        REQUIRE(idx.SearchAsync(query_ds, json, nullptr, expired).via(&executor).get().error() ==
+                knowhere::Status::search_timeout);
+
+        // a token that fires while the search runs stops its loops, flat has none to poll and always runs to the end
+        if (name != knowhere::IndexEnum::INDEX_FAISS_IDMAP) {
+            using Clock = std::chrono::steady_clock;
+            auto large_query_ds = GenDataSet(2000, dim, 7);
+            auto begin = Clock::now();
+            REQUIRE(idx.Search(large_query_ds, json, nullptr).has_value());
+            const auto full = Clock::now() - begin;
+            const auto deadline = std::max(std::chrono::milliseconds(1),
+                                           std::chrono::duration_cast<std::chrono::milliseconds>(full / 10));
+            CAPTURE(std::chrono::duration<double, std::milli>(full).count(), deadline.count());
+
+            begin = Clock::now();
+            auto expiring = knowhere::CancellationToken::WithTimeout(deadline);
+            auto timed_out = idx.Search(large_query_ds, json, nullptr, expiring);
+            REQUIRE(Clock::now() - begin < full);
+            REQUIRE(timed_out.error() == knowhere::Status::search_timeout);
+
+            auto live = std::make_shared<knowhere::CancellationToken>();
+            std::thread canceller([&live, deadline] {
+                std::this_thread::sleep_for(deadline);
+                live->Cancel();
+            });
+            begin = Clock::now();
+            auto cancelled = idx.Search(large_query_ds, json, nullptr, live);
+            const auto elapsed = Clock::now() - begin;
+            canceller.join();
+            REQUIRE(elapsed < full);
+            REQUIRE(cancelled.error() == knowhere::Status::search_cancelled);
+        }
+
+        // the tasks a search pushes to the pool see its token
+        knowhere::ScopedCancellation scope(token.get());
+        auto pool = knowhere::ThreadPool::GetGlobalSearchThreadPool();
+        REQUIRE(pool->push([] { return knowhere::SearchCancelled(); }).get());
+    }
+
+    SECTION("Test Search with allow-list") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_rcm_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        // IVF scores the allowed ids through the direct map made on load
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        REQUIRE(idx.Deserialize(bs, json) == knowhere::Status::success);
+
+        for (const float percentage : {0.5f, 0.98f}) {
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, percentage * nb);
+            knowhere::BitsetView bitset(bitset_data.data(), nb);
+            std::vector<int64_t> allowed;
+            for (int64_t i = 0; i < nb; ++i) {
+                if (!bitset.test(i)) {
+                    allowed.push_back(i);
+                }
+            }
+            auto allow_list = knowhere::BitsetView::FromAllowedIds(allowed.data(), allowed.size(), nb);
+            REQUIRE(allow_list.count() == bitset.get_filtered_out_num_());
+            REQUIRE(allow_list.get_filtered_out_num_() == bitset.get_filtered_out_num_());
+            for (int64_t i = 0; i < nb; ++i) {
+                REQUIRE(allow_list.test(i) == bitset.test(i));
+            }
+
+            auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, bitset);
+            auto gt_allowed = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, allow_list);
+            REQUIRE(GetKNNRecall(*gt.value(), *gt_allowed.value()) == 1.0f);
+
+            // a short allow-list is scanned directly, which is exact
+            auto results = idx.Search(query_ds, json, allow_list);
+            float recall = GetKNNRecall(*gt.value(), *results.value());
+            REQUIRE(recall > (percentage > 0.9f ? kBruteForceRecallThreshold : kKnnRecallThreshold));
+        }
+    }
+
+    SECTION("Test Search with scalar partition") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ8, ivfsq_gen),
+        }));
+        // scalar field 101 takes 8 values, row i has value i % 8, the last rows have no value
+        const int64_t field_id = 101;
+        const uint32_t num_categories = 8;
+        char opt_fields_template[] = "/tmp/knowhere_ut_opt_fields_XXXXXX";
+        int opt_fields_fd = mkstemp(opt_fields_template);
+        REQUIRE(opt_fields_fd != -1);
+        close(opt_fields_fd);
+        const std::string opt_fields_path = opt_fields_template;
+        {
+            std::ofstream writer(opt_fields_path, std::ios::binary);
+            uint8_t version = 0;
+            uint32_t num_fields = 1;
+            writer.write((const char*)&version, sizeof(version));
+            writer.write((const char*)&num_fields, sizeof(num_fields));
+            writer.write((const char*)&field_id, sizeof(field_id));
+            writer.write((const char*)&num_categories, sizeof(num_categories));
+            for (uint32_t c = 0; c < num_categories; ++c) {
+                std::vector<uint32_t> rows;
+                for (uint32_t i = c; i < nb - 10; i += num_categories) {
+                    rows.push_back(i);
+                }
+                uint32_t num_rows = rows.size();
+                writer.write((const char*)&num_rows, sizeof(num_rows));
+                writer.write((const char*)rows.data(), num_rows * sizeof(uint32_t));
+            }
+        }
+
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto partitioned_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(partitioned_idx.IsAdditionalScalarSupported());
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        json[knowhere::meta::MATERIALIZED_VIEW_OPT_FIELDS_PATH] = opt_fields_path;
+        REQUIRE(partitioned_idx.Build(train_ds, json) == knowhere::Status::success);
+
+        knowhere::BinarySet bs;
+        REQUIRE(partitioned_idx.Serialize(bs) == knowhere::Status::success);
+        auto loaded_idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded_idx.Deserialize(bs, json) == knowhere::Status::success);
+
+        // keep the rows with value 3, minus a few deleted ones
+        std::vector<uint8_t> bitset_data(nb / 8, 0xff);
+        for (int64_t i = 3; i < nb - 10; i += num_categories) {
+            if (i % 5 != 0) {
+                bitset_data[i >> 3] &= ~(1 << (i & 0x7));
+            }
+        }
+        knowhere::BitsetView bitset(bitset_data.data(), nb);
+        knowhere::MaterializedViewSearchInfo mv_info;
+        mv_info.field_id_to_touched_categories_cnt[field_id] = 1;
+        json[knowhere::meta::MATERIALIZED_VIEW_SEARCH_INFO] = mv_info;
+
+        auto expected = idx.Search(query_ds, json, bitset);
+        REQUIRE(expected.has_value());
+        for (auto& index : {partitioned_idx, loaded_idx}) {
+            auto results = index.Search(query_ds, json, bitset);
+            REQUIRE(results.has_value());
+            auto ids = results.value()->GetIds();
+            for (int64_t i = 0; i < nq * topk; ++i) {
+                REQUIRE(ids[i] == expected.value()->GetIds()[i]);
+                REQUIRE((ids[i] == -1 || !bitset.test(ids[i])));
+            }
+            auto range_results = index.RangeSearch(query_ds, json, bitset);
+            auto expected_range = idx.RangeSearch(query_ds, json, bitset);
+            REQUIRE(range_results.has_value());
+            REQUIRE(range_results.value()->GetLims()[nq] == expected_range.value()->GetLims()[nq]);
+            // a single query probes fewer rows than the partition has, and scans whole lists
+            auto single_query_ds = knowhere::GenDataSet(1, dim, query_ds->GetTensor());
+            auto single_results = index.Search(single_query_ds, json, bitset);
+            REQUIRE(single_results.has_value());
+            for (int64_t i = 0; i < topk; ++i) {
+                REQUIRE(single_results.value()->GetIds()[i] == expected.value()->GetIds()[i]);
+            }
+        }
+        std::remove(opt_fields_path.c_str());
+    }
+
     SECTION("Test Serialize/Deserialize") {
         using std::make_tuple;
         auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
@@ -352,6 +806,10 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ_CC, ivfsq_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen),
             make_tuple(knowhere::IndexEnum::INDEX_FAISS_SCANN, scann_gen2),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFSQ4_FS, ivfsq4fs_sq8_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFRABITQ, ivfrabitq_sq8_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8, hnsw_gen),
             make_tuple(knowhere::IndexEnum::INDEX_HNSW_SQ8_REFINE, hnsw_gen),
@@ -372,6 +830,35 @@ TEST_CASE("Test Mem Index With Float Vector", "[float metrics]") {
         REQUIRE(results.has_value());
     }
 
+    SECTION("Test Deserialize on a NUMA node") {
+        using std::make_tuple;
+        auto [name, gen] = GENERATE_REF(table<std::string, std::function<knowhere::Json()>>({
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IDMAP, flat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_FAISS_IVFFLAT, ivfflat_gen),
+            make_tuple(knowhere::IndexEnum::INDEX_HNSW, hnsw_gen),
+        }));
+        auto idx = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        auto cfg_json = gen().dump();
+        CAPTURE(name, cfg_json);
+        knowhere::Json json = knowhere::Json::parse(cfg_json);
+        REQUIRE(idx.Build(train_ds, json) == knowhere::Status::success);
+        knowhere::BinarySet bs;
+        REQUIRE(idx.Serialize(bs) == knowhere::Status::success);
+        auto expected = idx.Search(query_ds, json, nullptr);
+        REQUIRE(expected.has_value());
+
+        auto load_json = GENERATE(as<knowhere::Json>{}, knowhere::Json{{"numa_node", 0}},
+                                  knowhere::Json{{"numa_interleave", true}});
+        CAPTURE(load_json.dump());
+        auto loaded = knowhere::IndexFactory::Instance().Create<knowhere::fp32>(name, version).value();
+        REQUIRE(loaded.Deserialize(bs, load_json) == knowhere::Status::success);
+        auto results = loaded.Search(query_ds, json, nullptr);
+        REQUIRE(results.has_value());
+        for (int64_t i = 0; i < nq * topk; ++i) {
+            REQUIRE(results.value()->GetIds()[i] == expected.value()->GetIds()[i]);
+        }
+    }
+
     SECTION("Test IVFPQ with invalid params") {
         auto idx = knowhere::IndexFactory::Instance()
                        .Create<knowhere::fp32>(knowhere::IndexEnum::INDEX_FAISS_IVFPQ, version)
@@ -689,3 +1176,139 @@ TEST_CASE("Test Mem Index With Binary Vector", "[bool metrics]") {
     }
 #endif
 }
+
+TEST_CASE("Test HNSW Two-Hop Filtered Search", "[float metrics]") {
+    const int64_t nb = 10000, nq = 50;
+    const int64_t dim = 16, topk = 10;
+    // a sparse graph and a small ef keep the two-hop walk cheaper than brute force up to 98% filtered
+    const size_t M = 8, ef = 16;
+
+    auto train_ds = GenDataSet(nb, dim);
+    auto query_ds = GenDataSet(nq, dim, kSeed + 1);
+    knowhere::Json json;
+    json[knowhere::meta::DIM] = dim;
+    json[knowhere::meta::METRIC_TYPE] = knowhere::metric::L2;
+    json[knowhere::meta::TOPK] = topk;
+
+    // the index owns its space
+    auto space = new hnswlib::L2Space<knowhere::fp32, float>(dim);
+    hnswlib::HierarchicalNSW<knowhere::fp32, float, hnswlib::QuantType::None> alg(space, nb, M, 100);
+    auto xb = (const float*)train_ds->GetTensor();
+    for (int64_t i = 0; i < nb; ++i) {
+        alg.addPoint(xb + i * dim, i);
+    }
+
+    auto two_hop = GENERATE(true, false);
+    auto percentage = GENERATE(0.8f, 0.9f, 0.95f, 0.98f);
+    CAPTURE(two_hop, percentage);
+    const size_t filtered_num = percentage * nb;
+    auto bitset_data = GenerateBitsetWithRandomTbitsSet(nb, filtered_num);
+    knowhere::BitsetView bitset(bitset_data.data(), nb, filtered_num);
+
+    auto mode = alg.chooseFilteredSearchMode(topk, ef, bitset, two_hop);
+    if (two_hop) {
+        REQUIRE(mode == hnswlib::FilteredSearchMode::TWO_HOP);
+    } else if (percentage >= hnswlib::kHnswSearchKnnBFFilterThreshold) {
+        REQUIRE(mode == hnswlib::FilteredSearchMode::BRUTE_FORCE);
+    } else {
+        REQUIRE(mode == hnswlib::FilteredSearchMode::GRAPH);
+    }
+
+    hnswlib::SearchParam param;
+    param.ef_ = ef;
+    param.for_tuning = false;
+    param.filter_two_hop = two_hop;
+    auto xq = (const float*)query_ds->GetTensor();
+    std::vector<std::vector<int64_t>> results(nq);
+    for (int64_t i = 0; i < nq; ++i) {
+        for (const auto& [dist, id] : alg.searchKnn(xq + i * dim, topk, bitset, &param)) {
+            REQUIRE(!bitset.test(id));
+            results[i].push_back(id);
+        }
+        results[i].resize(topk, -1);
+    }
+    auto gt = knowhere::BruteForce::Search<knowhere::fp32>(train_ds, query_ds, json, bitset);
+    float recall = GetKNNRecall(*gt.value(), results);
+    if (two_hop) {
+        REQUIRE(recall > 0.85f);
+    } else if (mode == hnswlib::FilteredSearchMode::BRUTE_FORCE) {
+        REQUIRE(recall > kBruteForceRecallThreshold);
+    } else {
+        REQUIRE(recall > kKnnRecallThreshold);
+    }
+}
+
+namespace {
+// counts the distances computed on a flat index, as the refine index of IVF_RABITQ
+struct CountingIndexFlat : faiss::IndexFlat {
+    struct CountingDistanceComputer : faiss::DistanceComputer {
+        std::unique_ptr<faiss::DistanceComputer> dc;
+        std::atomic<size_t>* count;
+
+        void
+        set_query(const float* x) override {
+            dc->set_query(x);
+        }
+
+        float
+        operator()(faiss::idx_t i) override {
+            (*count)++;
+            return (*dc)(i);
+        }
+
+        float
+        symmetric_dis(faiss::idx_t i, faiss::idx_t j) override {
+            return dc->symmetric_dis(i, j);
+        }
+    };
+
+    mutable std::atomic<size_t> count{0};
+
+    explicit CountingIndexFlat(faiss::idx_t d) : faiss::IndexFlat(d, faiss::METRIC_L2) {
+    }
+
+    faiss::DistanceComputer*
+    get_distance_computer() const override {
+        auto dc = new CountingDistanceComputer;
+        dc->dc.reset(faiss::IndexFlat::get_distance_computer());
+        dc->count = &count;
+        return dc;
+    }
+};
+}  // namespace
+
+TEST_CASE("Test IVF_RABITQ Bounded Re-rank", "[float metrics]") {
+    const int64_t nb = 5000, nq = 20;
+    const int64_t dim = 32, topk = 10, nlist = 16;
+
+    auto train_ds = GenDataSet(nb, dim);
+    auto query_ds = GenDataSet(nq, dim, kSeed + 1);
+    auto xb = (const float*)train_ds->GetTensor();
+    auto xq = (const float*)query_ds->GetTensor();
+
+    faiss::IndexFlatL2 quantizer(dim);
+    auto refine = new CountingIndexFlat(dim);
+    faiss::IndexIVFRaBitQ index(&quantizer, dim, nlist, faiss::METRIC_L2, refine);
+    index.train(nb, xb);
+    index.add(nb, xb);
+    // every list is probed, so that the exact top-k is reachable
+    index.nprobe = nlist;
+
+    refine->count = 0;
+    std::vector<float> distances(nq * topk);
+    std::vector<faiss::idx_t> ids(nq * topk);
+    index.search(nq, xq, topk, distances.data(), ids.data());
+    size_t reranked = refine->count;
+
+    std::vector<float> gt_distances(nq * topk);
+    std::vector<faiss::idx_t> gt_ids(nq * topk);
+    refine->faiss::IndexFlat::search(nq, xq, topk, gt_distances.data(), gt_ids.data());
+
+    // a candidate is re-ranked only if its lower bound is below the k-th distance so far
+    REQUIRE(reranked >= (size_t)(nq * topk));
+    REQUIRE(reranked < (size_t)(nq * nb / 4));
+    for (int64_t i = 0; i < nq * topk; ++i) {
+        REQUIRE(ids[i] == gt_ids[i]);
+        REQUIRE(distances[i] == Catch::Approx(gt_distances[i]));
+    }
+}
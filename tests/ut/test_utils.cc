@@ -10,11 +10,14 @@
 // or implied. See the License for the specific language governing permissions and limitations under the License.
 
 #include <chrono>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "catch2/catch_approx.hpp"
 #include "catch2/catch_test_macros.hpp"
+#include "knowhere/comp/numa.h"
+#include "knowhere/comp/phase_timer.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/comp/time_recorder.h"
 #include "knowhere/expected.h"
@@ -25,6 +28,24 @@
 
 namespace {
 const std::vector<size_t> kBitsetSizes{4, 8, 10, 64, 100, 500, 1024};
+
+struct RecordingPhaseSink : knowhere::PhaseSink {
+    bool
+    Begin(const knowhere::PhaseSite&) override {
+        return true;
+    }
+
+    void
+    End(const knowhere::PhaseSite& site, double ms, bool span) override {
+        phases.emplace_back(std::string(site.operation) + "/" + site.phase);
+        durations.push_back(ms);
+        spans.push_back(span);
+    }
+
+    std::vector<std::string> phases;
+    std::vector<double> durations;
+    std::vector<bool> spans;
+};
 }
 
 TEST_CASE("Test Vector Normalization", "[normalize]") {
@@ -81,6 +102,59 @@ TEST_CASE("Test Bitset Generation", "[utils]") {
             }
         }
     }
+
+    SECTION("Word") {
+        for (const auto size : kBitsetSizes) {
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, size / 2);
+            knowhere::BitsetView bitset(bitset_data.data(), size);
+            std::vector<int64_t> ids(size);
+            for (size_t j = 0; j < size; ++j) {
+                ids[j] = size - 1 - j;
+            }
+            for (size_t offset = 0; offset < size + 64; offset += 64) {
+                const uint64_t word = bitset.test_word(offset);
+                for (size_t j = 0; j < 64; ++j) {
+                    REQUIRE(bool((word >> j) & 1) == bitset.test(offset + j));
+                }
+                if (offset < size) {
+                    const size_t n = std::min<size_t>(64, size - offset);
+                    const uint64_t gathered = bitset.test_ids(ids.data() + offset, n);
+                    for (size_t j = 0; j < n; ++j) {
+                        REQUIRE(bool((gathered >> j) & 1) == bitset.test(ids[offset + j]));
+                    }
+                }
+            }
+        }
+    }
+
+    SECTION("Word With Allowed Ids") {
+        for (const auto size : kBitsetSizes) {
+            auto bitset_data = GenerateBitsetWithRandomTbitsSet(size, size / 2);
+            knowhere::BitsetView bitmap(bitset_data.data(), size);
+            // the ids that pass the bitmap in even blocks of 64, odd blocks have no allowed id
+            std::vector<int64_t> allowed_ids;
+            for (size_t j = 0; j < size; ++j) {
+                if ((j / 64) % 2 == 0 && !bitmap.test(j)) {
+                    allowed_ids.push_back(j);
+                }
+            }
+            auto bitset = knowhere::BitsetView::FromAllowedIds(allowed_ids.data(), allowed_ids.size(), size);
+            REQUIRE(bitset.data() == nullptr);
+            // words at half blocks overlap an allowed block and an empty one
+            for (size_t offset = 0; offset < size + 64; offset += 32) {
+                const uint64_t word = bitset.test_word(offset);
+                for (size_t j = 0; j < 64; ++j) {
+                    const size_t id = offset + j;
+                    const bool filtered = id >= size || (id / 64) % 2 == 1 || bitmap.test(id);
+                    REQUIRE(bool((word >> j) & 1) == filtered);
+                    REQUIRE(bool((word >> j) & 1) == bitset.test(id));
+                }
+                if (offset % 64 == 0 && (offset / 64) % 2 == 1) {
+                    REQUIRE(word == ~uint64_t(0));
+                }
+            }
+        }
+    }
 }
 
 namespace {
@@ -212,3 +286,100 @@ TEST_CASE("Test WaitAllSuccess with knowhere::Status futures") {
         REQUIRE_THROWS_AS(knowhere::WaitAllSuccess(futures), std::runtime_error);
     }
 }
+
+TEST_CASE("Test FairTaskQueue order") {
+    knowhere::FairTaskQueue queue;
+    std::string order;
+    auto push = [&](int32_t priority, const std::string& group, int32_t weight, char tag) {
+        knowhere::TaskSchedule schedule;
+        schedule.priority = priority;
+        schedule.group = group;
+        schedule.weight = weight;
+        queue.Push(&schedule, [&order, tag]() { order += tag; });
+    };
+
+    SECTION("Groups take turns") {
+        // a small request queued behind a large batch runs right after the first task of the batch
+        for (int i = 0; i < 4; ++i) {
+            push(knowhere::TaskSchedule::NORMAL, "batch", 1, 'a');
+        }
+        push(knowhere::TaskSchedule::NORMAL, "small", 1, 'b');
+        push(knowhere::TaskSchedule::NORMAL, "small", 1, 'b');
+        while (auto task = queue.Pop()) {
+            task();
+        }
+        REQUIRE(order == "ababaa");
+    }
+
+    SECTION("Weights and priorities") {
+        for (int i = 0; i < 4; ++i) {
+            push(knowhere::TaskSchedule::NORMAL, "heavy", 3, 'h');
+            push(knowhere::TaskSchedule::NORMAL, "light", 1, 'l');
+        }
+        push(knowhere::TaskSchedule::LOW, "background", 1, 'z');
+        push(knowhere::TaskSchedule::HIGH, "interactive", 1, 'i');
+        REQUIRE(queue.Size() == 10);
+        while (auto task = queue.Pop()) {
+            task();
+        }
+        REQUIRE(order == "ihhhlhlllz");
+        REQUIRE(queue.Size() == 0);
+    }
+}
+
+TEST_CASE("Test NUMA helpers") {
+    REQUIRE(knowhere::numa::NumNodes() >= 1);
+    REQUIRE(knowhere::numa::ParseList("0-3,8,10-11") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    REQUIRE(knowhere::numa::ParseList("0") == std::vector<int>{0});
+    REQUIRE(knowhere::numa::ParseList("").empty());
+    REQUIRE(knowhere::numa::ParseList("a-b").empty());
+
+    // a node without NUMA pools searches on the global pool
+    REQUIRE(knowhere::ThreadPool::GetNumaSearchThreadPool(knowhere::numa::NumNodes()) ==
+            knowhere::ThreadPool::GetGlobalSearchThreadPool());
+}
+
+TEST_CASE("Test NUMA memory policy") {
+    const int node = knowhere::numa::NumNodes() - 1;
+    const size_t size = 4 << 20;
+    {
+        knowhere::numa::ScopedMemoryPolicy policy(node);
+        // large enough to be a fresh mapping, whose pages are faulted in under the policy
+        std::vector<char> block(size, 1);
+        if (policy.Applied()) {
+            REQUIRE(knowhere::numa::NodeOfAddress(block.data() + size / 2) == node);
+        }
+    }
+    {
+        knowhere::numa::ScopedMemoryPolicy policy;
+        std::vector<char> block(size, 1);
+        if (policy.Applied()) {
+            REQUIRE(knowhere::numa::NodeOfAddress(block.data() + size / 2) >= 0);
+        }
+    }
+    // an invalid node leaves the thread as it was
+    knowhere::numa::ScopedMemoryPolicy policy(-1);
+    REQUIRE(!policy.Applied());
+}
+
+TEST_CASE("Test phase timer") {
+    RecordingPhaseSink sink;
+    auto prev = knowhere::PhaseSink::Get();
+    knowhere::PhaseSink::Set(&sink);
+    {
+        KNOWHERE_SCOPED_PHASE("search", "scoped");
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    KNOWHERE_OBSERVE_PHASE("search", "observed", 1.5);
+    knowhere::PhaseSink::Set(prev);
+
+#ifdef KNOWHERE_WITH_PHASE_PROFILING
+    REQUIRE(sink.phases == std::vector<std::string>{"search/scoped", "search/observed"});
+    REQUIRE(sink.durations[0] >= 2.0);
+    REQUIRE(sink.durations[1] == 1.5);
+    // an observed phase was timed elsewhere and never opens a span
+    REQUIRE(sink.spans == std::vector<bool>{true, false});
+#else
+    REQUIRE(sink.phases.empty());
+#endif
+}
@@ -52,11 +52,55 @@ namespace diskann {
     }
   }
 
+  template<>
+  DISTFUN<knowhere::fp16> get_distance_function(diskann::Metric m) {
+    if (m == diskann::Metric::L2) {
+      return faiss::fp16_vec_L2sqr;
+    } else if (m == diskann::Metric::INNER_PRODUCT ||
+               m == diskann::Metric::COSINE) {
+      return [](const knowhere::fp16* x, const knowhere::fp16* y,
+                size_t size) -> float {
+        return (-1.0) * faiss::fp16_vec_inner_product(x, y, size);
+      };
+    } else {
+      std::stringstream stream;
+      stream << "Only L2, cosine, and inner product supported for fp16 "
+                "vectors as of now. ";
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+  }
+
+  template<>
+  DISTFUN<knowhere::bf16> get_distance_function(diskann::Metric m) {
+    if (m == diskann::Metric::L2) {
+      return faiss::bf16_vec_L2sqr;
+    } else if (m == diskann::Metric::INNER_PRODUCT ||
+               m == diskann::Metric::COSINE) {
+      return [](const knowhere::bf16* x, const knowhere::bf16* y,
+                size_t size) -> float {
+        return (-1.0) * faiss::bf16_vec_inner_product(x, y, size);
+      };
+    } else {
+      std::stringstream stream;
+      stream << "Only L2, cosine, and inner product supported for bf16 "
+                "vectors as of now. ";
+      LOG(ERROR) << stream.str();
+      throw diskann::ANNException(stream.str(), -1, __FUNCSIG__, __FILE__,
+                                  __LINE__);
+    }
+  }
+
   // get vector sqr norm
   template<typename T>
   float norm_l2sqr(const T* a, size_t size) {
     if constexpr (std::is_floating_point<T>::value) {
       return faiss::fvec_norm_L2sqr(a, size);
+    } else if constexpr (std::is_same_v<T, knowhere::fp16>) {
+      return faiss::fp16_vec_norm_L2sqr(a, size);
+    } else if constexpr (std::is_same_v<T, knowhere::bf16>) {
+      return faiss::bf16_vec_norm_L2sqr(a, size);
     } else {
       float res = 0;
       for (size_t i = 0; i < size; i++) {
@@ -20,6 +20,7 @@
 #include "diskann/aux_utils.h"
 #include "diskann/timer.h"
 #include "diskann/utils.h"
+#include "knowhere/comp/cancellation.h"
 #include "knowhere/comp/thread_pool.h"
 #include "knowhere/heap.h"
 #include "knowhere/prometheus_client.h"
@@ -947,7 +948,7 @@ namespace diskann {
       float *distances, const _u64 beam_width, const bool use_reorder_data,
       QueryStats *stats, const knowhere::feder::diskann::FederResultUniq &feder,
       knowhere::BitsetView bitset_view, const float filter_ratio_in,
-      const bool for_tuning) {
+      const bool for_tuning, const _u64 early_stop_patience) {
     if (beam_width > MAX_N_SECTOR_READS)
       throw ANNException("Beamwidth can not be higher than MAX_N_SECTOR_READS",
                          -1, __FUNCSIG__, __FILE__, __LINE__);
@@ -1085,6 +1086,10 @@ namespace diskann {
     unsigned num_ios = 0;
     unsigned k = 0;
 
+    // adaptive termination: rounds since the k-th candidate last moved closer
+    float topk_dist = (std::numeric_limits<float>::max)();
+    _u64  stale_rounds = 0;
+
     float                 accumulative_alpha = 0;
     std::vector<unsigned> filtered_nbrs;
     filtered_nbrs.reserve(this->max_degree);
@@ -1111,6 +1116,11 @@ namespace diskann {
     };
 
     while (k < cur_list_size) {
+      // each beam costs a round of disk reads, stop issuing them once the
+      // query is abandoned
+      if (knowhere::SearchCancelled()) {
+        break;
+      }
       auto nk = cur_list_size;
       // clear iteration state
       frontier.clear();
@@ -1287,6 +1297,18 @@ namespace diskann {
         ++k;
 
       hops++;
+
+      // the results come from full_retset, so only stop once it holds k
+      if (early_stop_patience > 0 && cur_list_size >= k_search &&
+          full_retset.size() >= k_search) {
+        float dist = retset[k_search - 1].distance;
+        if (dist < topk_dist) {
+          topk_dist = dist;
+          stale_rounds = 0;
+        } else if (++stale_rounds >= early_stop_patience) {
+          break;
+        }
+      }
     }
 
     // re-sort by distance
@@ -1423,7 +1445,7 @@ namespace diskann {
           res_count = l_search;
         }
       }
-      if (res_count < (_u32) (l_search / 2.0))
+      if (res_count < (_u32) (l_search / 2.0) || knowhere::SearchCancelled())
         stop_flag = true;
       l_search = l_search * 2;
       if (l_search > max_l_search)
@@ -504,6 +504,13 @@ void Clustering::train_encoded(
     // temporary buffer to decode vectors during the optimization
     std::vector<float> decode_buffer(codec ? d * decode_block_size : 0);
 
+    const ClusteringType type = clustering_type_override >= 0
+            ? static_cast<ClusteringType>(clustering_type_override)
+            : clustering_type;
+    const double stop_threshold = early_stop_threshold_override >= 0
+            ? early_stop_threshold_override
+            : early_stop_threshold;
+
     for (int redo = 0; redo < nredo; redo++) {
         if (verbose && nredo > 1) {
             printf("Outer iteration %d / %d\n", redo, nredo);
@@ -513,14 +520,14 @@ void Clustering::train_encoded(
             int64_t random_seed = seed + 1 + redo * 15486557L;
             std::vector<int> centroids_index(nx);
 
-            if (ClusteringType::K_MEANS == clustering_type) {
+            if (ClusteringType::K_MEANS == type) {
                 //Use classic kmeans algorithm
                 kmeans_algorithm(centroids_index, random_seed, n_input_centroids, d, k, nx, x_in);
-            } else if (ClusteringType::K_MEANS_PLUS_PLUS == clustering_type) {
+            } else if (ClusteringType::K_MEANS_PLUS_PLUS == type) {
                 //Use kmeans++ algorithm
                 kmeans_plus_plus_algorithm(centroids_index, random_seed, n_input_centroids, d, k, nx, x_in);
             } else {
-                FAISS_THROW_FMT ("Clustering Type is knonws: %d", (int)clustering_type);
+                FAISS_THROW_FMT ("Clustering Type is knonws: %d", (int)type);
             }
 
             centroids.resize(d * k);
@@ -646,7 +653,7 @@ void Clustering::train_encoded(
             float diff = (prev_objective == 0) ? std::numeric_limits<float>::max()
                                                : (prev_objective - stats.obj) / prev_objective;
             prev_objective = stats.obj;
-            if (diff < early_stop_threshold / 100.) {
+            if (diff < stop_threshold / 100.) {
                 break;
             }
 
@@ -62,6 +62,13 @@ struct ClusteringParameters {
     /// seed for the random number generator
     int seed = 1234;
 
+    /// clustering type of this run, a negative value falls back to the
+    /// process-wide faiss::clustering_type
+    int clustering_type_override = -1;
+    /// early stop threshold (in percent) of this run, a negative value falls
+    /// back to the process-wide faiss::early_stop_threshold
+    double early_stop_threshold_override = -1.0;
+
     /// when the training set is encoded, batch size of the codec decoder
     size_t decode_block_size = 32768;
 };
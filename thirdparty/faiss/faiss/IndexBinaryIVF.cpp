@@ -25,8 +25,25 @@
 #include <faiss/utils/sorting.h>
 #include <faiss/utils/utils.h>
 
+#include "knowhere/comp/phase_timer.h"
+#include "knowhere/comp/search_stats.h"
+
 namespace faiss {
 
+namespace {
+
+// Reports the work of a search to the knowhere request running on this
+// thread, if it collects stats.
+void add_search_stats(size_t ncentroids, size_t nlistv, size_t ndis) {
+    knowhere::SearchStats stats;
+    stats.distance_computations = ncentroids + ndis;
+    stats.lists_probed = nlistv;
+    stats.codes_scanned = ndis;
+    knowhere::AddSearchStats(stats);
+}
+
+} // namespace
+
 IndexBinaryIVF::IndexBinaryIVF(IndexBinary* quantizer, size_t d, size_t nlist)
         : IndexBinary(d),
           invlists(new ArrayInvertedLists(nlist, code_size)),
@@ -153,7 +170,10 @@ void IndexBinaryIVF::search(
             coarse_dis.get(),
             idx.get(),
             quantizer_params);
-    indexIVF_stats.quantization_time += getmillisecs() - t0;
+    double t1 = getmillisecs();
+    indexIVF_stats.quantization_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("search", "ivf_coarse_assign", t1 - t0);
+    add_search_stats(n * nlist, 0, 0);
 
     t0 = getmillisecs();
     invlists->prefetch_lists(idx.get(), n * nprobe_2);
@@ -169,7 +189,9 @@ void IndexBinaryIVF::search(
             false,
             params,
             &indexIVF_stats);
-    indexIVF_stats.search_time += getmillisecs() - t0;
+    t1 = getmillisecs();
+    indexIVF_stats.search_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("search", "ivf_scan_lists", t1 - t0);
 }
 
 void IndexBinaryIVF::reconstruct(idx_t key, uint8_t* recons) const {
@@ -395,17 +417,21 @@ struct IVFBinaryScannerL2 : BinaryInvertedListScanner {
         using C = CMax<int32_t, idx_t>;
 
         size_t nup = 0;
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                auto dis = hc.compute(codes);
-                if (dis < simi[0]) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    heap_replace_top<C>(k, simi, idxi, dis, id);
-                    nup++;
-                }
-            }
-            codes += code_size;
-        }
+        scan_codes_distances(
+                hc,
+                n,
+                codes,
+                code_size,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, int32_t dis) {
+                    if (dis < simi[0]) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        heap_replace_top<C>(k, simi, idxi, dis, id);
+                        nup++;
+                    }
+                });
         return nup;
     }
 
@@ -415,16 +441,21 @@ struct IVFBinaryScannerL2 : BinaryInvertedListScanner {
             const idx_t* __restrict ids,
             float radius,
             RangeQueryResult& result) const override {
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                auto dis = hc.compute(codes);
-                if (dis < radius) {
-                    int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    result.add(dis, id);
-                }
-            }
-            codes += code_size;
-        }
+        scan_codes_distances(
+                hc,
+                n,
+                codes,
+                code_size,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, int32_t dis) {
+                    if (dis < radius) {
+                        int64_t id =
+                                store_pairs ? lo_build(list_no, j) : ids[j];
+                        result.add(dis, id);
+                    }
+                });
     }
 };
 
@@ -461,17 +492,21 @@ struct IVFBinaryScannerJaccard : BinaryInvertedListScanner {
         // todo aguzhva: this is a dirty hack in the baseline
         float* psimi = (float*)simi;
         size_t nup = 0;
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                float dis = hc.compute(codes);
-                if (dis < psimi[0]) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    heap_replace_top<C>(k, psimi, idxi, dis, id);
-                    nup++;
-                }
-            }
-            codes += code_size;
-        }
+        scan_codes_distances(
+                hc,
+                n,
+                codes,
+                code_size,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, float dis) {
+                    if (dis < psimi[0]) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        heap_replace_top<C>(k, psimi, idxi, dis, id);
+                        nup++;
+                    }
+                });
         return nup;
     }
 
@@ -481,16 +516,20 @@ struct IVFBinaryScannerJaccard : BinaryInvertedListScanner {
             const idx_t* ids,
             float radius,
             RangeQueryResult& result) const override {
-        for (size_t j = 0; j < n; j++) {
-            if (!this->sel || this->sel->is_member(ids[j])) {
-                float dis = hc.compute(codes);
-                if (dis < radius) {
-                    idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
-                    result.add(dis, id);
-                }
-            }
-            codes += code_size;
-        }
+        scan_codes_distances(
+                hc,
+                n,
+                codes,
+                code_size,
+                [&](size_t j) {
+                    return !this->sel || this->sel->is_member(ids[j]);
+                },
+                [&](size_t j, float dis) {
+                    if (dis < radius) {
+                        idx_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                        result.add(dis, id);
+                    }
+                });
     }
 };
 
@@ -591,6 +630,7 @@ void search_knn_hamming_heap(
     indexIVF_stats.nlist += nlistv;
     indexIVF_stats.ndis += ndis;
     indexIVF_stats.nheap_updates += nheap;
+    add_search_stats(0, nlistv, ndis);
 }
 
 void search_knn_binary_dis_heap(
@@ -684,6 +724,7 @@ void search_knn_binary_dis_heap(
     indexIVF_stats.nlist += nlistv;
     indexIVF_stats.ndis += ndis;
     indexIVF_stats.nheap_updates += nheap;
+    add_search_stats(0, nlistv, ndis);
 }
 
 template <class HammingComputer, bool store_pairs>
@@ -781,6 +822,7 @@ void search_knn_hamming_count(
     indexIVF_stats.nq += nx;
     indexIVF_stats.nlist += nlistv;
     indexIVF_stats.ndis += ndis;
+    add_search_stats(0, nlistv, ndis);
 }
 
 /* Manages NQ queries at a time, stores results */
@@ -999,10 +1041,6 @@ BinaryInvertedListScanner* select_IVFBinaryScannerJaccard(
     switch (code_size) {
         HANDLE_CS(16)
         HANDLE_CS(32)
-        HANDLE_CS(64)
-        HANDLE_CS(128)
-        HANDLE_CS(256)
-        HANDLE_CS(512)
         default:
             return new IVFBinaryScannerJaccard<
                     JaccardComputerDefault>(code_size, store_pairs, sel);
@@ -1115,7 +1153,10 @@ void IndexBinaryIVF::range_search(
     double t0 = getmillisecs();
     quantizer->search(
             n, x, nprobe_2, coarse_dis.get(), idx.get(), quantizer_params);
-    indexIVF_stats.quantization_time += getmillisecs() - t0;
+    double t1 = getmillisecs();
+    indexIVF_stats.quantization_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("range_search", "ivf_coarse_assign", t1 - t0);
+    add_search_stats(n * nlist, 0, 0);
 
     t0 = getmillisecs();
     invlists->prefetch_lists(idx.get(), n * nprobe_2);
@@ -1130,7 +1171,9 @@ void IndexBinaryIVF::range_search(
             params, 
             &indexIVF_stats);
 
-    indexIVF_stats.search_time += getmillisecs() - t0;
+    t1 = getmillisecs();
+    indexIVF_stats.search_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("range_search", "ivf_scan_lists", t1 - t0);
 }
 
 void IndexBinaryIVF::range_search_preassigned(
@@ -1228,6 +1271,7 @@ void IndexBinaryIVF::range_search_preassigned(
     indexIVF_stats.nq += n;
     indexIVF_stats.nlist += nlistv;
     indexIVF_stats.ndis += ndis;
+    add_search_stats(0, nlistv, ndis);
 }
 
 IndexBinaryIVF::~IndexBinaryIVF() {
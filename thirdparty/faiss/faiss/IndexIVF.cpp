@@ -26,9 +26,14 @@
 #include <faiss/IndexFlat.h>
 #include <faiss/impl/AuxIndexStructures.h>
 #include <faiss/impl/CodePacker.h>
+#include <faiss/impl/DistanceComputer.h>
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/impl/IDSelector.h>
 
+#include "knowhere/bitsetview_idselector.h"
+#include "knowhere/comp/cancellation.h"
+#include "knowhere/comp/phase_timer.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/object.h"
 
 namespace faiss {
@@ -36,6 +41,85 @@ namespace faiss {
 using ScopedIds = InvertedLists::ScopedIds;
 using ScopedCodes = InvertedLists::ScopedCodes;
 
+namespace {
+
+// Reports the work of a search to the knowhere request running on this
+// thread, if it collects stats.
+void add_search_stats(size_t ncentroids, size_t nlistv, size_t ndis) {
+    knowhere::SearchStats stats;
+    stats.distance_computations = ncentroids + ndis;
+    stats.lists_probed = nlistv;
+    stats.codes_scanned = ndis;
+    knowhere::AddSearchStats(stats);
+}
+
+// Offset of the first of ids[begin, end) that sel accepts, end if none. A
+// bitset selector is tested 64 ids at a time.
+size_t first_selected(
+        const IDSelector* sel,
+        const knowhere::BitsetViewIDSelector* bitset_sel,
+        const idx_t* ids,
+        size_t begin,
+        size_t end) {
+    if (bitset_sel == nullptr) {
+        while (begin < end && !sel->is_member(ids[begin])) {
+            begin++;
+        }
+        return begin;
+    }
+    while (begin < end) {
+        size_t n = std::min<size_t>(64, end - begin);
+        uint64_t selected = ~bitset_sel->bitset_view.test_ids(ids + begin, n);
+        if (n < 64) {
+            selected &= (uint64_t(1) << n) - 1;
+        }
+        if (selected != 0) {
+            return begin + __builtin_ctzll(selected);
+        }
+        begin += n;
+    }
+    return end;
+}
+
+// Calls scan(begin, size) for the parts of a list segment that are covered by
+// the requested list ranges, with offsets relative to the segment start. The
+// whole segment is scanned when no ranges are given. With a selector and the
+// ids of the segment, the leading entries of a range that the selector
+// rejects are skipped, so a range none of which is selected is dropped
+// without computing any distance.
+template <class ScanFunc>
+void scan_segment_ranges(
+        const IVFListRanges* list_ranges,
+        idx_t key,
+        size_t segment_offset,
+        size_t segment_size,
+        const IDSelector* sel,
+        const idx_t* ids,
+        ScanFunc&& scan) {
+    if (list_ranges == nullptr) {
+        scan(0, segment_size);
+        return;
+    }
+    auto bitset_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel);
+    for (const auto& range : (*list_ranges)[key]) {
+        size_t begin = std::max(range.first, segment_offset);
+        size_t end = std::min(range.second, segment_offset + segment_size);
+        if (begin >= end) {
+            continue;
+        }
+        begin -= segment_offset;
+        end -= segment_offset;
+        if (sel != nullptr && ids != nullptr) {
+            begin = first_selected(sel, bitset_sel, ids, begin, end);
+        }
+        if (begin < end) {
+            scan(begin, end - begin);
+        }
+    }
+}
+
+} // namespace
+
 /*****************************************
  * Level1Quantizer implementation
  ******************************************/
@@ -326,6 +410,7 @@ void IndexIVF::search(
     const size_t nprobe =
             std::min(nlist, params ? params->nprobe : this->nprobe);
     FAISS_THROW_IF_NOT(nprobe > 0);
+    add_search_stats(n * nlist, 0, 0);
 
     // search function for a subset of queries
     auto sub_search_func = [this, k, nprobe, params](
@@ -363,6 +448,8 @@ void IndexIVF::search(
         double t2 = getmillisecs();
         ivf_stats->quantization_time += t1 - t0;
         ivf_stats->search_time += t2 - t0;
+        KNOWHERE_OBSERVE_PHASE("search", "ivf_coarse_assign", t1 - t0);
+        KNOWHERE_OBSERVE_PHASE("search", "ivf_scan_lists", t2 - t1);
     };
 
     if ((parallel_mode & ~PARALLEL_MODE_NO_HEAP_INIT) == 0) {
@@ -444,7 +531,8 @@ void IndexIVF::search_preassigned(
             !invlists->use_iterator || (max_codes == 0 && store_pairs == false),
             "iterable inverted lists don't support max_codes and store_pairs");
 
-    size_t nlistv = 0, ndis = 0, nheap = 0;
+    // ncodes counts the codes read, ndis only those the scanner reports
+    size_t nlistv = 0, ndis = 0, nheap = 0, ncodes = 0;
 
     using HeapForIP = CMin<float, idx_t>;
     using HeapForL2 = CMax<float, idx_t>;
@@ -472,12 +560,26 @@ void IndexIVF::search_preassigned(
 
     void* inverted_list_context =
             params ? params->inverted_list_context : nullptr;
+    const IVFListRanges* list_ranges = params ? params->list_ranges : nullptr;
+    FAISS_THROW_IF_NOT_MSG(
+            !list_ranges || list_ranges->size() == nlist,
+            "list_ranges should have one entry per inverted list");
+    const float* query_tables = params ? params->query_tables : nullptr;
+    const size_t query_table_size = params ? params->query_table_size : 0;
 
-#pragma omp parallel if (do_parallel) reduction(+ : nlistv, ndis, nheap)
+#pragma omp parallel if (do_parallel) reduction(+ : nlistv, ndis, nheap, ncodes)
     {
         std::unique_ptr<InvertedListScanner> scanner(
                 get_InvertedListScanner(store_pairs, sel));
 
+        // hand the table of query i computed by the caller to the scanner
+        auto set_query = [&](idx_t i) {
+            if (query_tables) {
+                scanner->set_query_table(query_tables + i * query_table_size);
+            }
+            scanner->set_query(x + i * d);
+        };
+
         /*****************************************************
          * Depending on parallel_mode, there are two possible ways
          * to organize the search. Here we define local functions
@@ -538,6 +640,9 @@ void IndexIVF::search_preassigned(
             if (invlists->is_empty(key, inverted_list_context)) {
                 return (size_t)0;
             }
+            if (list_ranges && (*list_ranges)[key].empty()) {
+                return (size_t)0;
+            }
 
             scanner->set_list(key, coarse_dis_i);
 
@@ -554,6 +659,7 @@ void IndexIVF::search_preassigned(
 
                     nheap += scanner->iterate_codes(
                             it.get(), simi, idxi, k, list_size);
+                    ncodes += list_size;
 
                     return list_size;
                 } else {
@@ -575,15 +681,26 @@ void IndexIVF::search_preassigned(
                                 invlists, key, segment_offset);
                             ids = sids->get();
                         }
-                        nheap += scanner->scan_codes(
+                        scan_segment_ranges(
+                                list_ranges,
+                                key,
+                                segment_offset,
                                 segment_size,
-                                scodes.get(),
-                                code_norms,
+                                sel,
                                 ids,
-                                simi,
-                                idxi,
-                                k,
-                                scan_cnt);
+                                [&](size_t begin, size_t size) {
+                                    ncodes += size;
+                                    nheap += scanner->scan_codes(
+                                            size,
+                                            scodes.get() + begin * code_size,
+                                            code_norms ? code_norms + begin
+                                                       : nullptr,
+                                            ids ? ids + begin : nullptr,
+                                            simi,
+                                            idxi,
+                                            k,
+                                            scan_cnt);
+                                });
                     }
 
                     return scan_cnt;
@@ -609,7 +726,7 @@ void IndexIVF::search_preassigned(
                 }
 
                 // loop over queries
-                scanner->set_query(x + i * d);
+                set_query(i);
                 float* simi = distances + i * k;
                 idx_t* idxi = labels + i * k;
 
@@ -630,6 +747,10 @@ void IndexIVF::search_preassigned(
                     if (nscan >= max_codes && (!ensure_topk_full || nscan >= k)) {
                         break;
                     }
+                    // an abandoned query frees its thread after the current list
+                    if (knowhere::SearchCancelled()) {
+                        break;
+                    }
                 }
 
                 ndis += nscan;
@@ -645,7 +766,7 @@ void IndexIVF::search_preassigned(
             std::vector<float> local_dis(k);
 
             for (size_t i = 0; i < n; i++) {
-                scanner->set_query(x + i * d);
+                set_query(i);
                 init_result(local_dis.data(), local_idx.data());
 
 #pragma omp for schedule(dynamic)
@@ -689,7 +810,7 @@ void IndexIVF::search_preassigned(
             for (int64_t ij = 0; ij < n * nprobe; ij++) {
                 size_t i = ij / nprobe;
 
-                scanner->set_query(x + i * d);
+                set_query(i);
                 init_result(local_dis.data(), local_idx.data());
                 ndis += scan_one_list(
                         keys[ij],
@@ -736,6 +857,7 @@ void IndexIVF::search_preassigned(
         ivf_stats->ndis += ndis;
         ivf_stats->nheap_updates += nheap;
     }
+    add_search_stats(0, nlistv, ncodes);
 }
 
 void IndexIVF::range_search(
@@ -759,7 +881,10 @@ void IndexIVF::range_search(
     double t0 = getmillisecs();
     quantizer->search(
             nx, x, nprobe, coarse_dis.get(), keys.get(), quantizer_params);
-    indexIVF_stats.quantization_time += getmillisecs() - t0;
+    add_search_stats(nx * nlist, 0, 0);
+    double t1 = getmillisecs();
+    indexIVF_stats.quantization_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("range_search", "ivf_coarse_assign", t1 - t0);
 
     t0 = getmillisecs();
     invlists->prefetch_lists(keys.get(), nx * nprobe);
@@ -775,7 +900,9 @@ void IndexIVF::range_search(
             params,
             &indexIVF_stats);
 
-    indexIVF_stats.search_time += getmillisecs() - t0;
+    t1 = getmillisecs();
+    indexIVF_stats.search_time += t1 - t0;
+    KNOWHERE_OBSERVE_PHASE("range_search", "ivf_scan_lists", t1 - t0);
 }
 
 void IndexIVF::range_search_preassigned(
@@ -822,6 +949,10 @@ void IndexIVF::range_search_preassigned(
 
     void* inverted_list_context =
             params ? params->inverted_list_context : nullptr;
+    const IVFListRanges* list_ranges = params ? params->list_ranges : nullptr;
+    FAISS_THROW_IF_NOT_MSG(
+            !list_ranges || list_ranges->size() == nlist,
+            "list_ranges should have one entry per inverted list");
 
 #pragma omp parallel if (do_parallel) reduction(+ : nlistv, ndis)
     {
@@ -847,6 +978,9 @@ void IndexIVF::range_search_preassigned(
             if (invlists->is_empty(key, inverted_list_context)) {
                 return;
             }
+            if (list_ranges && (*list_ranges)[key].empty()) {
+                return;
+            }
 
             try {
                 // todo aguzhva: validate segments here
@@ -874,14 +1008,25 @@ void IndexIVF::range_search_preassigned(
 
                         scanner->set_list(key, coarse_dis[i * nprobe + ik]);
                         nlistv++;
-                        ndis += segment_size;
-                        scanner->scan_codes_range(
+                        const float* code_norms = scode_norms.get();
+                        scan_segment_ranges(
+                                list_ranges,
+                                key,
+                                segment_offset,
                                 segment_size,
-                                scodes.get(),
-                                scode_norms.get(),
+                                sel,
                                 ids.get(),
-                                radius,
-                                qres);
+                                [&](size_t begin, size_t size) {
+                                    ndis += size;
+                                    scanner->scan_codes_range(
+                                            size,
+                                            scodes.get() + begin * code_size,
+                                            code_norms ? code_norms + begin
+                                                       : nullptr,
+                                            ids.get() + begin,
+                                            radius,
+                                            qres);
+                                });
                     }
                 }
             } catch (const std::exception& e) {
@@ -922,6 +1067,9 @@ void IndexIVF::range_search_preassigned(
                         break;
                     }
                     prev_nres = qres.nres;
+                    if (knowhere::SearchCancelled()) {
+                        break;
+                    }
                 }
 
                 // The end of Knowhere-specific code.
@@ -956,6 +1104,79 @@ void IndexIVF::range_search_preassigned(
         stats->nlist += nlistv;
         stats->ndis += ndis;
     }
+    add_search_stats(0, nlistv, ndis);
+}
+
+void IndexIVF::search_by_ids(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        const idx_t* ids,
+        size_t nids,
+        float* distances,
+        idx_t* labels) const {
+    FAISS_THROW_IF_NOT_MSG(
+            direct_map.type != DirectMap::NoMap,
+            "search_by_ids requires a direct map");
+
+    using HeapForIP = CMin<float, idx_t>;
+    using HeapForL2 = CMax<float, idx_t>;
+
+    // visit the codes list by list, so that each list is set up once
+    struct Entry {
+        idx_t list_no;
+        idx_t offset;
+        idx_t id;
+    };
+    std::vector<Entry> entries(nids);
+    for (size_t j = 0; j < nids; j++) {
+        const idx_t lo = direct_map.get(ids[j]);
+        entries[j] = {(idx_t)lo_listno(lo), (idx_t)lo_offset(lo), ids[j]};
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.list_no < b.list_no ||
+                (a.list_no == b.list_no && a.offset < b.offset);
+    });
+
+#pragma omp parallel for if (n > 1)
+    for (idx_t i = 0; i < n; i++) {
+        const float* xi = x + i * d;
+        float* simi = distances + i * k;
+        idx_t* idxi = labels + i * k;
+        if (metric_type == METRIC_INNER_PRODUCT) {
+            heap_heapify<HeapForIP>(k, simi, idxi);
+        } else {
+            heap_heapify<HeapForL2>(k, simi, idxi);
+        }
+
+        std::unique_ptr<InvertedListScanner> scanner(
+                get_InvertedListScanner(false, nullptr));
+        std::unique_ptr<DistanceComputer> qdis(
+                quantizer->get_distance_computer());
+        scanner->set_query(xi);
+        qdis->set_query(xi);
+        idx_t cur_list = -1;
+        for (const auto& e : entries) {
+            if (e.list_no != cur_list) {
+                scanner->set_list(e.list_no, (*qdis)(e.list_no));
+                cur_list = e.list_no;
+            }
+            InvertedLists::ScopedCodes code(invlists, e.list_no, e.offset);
+            InvertedLists::ScopedCodeNorms code_norm(
+                    invlists, e.list_no, e.offset);
+            size_t scan_cnt = 0;
+            scanner->scan_codes(
+                    1, code.get(), code_norm.get(), &e.id, simi, idxi, k,
+                    scan_cnt);
+        }
+
+        if (metric_type == METRIC_INNER_PRODUCT) {
+            heap_reorder<HeapForIP>(k, simi, idxi);
+        } else {
+            heap_reorder<HeapForL2>(k, simi, idxi);
+        }
+    }
+    add_search_stats(0, 0, n * nids);
 }
 
 InvertedListScanner* IndexIVF::get_InvertedListScanner(
@@ -1218,6 +1439,132 @@ void IndexIVF::train(idx_t n, const float* x) {
     is_trained = true;
 }
 
+std::unique_ptr<IVFIteratorWorkspace> IndexIVF::getIteratorWorkspace(
+        const float* query_data,
+        const IVFSearchParameters* ivfsearchParams) const {
+    auto workspace = std::make_unique<IVFIteratorWorkspace>(
+            query_data, ivfsearchParams);
+
+    // snapshot of list_sizes;
+    auto coarse_list_sizes = std::make_unique<size_t[]>(nlist);
+    // total size of all lists
+    size_t count = 0;
+    auto max_coarse_list_size = 0;
+    for (size_t list_no = 0; list_no < nlist; ++list_no) {
+        auto list_size = invlists->list_size(list_no);
+        coarse_list_sizes[list_no] = list_size;
+        count += list_size;
+        if (list_size > max_coarse_list_size) {
+            max_coarse_list_size = list_size;
+        }
+    }
+    // compute backup_count_threshold - (nprobe / nlist) * count
+    size_t nprobe = workspace->search_params->nprobe
+            ? workspace->search_params->nprobe
+            : this->nprobe;
+    nprobe = std::min(nlist, nprobe);
+    workspace->backup_count_threshold = count * nprobe / nlist;
+    auto max_backup_count =
+            max_coarse_list_size + workspace->backup_count_threshold;
+
+    // compute distances of all centroids
+    auto coarse_idx = std::make_unique<idx_t[]>(nlist);
+    auto coarse_dis = std::make_unique<float[]>(nlist);
+    quantizer->search(
+            1,
+            workspace->query_data,
+            nlist,
+            coarse_dis.get(),
+            coarse_idx.get(),
+            workspace->search_params
+                    ? workspace->search_params->quantizer_params
+                    : nullptr);
+
+    workspace->coarse_idx = std::move(coarse_idx);
+    workspace->coarse_dis = std::move(coarse_dis);
+    workspace->coarse_list_sizes = std::move(coarse_list_sizes);
+    workspace->nprobe = nprobe;
+    workspace->dists.reserve(max_backup_count);
+
+    return workspace;
+}
+
+void IndexIVF::getIteratorNextBatch(
+        IVFIteratorWorkspace* workspace,
+        size_t current_backup_count) const {
+    workspace->dists.clear();
+
+    while (current_backup_count + workspace->dists.size() <
+                   workspace->backup_count_threshold &&
+           workspace->next_visit_coarse_list_idx < nlist) {
+        auto next_list_idx = workspace->next_visit_coarse_list_idx;
+        workspace->next_visit_coarse_list_idx++;
+
+        invlists->prefetch_lists(
+                workspace->coarse_idx.get() + next_list_idx, 1);
+        const auto list_no = workspace->coarse_idx[next_list_idx];
+
+        // max_codes is the size of the list when we started the
+        // iteration so that we won't search vectors added during the
+        // iteration(for IVFCC).
+        const auto max_codes = workspace->coarse_list_sizes
+                                       [workspace->coarse_idx[next_list_idx]];
+        if (list_no < 0) {
+            // not enough centroids for multiprobe
+            continue;
+        }
+        FAISS_THROW_IF_NOT_FMT(
+                list_no < (idx_t)nlist,
+                "Invalid list_no=%" PRId64 " nlist=%zd\n",
+                list_no,
+                nlist);
+
+        // don't waste time on empty lists
+        void* inverted_list_context = workspace->search_params
+                ? workspace->search_params->inverted_list_context
+                : nullptr;
+
+        if (invlists->is_empty(list_no, inverted_list_context)) {
+            continue;
+        }
+
+        // get scanner
+        IDSelector* sel = workspace->search_params
+                ? workspace->search_params->sel
+                : nullptr;
+        std::unique_ptr<InvertedListScanner> scanner(
+                get_InvertedListScanner(false, sel));
+        scanner->set_query(workspace->query_data);
+
+        size_t segment_num = invlists->get_segment_num(list_no);
+        size_t scan_cnt = 0;
+        for (size_t segment_idx = 0; segment_idx < segment_num; segment_idx++) {
+            size_t segment_size =
+                    invlists->get_segment_size(list_no, segment_idx);
+            size_t should_scan_size =
+                    std::min(segment_size, max_codes - scan_cnt);
+            scan_cnt += should_scan_size;
+            if (should_scan_size <= 0) {
+                break;
+            }
+            size_t segment_offset =
+                    invlists->get_segment_offset(list_no, segment_idx);
+            InvertedLists::ScopedCodes scodes(
+                    invlists, list_no, segment_offset);
+            InvertedLists::ScopedCodeNorms scode_norms(
+                    invlists, list_no, segment_offset);
+            InvertedLists::ScopedIds sids(invlists, list_no, segment_offset);
+
+            scanner->scan_codes_and_return(
+                    should_scan_size,
+                    scodes.get(),
+                    scode_norms.get(),
+                    sids.get(),
+                    workspace->dists);
+        }
+    }
+}
+
 idx_t IndexIVF::train_encoder_num_vectors() const {
     return 0;
 }
@@ -13,6 +13,7 @@
 #include <stdint.h>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <faiss/Clustering.h>
@@ -70,6 +71,9 @@ struct Level1Quantizer {
     ~Level1Quantizer();
 };
 
+/// [begin, end) offsets of the entries to scan, per inverted list
+using IVFListRanges = std::vector<std::vector<std::pair<size_t, size_t>>>;
+
 struct SearchParametersIVF : SearchParameters {
     size_t nprobe = 1;    ///< number of probes at query time
     size_t max_codes = 0; ///< max nb of codes to visit to do a query
@@ -88,12 +92,41 @@ struct SearchParametersIVF : SearchParameters {
     /// context object to pass to InvertedLists
     void* inverted_list_context = nullptr;
 
+    ///< if set, only these parts of each probed list are scanned, e.g. the
+    ///< sub-lists of the scalar values that a filter can match. A range whose
+    ///< entries all fail sel is dropped before any distance is computed. Not
+    ///< used by iterable inverted lists.
+    const IVFListRanges* list_ranges = nullptr;
+
+    ///< per-query tables computed beforehand, e.g. by
+    ///< IndexIVFPQ::compute_query_tables, query_table_size floats per query.
+    ///< They replace the tables the scanner computes in set_query.
+    const float* query_tables = nullptr;
+    size_t query_table_size = 0;
+
     virtual ~SearchParametersIVF() {}
 };
 
 // the new convention puts the index type after SearchParameters
 using IVFSearchParameters = SearchParametersIVF;
 
+struct IVFIteratorWorkspace {
+    IVFIteratorWorkspace(
+            const float* query_data,
+            const IVFSearchParameters* search_params)
+            : query_data(query_data), search_params(search_params) {}
+
+    const float* query_data = nullptr; // single query
+    const IVFSearchParameters* search_params = nullptr;
+    size_t nprobe = 0;
+    size_t backup_count_threshold = 0;  // count * nprobe / nlist
+    std::vector<knowhere::DistId> dists;    // should be cleared after each use
+    size_t next_visit_coarse_list_idx = 0;
+    std::unique_ptr<float[]> coarse_dis = nullptr;   // backup coarse centroids distances (heap)
+    std::unique_ptr<idx_t[]> coarse_idx = nullptr;   // backup coarse centroids ids (heap)
+    std::unique_ptr<size_t[]> coarse_list_sizes = nullptr;  // snapshot of the list_size
+};
+
 struct InvertedListScanner;
 struct IndexIVFStats;
 struct CodePacker;
@@ -316,6 +349,20 @@ struct IndexIVF : Index, IndexIVFInterface {
             idx_t* labels,
             const SearchParameters* params = nullptr) const override;
 
+    /** exhaustive search over the given ids only, found through the direct
+     * map. Cheaper than probing lists when a filter leaves very few ids.
+     *
+     * @param ids   ids to consider, size nids
+     */
+    void search_by_ids(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            const idx_t* ids,
+            size_t nids,
+            float* distances,
+            idx_t* labels) const;
+
     void range_search(
             idx_t n,
             const float* x,
@@ -463,6 +510,20 @@ struct IndexIVF : Index, IndexIVFInterface {
 
     void dump();
 
+    std::unique_ptr<IVFIteratorWorkspace> getIteratorWorkspace(
+            const float* query_data,
+            const IVFSearchParameters* ivfsearchParams) const;
+
+    // Unlike regular knn-search, the iterator does not know the size `k` of the
+    // returned result.
+    //   The iterator will maintain a heap of at least (nprobe/nlist) nodes for
+    //   iterator `Next()` operation.
+    //   When there are not enough nodes in the heap, iterator will scan the
+    //   next coarse list.
+    void getIteratorNextBatch(
+            IVFIteratorWorkspace* workspace,
+            size_t current_backup_count) const;
+
     IndexIVF();
 };
 
@@ -492,6 +553,10 @@ struct InvertedListScanner {
     /// from now on we handle this query.
     virtual void set_query(const float* query_vector) = 0;
 
+    /// the next set_query uses this precomputed query table instead of
+    /// computing it, ignored by the scanners that have no query table
+    virtual void set_query_table(const float* /* table */) {}
+
     /// following codes come from this inverted list
     virtual void set_list(idx_t list_no, float coarse_dis) = 0;
 
@@ -19,6 +19,7 @@
 
 #include <faiss/utils/Heap.h>
 #include <faiss/utils/distances.h>
+#include <faiss/utils/distances_if.h>
 #include <faiss/utils/utils.h>
 
 #include <faiss/Clustering.h>
@@ -36,6 +37,8 @@
 
 #include <faiss/impl/code_distance/code_distance.h>
 
+#include "knowhere/bitsetview_idselector.h"
+
 namespace faiss {
 
 /*****************************************
@@ -463,6 +466,21 @@ void initialize_IVFPQ_precomputed_table(
     }
 }
 
+bool IndexIVFPQ::compute_query_tables(idx_t n, const float* x, float* tables)
+        const {
+    if (metric_type == METRIC_INNER_PRODUCT) {
+        pq.compute_inner_prod_tables(n, x, tables);
+    } else if (!by_residual) {
+        pq.compute_distance_tables(n, x, tables);
+    } else if (use_precomputed_table > 0) {
+        pq.compute_inner_prod_tables(n, x, tables);
+    } else {
+        // the tables depend on the list, they are computed in set_list
+        return false;
+    }
+    return true;
+}
+
 void IndexIVFPQ::precompute_table() {
     initialize_IVFPQ_precomputed_table(
             use_precomputed_table,
@@ -546,10 +564,15 @@ struct QueryTables {
     // field specific to query
     const float* qi;
 
+    // table of the next query computed by compute_query_tables, if any
+    const float* query_table = nullptr;
+
     // query-specific initialization
     void init_query(const float* qi) {
         this->qi = qi;
-        if (metric_type == METRIC_INNER_PRODUCT)
+        if (query_table)
+            init_query_from_table();
+        else if (metric_type == METRIC_INNER_PRODUCT)
             init_query_IP();
         else
             init_query_L2();
@@ -570,6 +593,17 @@ struct QueryTables {
         }
     }
 
+    void init_query_from_table() {
+        // the L2 residual search keeps the query table in sim_table_2
+        bool l2_residual = metric_type != METRIC_INNER_PRODUCT && by_residual;
+        if (!l2_residual || use_precomputed_table > 0) {
+            memcpy(l2_residual ? sim_table_2 : sim_table,
+                   query_table,
+                   sizeof(float) * pq.M * pq.ksub);
+        }
+        query_table = nullptr;
+    }
+
     /*****************************************************
      * When inverted list is known: prepare computations
      *****************************************************/
@@ -937,6 +971,78 @@ struct IVFPQScannerT : QueryTables {
         }
     }
 
+    /// version of scan_list_with_table() where the filter is checked for
+    /// 64 codes at a time, so runs of filtered out codes are skipped at once
+    template <class Mask, class SearchResultType>
+    void scan_list_with_table_masked(
+            size_t ncode,
+            const uint8_t* codes,
+            Mask mask,
+            SearchResultType& res) const {
+        auto distance1 = [&](const size_t j) {
+            float dis = dis0 +
+                    distance_single_code<PQDecoder>(
+                                pq.M,
+                                pq.nbits,
+                                sim_table,
+                                codes + j * pq.code_size);
+            res.add(j, dis);
+        };
+
+        auto distance4 = [&](const size_t j0,
+                             const size_t j1,
+                             const size_t j2,
+                             const size_t j3) {
+            float distance_0 = 0;
+            float distance_1 = 0;
+            float distance_2 = 0;
+            float distance_3 = 0;
+            distance_four_codes<PQDecoder>(
+                    pq.M,
+                    pq.nbits,
+                    sim_table,
+                    codes + j0 * pq.code_size,
+                    codes + j1 * pq.code_size,
+                    codes + j2 * pq.code_size,
+                    codes + j3 * pq.code_size,
+                    distance_0,
+                    distance_1,
+                    distance_2,
+                    distance_3);
+
+            res.add(j0, dis0 + distance_0);
+            res.add(j1, dis0 + distance_1);
+            res.add(j2, dis0 + distance_2);
+            res.add(j3, dis0 + distance_3);
+        };
+
+        auto process_run = [&](const size_t j0, const size_t n) {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                distance4(j0 + i, j0 + i + 1, j0 + i + 2, j0 + i + 3);
+            }
+            for (; i < n; i++) {
+                distance1(j0 + i);
+            }
+        };
+
+        auto process_idx = [&](const size_t* indices, const size_t n) {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                distance4(
+                        indices[i],
+                        indices[i + 1],
+                        indices[i + 2],
+                        indices[i + 3]);
+            }
+            for (; i < n; i++) {
+                distance1(indices[i]);
+            }
+        };
+
+        masked_blocks_if(ncode, mask, process_run, process_idx);
+    }
+
     /// tables are not precomputed, but pointers are provided to the
     /// relevant X_c|x_r tables
     template <class SearchResultType>
@@ -1195,6 +1301,8 @@ struct IVFPQScanner : IVFPQScannerT<idx_t, METRIC_TYPE, PQDecoder>,
                       InvertedListScanner {
     int precompute_mode;
     const IDSelector* sel;
+    // set when sel is a knowhere bitset, it is then checked 64 ids at a time
+    knowhere::BitsetView bitset;
 
     IVFPQScanner(
             const IndexIVFPQ& ivfpq,
@@ -1206,6 +1314,14 @@ struct IVFPQScanner : IVFPQScannerT<idx_t, METRIC_TYPE, PQDecoder>,
               sel(sel) {
         this->store_pairs = store_pairs;
         this->keep_max = is_similarity_metric(METRIC_TYPE);
+        if (const auto* bitsetview_sel =
+                    dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
+            bitset = bitsetview_sel->bitset_view;
+        }
+    }
+
+    void set_query_table(const float* table) override {
+        this->query_table = table;
     }
 
     void set_query(const float* query) override {
@@ -1246,6 +1362,11 @@ struct IVFPQScanner : IVFPQScannerT<idx_t, METRIC_TYPE, PQDecoder>,
         if (this->polysemous_ht > 0) {
             assert(precompute_mode == 2);
             this->scan_list_polysemous(ncode, codes, res);
+        } else if (precompute_mode == 2 && use_sel && !bitset.empty()) {
+            auto mask = [this, ids](const size_t j0, const size_t n) {
+                return ~bitset.test_ids(ids + j0, n);
+            };
+            this->scan_list_with_table_masked(ncode, codes, mask, res);
         } else if (precompute_mode == 2) {
             this->scan_list_with_table(ncode, codes, res);
         } else if (precompute_mode == 1) {
@@ -1275,6 +1396,11 @@ struct IVFPQScanner : IVFPQScannerT<idx_t, METRIC_TYPE, PQDecoder>,
         if (this->polysemous_ht > 0) {
             assert(precompute_mode == 2);
             this->scan_list_polysemous(ncode, codes, res);
+        } else if (precompute_mode == 2 && use_sel && !bitset.empty()) {
+            auto mask = [this, ids](const size_t j0, const size_t n) {
+                return ~bitset.test_ids(ids + j0, n);
+            };
+            this->scan_list_with_table_masked(ncode, codes, mask, res);
         } else if (precompute_mode == 2) {
             this->scan_list_with_table(ncode, codes, res);
         } else if (precompute_mode == 1) {
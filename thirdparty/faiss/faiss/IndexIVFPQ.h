@@ -140,6 +140,16 @@ struct IndexIVFPQ : IndexIVF {
     /// build precomputed table
     void precompute_table();
 
+    /** compute the tables the search derives from each query alone, so
+     * that one query searched on several indexes sharing the same pq does
+     * not recompute them, see SearchParametersIVF::query_tables.
+     *
+     * @param tables  output, size n * pq.M * pq.ksub
+     * @return false if the search has no per-query table, i.e. L2 on
+     *         residuals without precomputed tables
+     */
+    bool compute_query_tables(idx_t n, const float* x, float* tables) const;
+
     IndexIVFPQ();
 };
 
@@ -0,0 +1,475 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// -*- c++ -*-
+
+#include <faiss/IndexIVFRaBitQ.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include <faiss/IndexFlat.h>
+#include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/DistanceComputer.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/utils/distances.h>
+#include <faiss/utils/hamming.h>
+#include <faiss/utils/random.h>
+#include <faiss/utils/utils.h>
+
+namespace faiss {
+
+namespace {
+
+// the rotation is stored with the index, the seed only matters at
+// construction
+constexpr int kRotationSeed = 1234;
+
+// nb of sign flip + Walsh-Hadamard rounds of the rotation
+constexpr int kRotationRounds = 4;
+
+// bits of the 4-bit quantized query
+constexpr int kQueryBits = 4;
+
+size_t rotated_dim(size_t d) {
+    return (d + 63) / 64 * 64;
+}
+
+// unnormalized in-place Walsh-Hadamard transform, n is a power of 2
+void fwht(float* x, size_t n) {
+    for (size_t h = 1; h < n; h *= 2) {
+        for (size_t i = 0; i < n; i += 2 * h) {
+            for (size_t j = i; j < i + h; j++) {
+                float a = x[j];
+                float b = x[j + h];
+                x[j] = a + b;
+                x[j + h] = a - b;
+            }
+        }
+    }
+}
+
+// sign bits of the rotated residual v, followed by ||r|| and <o_bar, o>
+void encode_rotated(size_t d_rot, const float* v, uint8_t* code) {
+    memset(code, 0, d_rot / 8);
+    float r_norm = std::sqrt(fvec_norm_L2sqr(v, d_rot));
+    float abs_sum = 0;
+    for (size_t i = 0; i < d_rot; i++) {
+        if (v[i] > 0) {
+            code[i >> 3] |= 1 << (i & 7);
+        }
+        abs_sum += std::fabs(v[i]);
+    }
+    // <o_bar, o> with o = v / ||v|| and o_bar = (2 * bits - 1) / sqrt(d_rot)
+    float o_dot = r_norm > 0 ? abs_sum / (r_norm * std::sqrt((float)d_rot))
+                             : 1.0f;
+    float factors[2] = {r_norm, o_dot};
+    memcpy(code + d_rot / 8, factors, sizeof(factors));
+}
+
+} // namespace
+
+IndexIVFRaBitQ::IndexIVFRaBitQ(
+        Index* quantizer,
+        size_t d,
+        size_t nlist,
+        MetricType metric,
+        Index* refine_index)
+        : IndexIVF(quantizer, d, nlist, 0, metric),
+          d_rot(rotated_dim(d)),
+          refine_index(refine_index) {
+    FAISS_THROW_IF_NOT_MSG(
+            metric == METRIC_L2 || metric == METRIC_INNER_PRODUCT,
+            "RaBitQ only supports L2 and inner product");
+    rotation_signs.resize(kRotationRounds * d_rot / 8);
+    byte_rand(rotation_signs.data(), rotation_signs.size(), kRotationSeed);
+    code_size = d_rot / 8 + 2 * sizeof(float);
+    // the lists were created before the code size was known
+    invlists->code_size = code_size;
+    by_residual = true;
+    is_trained = false;
+    if (refine_index) {
+        FAISS_THROW_IF_NOT(refine_index->d == d);
+        FAISS_THROW_IF_NOT(refine_index->ntotal == 0);
+    }
+}
+
+IndexIVFRaBitQ::IndexIVFRaBitQ() : IndexIVF() {
+    by_residual = true;
+}
+
+IndexIVFRaBitQ::~IndexIVFRaBitQ() {
+    if (own_refine_index) {
+        delete refine_index;
+    }
+}
+
+void IndexIVFRaBitQ::train(idx_t n, const float* x) {
+    train_q1(n, x, verbose, metric_type);
+    compute_rotated_centroids();
+    if (refine_index) {
+        refine_index->train(n, x);
+    }
+    is_trained = true;
+}
+
+void IndexIVFRaBitQ::rotate(idx_t n, const float* x, float* xr) const {
+    FAISS_THROW_IF_NOT(rotation_signs.size() == kRotationRounds * d_rot / 8);
+    // the transform runs on the largest power of 2 block, alternately at
+    // the start and at the end of the vector, and the two halves are mixed
+    // after each round so that all the dimensions are covered
+    size_t block = 1;
+    while (block * 2 <= d_rot) {
+        block *= 2;
+    }
+    const float block_scale = 1 / std::sqrt((float)block);
+    const float half_scale = std::sqrt(0.5f);
+    const size_t half = d_rot / 2;
+
+#pragma omp parallel for if (n > 1000)
+    for (idx_t i = 0; i < n; i++) {
+        float* v = xr + i * d_rot;
+        memcpy(v, x + i * d, sizeof(float) * d);
+        memset(v + d, 0, sizeof(float) * (d_rot - d));
+        for (int r = 0; r < kRotationRounds; r++) {
+            const uint8_t* signs = rotation_signs.data() + r * d_rot / 8;
+            for (size_t j = 0; j < d_rot; j++) {
+                if ((signs[j >> 3] >> (j & 7)) & 1) {
+                    v[j] = -v[j];
+                }
+            }
+            float* b = r % 2 == 0 ? v : v + d_rot - block;
+            fwht(b, block);
+            for (size_t j = 0; j < block; j++) {
+                b[j] *= block_scale;
+            }
+            if (block < d_rot) {
+                for (size_t j = 0; j < half; j++) {
+                    float lo = v[j];
+                    float hi = v[j + half];
+                    v[j] = (lo + hi) * half_scale;
+                    v[j + half] = (lo - hi) * half_scale;
+                }
+            }
+        }
+    }
+}
+
+void IndexIVFRaBitQ::compute_rotated_centroids() {
+    std::vector<float> centroids(nlist * d);
+    quantizer->reconstruct_n(0, nlist, centroids.data());
+    rotated_centroids.resize(nlist * d_rot);
+    rotate(nlist, centroids.data(), rotated_centroids.data());
+}
+
+void IndexIVFRaBitQ::add_with_ids(idx_t n, const float* x, const idx_t* xids) {
+    FAISS_THROW_IF_NOT_MSG(
+            !refine_index || (!xids && refine_index->ntotal == ntotal),
+            "the refine index needs sequential ids");
+    IndexIVF::add_with_ids(n, x, xids);
+    if (refine_index) {
+        refine_index->add(n, x);
+    }
+}
+
+void IndexIVFRaBitQ::reset() {
+    IndexIVF::reset();
+    if (refine_index) {
+        refine_index->reset();
+    }
+}
+
+void IndexIVFRaBitQ::encode_vectors(
+        idx_t n,
+        const float* x,
+        const idx_t* list_nos,
+        uint8_t* codes,
+        bool include_listnos) const {
+    FAISS_THROW_IF_NOT(is_trained);
+    size_t coarse_size = include_listnos ? coarse_code_size() : 0;
+    memset(codes, 0, (code_size + coarse_size) * n);
+
+    // rotate the residuals block by block to bound the memory
+    constexpr idx_t bs = 65536;
+    std::vector<float> residuals(std::min(n, bs) * d);
+    std::vector<float> rotated(std::min(n, bs) * d_rot);
+    for (idx_t i0 = 0; i0 < n; i0 += bs) {
+        idx_t i1 = std::min(n, i0 + bs);
+#pragma omp parallel for if (i1 - i0 > 1000)
+        for (idx_t i = i0; i < i1; i++) {
+            float* ri = residuals.data() + (i - i0) * d;
+            if (list_nos[i] >= 0) {
+                quantizer->compute_residual(x + i * d, ri, list_nos[i]);
+            } else {
+                memset(ri, 0, sizeof(float) * d);
+            }
+        }
+        rotate(i1 - i0, residuals.data(), rotated.data());
+#pragma omp parallel for if (i1 - i0 > 1000)
+        for (idx_t i = i0; i < i1; i++) {
+            int64_t list_no = list_nos[i];
+            if (list_no >= 0) {
+                uint8_t* code = codes + i * (code_size + coarse_size);
+                if (coarse_size) {
+                    encode_listno(list_no, code);
+                }
+                encode_rotated(
+                        d_rot,
+                        rotated.data() + (i - i0) * d_rot,
+                        code + coarse_size);
+            }
+        }
+    }
+}
+
+void IndexIVFRaBitQ::reconstruct(idx_t key, float* recons) const {
+    FAISS_THROW_IF_NOT_MSG(
+            refine_index, "RaBitQ codes cannot be reconstructed");
+    refine_index->reconstruct(key, recons);
+}
+
+bool IndexIVFRaBitQ::with_raw_data() const {
+    return dynamic_cast<const IndexFlat*>(refine_index) != nullptr;
+}
+
+namespace {
+
+template <class C, bool use_sel>
+struct IVFRaBitQScanner : InvertedListScanner {
+    const IndexIVFRaBitQ* index;
+    size_t d_rot;
+    size_t nwords;
+
+    std::vector<float> q_rot; // rotated query
+    std::vector<float> q_res; // rotated query residual, L2 only
+    // bit planes of the quantized query, word w of plane b is at
+    // w * kQueryBits + b
+    std::vector<uint64_t> q_planes;
+    float q_norm = 0;  // norm of the quantized vector
+    float q_vl = 0;    // lowest value of the quantized vector
+    float q_delta = 0; // quantization step
+    float q_sum = 0;   // sum of the quantized values
+    float list_ip = 0; // <q, c>, inner product only
+    float err_scale;
+
+    std::unique_ptr<DistanceComputer> refine_dc;
+
+    IVFRaBitQScanner(
+            const IndexIVFRaBitQ* index,
+            bool store_pairs,
+            const IDSelector* sel)
+            : InvertedListScanner(store_pairs, sel),
+              index(index),
+              d_rot(index->d_rot),
+              nwords(index->d_rot / 64),
+              q_rot(index->d_rot),
+              q_res(index->d_rot),
+              q_planes(kQueryBits * index->d_rot / 64),
+              err_scale(index->eps0 / std::sqrt((float)index->d_rot - 1)) {
+        this->code_size = index->code_size;
+        this->keep_max = !C::is_max;
+        if (index->refine_index) {
+            refine_dc.reset(index->refine_index->get_distance_computer());
+        }
+    }
+
+    void quantize_query(const float* v) {
+        q_norm = std::sqrt(fvec_norm_L2sqr(v, d_rot));
+        auto [vmin, vmax] = std::minmax_element(v, v + d_rot);
+        q_vl = *vmin;
+        q_delta = (*vmax - *vmin) / ((1 << kQueryBits) - 1);
+        float inv_delta = q_delta > 0 ? 1.0f / q_delta : 0.0f;
+
+        std::fill(q_planes.begin(), q_planes.end(), 0);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < d_rot; i++) {
+            uint64_t qu = (uint64_t)((v[i] - q_vl) * inv_delta + 0.5f);
+            sum += qu;
+            for (int b = 0; b < kQueryBits; b++) {
+                q_planes[i / 64 * kQueryBits + b] |= ((qu >> b) & 1)
+                        << (i % 64);
+            }
+        }
+        q_sum = sum;
+    }
+
+    void set_query(const float* query) override {
+        index->rotate(1, query, q_rot.data());
+        if (refine_dc) {
+            refine_dc->set_query(query);
+        }
+        // <q, x> = <q, c> + <q, r>, the query itself is quantized
+        if (index->metric_type == METRIC_INNER_PRODUCT) {
+            quantize_query(q_rot.data());
+        }
+    }
+
+    void set_list(idx_t list_no, float /*coarse_dis*/) override {
+        this->list_no = list_no;
+        const float* c = index->rotated_centroids.data() + list_no * d_rot;
+        if (index->metric_type == METRIC_L2) {
+            // ||q - x||^2 = ||(q - c) - r||^2, the query residual is quantized
+            fvec_sub(d_rot, q_rot.data(), c, q_res.data());
+            quantize_query(q_res.data());
+        } else {
+            // the rotation is orthonormal and keeps the inner products
+            list_ip = fvec_inner_product(q_rot.data(), c, d_rot);
+        }
+    }
+
+    // estimated distance to the code and the bound of its error
+    inline float estimate(const uint8_t* code, float& err) const {
+        const uint64_t* bits = (const uint64_t*)code;
+        const uint64_t* plane = q_planes.data();
+        uint64_t popcnt = 0;
+        uint64_t cnt[kQueryBits] = {};
+        for (size_t w = 0; w < nwords; w++, plane += kQueryBits) {
+            uint64_t word = bits[w];
+            popcnt += popcount64(word);
+            for (int b = 0; b < kQueryBits; b++) {
+                cnt[b] += popcount64(word & plane[b]);
+            }
+        }
+        uint64_t weighted = 0;
+        for (int b = 0; b < kQueryBits; b++) {
+            weighted += cnt[b] << b;
+        }
+        float factors[2];
+        memcpy(factors, code + d_rot / 8, sizeof(factors));
+        const float r_norm = factors[0];
+        const float o_dot = factors[1];
+
+        // <2 * bits - 1, q> from the quantized query
+        float ip_bq = 2 * (q_delta * weighted + q_vl * popcnt) -
+                (q_delta * q_sum + q_vl * d_rot);
+        // <o, q> estimated as <o_bar, q> / <o_bar, o>
+        float ip_oq = ip_bq / (std::sqrt((float)d_rot) * o_dot);
+        err = err_scale * r_norm * q_norm *
+                std::sqrt(std::max(0.0f, 1 - o_dot * o_dot)) / o_dot;
+        if (index->metric_type == METRIC_L2) {
+            err *= 2;
+            return r_norm * r_norm + q_norm * q_norm - 2 * r_norm * ip_oq;
+        }
+        return list_ip + r_norm * ip_oq;
+    }
+
+    float distance_to_code(const uint8_t* code) const override {
+        float err;
+        return estimate(code, err);
+    }
+
+    // lower bound of the distance for L2, upper bound of the similarity for
+    // inner product
+    static inline float best_case(float dis, float err) {
+        return C::is_max ? dis - err : dis + err;
+    }
+
+    size_t scan_codes(
+            size_t list_size,
+            const uint8_t* codes,
+            const float* code_norms,
+            const idx_t* ids,
+            float* simi,
+            idx_t* idxi,
+            size_t k,
+            size_t& scan_cnt) const override {
+        size_t nup = 0;
+        for (size_t j = 0; j < list_size; j++, codes += code_size) {
+            if (use_sel && !sel->is_member(ids[j])) {
+                continue;
+            }
+            scan_cnt++;
+            float err;
+            float dis = estimate(codes, err);
+            if (refine_dc) {
+                // only the candidates that may enter the heap are re-ranked
+                if (!C::cmp(simi[0], best_case(dis, err))) {
+                    continue;
+                }
+                dis = (*refine_dc)(ids[j]);
+            }
+            if (C::cmp(simi[0], dis)) {
+                int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                heap_replace_top<C>(k, simi, idxi, dis, id);
+                nup++;
+            }
+        }
+        return nup;
+    }
+
+    void scan_codes_range(
+            size_t list_size,
+            const uint8_t* codes,
+            const float* code_norms,
+            const idx_t* ids,
+            float radius,
+            RangeQueryResult& res) const override {
+        for (size_t j = 0; j < list_size; j++, codes += code_size) {
+            if (use_sel && !sel->is_member(ids[j])) {
+                continue;
+            }
+            float err;
+            float dis = estimate(codes, err);
+            if (refine_dc) {
+                if (!C::cmp(radius, best_case(dis, err))) {
+                    continue;
+                }
+                dis = (*refine_dc)(ids[j]);
+            }
+            if (C::cmp(radius, dis)) {
+                int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                res.add(dis, id);
+            }
+        }
+    }
+
+    // the iterator gets the estimates and refines them itself
+    void scan_codes_and_return(
+            size_t list_size,
+            const uint8_t* codes,
+            const float* code_norms,
+            const idx_t* ids,
+            std::vector<knowhere::DistId>& out) const override {
+        for (size_t j = 0; j < list_size; j++, codes += code_size) {
+            if (use_sel && !sel->is_member(ids[j])) {
+                continue;
+            }
+            float err;
+            out.emplace_back(ids[j], estimate(codes, err));
+        }
+    }
+};
+
+template <class C>
+InvertedListScanner* make_scanner(
+        const IndexIVFRaBitQ* index,
+        bool store_pairs,
+        const IDSelector* sel) {
+    if (sel) {
+        return new IVFRaBitQScanner<C, true>(index, store_pairs, sel);
+    }
+    return new IVFRaBitQScanner<C, false>(index, store_pairs, sel);
+}
+
+} // anonymous namespace
+
+InvertedListScanner* IndexIVFRaBitQ::get_InvertedListScanner(
+        bool store_pairs,
+        const IDSelector* sel) const {
+    // the refine index is looked up by id
+    FAISS_THROW_IF_NOT(!(store_pairs && refine_index));
+    if (metric_type == METRIC_L2) {
+        return make_scanner<CMax<float, idx_t>>(this, store_pairs, sel);
+    } else if (metric_type == METRIC_INNER_PRODUCT) {
+        return make_scanner<CMin<float, idx_t>>(this, store_pairs, sel);
+    }
+    FAISS_THROW_MSG("metric type not supported");
+}
+
+} // namespace faiss
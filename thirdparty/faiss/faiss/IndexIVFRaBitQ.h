@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) Facebook, Inc. and its affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// -*- c++ -*-
+
+#pragma once
+
+#include <vector>
+
+#include <faiss/IndexIVF.h>
+
+namespace faiss {
+
+/** Inverted file with RaBitQ codes (Gao & Long, SIGMOD'24).
+ *
+ * The residual r = x - c of a vector to its centroid is randomly rotated
+ * into d_rot dimensions and stored as the sign bit of each dimension, with
+ * two correction factors: ||r|| and <o_bar, o>, where o is the rotated unit
+ * residual and o_bar its binarized version. At search time the rotated query
+ * is quantized to 4 bits per dimension, so that <o_bar, q> is a weighted sum
+ * of popcounts over the 4 bit planes of the query.
+ *
+ * The estimate comes with a bound on its error that holds with high
+ * probability. If a refine index is set, a candidate is re-ranked on it only
+ * if its estimate minus the bound could enter the results, and the results
+ * hold the refined distances. Without a refine index the estimates are
+ * returned.
+ *
+ * The rotation is a product of random sign flips and Walsh-Hadamard
+ * transforms rather than a dense matrix, so that rotating a query costs
+ * O(d log d) instead of O(d^2).
+ *
+ * Code layout: d_rot / 8 bytes of sign bits, then ||r|| and <o_bar, o> as
+ * floats.
+ */
+struct IndexIVFRaBitQ : IndexIVF {
+    /// nb of bits of the codes, d rounded up to a multiple of 64
+    size_t d_rot = 0;
+
+    /// random signs of the rotation rounds, one bit per dimension and round
+    std::vector<uint8_t> rotation_signs;
+
+    /// optional index the candidates are re-ranked on. It holds the same
+    /// vectors with sequential ids, so no add_with_ids is allowed.
+    Index* refine_index = nullptr;
+    bool own_refine_index = true;
+
+    /// scale of the error bound, 1.9 gives a failure probability below 1e-3
+    /// for each estimate
+    float eps0 = 1.9f;
+
+    /// rotated centroids, nlist * d_rot, recomputed on training and loading
+    std::vector<float> rotated_centroids;
+
+    IndexIVFRaBitQ(
+            Index* quantizer,
+            size_t d,
+            size_t nlist,
+            MetricType metric = METRIC_L2,
+            Index* refine_index = nullptr);
+
+    IndexIVFRaBitQ();
+
+    /// trains the coarse quantizer and the refine index, the rotation is
+    /// random
+    void train(idx_t n, const float* x) override;
+
+    void add_with_ids(idx_t n, const float* x, const idx_t* xids) override;
+
+    void reset() override;
+
+    void encode_vectors(
+            idx_t n,
+            const float* x,
+            const idx_t* list_nos,
+            uint8_t* codes,
+            bool include_listnos = false) const override;
+
+    InvertedListScanner* get_InvertedListScanner(
+            bool store_pairs,
+            const IDSelector* sel) const override;
+
+    /// reconstructs from the refine index, the codes cannot be decoded
+    void reconstruct(idx_t key, float* recons) const override;
+
+    /// the refine index holds the raw vectors, not only their codes
+    bool with_raw_data() const;
+
+    /// orthonormal d -> d_rot rotation of n vectors
+    void rotate(idx_t n, const float* x, float* xr) const;
+
+    void compute_rotated_centroids();
+
+    ~IndexIVFRaBitQ() override;
+};
+
+} // namespace faiss
@@ -3,6 +3,7 @@
 
 #include <faiss/IndexFlat.h>
 #include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/DistanceComputer.h>
 #include <faiss/impl/FaissAssert.h>
 #include <faiss/utils/Heap.h>
 #include <faiss/utils/distances.h>
@@ -101,10 +102,39 @@ int64_t IndexScaNN::size() {
     auto centroid_table = pq.M * pq.ksub * pq.dsub * sizeof(float);
     auto precomputed_table = nlist * pq.M * pq.ksub * sizeof(float);
 
-    auto raw_data = (refine_index ? index_->ntotal * d * sizeof(float) : 0);
+    auto refine_codes = dynamic_cast<const IndexFlatCodes*>(refine_index);
+    auto raw_data = (refine_codes ? refine_codes->codes.size() : 0);
     return (capacity + centroid_table + precomputed_table + raw_data);
 }
 
+void IndexScaNN::compute_refine_distances(
+        idx_t n,
+        const float* x,
+        idx_t k,
+        float* distances,
+        idx_t* labels) const {
+    if (auto rf = dynamic_cast<const IndexFlat*>(refine_index)) {
+        rf->compute_distance_subset(n, x, k, distances, labels);
+        return;
+    }
+    FAISS_THROW_IF_NOT(refine_index);
+
+#pragma omp parallel if (n > 1)
+    {
+        std::unique_ptr<DistanceComputer> dc(
+                refine_index->get_distance_computer());
+#pragma omp for
+        for (idx_t i = 0; i < n; i++) {
+            dc->set_query(x + i * d);
+            for (idx_t j = i * k; j < (i + 1) * k; j++) {
+                if (labels[j] >= 0) {
+                    distances[j] = (*dc)(labels[j]);
+                }
+            }
+        }
+    }
+}
+
 void IndexScaNN::search(
         idx_t n,
         const float* x,
@@ -165,10 +195,7 @@ void IndexScaNN::search(
         assert(base_labels[i] >= -1 && base_labels[i] < ntotal);
 
     // compute refined distances
-    auto rf = dynamic_cast<const IndexFlat*>(refine_index);
-    FAISS_THROW_IF_NOT(rf);
-
-    rf->compute_distance_subset(n, x, k_base, base_distances, base_labels);
+    compute_refine_distances(n, x, k_base, base_distances, base_labels);
 
     if (base->is_cosine) {
         for (idx_t i = 0; i < n * k_base; i++) {
@@ -225,10 +252,8 @@ void IndexScaNN::range_search(
     }
 
     // compute refined distances
-    auto rf = dynamic_cast<const IndexFlat*>(refine_index);
-    FAISS_THROW_IF_NOT(rf);
-
-    rf->compute_distance_subset(n, x, result->lims[1], result->distances, result->labels);
+    compute_refine_distances(
+            n, x, result->lims[1], result->distances, result->labels);
 
     idx_t current = 0;
     for (idx_t i = 0; i < result->lims[1]; ++i) {
@@ -255,4 +280,22 @@ void IndexScaNN::range_search(
     result->lims[1] = current;
 }
 
+/***************************************************
+ * IndexSQ4FastScan
+ ***************************************************/
+
+IndexSQ4FastScan::IndexSQ4FastScan(Index* base_index, Index* refine_index)
+        : IndexScaNN(base_index, nullptr) {
+    this->refine_index = refine_index;
+    FAISS_THROW_IF_NOT_MSG(
+            base_index->ntotal == 0,
+            "base_index should be empty in the beginning");
+    if (refine_index) {
+        FAISS_THROW_IF_NOT(refine_index->d == base_index->d);
+        FAISS_THROW_IF_NOT(refine_index->ntotal == 0);
+    }
+}
+
+IndexSQ4FastScan::IndexSQ4FastScan() : IndexScaNN() {}
+
 } // namespace faiss
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <faiss/Index.h>
+#include <faiss/IndexFlat.h>
 #include <faiss/IndexRefine.h>
 
 namespace faiss {
@@ -24,8 +25,9 @@ struct IndexScaNN : IndexRefine {
 
     void reset() override;
 
+    // the refine index holds the raw vectors, not only their codes
     inline bool with_raw_data() const {
-        return (refine_index != nullptr);
+        return dynamic_cast<const IndexFlat*>(refine_index) != nullptr;
     }
 
     int64_t size();
@@ -44,6 +46,28 @@ struct IndexScaNN : IndexRefine {
             float radius,
             RangeSearchResult* result,
             const SearchParameters* params = nullptr) const override;
+
+   protected:
+    /// replace the base distances of the k candidates of each query by the
+    /// distances computed on the refine index
+    void compute_refine_distances(
+            idx_t n,
+            const float* x,
+            idx_t k,
+            float* distances,
+            idx_t* labels) const;
+};
+
+/** 4-bit scalar quantizer on the pq4 fast-scan layout: the base index is an
+ * IndexIVFPQFastScan with one 4-bit sub-quantizer per dimension, whose 16
+ * levels are trained per dimension. The candidates are refined on the raw
+ * vectors (IndexFlat), on their 8-bit codes (IndexScalarQuantizer) or not at
+ * all (nullptr). Both indexes are owned.
+ */
+struct IndexSQ4FastScan : IndexScaNN {
+    IndexSQ4FastScan(Index* base_index, Index* refine_index);
+
+    IndexSQ4FastScan();
 };
 
 } // namespace faiss
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 #include <faiss/utils/distances_if.h>
 
+#include "knowhere/bitsetview_idselector.h"
+
 namespace faiss {
 
 /*******************************************************************
@@ -17,6 +19,64 @@ namespace faiss {
  * IndexScalarQuantizer as well.
  ********************************************************************/
 
+template<
+    // Returns the filter bits of a block.
+    //   uint64_t Mask(const size_t j0, const size_t n);
+    // * bit i is set if the element j0 + i is acceptable.
+    typename Mask,
+    // Apply an element.
+    //   void Apply(const float dis, const size_t idx);
+    typename Apply,
+    typename DCClass>
+void fvec_distance_ny_scalar_masked_if(
+        const DCClass& dc,
+        const uint8_t* __restrict codes,
+        const size_t code_size,
+        const size_t ny,
+        Mask mask,
+        Apply apply) {
+    // compute distances from the query to 4 elements
+    auto distance4 = [&](const size_t j0, const size_t j1, const size_t j2, const size_t j3) {
+        float dis0, dis1, dis2, dis3;
+        dc.query_to_codes_batch_4(
+            codes + j0 * code_size,
+            codes + j1 * code_size,
+            codes + j2 * code_size,
+            codes + j3 * code_size,
+            dis0,
+            dis1,
+            dis2,
+            dis3
+        );
+        apply(dis0, j0);
+        apply(dis1, j1);
+        apply(dis2, j2);
+        apply(dis3, j3);
+    };
+
+    auto process_run = [&](const size_t j0, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            distance4(j0 + i, j0 + i + 1, j0 + i + 2, j0 + i + 3);
+        }
+        for (; i < n; i++) {
+            apply(dc.query_to_code(codes + (j0 + i) * code_size), j0 + i);
+        }
+    };
+
+    auto process_idx = [&](const size_t* indices, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            distance4(indices[i], indices[i + 1], indices[i + 2], indices[i + 3]);
+        }
+        for (; i < n; i++) {
+            apply(dc.query_to_code(codes + indices[i] * code_size), indices[i]);
+        }
+    };
+
+    masked_blocks_if(ny, mask, process_run, process_idx);
+}
+
 /* use_sel = 0: don't check selector
  * = 1: check on ids[j]
  * = 2: check in j directly (normally ids is nullptr and store_pairs)
@@ -29,6 +89,9 @@ struct IVFSQScannerIP : InvertedListScanner {
 
     float accu0; /// added to all distances
 
+    // set when sel is a knowhere bitset, it is then checked 64 ids at a time
+    knowhere::BitsetView bitset;
+
     IVFSQScannerIP(
             int d,
             const std::vector<float>& trained,
@@ -41,6 +104,9 @@ struct IVFSQScannerIP : InvertedListScanner {
         this->sel = sel;
         this->code_size = code_size;
         this->keep_max = true;
+        if (const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
+            bitset = bitsetview_sel->bitset_view;
+        }
     }
 
     void set_query(const float* query) override {
@@ -67,6 +133,23 @@ struct IVFSQScannerIP : InvertedListScanner {
             size_t& scan_cnt) const override {
         size_t nup = 0;
 
+        if (use_sel == 1 && !bitset.empty()) {
+            fvec_distance_ny_scalar_masked_if(
+                    dc, codes, code_size, list_size,
+                    [&](const size_t j0, const size_t n) {
+                        return ~bitset.test_ids(ids + j0, n);
+                    },
+                    [&](const float dis, const size_t j) {
+                        const float accu = accu0 + dis;
+                        if (accu > simi[0]) {
+                            int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                            minheap_replace_top(k, simi, idxi, accu, id);
+                            nup++;
+                        }
+                    });
+            return nup;
+        }
+
         for (size_t j = 0; j < list_size; j++, codes += code_size) {
             if (use_sel && !sel->is_member(use_sel == 1 ? ids[j] : j)) {
                 continue;
@@ -91,6 +174,22 @@ struct IVFSQScannerIP : InvertedListScanner {
             const idx_t* ids,
             float radius,
             RangeQueryResult& res) const override {
+        if (use_sel == 1 && !bitset.empty()) {
+            fvec_distance_ny_scalar_masked_if(
+                    dc, codes, code_size, list_size,
+                    [&](const size_t j0, const size_t n) {
+                        return ~bitset.test_ids(ids + j0, n);
+                    },
+                    [&](const float dis, const size_t j) {
+                        const float accu = accu0 + dis;
+                        if (accu > radius) {
+                            int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                            res.add(accu, id);
+                        }
+                    });
+            return;
+        }
+
         for (size_t j = 0; j < list_size; j++, codes += code_size) {
             if (use_sel && !sel->is_member(use_sel == 1 ? ids[j] : j)) {
                 continue;
@@ -170,6 +269,9 @@ struct IVFSQScannerL2 : InvertedListScanner {
 
     std::vector<float> tmp;
 
+    // set when sel is a knowhere bitset, it is then checked 64 ids at a time
+    knowhere::BitsetView bitset;
+
     IVFSQScannerL2(
             int d,
             const std::vector<float>& trained,
@@ -186,6 +288,9 @@ struct IVFSQScannerL2 : InvertedListScanner {
         this->store_pairs = store_pairs;
         this->sel = sel;
         this->code_size = code_size;
+        if (const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
+            bitset = bitsetview_sel->bitset_view;
+        }
     }
 
     void set_query(const float* query) override {
@@ -251,7 +356,16 @@ struct IVFSQScannerL2 : InvertedListScanner {
             };
 
         // compute distances
-        fvec_L2sqr_ny_scalar_if(dc, codes, code_size, list_size, filter, apply);
+        if (use_sel == 1 && !bitset.empty()) {
+            fvec_distance_ny_scalar_masked_if(
+                    dc, codes, code_size, list_size,
+                    [&](const size_t j0, const size_t n) {
+                        return ~bitset.test_ids(ids + j0, n);
+                    },
+                    apply);
+        } else {
+            fvec_L2sqr_ny_scalar_if(dc, codes, code_size, list_size, filter, apply);
+        }
 
         return nup;
     }
@@ -263,6 +377,21 @@ struct IVFSQScannerL2 : InvertedListScanner {
             const idx_t* ids,
             float radius,
             RangeQueryResult& res) const override {
+        if (use_sel == 1 && !bitset.empty()) {
+            fvec_distance_ny_scalar_masked_if(
+                    dc, codes, code_size, list_size,
+                    [&](const size_t j0, const size_t n) {
+                        return ~bitset.test_ids(ids + j0, n);
+                    },
+                    [&](const float dis, const size_t j) {
+                        if (dis < radius) {
+                            int64_t id = store_pairs ? lo_build(list_no, j) : ids[j];
+                            res.add(dis, id);
+                        }
+                    });
+            return;
+        }
+
         for (size_t j = 0; j < list_size; j++, codes += code_size) {
             if (use_sel && !sel->is_member(use_sel == 1 ? ids[j] : j)) {
                 continue;
@@ -37,6 +37,7 @@
 #include <faiss/IndexIVFPQ.h>
 #include <faiss/IndexIVFPQFastScan.h>
 #include <faiss/IndexIVFPQR.h>
+#include <faiss/IndexIVFRaBitQ.h>
 #include <faiss/IndexIVFSpectralHash.h>
 #include <faiss/IndexLSH.h>
 #include <faiss/IndexLattice.h>
@@ -1043,6 +1044,22 @@ Index* read_index(IOReader* f, int io_flags) {
         READVECTOR(ivsp->trained);
         read_InvertedLists(ivsp, f, io_flags);
         idx = ivsp;
+    } else if (h == fourcc("IwRB")) {
+        IndexIVFRaBitQ* ivrb = new IndexIVFRaBitQ();
+        read_ivf_header(ivrb, f);
+        READ1(ivrb->d_rot);
+        // not stored by write_ivf_header
+        ivrb->code_size = ivrb->d_rot / 8 + 2 * sizeof(float);
+        READVECTOR(ivrb->rotation_signs);
+        READ1(ivrb->eps0);
+        bool with_refine;
+        READ1(with_refine);
+        if (with_refine) {
+            ivrb->refine_index = read_index(f, io_flags);
+        }
+        read_InvertedLists(ivrb, f, io_flags);
+        ivrb->compute_rotated_centroids();
+        idx = ivrb;
     } else if (
             h == fourcc("IvPQ") || h == fourcc("IvQR") || h == fourcc("IwPQ") ||
             h == fourcc("IwQR")) {
@@ -1083,13 +1100,14 @@ Index* read_index(IOReader* f, int io_flags) {
         read_index_header(imiq, f);
         read_ProductQuantizer(&imiq->pq, f);
         idx = imiq;
-    } else if (h == fourcc("IxSC")) {
-        IndexScaNN* idxscann = new IndexScaNN();
+    } else if (h == fourcc("IxSC") || h == fourcc("IxS4")) {
+        IndexScaNN* idxscann = h == fourcc("IxS4") ? new IndexSQ4FastScan()
+                                                   : new IndexScaNN();
         read_index_header(idxscann, f);
         idxscann->base_index = read_index(f, io_flags);
-        bool with_raw_data;
-        READ1(with_raw_data);
-        if (with_raw_data) {
+        bool with_refine;
+        READ1(with_refine);
+        if (with_refine) {
             idxscann->refine_index = read_index(f, io_flags);
         } else {
             idxscann->refine_index = nullptr;
@@ -37,6 +37,7 @@
 #include <faiss/IndexIVFPQ.h>
 #include <faiss/IndexIVFPQFastScan.h>
 #include <faiss/IndexIVFPQR.h>
+#include <faiss/IndexIVFRaBitQ.h>
 #include <faiss/IndexIVFSpectralHash.h>
 #include <faiss/IndexLSH.h>
 #include <faiss/IndexLattice.h>
@@ -865,6 +866,20 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         WRITE1(ivsp->threshold_type);
         WRITEVECTOR(ivsp->trained);
         write_InvertedLists(ivsp->invlists, f);
+    } else if (
+            const IndexIVFRaBitQ* ivrb =
+                    dynamic_cast<const IndexIVFRaBitQ*>(idx)) {
+        uint32_t h = fourcc("IwRB");
+        WRITE1(h);
+        write_ivf_header(ivrb, f);
+        WRITE1(ivrb->d_rot);
+        WRITEVECTOR(ivrb->rotation_signs);
+        WRITE1(ivrb->eps0);
+        bool with_refine = ivrb->refine_index != nullptr;
+        WRITE1(with_refine);
+        if (with_refine)
+            write_index(ivrb->refine_index, f);
+        write_InvertedLists(ivrb->invlists, f);
     } else if (const IndexIVFPQ* ivpq = dynamic_cast<const IndexIVFPQ*>(idx)) {
         const IndexIVFPQR* ivfpqr = dynamic_cast<const IndexIVFPQR*>(idx);
 
@@ -916,13 +931,15 @@ void write_index(const Index* idx, IOWriter* f, int io_flags) {
         write_ProductQuantizer(&imiq->pq, f);
     } else if (
         const IndexScaNN* idxscann = dynamic_cast<const IndexScaNN*>(idx)) {
-        uint32_t h = fourcc("IxSC");
+        uint32_t h = dynamic_cast<const IndexSQ4FastScan*>(idx)
+                ? fourcc("IxS4")
+                : fourcc("IxSC");
         WRITE1(h);
         write_index_header(idxscann, f);
         write_index(idxscann->base_index, f);
-        bool with_raw_data = idxscann->with_raw_data();
-        WRITE1(with_raw_data);
-        if (with_raw_data)
+        bool with_refine = idxscann->refine_index != nullptr;
+        WRITE1(with_refine);
+        if (with_refine)
             write_index(idxscann->refine_index, f);
         WRITE1(idxscann->k_factor);
     } else if (
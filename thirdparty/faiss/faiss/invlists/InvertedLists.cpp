@@ -458,7 +458,7 @@ const float* ArrayInvertedLists::get_code_norms(
         size_t offset) const {
     if (with_norm) {
         assert(list_no < nlist);
-        return code_norms[list_no].data();
+        return code_norms[list_no].data() + offset;
     } else {
         return nullptr;
     }
@@ -27,118 +27,33 @@
 
 namespace faiss {
 
-extern uint8_t lookup8bit[256];
-
-#define fast_loop_imp(fun_u64, fun_u8)                 \
-    auto a = reinterpret_cast<const uint64_t*>(data1); \
-    auto b = reinterpret_cast<const uint64_t*>(data2); \
-    int div = code_size / 8;                           \
-    int mod = code_size % 8;                           \
-    int i = 0, len = div;                              \
-    switch (len & 7) {                                 \
-        default:                                       \
-            while (len > 7) {                          \
-                len -= 8;                              \
-                fun_u64;                               \
-                i++;                                   \
-                case 7:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 6:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 5:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 4:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 3:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 2:                                \
-                    fun_u64;                           \
-                    i++;                               \
-                case 1:                                \
-                    fun_u64;                           \
-                    i++;                               \
-            }                                          \
-    }                                                  \
-    if (mod) {                                         \
-        auto a = data1 + 8 * div;                      \
-        auto b = data2 + 8 * div;                      \
-        switch (mod) {                                 \
-            case 7:                                    \
-                fun_u8(6);                             \
-            case 6:                                    \
-                fun_u8(5);                             \
-            case 5:                                    \
-                fun_u8(4);                             \
-            case 4:                                    \
-                fun_u8(3);                             \
-            case 3:                                    \
-                fun_u8(2);                             \
-            case 2:                                    \
-                fun_u8(1);                             \
-            case 1:                                    \
-                fun_u8(0);                             \
-            default:                                   \
-                break;                                 \
-        }                                              \
-    }
-
 int popcnt(const uint8_t* data, const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-    auto data1 = data, data2 = data; // for the macro fast_loop_imp
-#define fun_u64 accu += popcount64(a[i])
-#define fun_u8(i) accu += lookup8bit[a[i]]
-    int accu = 0;
-    fast_loop_imp(fun_u64, fun_u8);
-    return accu;
-#undef fun_u64
-#undef fun_u8
+    return bitset_popcount(data, code_size);
 }
 
 int xor_popcnt(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-#define fun_u64 accu += popcount64(a[i] ^ b[i]);
-#define fun_u8(i) accu += lookup8bit[a[i] ^ b[i]];
-    int accu = 0;
-    fast_loop_imp(fun_u64, fun_u8);
-    return accu;
-#undef fun_u64
-#undef fun_u8
+    return bvec_xor_popcount(data1, data2, code_size);
 }
 
 int or_popcnt(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-#define fun_u64 accu += popcount64(a[i] | b[i])
-#define fun_u8(i) accu += lookup8bit[a[i] | b[i]]
-    int accu = 0;
-    fast_loop_imp(fun_u64, fun_u8);
-    return accu;
-#undef fun_u64
-#undef fun_u8
+    int and_count, or_count;
+    bvec_and_or_popcount(data1, data2, code_size, and_count, or_count);
+    return or_count;
 }
 
 int and_popcnt(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-#define fun_u64 accu += popcount64(a[i] & b[i])
-#define fun_u8(i) accu += lookup8bit[a[i] & b[i]]
-    int accu = 0;
-    fast_loop_imp(fun_u64, fun_u8);
-    return accu;
-#undef fun_u64
-#undef fun_u8
+    int and_count, or_count;
+    bvec_and_or_popcount(data1, data2, code_size, and_count, or_count);
+    return and_count;
 }
 
 // return true, if data1 is subset of data2
@@ -147,37 +62,16 @@ bool is_subset(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-#define fun_u64                \
-    if ((a[i] & b[i]) != a[i]) \
-    return false
-#define fun_u8(i)              \
-    if ((a[i] & b[i]) != a[i]) \
-    return false
-    fast_loop_imp(fun_u64, fun_u8);
-    return true;
-#undef fun_u64
-#undef fun_u8
+    return bvec_is_subset(data1, data2, code_size);
 }
 
 float bvec_jaccard(
         const uint8_t* data1,
         const uint8_t* data2,
         const size_t code_size) {
-    // todo aguzhva: improve this code, maybe reuse the code from hamming.h
-#define fun_u64                          \
-    accu_num += popcount64(a[i] & b[i]); \
-    accu_den += popcount64(a[i] | b[i])
-#define fun_u8(i)                        \
-    accu_num += lookup8bit[a[i] & b[i]]; \
-    accu_den += lookup8bit[a[i] | b[i]]
-    int accu_num = 0;
-    int accu_den = 0;
-    fast_loop_imp(fun_u64, fun_u8);
-    return (accu_den == 0) ? 1.0
-                           : ((float)(accu_den - accu_num) / (float)(accu_den));
-#undef fun_u64
-#undef fun_u8
+    int and_count, or_count;
+    bvec_and_or_popcount(data1, data2, code_size, and_count, or_count);
+    return jaccard_distance(and_count, or_count);
 }
 
 template <class T>
@@ -462,19 +356,22 @@ void binary_knn_hc(
             for (size_t i = 0; i < ha->nh; i++) {
                 MetricComputer hc(bs1 + i * bytes_per_code, bytes_per_code);
 
-                const uint8_t* bs2_ = bs2 + j0 * bytes_per_code;
-                T dis;
                 T* __restrict bh_val_ = ha->val + i * k;
                 int64_t* __restrict bh_ids_ = ha->ids + i * k;
-                for (size_t j = j0; j < j1; j++, bs2_ += bytes_per_code) {
-                    if (!sel || sel->is_member(j)) {
-                        dis = hc.compute(bs2_);
-                        if (C::cmp(bh_val_[0], dis)) {
-                            faiss::heap_replace_top<C>(
-                                    k, bh_val_, bh_ids_, dis, j);
-                        }
-                    }
-                }
+                scan_codes_distances(
+                        hc,
+                        j1 - j0,
+                        bs2 + j0 * bytes_per_code,
+                        bytes_per_code,
+                        [&](size_t j) {
+                            return !sel || sel->is_member(j0 + j);
+                        },
+                        [&](size_t j, T dis) {
+                            if (C::cmp(bh_val_[0], dis)) {
+                                faiss::heap_replace_top<C>(
+                                        k, bh_val_, bh_ids_, dis, j0 + j);
+                            }
+                        });
             }
         }
     }
@@ -502,10 +399,6 @@ void binary_knn_hc(
                     binary_knn_hc_jaccard(8);
                     binary_knn_hc_jaccard(16);
                     binary_knn_hc_jaccard(32);
-                    binary_knn_hc_jaccard(64);
-                    binary_knn_hc_jaccard(128);
-                    binary_knn_hc_jaccard(256);
-                    binary_knn_hc_jaccard(512);
 #undef binary_knn_hc_jaccard
                     default:
                         binary_knn_hc<C, faiss::JaccardComputerDefault>(
@@ -580,14 +473,17 @@ void binary_range_search(
         for (int64_t i = 0; i < na; i++) {
             MetricComputer mc(a + i * code_size, code_size);
             RangeQueryResult& qres = pres.new_result(i);
-            for (size_t j = 0; j < nb; j++) {
-                if (!sel || sel->is_member(j)) {
-                    T dis = mc.compute(b + j * code_size);
-                    if (C::cmp(dis, radius)) {
-                        qres.add(dis, j);
-                    }
-                }
-            }
+            scan_codes_distances(
+                    mc,
+                    nb,
+                    b,
+                    code_size,
+                    [&](size_t j) { return !sel || sel->is_member(j); },
+                    [&](size_t j, T dis) {
+                        if (C::cmp(dis, radius)) {
+                            qres.add(dis, j);
+                        }
+                    });
         }
         pres.finalize();
     }
@@ -616,10 +512,6 @@ void binary_range_search(
                     binary_range_search_jaccard(8);
                     binary_range_search_jaccard(16);
                     binary_range_search_jaccard(32);
-                    binary_range_search_jaccard(64);
-                    binary_range_search_jaccard(128);
-                    binary_range_search_jaccard(256);
-                    binary_range_search_jaccard(512);
 #undef binary_range_search_jaccard
                     default:
                         binary_range_search<
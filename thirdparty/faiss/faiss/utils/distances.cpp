@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <type_traits>
 
 #include <omp.h>
 
@@ -148,6 +149,28 @@ struct IDSelectorHelper {
     }
 };
 
+// a filter given as the sorted list of allowed ids, only those rows are
+// visited
+struct AllowedIdsSelectorHelper {
+    const int64_t* ids;
+    size_t n;
+
+    inline bool is_member(const size_t idx) const {
+        return std::binary_search(ids, ids + n, (int64_t)idx);
+    }
+
+    // ids beyond the ny rows are dropped
+    static AllowedIdsSelectorHelper from(
+            const knowhere::BitsetView& bitset,
+            size_t ny) {
+        const int64_t* ids = bitset.allowed_ids();
+        const size_t n =
+                std::lower_bound(ids, ids + bitset.allowed_num(), (int64_t)ny) -
+                ids;
+        return {ids, n};
+    }
+};
+
 struct BitsetViewSelectorHelper {
     // todo aguzhva: use avx gather instruction
     const knowhere::BitsetView bitset;
@@ -155,6 +178,11 @@ struct BitsetViewSelectorHelper {
     inline bool is_member(const size_t idx) const {
         return !bitset.test(idx);
     }
+
+    // acceptable elements among the 64 starting at j0
+    inline uint64_t members(const size_t j0) const {
+        return ~bitset.test_word(j0);
+    }
 };
 
 /* Find the nearest neighbors for nx queries in a set of ny vectors */
@@ -230,7 +258,25 @@ void exhaustive_inner_product_seq_impl(
             };
 
             // compute distances
-            fvec_inner_products_ny_if(x_i, y, d, ny, filter, apply);
+            if constexpr (std::is_same_v<SelectorHelper, AllowedIdsSelectorHelper>) {
+                const int64_t* ids = selector.ids;
+                fvec_inner_products_ny_by_idx_if(
+                        x_i, y, ids, d, selector.n,
+                        [](const size_t) { return true; },
+                        [&apply, ids](const float ip, const idx_t j) {
+                            apply(ip, ids[j]);
+                        });
+            } else if constexpr (std::is_same_v<SelectorHelper, BitsetViewSelectorHelper>) {
+                // skip words of filtered out rows at once
+                fvec_inner_products_ny_masked_if(
+                        x_i, y, d, ny,
+                        [&selector](const size_t j0, const size_t) {
+                            return selector.members(j0);
+                        },
+                        apply);
+            } else {
+                fvec_inner_products_ny_if(x_i, y, d, ny, filter, apply);
+            }
 
             resi.end();
         }
@@ -254,6 +300,13 @@ void exhaustive_inner_product_seq(
     if (const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
         // A specialized case for Knowhere
         auto bitset = bitsetview_sel->bitset_view;
+        if (bitset.has_allowed_ids()) {
+            // only visit the allowed rows instead of testing all of them
+            auto ids_helper = AllowedIdsSelectorHelper::from(bitset, ny);
+            exhaustive_inner_product_seq_impl<BlockResultHandler, AllowedIdsSelectorHelper>(
+                x, y, d, nx, ny, res, ids_helper);
+            return;
+        }
         if (!bitset.empty()) {
             BitsetViewSelectorHelper bitset_helper{bitset};
             exhaustive_inner_product_seq_impl<BlockResultHandler, BitsetViewSelectorHelper>(
@@ -344,7 +397,25 @@ void exhaustive_L2sqr_seq_impl(
             };
 
             // compute distances
-            fvec_L2sqr_ny_if(x_i, y, d, ny, filter, apply);
+            if constexpr (std::is_same_v<SelectorHelper, AllowedIdsSelectorHelper>) {
+                const int64_t* ids = selector.ids;
+                fvec_L2sqr_ny_by_idx_if(
+                        x_i, y, ids, d, selector.n,
+                        [](const size_t) { return true; },
+                        [&apply, ids](const float dis, const idx_t j) {
+                            apply(dis, ids[j]);
+                        });
+            } else if constexpr (std::is_same_v<SelectorHelper, BitsetViewSelectorHelper>) {
+                // skip words of filtered out rows at once
+                fvec_L2sqr_ny_masked_if(
+                        x_i, y, d, ny,
+                        [&selector](const size_t j0, const size_t) {
+                            return selector.members(j0);
+                        },
+                        apply);
+            } else {
+                fvec_L2sqr_ny_if(x_i, y, d, ny, filter, apply);
+            }
 
             resi.end();
         }
@@ -368,6 +439,13 @@ void exhaustive_L2sqr_seq(
     if (const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
         // A specialized case for Knowhere
         auto bitset = bitsetview_sel->bitset_view;
+        if (bitset.has_allowed_ids()) {
+            // only visit the allowed rows instead of testing all of them
+            auto ids_helper = AllowedIdsSelectorHelper::from(bitset, ny);
+            exhaustive_L2sqr_seq_impl<BlockResultHandler, AllowedIdsSelectorHelper>(
+                x, y, d, nx, ny, res, ids_helper);
+            return;
+        }
         if (!bitset.empty()) {
             BitsetViewSelectorHelper bitset_helper{bitset};
             exhaustive_L2sqr_seq_impl<BlockResultHandler, BitsetViewSelectorHelper>(
@@ -469,7 +547,25 @@ void exhaustive_cosine_seq_impl(
             };
 
             // compute distances
-            fvec_inner_products_ny_if(x_i, y, d, ny, filter, apply);
+            if constexpr (std::is_same_v<SelectorHelper, AllowedIdsSelectorHelper>) {
+                const int64_t* ids = selector.ids;
+                fvec_inner_products_ny_by_idx_if(
+                        x_i, y, ids, d, selector.n,
+                        [](const size_t) { return true; },
+                        [&apply, ids](const float ip, const idx_t j) {
+                            apply(ip, ids[j]);
+                        });
+            } else if constexpr (std::is_same_v<SelectorHelper, BitsetViewSelectorHelper>) {
+                // skip words of filtered out rows at once
+                fvec_inner_products_ny_masked_if(
+                        x_i, y, d, ny,
+                        [&selector](const size_t j0, const size_t) {
+                            return selector.members(j0);
+                        },
+                        apply);
+            } else {
+                fvec_inner_products_ny_if(x_i, y, d, ny, filter, apply);
+            }
 
             resi.end();
         }
@@ -494,6 +590,13 @@ void exhaustive_cosine_seq(
     if (const auto* bitsetview_sel = dynamic_cast<const knowhere::BitsetViewIDSelector*>(sel)) {
         // A specialized case for Knowhere
         auto bitset = bitsetview_sel->bitset_view;
+        if (bitset.has_allowed_ids()) {
+            // only visit the allowed rows instead of testing all of them
+            auto ids_helper = AllowedIdsSelectorHelper::from(bitset, ny);
+            exhaustive_cosine_seq_impl<BlockResultHandler, AllowedIdsSelectorHelper>(
+                x, y, y_norms, d, nx, ny, res, ids_helper);
+            return;
+        }
         if (!bitset.empty()) {
             BitsetViewSelectorHelper bitset_helper{bitset};
             exhaustive_cosine_seq_impl<BlockResultHandler, BitsetViewSelectorHelper>(
@@ -129,6 +129,53 @@ leftovers:
     }
 }
 
+// The size of a block of elements whose filter bits are checked in one word.
+constexpr size_t MASK_BLOCK_SIZE = 64;
+
+// Checks the elements in blocks of MASK_BLOCK_SIZE using a single word of
+//   filter bits per block. Blocks without acceptable elements are skipped
+//   as a whole, blocks where every element is acceptable are processed as
+//   a contiguous run and the rest is compacted into a list of indices.
+template<
+    // Returns the filter bits of a block.
+    //   uint64_t Mask(const size_t j0, const size_t n);
+    // * bit i is set if the element j0 + i is acceptable.
+    typename Mask,
+    // process a contiguous run of acceptable elements.
+    //   void ProcessRun(const size_t j0, const size_t n);
+    typename ProcessRun,
+    // process acceptable elements given by their indices.
+    //   void ProcessIdx(const size_t* indices, const size_t n);
+    typename ProcessIdx>
+void masked_blocks_if(
+        const size_t ny,
+        Mask mask,
+        ProcessRun process_run,
+        ProcessIdx process_idx) {
+    size_t indices[MASK_BLOCK_SIZE];
+
+    for (size_t j0 = 0; j0 < ny; j0 += MASK_BLOCK_SIZE) {
+        const size_t n = std::min(MASK_BLOCK_SIZE, ny - j0);
+        const uint64_t all = (n == MASK_BLOCK_SIZE) ? ~uint64_t(0) : ((uint64_t(1) << n) - 1);
+
+        uint64_t word = mask(j0, n) & all;
+        if (word == 0) {
+            continue;
+        }
+        if (word == all) {
+            process_run(j0, n);
+            continue;
+        }
+
+        size_t counter = 0;
+        while (word != 0) {
+            indices[counter++] = j0 + __builtin_ctzll(word);
+            word &= word - 1;
+        }
+        process_idx(indices, counter);
+    }
+}
+
 // does nothing
 struct NoRemapping {
     inline size_t operator()(const size_t idx) const {
@@ -240,14 +287,17 @@ void internal_fvec_inner_products_ny_if(
         Apply apply) {
     using idx_type = std::invoke_result_t<IndexRemapper, size_t>;
 
+    // the kernels unrolled for d if there are, picked once for the scan
+    const FvecKernels kernels = fvec_kernels_for_dim(d);
+
     // compute a distance from the query to 1 element
-    auto distance1 = [x, y, d](const idx_type idx) { 
-        return fvec_inner_product(x, y + idx * d, d); 
+    auto distance1 = [x, y, d, &kernels](const idx_type idx) { 
+        return kernels.inner_product(x, y + idx * d, d); 
     };
 
     // compute distances from the query to 4 elements
-    auto distance4 = [x, y, d](const std::array<idx_type, 4> indices, std::array<float, 4>& dis) { 
-        fvec_inner_product_batch_4(
+    auto distance4 = [x, y, d, &kernels](const std::array<idx_type, 4> indices, std::array<float, 4>& dis) { 
+        kernels.inner_product_batch_4(
             x,
             y + indices[0] * d,
             y + indices[1] * d,
@@ -297,14 +347,17 @@ void internal_fvec_L2sqr_ny_if(
         Apply apply) {    
     using idx_type = std::invoke_result_t<IndexRemapper, size_t>;
 
+    // the kernels unrolled for d if there are, picked once for the scan
+    const FvecKernels kernels = fvec_kernels_for_dim(d);
+
     // compute a distance from the query to 1 element
-    auto distance1 = [x, y, d](const idx_type idx) { 
-        return fvec_L2sqr(x, y + idx * d, d); 
+    auto distance1 = [x, y, d, &kernels](const idx_type idx) { 
+        return kernels.L2sqr(x, y + idx * d, d); 
     };
 
     // compute distances from the query to 4 elements
-    auto distance4 = [x, y, d](const std::array<idx_type, 4> indices, std::array<float, 4>& dis) { 
-        fvec_L2sqr_batch_4(
+    auto distance4 = [x, y, d, &kernels](const std::array<idx_type, 4> indices, std::array<float, 4>& dis) { 
+        kernels.L2sqr_batch_4(
             x,
             y + indices[0] * d,
             y + indices[1] * d,
@@ -525,6 +578,120 @@ void internal_distance_compute_if(
     );
 }
 
+// compute ny inner product between x vectors x and a set of contiguous y vectors
+//   with filtering by words of 64 elements and applying filtered elements.
+//   Fully acceptable words use the unfiltered fvec_inner_products_ny() kernel.
+template<
+    // Returns the filter bits of a block.
+    //   uint64_t Mask(const size_t j0, const size_t n);
+    // * bit i is set if the element j0 + i is acceptable.
+    typename Mask,
+    // Apply an element.
+    //   void Apply(const float dis, const size_t idx);
+    typename Apply>
+void fvec_inner_products_ny_masked_if(
+        const float* __restrict x,
+        const float* __restrict y,
+        size_t d,
+        const size_t ny,
+        Mask mask,
+        Apply apply) {
+    auto process_run = [&](const size_t j0, const size_t n) {
+        float dis[MASK_BLOCK_SIZE];
+        fvec_inner_products_ny(dis, x, y + j0 * d, d, n);
+        for (size_t i = 0; i < n; i++) {
+            apply(dis[i], j0 + i);
+        }
+    };
+
+    // the kernels unrolled for d if there are, picked once for the scan
+    const FvecKernels kernels = fvec_kernels_for_dim(d);
+    auto process_idx = [&](const size_t* indices, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            float dis0, dis1, dis2, dis3;
+            kernels.inner_product_batch_4(
+                x,
+                y + indices[i] * d,
+                y + indices[i + 1] * d,
+                y + indices[i + 2] * d,
+                y + indices[i + 3] * d,
+                d,
+                dis0,
+                dis1,
+                dis2,
+                dis3
+            );
+            apply(dis0, indices[i]);
+            apply(dis1, indices[i + 1]);
+            apply(dis2, indices[i + 2]);
+            apply(dis3, indices[i + 3]);
+        }
+        for (; i < n; i++) {
+            apply(kernels.inner_product(x, y + indices[i] * d, d), indices[i]);
+        }
+    };
+
+    masked_blocks_if(ny, mask, process_run, process_idx);
+}
+
+// compute ny square L2 distance between x vectors x and a set of contiguous y vectors
+//   with filtering by words of 64 elements and applying filtered elements.
+//   Fully acceptable words use the unfiltered fvec_L2sqr_ny() kernel.
+template<
+    // Returns the filter bits of a block.
+    //   uint64_t Mask(const size_t j0, const size_t n);
+    // * bit i is set if the element j0 + i is acceptable.
+    typename Mask,
+    // Apply an element.
+    //   void Apply(const float dis, const size_t idx);
+    typename Apply>
+void fvec_L2sqr_ny_masked_if(
+        const float* __restrict x,
+        const float* __restrict y,
+        size_t d,
+        const size_t ny,
+        Mask mask,
+        Apply apply) {
+    auto process_run = [&](const size_t j0, const size_t n) {
+        float dis[MASK_BLOCK_SIZE];
+        fvec_L2sqr_ny(dis, x, y + j0 * d, d, n);
+        for (size_t i = 0; i < n; i++) {
+            apply(dis[i], j0 + i);
+        }
+    };
+
+    // the kernels unrolled for d if there are, picked once for the scan
+    const FvecKernels kernels = fvec_kernels_for_dim(d);
+    auto process_idx = [&](const size_t* indices, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            float dis0, dis1, dis2, dis3;
+            kernels.L2sqr_batch_4(
+                x,
+                y + indices[i] * d,
+                y + indices[i + 1] * d,
+                y + indices[i + 2] * d,
+                y + indices[i + 3] * d,
+                d,
+                dis0,
+                dis1,
+                dis2,
+                dis3
+            );
+            apply(dis0, indices[i]);
+            apply(dis1, indices[i + 1]);
+            apply(dis2, indices[i + 2]);
+            apply(dis3, indices[i + 3]);
+        }
+        for (; i < n; i++) {
+            apply(kernels.L2sqr(x, y + indices[i] * d, d), indices[i]);
+        }
+    };
+
+    masked_blocks_if(ny, mask, process_run, process_idx);
+}
+
 // compute ny distance between x vectors x and a set of contiguous y vectors
 //   with filtering and applying filtered elements.
 template<
@@ -8,7 +8,9 @@
 #ifndef FAISS_hamming_common_h
 #define FAISS_hamming_common_h
 
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 #include <faiss/impl/platform_macros.h>
 
@@ -17,6 +19,63 @@ using hamdis_t = int32_t;
 
 namespace faiss {
 
+// whether a distance computer can compute the distances to 4 codes at once
+template <class Computer, class = void>
+struct has_compute_batch_4 : std::false_type {};
+
+template <class Computer>
+struct has_compute_batch_4<
+        Computer,
+        std::void_t<decltype(&Computer::compute_batch_4)>> : std::true_type {};
+
+// calls consume(j, dis) for the codes j < n that pass filter(j), in order.
+// computers with compute_batch_4 get the codes that pass 4 at a time.
+template <class Computer, class Filter, class Consume>
+inline void scan_codes_distances(
+        const Computer& hc,
+        size_t n,
+        const uint8_t* codes,
+        size_t code_size,
+        Filter&& filter,
+        Consume&& consume) {
+    if constexpr (has_compute_batch_4<Computer>::value) {
+        using T = decltype(hc.compute(codes));
+        size_t js[4];
+        size_t nbuf = 0;
+        for (size_t j = 0; j < n; j++) {
+            if (!filter(j)) {
+                continue;
+            }
+            js[nbuf++] = j;
+            if (nbuf == 4) {
+                T dis[4];
+                hc.compute_batch_4(
+                        codes + js[0] * code_size,
+                        codes + js[1] * code_size,
+                        codes + js[2] * code_size,
+                        codes + js[3] * code_size,
+                        dis[0],
+                        dis[1],
+                        dis[2],
+                        dis[3]);
+                for (size_t t = 0; t < 4; t++) {
+                    consume(js[t], dis[t]);
+                }
+                nbuf = 0;
+            }
+        }
+        for (size_t t = 0; t < nbuf; t++) {
+            consume(js[t], hc.compute(codes + js[t] * code_size));
+        }
+    } else {
+        for (size_t j = 0; j < n; j++) {
+            if (filter(j)) {
+                consume(j, hc.compute(codes + j * code_size));
+            }
+        }
+    }
+}
+
 // trust the compiler to provide efficient popcount implementations
 inline int popcount32(uint32_t x) {
     return __builtin_popcount(x);
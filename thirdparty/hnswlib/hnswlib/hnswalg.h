@@ -25,8 +25,12 @@
 #include <random>
 #include <unordered_set>
 
+#include "faiss/impl/ProductQuantizer.h"
 #include "hnswlib.h"
 #include "io/memory_io.h"
+#include "knowhere/comp/cancellation.h"
+#include "knowhere/comp/phase_timer.h"
+#include "knowhere/comp/search_stats.h"
 #include "knowhere/config.h"
 #include "knowhere/heap.h"
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
@@ -47,6 +51,24 @@ typedef unsigned int linklistsizeint;
 constexpr float kHnswSearchKnnBFFilterThreshold = 0.93f;
 constexpr float kHnswSearchRangeBFFilterThreshold = 0.97f;
 constexpr float kHnswSearchBFTopkThreshold = 0.5f;
+// filtered knn search: below this filter ratio the plain graph walk is used
+constexpr float kHnswSearchTwoHopFilterThreshold = 0.5f;
+// the two-hop walk needs at least this many valid points within two hops of a node on average, otherwise the valid
+// points are too sparse in the graph to be found by walking it
+constexpr float kHnswSearchTwoHopMinReachable = 4.0f;
+// cost of a bitset test relative to a distance computation, used to price the scan of the whole bitset
+constexpr float kHnswSearchBitsetTestCost = 0.05f;
+// filtered search with an allow-list: allowed points spread over the list that join the entry point as candidates
+constexpr size_t kHnswSearchAllowedSeeds = 16;
+
+// optional sections appended after the upper-layer link lists, each one starts with its tag. Readers that do not know
+// a section stop before it, so indexes without these sections keep the original layout.
+constexpr uint32_t kHnswSectionNeighborCodes = 0x4e434f44;  // "NCOD"
+constexpr uint32_t kHnswSectionReorder = 0x524f5244;        // "RORD"
+// 4-bit codes: 16 centroids per sub-quantizer
+constexpr size_t kNeighborCodeNbits = 4;
+constexpr size_t kNeighborCodeKsub = 1 << kNeighborCodeNbits;
+constexpr size_t kNeighborCodeMaxTrainSize = 65536;
 
 enum Metric {
     L2 = 0,
@@ -59,6 +81,26 @@ enum Metric {
 
 enum QuantType { None = 0, SQ8 = 1, SQ8Refine = 2 };
 
+// post-build relabeling of the internal ids, see reorderGraph()
+enum class ReorderType { NONE = 0, BFS = 1, RCM = 2 };
+
+// optional knobs of the base layer search, only set by the knn and range search entrances
+struct BaseLayerSearchOpts {
+    // neighbor code lookup table of the query and the margin over the search bound, see buildNeighborCodes()
+    const float* nc_lut = nullptr;
+    float nc_slack = 0.0f;
+    // adaptive termination: stop once the top-k has not improved for early_stop_patience expansions, 0 disables it
+    size_t topk = 0;
+    size_t early_stop_patience = 0;
+    // filtered search: when an expansion finds fewer valid neighbors than this, the neighbors of its filtered
+    // neighbors are expanded as well until this many valid ones are found, 0 disables it
+    size_t two_hop_target = 0;
+    // filtered search with an allow-list: number of allowed points seeded next to the entry point, 0 disables it
+    size_t allowed_seeds = 0;
+};
+
+enum class FilteredSearchMode { GRAPH = 0, TWO_HOP = 1, BRUTE_FORCE = 2 };
+
 template <typename data_t, typename dist_t, QuantType quant_type>
 class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     static_assert(std::is_same_v<data_t, knowhere::bin1> || std::is_same_v<data_t, knowhere::fp32> ||
@@ -190,6 +232,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 free(linkLists_[i]);
         }
         free(linkLists_);
+        free(neighbor_codes_);
         delete visited_list_pool_;
 
         delete space_;
@@ -250,6 +293,20 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 
     mutable knowhere::lru_cache<uint64_t, tableint> lru_cache;
 
+    // Neighbor code embedding: every level-0 adjacency slot owns a 4-bit PQ code of the neighbor it points to, laid out
+    // as maxM0_ codes per element in the same order as the link list. A hop scores all neighbors from this one
+    // contiguous block and only fetches the full vectors of the promising ones. The block is kept apart from
+    // data_level0_memory_ rather than interleaved with the link lists: a hop costs the same either way, as the vector
+    // fetches dominate it, while interleaving would grow every level-0 record and change its serialized layout.
+    std::unique_ptr<faiss::ProductQuantizer> nc_pq_ = nullptr;
+    size_t nc_code_size_ = 0;
+    uint8_t* neighbor_codes_ = nullptr;
+
+    // Internal ids equal the external labels unless the graph has been reordered, in which case these map between
+    // the two. Bitsets and search results always use external labels.
+    std::vector<tableint> internal_to_label_;
+    std::vector<tableint> label_to_internal_;
+
     // Symmetric quantization to encode each element value from [-alpha, alpha] to [-127, 127]
     void
     trainSQuant(const data_t* train_data, size_t ntrain) {
@@ -288,6 +345,16 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         }
     }
 
+    inline labeltype
+    getExternalLabel(tableint internal_id) const {
+        return internal_to_label_.empty() ? internal_id : internal_to_label_[internal_id];
+    }
+
+    inline tableint
+    getInternalIdByLabel(labeltype label) const {
+        return label_to_internal_.empty() ? label : label_to_internal_[label];
+    }
+
     inline char*
     getSQDataByInternalId(tableint internal_id) const {
         return (data_level0_memory_ + internal_id * size_data_per_element_ + offsetSQData_);
@@ -342,6 +409,143 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return dist;
     }
 
+    bool
+    hasNeighborCodes() const {
+        return neighbor_codes_ != nullptr;
+    }
+
+    inline const uint8_t*
+    getNeighborCodes(tableint internal_id) const {
+        return neighbor_codes_ + internal_id * maxM0_ * nc_code_size_;
+    }
+
+    // approximate distance of a neighbor code, in the same unit as calcDistance
+    inline float
+    calcNeighborCodeDistance(const float* lut, const uint8_t* code) const {
+        const size_t nsub = nc_pq_->M;
+        float dist = 0.0f;
+        size_t m = 0;
+        for (; m + 1 < nsub; m += 2, lut += 2 * kNeighborCodeKsub) {
+            uint8_t c = *code++;
+            dist += lut[c & 0xf] + lut[kNeighborCodeKsub + (c >> 4)];
+        }
+        if (m < nsub) {
+            dist += lut[*code & 0xf];
+        }
+        return dist;
+    }
+
+    // decode the stored vector of an element to float, normalized for COSINE
+    void
+    getFloatVector(tableint internal_id, float* out) const {
+        size_t dim = *(size_t*)dist_func_param_;
+        if constexpr (has_raw_data) {
+            const data_t* x = (const data_t*)getDataByInternalId(internal_id);
+            for (size_t i = 0; i < dim; ++i) {
+                out[i] = (float)x[i];
+            }
+            if (metric_type_ == Metric::COSINE && data_norm_l2_[internal_id] > 0.0f) {
+                for (size_t i = 0; i < dim; ++i) {
+                    out[i] /= data_norm_l2_[internal_id];
+                }
+            }
+        } else {
+            const int8_t* x = (const int8_t*)getSQDataByInternalId(internal_id);
+            for (size_t i = 0; i < dim; ++i) {
+                out[i] = x[i] * alpha_ / 127.0f;
+            }
+        }
+    }
+
+    // Train the neighbor code quantizer and fill the code of every level-0 adjacency slot. Must be called after the
+    // graph is finalized (including connectivity repair), link lists are not expected to change afterwards.
+    void
+    buildNeighborCodes(const data_t* train_data, size_t ntrain, size_t nsub) {
+        static_assert(knowhere::KnowhereFloatTypeCheck<data_t>::value, "neighbor codes need float data");
+        size_t dim = *(size_t*)dist_func_param_;
+        if (nsub == 0 || dim % nsub != 0) {
+            throw std::runtime_error("dimension " + std::to_string(dim) + " is not a multiple of neighbor code m " +
+                                     std::to_string(nsub));
+        }
+        if (ntrain < kNeighborCodeKsub) {
+            throw std::runtime_error("not enough vectors to train neighbor codes");
+        }
+
+        // uniformly sampled training set
+        size_t nsample = std::min(ntrain, kNeighborCodeMaxTrainSize);
+        std::vector<float> sample(nsample * dim);
+        for (size_t i = 0; i < nsample; ++i) {
+            const data_t* x = train_data + (i * ntrain / nsample) * dim;
+            float* y = sample.data() + i * dim;
+            for (size_t j = 0; j < dim; ++j) {
+                y[j] = (float)x[j];
+            }
+            if (metric_type_ == Metric::COSINE) {
+                knowhere::NormalizeVec(y, dim);
+            }
+        }
+        auto pq = std::make_unique<faiss::ProductQuantizer>(dim, nsub, kNeighborCodeNbits);
+        pq->verbose = false;
+        pq->train(nsample, sample.data());
+
+        // encode every element once, then copy the codes into the adjacency slots
+        size_t code_size = pq->code_size;
+        std::vector<uint8_t> codes(cur_element_count * code_size);
+        constexpr size_t batch_size = 8192;
+        std::vector<float> batch(batch_size * dim);
+        for (size_t start = 0; start < cur_element_count; start += batch_size) {
+            size_t n = std::min(batch_size, cur_element_count - start);
+            for (size_t i = 0; i < n; ++i) {
+                getFloatVector(start + i, batch.data() + i * dim);
+            }
+            pq->compute_codes(batch.data(), codes.data() + start * code_size, n);
+        }
+
+        uint8_t* neighbor_codes = (uint8_t*)calloc(max_elements_ * maxM0_ * code_size, 1);  // NOLINT
+        if (neighbor_codes == nullptr) {
+            throw std::runtime_error("Not enough memory: buildNeighborCodes failed to allocate neighbor codes");
+        }
+        for (size_t u = 0; u < cur_element_count; ++u) {
+            linklistsizeint* ll = get_linklist0(u);
+            size_t size = getListCount(ll);
+            tableint* data = (tableint*)(ll + 1);
+            uint8_t* slots = neighbor_codes + u * maxM0_ * code_size;
+            for (size_t j = 0; j < size; ++j) {
+                memcpy(slots + j * code_size, codes.data() + data[j] * code_size, code_size);
+            }
+        }
+        free(neighbor_codes_);
+        neighbor_codes_ = neighbor_codes;
+        nc_code_size_ = code_size;
+        nc_pq_ = std::move(pq);
+    }
+
+    // per-query distance table of the neighbor codes, query must already be normalized for COSINE
+    std::unique_ptr<float[]>
+    computeNeighborCodeLUT(const data_t* query) const {
+        size_t dim = *(size_t*)dist_func_param_;
+        std::unique_ptr<float[]> query_float;
+        const float* x = (const float*)query;
+        if constexpr (!std::is_same_v<data_t, knowhere::fp32>) {
+            query_float = std::make_unique<float[]>(dim);
+            for (size_t i = 0; i < dim; ++i) {
+                query_float[i] = (float)query[i];
+            }
+            x = query_float.get();
+        }
+        auto lut = std::make_unique<float[]>(nc_pq_->M * kNeighborCodeKsub);
+        if (metric_type_ == Metric::L2) {
+            nc_pq_->compute_distance_table(x, lut.get());
+        } else {
+            // hnswlib uses negative inner product as distance
+            nc_pq_->compute_inner_prod_table(x, lut.get());
+            for (size_t i = 0; i < nc_pq_->M * kNeighborCodeKsub; ++i) {
+                lut[i] = -lut[i];
+            }
+        }
+        return lut;
+    }
+
     void
     prefetchData(const tableint id) const {
 #if defined(USE_PREFETCH)
@@ -422,20 +626,45 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     mutable std::atomic<long> metric_distance_computations;
     mutable std::atomic<long> metric_hops;
 
+    // returns the number of distances computed
     template <typename AddSearchCandidate, bool has_deletions, bool collect_metrics = false>
-    inline void
+    inline size_t
     searchBaseLayerSTNext(const void* data_point, Neighbor next, std::vector<bool>& visited, float& accumulative_alpha,
                           const knowhere::BitsetView& bitset, AddSearchCandidate& add_search_candidate,
-                          const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
+                          const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr,
+                          const float* nc_lut = nullptr, float nc_bound = std::numeric_limits<float>::max(),
+                          size_t two_hop_target = 0) const {
         auto [u, d, s] = next;
         tableint* list = (tableint*)get_linklist0(u);
         int size = list[0];
 
+        // pre-screen the unvisited neighbors with their embedded codes, those clearly beyond the bound are left
+        // unvisited so that a later hop with a different bound may still reach them
+        thread_local std::vector<tableint> screened;
+        if (nc_lut != nullptr) {
+            screened.resize(size + 1);
+            const uint8_t* codes = getNeighborCodes(u);
+            int kept = 0;
+            for (int i = 1; i <= size; ++i) {
+                tableint v = list[i];
+                if (!visited[v] && calcNeighborCodeDistance(nc_lut, codes + (i - 1) * nc_code_size_) > nc_bound) {
+                    continue;
+                }
+                screened[++kept] = v;
+            }
+            list = screened.data();
+            size = kept;
+        }
+
         if constexpr (collect_metrics) {
             metric_hops++;
             metric_distance_computations += size;
         }
         float kAlpha = bitset.filter_ratio() / 2.0f;
+        thread_local std::vector<tableint> filtered_neighbors;
+        filtered_neighbors.clear();
+        size_t valid_neighbors = 0;
+        size_t ndis = 0;
         for (size_t i = 1; i <= size; ++i) {
             if (i + 1 <= size) {
                 prefetchData(list[i + 1]);
@@ -451,16 +680,22 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             }
             visited[v] = true;
             int status = Neighbor::kValid;
-            if (has_deletions && bitset.test((int64_t)v)) {
+            if (has_deletions && bitset.test((int64_t)getExternalLabel(v))) {
                 status = Neighbor::kInvalid;
+                if (two_hop_target > 0) {
+                    filtered_neighbors.push_back(v);
+                }
 
                 accumulative_alpha += kAlpha;
                 if (accumulative_alpha < 1.0f) {
                     continue;
                 }
                 accumulative_alpha -= 1.0f;
+            } else {
+                valid_neighbors++;
             }
             dist_t dist = calcDistance(data_point, v);
+            ndis++;
             if (feder_result != nullptr) {
                 feder_result->visit_info_.AddVisitRecord(0, u, v, dist);
                 feder_result->id_set_.insert(u);
@@ -474,6 +709,41 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 #endif
             }
         }
+
+        if constexpr (has_deletions) {
+            // few neighbors passed the filter: look through the filtered ones, as if the filtered subgraph had an
+            // edge to each valid point two hops away
+            for (size_t i = 0; i < filtered_neighbors.size() && valid_neighbors < two_hop_target; ++i) {
+                tableint f = filtered_neighbors[i];
+                tableint* list2 = (tableint*)get_linklist0(f);
+                int size2 = list2[0];
+                for (int j = 1; j <= size2 && valid_neighbors < two_hop_target; ++j) {
+                    tableint w = list2[j];
+                    // filtered ones stay unvisited, so that the walk may still pass through them
+                    if (visited[w] || bitset.test((int64_t)getExternalLabel(w))) {
+                        continue;
+                    }
+                    visited[w] = true;
+                    valid_neighbors++;
+                    dist_t dist = calcDistance(data_point, w);
+                    ndis++;
+                    if constexpr (collect_metrics) {
+                        metric_distance_computations++;
+                    }
+                    if (feder_result != nullptr) {
+                        feder_result->visit_info_.AddVisitRecord(0, f, w, dist);
+                        feder_result->id_set_.insert(f);
+                        feder_result->id_set_.insert(w);
+                    }
+                    if (add_search_candidate(Neighbor(w, dist, Neighbor::kValid))) {
+#if defined(USE_PREFETCH)
+                        _mm_prefetch(get_linklist0(w), _MM_HINT_T0);
+#endif
+                    }
+                }
+            }
+        }
+        return ndis;
     }
 
     // accumulative_alpha: when searching on graph with filter, we want to keep some filtered nodes in the search path
@@ -484,30 +754,83 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     searchBaseLayerST(tableint ep_id, const void* data_point, size_t ef, std::vector<bool>& visited,
                       const knowhere::BitsetView& bitset,
                       const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr,
-                      IteratorMinHeap* disqualified = nullptr, float accumulative_alpha = 0.0f) const {
+                      IteratorMinHeap* disqualified = nullptr, float accumulative_alpha = 0.0f,
+                      const BaseLayerSearchOpts* opts = nullptr) const {
         if (feder_result != nullptr) {
             feder_result->visit_info_.AddLevelVisitRecord(0);
         }
         NeighborSetDoublePopList retset(ef);
 
         dist_t dist = calcDistance(data_point, ep_id);
-        if (!has_deletions || !bitset.test((int64_t)ep_id)) {
+        if (!has_deletions || !bitset.test((int64_t)getExternalLabel(ep_id))) {
             retset.insert(Neighbor(ep_id, dist, Neighbor::kValid));
         } else {
             retset.insert(Neighbor(ep_id, dist, Neighbor::kInvalid));
         }
 
         visited[ep_id] = true;
+        size_t ndis = 1;
+        if constexpr (has_deletions) {
+            if (opts != nullptr && opts->allowed_seeds > 0 && bitset.has_allowed_ids()) {
+                // the entry point of a selective filter is rarely near a valid point, start from some of them too
+                const int64_t* allowed = bitset.allowed_ids();
+                const size_t allowed_num = bitset.allowed_num();
+                const size_t step = std::max<size_t>(1, allowed_num / opts->allowed_seeds);
+                for (size_t i = 0; i < allowed_num; i += step) {
+                    if (allowed[i] >= (int64_t)std::min<size_t>(bitset.size(), cur_element_count)) {
+                        break;
+                    }
+                    tableint id = getInternalIdByLabel(allowed[i]);
+                    if (visited[id]) {
+                        continue;
+                    }
+                    visited[id] = true;
+                    retset.insert(Neighbor(id, calcDistance(data_point, id), Neighbor::kValid));
+                    ndis++;
+                }
+            }
+        }
         auto add_search_candidate = [&](Neighbor n) { return retset.insert(n, disqualified); };
+        const float* nc_lut = opts ? opts->nc_lut : nullptr;
+        const size_t two_hop_target = opts ? opts->two_hop_target : 0;
+        const size_t topk = opts ? opts->topk : 0;
+        const size_t patience = opts ? opts->early_stop_patience : 0;
+        float topk_dist = std::numeric_limits<float>::max();
+        size_t stale_hops = 0;
         size_t hops = 0;
         while (retset.has_next()) {
-            searchBaseLayerSTNext<decltype(add_search_candidate), has_deletions, collect_metrics>(
-                data_point, retset.pop(), visited, accumulative_alpha, bitset, add_search_candidate, feder_result);
+            if ((hops & 15) == 0 && knowhere::SearchCancelled()) {
+                break;
+            }
+            float nc_bound = std::numeric_limits<float>::max();
+            if (nc_lut != nullptr) {
+                float bound = retset.at_search_back_dist();
+                if (bound != std::numeric_limits<float>::max()) {
+                    nc_bound = bound + opts->nc_slack * std::abs(bound);
+                }
+            }
+            ndis += searchBaseLayerSTNext<decltype(add_search_candidate), has_deletions, collect_metrics>(
+                data_point, retset.pop(), visited, accumulative_alpha, bitset, add_search_candidate, feder_result,
+                nc_lut, nc_bound, two_hop_target);
             hops++;
+            if (patience > 0 && retset.size() >= topk) {
+                // the k-th valid result only moves closer, an unchanged one means this hop did not help the top-k
+                float dist = retset[topk - 1].distance;
+                if (dist < topk_dist) {
+                    topk_dist = dist;
+                    stale_hops = 0;
+                } else if (++stale_hops >= patience) {
+                    break;
+                }
+            }
         }
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
         knowhere::knowhere_hnsw_search_hops.Observe(hops);
 #endif
+        knowhere::SearchStats stats;
+        stats.nodes_visited = hops;
+        stats.distance_computations = ndis;
+        knowhere::AddSearchStats(stats);
         return retset;
     }
 
@@ -565,12 +888,17 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             auto cand = top_candidates[i--];
             if (cand.distance < radius) {
                 radius_queue.push({cand.distance, cand.id});
-                result.emplace_back(cand.distance, cand.id);
+                result.emplace_back(cand.distance, getExternalLabel(cand.id));
             }
             visited[cand.id] = true;
         }
 
+        size_t expansions = 0;
+        size_t ndis = 0;
         while (!radius_queue.empty()) {
+            if ((expansions++ & 15) == 0 && knowhere::SearchCancelled()) {
+                break;
+            }
             auto cur = radius_queue.front();
             radius_queue.pop();
 
@@ -585,17 +913,22 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 int candidate_id = *(data + j);
                 if (!visited[candidate_id]) {
                     visited[candidate_id] = true;
-                    if (bitset.empty() || !bitset.test((int64_t)candidate_id)) {
+                    if (bitset.empty() || !bitset.test((int64_t)getExternalLabel(candidate_id))) {
                         dist_t dist = calcDistance(data_point, candidate_id);
+                        ndis++;
                         if (dist < radius) {
                             radius_queue.push({dist, candidate_id});
-                            result.emplace_back(dist, candidate_id);
+                            result.emplace_back(dist, getExternalLabel(candidate_id));
                         }
                     }
                 }
             }
         }
 
+        knowhere::SearchStats stats;
+        stats.nodes_visited = expansions;
+        stats.distance_computations = ndis;
+        knowhere::AddSearchStats(stats);
         return result;
     }
 
@@ -857,6 +1190,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 input.advance(cur_element_count * sizeof(float));
             }
         } else {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_read_level0");
             data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
             input.read(data_level0_memory_, cur_element_count * size_data_per_element_);
 
@@ -871,28 +1205,47 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
 
         size_links_level0_ = maxM0_ * sizeof(tableint) + sizeof(linklistsizeint);
 
-        visited_list_pool_ = new VisitedListPool(max_elements);
+        {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_visited_pool");
+            visited_list_pool_ = new VisitedListPool(max_elements);
+        }
 
-        linkLists_ = (char**)malloc(sizeof(void*) * max_elements);  // NOLINT
-        if (linkLists_ == nullptr) {
-            throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklists");
+        {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_read_links");
+            linkLists_ = (char**)malloc(sizeof(void*) * max_elements);  // NOLINT
+            if (linkLists_ == nullptr) {
+                throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklists");
+            }
+            element_levels_ = std::vector<int>(max_elements);
+            revSize_ = 1.0 / mult_;
+            ef_ = 10;
+            for (size_t i = 0; i < cur_element_count; i++) {
+                unsigned int linkListSize;
+                readBinaryPOD(input, linkListSize);
+                if (linkListSize == 0) {
+                    element_levels_[i] = 0;
+                    linkLists_[i] = nullptr;
+                } else {
+                    element_levels_[i] = linkListSize / size_links_per_element_;
+                    linkLists_[i] = (char*)malloc(linkListSize);
+                    if (linkLists_[i] == nullptr) {
+                        throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklist");
+                    }
+                    input.read(linkLists_[i], linkListSize);
+                }
+            }
         }
-        element_levels_ = std::vector<int>(max_elements);
-        revSize_ = 1.0 / mult_;
-        ef_ = 10;
-        for (size_t i = 0; i < cur_element_count; i++) {
-            unsigned int linkListSize;
-            readBinaryPOD(input, linkListSize);
-            if (linkListSize == 0) {
-                element_levels_[i] = 0;
-                linkLists_[i] = nullptr;
+
+        KNOWHERE_SCOPED_PHASE("load", "hnsw_read_sections");
+        while ((size_t)input.offset() < input.size()) {
+            uint32_t section;
+            readBinaryPOD(input, section);
+            if (section == kHnswSectionNeighborCodes) {
+                loadNeighborCodes(input, max_elements);
+            } else if (section == kHnswSectionReorder) {
+                loadReorder(input);
             } else {
-                element_levels_[i] = linkListSize / size_links_per_element_;
-                linkLists_[i] = (char*)malloc(linkListSize);
-                if (linkLists_[i] == nullptr) {
-                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklist");
-                }
-                input.read(linkLists_[i], linkListSize);
+                throw std::runtime_error("Unknown hnsw index section: " + std::to_string(section));
             }
         }
 
@@ -938,6 +1291,17 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                 output.write(linkLists_[i], linkListSize);
         }
 
+        if (hasNeighborCodes()) {
+            writeBinaryPOD(output, kHnswSectionNeighborCodes);
+            writeBinaryPOD(output, nc_pq_->M);
+            output.write((char*)nc_pq_->centroids.data(), nc_pq_->centroids.size() * sizeof(float));
+            output.write((char*)neighbor_codes_, cur_element_count * maxM0_ * nc_code_size_);
+        }
+        if (!internal_to_label_.empty()) {
+            writeBinaryPOD(output, kHnswSectionReorder);
+            output.write((char*)internal_to_label_.data(), cur_element_count * sizeof(tableint));
+        }
+
         // output.close();
     }
 
@@ -1003,47 +1367,98 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         readBinaryPOD(input, mult_);
         readBinaryPOD(input, ef_construction_);
 
-        data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
-        if (data_level0_memory_ == nullptr)
-            throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
-        input.read(data_level0_memory_, cur_element_count * size_data_per_element_);
-
-        // for COSINE, need load data_norm_l2_
-        if (metric_type_ == Metric::COSINE) {
-            data_norm_l2_ = (float*)malloc(max_elements * sizeof(float));  // NOLINT
-            if (data_norm_l2_ == nullptr)
+        {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_read_level0");
+            data_level0_memory_ = (char*)malloc(max_elements * size_data_per_element_);  // NOLINT
+            if (data_level0_memory_ == nullptr)
                 throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
-            input.read(data_norm_l2_, cur_element_count * sizeof(float));
+            input.read(data_level0_memory_, cur_element_count * size_data_per_element_);
+
+            // for COSINE, need load data_norm_l2_
+            if (metric_type_ == Metric::COSINE) {
+                data_norm_l2_ = (float*)malloc(max_elements * sizeof(float));  // NOLINT
+                if (data_norm_l2_ == nullptr)
+                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate level0");
+                input.read(data_norm_l2_, cur_element_count * sizeof(float));
+            }
         }
 
         size_links_per_element_ = maxM_ * sizeof(tableint) + sizeof(linklistsizeint);
 
         size_links_level0_ = maxM0_ * sizeof(tableint) + sizeof(linklistsizeint);
 
-        visited_list_pool_ = new VisitedListPool(max_elements);
+        {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_visited_pool");
+            visited_list_pool_ = new VisitedListPool(max_elements);
+        }
 
-        linkLists_ = (char**)malloc(sizeof(void*) * max_elements);
-        if (linkLists_ == nullptr)
-            throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklists");
-        element_levels_ = std::vector<int>(max_elements);
-        revSize_ = 1.0 / mult_;
-        ef_ = 10;
-        for (size_t i = 0; i < cur_element_count; i++) {
-            unsigned int linkListSize;
-            readBinaryPOD(input, linkListSize);
-            if (linkListSize == 0) {
-                element_levels_[i] = 0;
-                linkLists_[i] = nullptr;
+        {
+            KNOWHERE_SCOPED_PHASE("load", "hnsw_read_links");
+            linkLists_ = (char**)malloc(sizeof(void*) * max_elements);
+            if (linkLists_ == nullptr)
+                throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklists");
+            element_levels_ = std::vector<int>(max_elements);
+            revSize_ = 1.0 / mult_;
+            ef_ = 10;
+            for (size_t i = 0; i < cur_element_count; i++) {
+                unsigned int linkListSize;
+                readBinaryPOD(input, linkListSize);
+                if (linkListSize == 0) {
+                    element_levels_[i] = 0;
+                    linkLists_[i] = nullptr;
+                } else {
+                    element_levels_[i] = linkListSize / size_links_per_element_;
+                    linkLists_[i] = (char*)malloc(linkListSize);
+                    if (linkLists_[i] == nullptr)
+                        throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklist");
+                    input.read(linkLists_[i], linkListSize);
+                }
+            }
+        }
+
+        KNOWHERE_SCOPED_PHASE("load", "hnsw_read_sections");
+        while (input.tellg() < input.total_) {
+            uint32_t section;
+            readBinaryPOD(input, section);
+            if (section == kHnswSectionNeighborCodes) {
+                loadNeighborCodes(input, max_elements);
+            } else if (section == kHnswSectionReorder) {
+                loadReorder(input);
             } else {
-                element_levels_[i] = linkListSize / size_links_per_element_;
-                linkLists_[i] = (char*)malloc(linkListSize);
-                if (linkLists_[i] == nullptr)
-                    throw std::runtime_error("Not enough memory: loadIndex failed to allocate linklist");
-                input.read(linkLists_[i], linkListSize);
+                throw std::runtime_error("Unknown hnsw index section: " + std::to_string(section));
             }
         }
     }
 
+    template <typename Reader>
+    void
+    loadNeighborCodes(Reader& input, size_t max_elements) {
+        using knowhere::readBinaryPOD;
+        size_t nsub;
+        readBinaryPOD(input, nsub);
+        size_t dim = *(size_t*)dist_func_param_;
+        auto pq = std::make_unique<faiss::ProductQuantizer>(dim, nsub, kNeighborCodeNbits);
+        input.read((char*)pq->centroids.data(), pq->centroids.size() * sizeof(float));
+        nc_code_size_ = pq->code_size;
+        neighbor_codes_ = (uint8_t*)calloc(max_elements * maxM0_ * nc_code_size_, 1);  // NOLINT
+        if (neighbor_codes_ == nullptr) {
+            throw std::runtime_error("Not enough memory: loadIndex failed to allocate neighbor codes");
+        }
+        input.read((char*)neighbor_codes_, cur_element_count * maxM0_ * nc_code_size_);
+        nc_pq_ = std::move(pq);
+    }
+
+    template <typename Reader>
+    void
+    loadReorder(Reader& input) {
+        internal_to_label_.resize(cur_element_count);
+        input.read((char*)internal_to_label_.data(), cur_element_count * sizeof(tableint));
+        label_to_internal_.assign(cur_element_count, 0);
+        for (tableint i = 0; i < cur_element_count; ++i) {
+            label_to_internal_[internal_to_label_[i]] = i;
+        }
+    }
+
     unsigned short int
     getListCount(linklistsizeint* ptr) const {
         return *((unsigned short int*)ptr);
@@ -1304,12 +1719,27 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     std::vector<std::pair<dist_t, labeltype>>
     searchKnnBF(const void* query_data, size_t k, const knowhere::BitsetView bitset) const {
         knowhere::ResultMaxHeap<dist_t, labeltype> max_heap(k);
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (bitset.empty() || !bitset.test(id)) {
-                dist_t dist = calcDistance(query_data, id);
-                max_heap.Push(dist, id);
+        knowhere::SearchStats stats;
+        if (bitset.has_allowed_ids()) {
+            // only the allowed points, the ids are sorted so the ones past the end are at the tail
+            const size_t end = std::min<size_t>(bitset.size(), cur_element_count);
+            for (size_t i = 0; i < bitset.allowed_num() && bitset.allowed_ids()[i] < (int64_t)end; ++i) {
+                labeltype label = bitset.allowed_ids()[i];
+                max_heap.Push(calcDistance(query_data, getInternalIdByLabel(label)), label);
+                stats.distance_computations++;
+            }
+        } else {
+            for (tableint id = 0; id < cur_element_count; ++id) {
+                labeltype label = getExternalLabel(id);
+                if (bitset.empty() || !bitset.test(label)) {
+                    dist_t dist = calcDistance(query_data, id);
+                    max_heap.Push(dist, label);
+                    stats.distance_computations++;
+                }
             }
         }
+        stats.codes_scanned = stats.distance_computations;
+        knowhere::AddSearchStats(stats);
         const size_t len = std::min(max_heap.Size(), k);
         std::vector<std::pair<dist_t, labeltype>> result(len);
         for (int64_t i = len - 1; i >= 0; --i) {
@@ -1388,28 +1818,77 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         return {currObj, vec_hash};
     }
 
+    // Cost model of a filtered knn search. While most points pass the filter the plain walk finds enough valid
+    // neighbors. Past kHnswSearchTwoHopFilterThreshold the two-hop walk keeps the valid points connected, as long as
+    // enough of them lie within two hops of a node. A brute force scan computes the distance of every valid point and
+    // tests the whole bitset, and wins whenever that is cheaper than the walk, or the walk would get stuck.
+    FilteredSearchMode
+    chooseFilteredSearchMode(size_t k, size_t ef, const knowhere::BitsetView& bitset, bool two_hop) const {
+        const size_t filtered_out_num = std::min(bitset.count(), (size_t)cur_element_count);
+        const size_t valid_num = cur_element_count - filtered_out_num;
+        if (k >= valid_num * kHnswSearchBFTopkThreshold) {
+            return FilteredSearchMode::BRUTE_FORCE;
+        }
+        const float filter_ratio = (float)filtered_out_num / cur_element_count;
+        if (!two_hop) {
+            return filter_ratio >= kHnswSearchKnnBFFilterThreshold ? FilteredSearchMode::BRUTE_FORCE
+                                                                   : FilteredSearchMode::GRAPH;
+        }
+        if (filter_ratio < kHnswSearchTwoHopFilterThreshold) {
+            return FilteredSearchMode::GRAPH;
+        }
+        // valid points among the neighbors and the neighbors of the filtered neighbors
+        const float degree = maxM0_;
+        const float reachable = degree * (1.0f - filter_ratio) * (1.0f + filter_ratio * degree);
+        if (reachable < kHnswSearchTwoHopMinReachable) {
+            return FilteredSearchMode::BRUTE_FORCE;
+        }
+        // each of the ~ef expansions reads the link lists of its filtered neighbors, tests their neighbors against the
+        // bitset and computes up to maxM_ distances. Without a bitmap a test is a binary search of the allow-list,
+        // while brute force walks the allow-list instead of the whole bitset.
+        const float test_cost = bitset.data() != nullptr
+                                    ? kHnswSearchBitsetTestCost
+                                    : kHnswSearchBitsetTestCost * std::log2((float)bitset.allowed_num() + 2.0f);
+        const float two_hop_cost =
+            ef * (degree * filter_ratio + maxM_ + degree * (1.0f + filter_ratio * degree) * test_cost);
+        const float scan_cost = bitset.has_allowed_ids() ? 0.0f : cur_element_count * kHnswSearchBitsetTestCost;
+        const float brute_force_cost = valid_num + scan_cost;
+        return brute_force_cost <= two_hop_cost ? FilteredSearchMode::BRUTE_FORCE : FilteredSearchMode::TWO_HOP;
+    }
+
     std::vector<std::pair<dist_t, labeltype>>
     searchKnn(const void* query_data, size_t k, const knowhere::BitsetView bitset, const SearchParam* param = nullptr,
               const knowhere::feder::hnsw::FederResultUniq& feder_result = nullptr) const {
         if (cur_element_count == 0 || bitset.count() == cur_element_count)
             return {};
 
-        // do normalize for COSINE metric type
+        // do normalize for COSINE metric type, unless the caller did
         std::unique_ptr<data_t[]> query_data_norm;
         if constexpr (knowhere::KnowhereFloatTypeCheck<data_t>::value) {
-            if (metric_type_ == Metric::COSINE) {
+            if (metric_type_ == Metric::COSINE && (param == nullptr || !param->query_normalized)) {
                 query_data_norm =
                     knowhere::CopyAndNormalizeVecs((const data_t*)query_data, 1, *(size_t*)dist_func_param_);
                 query_data = query_data_norm.get();
             }
         }
 
+        std::unique_ptr<float[]> nc_lut;
+        if constexpr (knowhere::KnowhereFloatTypeCheck<data_t>::value) {
+            if (hasNeighborCodes()) {
+                nc_lut = computeNeighborCodeLUT((const data_t*)query_data);
+            }
+        }
+
         std::unique_ptr<int8_t[]> query_data_sq;
         [[maybe_unused]] const data_t* raw_data = (const data_t*)query_data;
         if constexpr (sq_enabled) {
-            query_data_sq = std::make_unique<int8_t[]>(*(size_t*)dist_func_param_);
-            encodeSQuant((const data_t*)query_data, query_data_sq.get());
-            query_data = query_data_sq.get();
+            if (param != nullptr && param->query_sq != nullptr) {
+                query_data = param->query_sq;
+            } else {
+                query_data_sq = std::make_unique<int8_t[]>(*(size_t*)dist_func_param_);
+                encodeSQuant((const data_t*)query_data, query_data_sq.get());
+                query_data = query_data_sq.get();
+            }
         }
 
         // do bruteforce search when topk is super large
@@ -1417,33 +1896,49 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             return searchKnnBF(query_data, k, bitset);
         }
 
-        // do bruteforce search when delete rate high
+        size_t ef = param ? param->ef_ : this->ef_;
+        auto mode = FilteredSearchMode::GRAPH;
         if (!bitset.empty()) {
-            const size_t filtered_out_num = bitset.count();
 #if defined(NOT_COMPILE_FOR_SWIG) && !defined(KNOWHERE_WITH_LIGHT)
-            double ratio = ((double)filtered_out_num) / bitset.size();
+            double ratio = ((double)bitset.count()) / bitset.size();
             knowhere::knowhere_hnsw_bitset_ratio.Observe(ratio);
 #endif
-            if (filtered_out_num >= (cur_element_count * kHnswSearchKnnBFFilterThreshold) ||
-                k >= (cur_element_count - filtered_out_num) * kHnswSearchBFTopkThreshold) {
+            mode = chooseFilteredSearchMode(k, std::max(ef, k), bitset, param == nullptr || param->filter_two_hop);
+            if (mode == FilteredSearchMode::BRUTE_FORCE) {
                 return searchKnnBF(query_data, k, bitset);
             }
         }
 
-        auto [currObj, vec_hash] = searchTopLayers(query_data, param, feder_result);
+        std::pair<tableint, int64_t> top_layers;
+        {
+            KNOWHERE_SCOPED_PHASE("search", "hnsw_upper_layers");
+            top_layers = searchTopLayers(query_data, param, feder_result);
+        }
+        auto [currObj, vec_hash] = top_layers;
         NeighborSetDoublePopList retset;
-        size_t ef = param ? param->ef_ : this->ef_;
+        BaseLayerSearchOpts opts;
+        opts.two_hop_target = mode == FilteredSearchMode::TWO_HOP ? maxM_ : 0;
+        opts.allowed_seeds = bitset.has_allowed_ids() ? kHnswSearchAllowedSeeds : 0;
+        opts.nc_lut = nc_lut.get();
+        opts.nc_slack = param ? param->neighbor_code_slack : SearchParam{}.neighbor_code_slack;
+        opts.topk = std::max<size_t>(k, 1);
+        opts.early_stop_patience = param ? param->early_stop_patience : 0;
         auto visited = visited_list_pool_->getFreeVisitedList();
-        if (!bitset.empty()) {
-            retset = searchBaseLayerST<true, true>(currObj, query_data, std::max(ef, k), visited, bitset, feder_result);
-        } else {
-            retset =
-                searchBaseLayerST<false, true>(currObj, query_data, std::max(ef, k), visited, bitset, feder_result);
+        {
+            KNOWHERE_SCOPED_PHASE("search", "hnsw_base_layer");
+            if (!bitset.empty()) {
+                retset = searchBaseLayerST<true, true>(currObj, query_data, std::max(ef, k), visited, bitset,
+                                                       feder_result, nullptr, 0.0f, &opts);
+            } else {
+                retset = searchBaseLayerST<false, true>(currObj, query_data, std::max(ef, k), visited, bitset,
+                                                        feder_result, nullptr, 0.0f, &opts);
+            }
         }
         std::vector<std::pair<dist_t, labeltype>> result;
         size_t len = std::min(k, retset.size());
         result.reserve(len);
         if constexpr (sq_enabled && has_raw_data) {
+            KNOWHERE_SCOPED_PHASE("search", "hnsw_refine");
             knowhere::ResultMaxHeap<dist_t, labeltype> max_heap(len);
             for (int i = 0; i < retset.size(); ++i) {
                 max_heap.Push(calcRefineDistance(raw_data, retset[i].id), retset[i].id);
@@ -1460,6 +1955,11 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         if (len > 0) {
             lru_cache.put(vec_hash, result[0].second);
         }
+        if (!internal_to_label_.empty()) {
+            for (auto& [dist, id] : result) {
+                id = internal_to_label_[id];
+            }
+        }
         return result;
     };
 
@@ -1512,7 +2012,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             }
             workspace->dists.reserve(retset.size());
             for (int i = 0; i < retset.size(); i++) {
-                workspace->dists.emplace_back(retset[i].id, retset[i].distance);
+                workspace->dists.emplace_back(getExternalLabel(retset[i].id), retset[i].distance);
             }
             workspace->initial_search_done = true;
             return;
@@ -1536,8 +2036,9 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
                     query_data, top, workspace->visited, workspace->accumulative_alpha, workspace->bitset,
                     add_search_candidate, feder_result);
             }
-            if (!has_deletions || !workspace->bitset.test((int64_t)top.id)) {
-                workspace->dists.emplace_back(top.id, top.distance);
+            labeltype label = getExternalLabel(top.id);
+            if (!has_deletions || !workspace->bitset.test((int64_t)label)) {
+                workspace->dists.emplace_back(label, top.distance);
                 return;
             }
         }
@@ -1546,11 +2047,23 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
     std::vector<std::pair<dist_t, labeltype>>
     searchRangeBF(const void* query_data, float radius, const knowhere::BitsetView bitset) const {
         std::vector<std::pair<dist_t, labeltype>> result;
-        for (labeltype id = 0; id < cur_element_count; ++id) {
-            if (bitset.empty() || !bitset.test(id)) {
+        if (bitset.has_allowed_ids()) {
+            const size_t end = std::min<size_t>(bitset.size(), cur_element_count);
+            for (size_t i = 0; i < bitset.allowed_num() && bitset.allowed_ids()[i] < (int64_t)end; ++i) {
+                labeltype label = bitset.allowed_ids()[i];
+                dist_t dist = calcDistance(query_data, getInternalIdByLabel(label));
+                if (dist < radius) {
+                    result.emplace_back(dist, label);
+                }
+            }
+            return result;
+        }
+        for (tableint id = 0; id < cur_element_count; ++id) {
+            labeltype label = getExternalLabel(id);
+            if (bitset.empty() || !bitset.test(label)) {
                 dist_t dist = calcDistance(query_data, id);
                 if (dist < radius) {
-                    result.emplace_back(dist, id);
+                    result.emplace_back(dist, label);
                 }
             }
         }
@@ -1565,21 +2078,32 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             return {};
         }
 
-        // do normalize for COSINE metric type
+        // do normalize for COSINE metric type, unless the caller did
         std::unique_ptr<data_t[]> query_data_norm;
         if constexpr (knowhere::KnowhereFloatTypeCheck<data_t>::value) {
-            if (metric_type_ == Metric::COSINE) {
+            if (metric_type_ == Metric::COSINE && (param == nullptr || !param->query_normalized)) {
                 query_data_norm =
                     knowhere::CopyAndNormalizeVecs((const data_t*)query_data, 1, *(size_t*)dist_func_param_);
                 query_data = query_data_norm.get();
             }
         }
 
+        std::unique_ptr<float[]> nc_lut;
+        if constexpr (knowhere::KnowhereFloatTypeCheck<data_t>::value) {
+            if (hasNeighborCodes()) {
+                nc_lut = computeNeighborCodeLUT((const data_t*)query_data);
+            }
+        }
+
         std::unique_ptr<int8_t[]> query_data_sq;
         if constexpr (sq_enabled) {
-            query_data_sq = std::make_unique<int8_t[]>(*(size_t*)dist_func_param_);
-            encodeSQuant((const data_t*)query_data, query_data_sq.get());
-            query_data = query_data_sq.get();
+            if (param != nullptr && param->query_sq != nullptr) {
+                query_data = param->query_sq;
+            } else {
+                query_data_sq = std::make_unique<int8_t[]>(*(size_t*)dist_func_param_);
+                encodeSQuant((const data_t*)query_data, query_data_sq.get());
+                query_data = query_data_sq.get();
+            }
         }
 
         // do bruteforce range search when ef is super large
@@ -1601,13 +2125,27 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             }
         }
 
-        auto [currObj, vec_hash] = searchTopLayers(query_data, param, feder_result);
+        std::pair<tableint, int64_t> top_layers;
+        {
+            KNOWHERE_SCOPED_PHASE("range_search", "hnsw_upper_layers");
+            top_layers = searchTopLayers(query_data, param, feder_result);
+        }
+        auto [currObj, vec_hash] = top_layers;
         NeighborSetDoublePopList retset;
+        BaseLayerSearchOpts opts;
+        opts.allowed_seeds = bitset.has_allowed_ids() ? kHnswSearchAllowedSeeds : 0;
+        opts.nc_lut = nc_lut.get();
+        opts.nc_slack = param ? param->neighbor_code_slack : SearchParam{}.neighbor_code_slack;
         auto visited = visited_list_pool_->getFreeVisitedList();
-        if (!bitset.empty()) {
-            retset = searchBaseLayerST<true, true>(currObj, query_data, ef, visited, bitset, feder_result);
-        } else {
-            retset = searchBaseLayerST<false, true>(currObj, query_data, ef, visited, bitset, feder_result);
+        {
+            KNOWHERE_SCOPED_PHASE("range_search", "hnsw_base_layer");
+            if (!bitset.empty()) {
+                retset = searchBaseLayerST<true, true>(currObj, query_data, ef, visited, bitset, feder_result, nullptr,
+                                                       0.0f, &opts);
+            } else {
+                retset = searchBaseLayerST<false, true>(currObj, query_data, ef, visited, bitset, feder_result,
+                                                        nullptr, 0.0f, &opts);
+            }
         }
 
         if (retset.size() == 0) {
@@ -1616,6 +2154,7 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
             lru_cache.put(vec_hash, retset[0].id);
         }
 
+        KNOWHERE_SCOPED_PHASE("range_search", "hnsw_radius_expand");
         return getNeighboursWithinRadius(retset, query_data, radius, bitset);
     }
 
@@ -1746,6 +2285,142 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         }
     }
 
+    // Relabel the internal ids so that nodes adjacent in the base layer graph are also adjacent in memory, which cuts
+    // the random accesses of every hop. BFS visits the graph from the entry point; RCM (reverse Cuthill-McKee) starts
+    // from low degree nodes, expands neighbors by increasing degree and reverses the order. Only call this after
+    // index building, the external labels are kept in internal_to_label_.
+    void
+    reorderGraph(ReorderType type) {
+        if (type == ReorderType::NONE || cur_element_count == 0) {
+            return;
+        }
+        const size_t n = cur_element_count;
+        auto degree = [&](tableint id) { return getListCount(get_linklist0(id)); };
+
+        // roots of the traversal, every node not reached yet starts a new component
+        std::vector<tableint> roots;
+        roots.reserve(n + 1);
+        if (type == ReorderType::BFS) {
+            roots.push_back(enterpoint_node_);
+            for (tableint i = 0; i < n; ++i) {
+                roots.push_back(i);
+            }
+        } else {
+            // counting sort by degree
+            std::vector<size_t> offsets(maxM0_ + 2, 0);
+            for (tableint i = 0; i < n; ++i) {
+                offsets[degree(i) + 1]++;
+            }
+            for (size_t d = 1; d < offsets.size(); ++d) {
+                offsets[d] += offsets[d - 1];
+            }
+            roots.resize(n);
+            for (tableint i = 0; i < n; ++i) {
+                roots[offsets[degree(i)]++] = i;
+            }
+        }
+
+        std::vector<tableint> new_to_old;
+        new_to_old.reserve(n);
+        std::vector<bool> visited(n, false);
+        std::vector<tableint> neighbors;
+        for (tableint root : roots) {
+            if (visited[root]) {
+                continue;
+            }
+            visited[root] = true;
+            size_t head = new_to_old.size();
+            new_to_old.push_back(root);
+            while (head < new_to_old.size()) {
+                tableint u = new_to_old[head++];
+                linklistsizeint* ll = get_linklist0(u);
+                size_t size = getListCount(ll);
+                tableint* data = (tableint*)(ll + 1);
+                neighbors.clear();
+                for (size_t j = 0; j < size; ++j) {
+                    if (!visited[data[j]]) {
+                        visited[data[j]] = true;
+                        neighbors.push_back(data[j]);
+                    }
+                }
+                if (type == ReorderType::RCM) {
+                    std::stable_sort(neighbors.begin(), neighbors.end(),
+                                     [&](tableint a, tableint b) { return degree(a) < degree(b); });
+                }
+                new_to_old.insert(new_to_old.end(), neighbors.begin(), neighbors.end());
+            }
+        }
+        if (type == ReorderType::RCM) {
+            std::reverse(new_to_old.begin(), new_to_old.end());
+        }
+
+        std::vector<tableint> old_to_new(n);
+        for (tableint i = 0; i < n; ++i) {
+            old_to_new[new_to_old[i]] = i;
+        }
+
+        // base layer: element blocks are moved and their link lists rewritten
+        char* data_level0_memory = (char*)malloc(max_elements_ * size_data_per_element_);  // NOLINT
+        if (data_level0_memory == nullptr) {
+            throw std::runtime_error("Not enough memory: reorderGraph failed to allocate base layer");
+        }
+        for (tableint i = 0; i < n; ++i) {
+            memcpy(data_level0_memory + i * size_data_per_element_,
+                   data_level0_memory_ + new_to_old[i] * size_data_per_element_, size_data_per_element_);
+            linklistsizeint* ll = get_linklist0(i, data_level0_memory);
+            size_t size = getListCount(ll);
+            tableint* data = (tableint*)(ll + 1);
+            for (size_t j = 0; j < size; ++j) {
+                data[j] = old_to_new[data[j]];
+            }
+        }
+        free(data_level0_memory_);
+        data_level0_memory_ = data_level0_memory;
+
+        // upper layers only need their pointers permuted
+        std::vector<char*> link_lists(linkLists_, linkLists_ + n);
+        std::vector<int> element_levels(element_levels_.begin(), element_levels_.begin() + n);
+        for (tableint i = 0; i < n; ++i) {
+            linkLists_[i] = link_lists[new_to_old[i]];
+            element_levels_[i] = element_levels[new_to_old[i]];
+            for (int level = 1; level <= element_levels_[i]; ++level) {
+                linklistsizeint* ll = get_linklist(i, level);
+                size_t size = getListCount(ll);
+                tableint* data = (tableint*)(ll + 1);
+                for (size_t j = 0; j < size; ++j) {
+                    data[j] = old_to_new[data[j]];
+                }
+            }
+        }
+
+        if (metric_type_ == Metric::COSINE) {
+            std::vector<float> norms(data_norm_l2_, data_norm_l2_ + n);
+            for (tableint i = 0; i < n; ++i) {
+                data_norm_l2_[i] = norms[new_to_old[i]];
+            }
+        }
+
+        if (hasNeighborCodes()) {
+            size_t block = maxM0_ * nc_code_size_;
+            std::vector<uint8_t> codes(neighbor_codes_, neighbor_codes_ + n * block);
+            for (tableint i = 0; i < n; ++i) {
+                memcpy(neighbor_codes_ + i * block, codes.data() + new_to_old[i] * block, block);
+            }
+        }
+
+        std::vector<tableint> internal_to_label(n);
+        for (tableint i = 0; i < n; ++i) {
+            internal_to_label[i] = getExternalLabel(new_to_old[i]);
+        }
+        internal_to_label_ = std::move(internal_to_label);
+        label_to_internal_.assign(n, 0);
+        for (tableint i = 0; i < n; ++i) {
+            label_to_internal_[internal_to_label_[i]] = i;
+        }
+        enterpoint_node_ = old_to_new[enterpoint_node_];
+        lru_cache.clear();
+    }
+
     void
     checkIntegrity() {
         int connections_checked = 0;
@@ -1796,6 +2471,11 @@ class HierarchicalNSW : public AlgorithmInterface<dist_t> {
         if (metric_type_ == Metric::COSINE) {
             ret += max_elements_ * sizeof(float);
         }
+        ret += (internal_to_label_.size() + label_to_internal_.size()) * sizeof(tableint);
+        if (hasNeighborCodes()) {
+            ret += max_elements_ * maxM0_ * nc_code_size_;
+            ret += nc_pq_->centroids.size() * sizeof(float);
+        }
         return ret;
     }
 };
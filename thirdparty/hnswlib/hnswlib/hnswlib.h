@@ -137,6 +137,7 @@ AVX512Capable() {
 #include "knowhere/bitsetview.h"
 #include "knowhere/feder/HNSW.h"
 #include "knowhere/object.h"
+#include "simd/hook.h"
 
 namespace hnswlib {
 typedef int64_t labeltype;
@@ -153,6 +154,13 @@ class pairGreater {
 template <typename DistanceType>
 using DISTFUNC = DistanceType (*)(const void*, const void*, const void*);
 
+// The param of the distance functions of the float spaces: the dim, first so that *(size_t*)param reads it as for the
+// other spaces, and the fp32 kernels bound to the index.
+struct FloatDistParam {
+    size_t dim;
+    faiss::FvecKernels kernels;
+};
+
 template <typename DistanceType>
 class SpaceInterface {
  public:
@@ -171,6 +179,11 @@ class SpaceInterface {
     virtual void*
     get_dist_func_param() = 0;
 
+    // binds the fp32 kernels the distance functions call, a no-op for the spaces that do not use them
+    virtual void
+    set_fvec_kernels(const faiss::FvecKernels& kernels) {
+    }
+
     virtual ~SpaceInterface() {
     }
 };
@@ -178,6 +191,16 @@ class SpaceInterface {
 struct SearchParam {
     size_t ef_;
     bool for_tuning;
+    // relative margin over the current search bound under which a neighbor code is still expanded
+    float neighbor_code_slack = 0.1f;
+    // stop the base layer search once the top-k has not improved for this many hops, 0 disables it
+    size_t early_stop_patience = 0;
+    // let filtered knn searches expand the neighbors of filtered neighbors, see chooseFilteredSearchMode()
+    bool filter_two_hop = true;
+    // the query was already normalized for COSINE by the caller
+    bool query_normalized = false;
+    // the sq codes of the query computed by the caller with encodeSQuant(), nullptr to encode them in the search
+    const int8_t* query_sq = nullptr;
 };
 
 struct IteratorWorkspace {
@@ -179,6 +179,12 @@ class NeighborSetDoublePopList {
         return valid_ns_->size();
     }
 
+    // distance of the worst valid result once the set is full, max float before that
+    inline float
+    at_search_back_dist() const {
+        return valid_ns_->at_search_back_dist();
+    }
+
  private:
     auto
     pop_based_on_distance() -> Neighbor {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hnswlib.h"
+#include "knowhere/operands.h"
 #include "simd/hook.h"
 
 namespace hnswlib {
@@ -8,7 +9,13 @@ namespace hnswlib {
 template <typename DataType, typename DistanceType>
 static DistanceType
 Cosine(const void* pVect1, const void* pVect2, const void* qty_ptr) {
-    if constexpr (!std::is_same<float, DataType>::value) {
+    if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
+        return faiss::fp16_vec_inner_product((const knowhere::fp16*)pVect1, (const knowhere::fp16*)pVect2,
+                                             *((size_t*)qty_ptr));
+    } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
+        return faiss::bf16_vec_inner_product((const knowhere::bf16*)pVect1, (const knowhere::bf16*)pVect2,
+                                             *((size_t*)qty_ptr));
+    } else if constexpr (!std::is_same<float, DataType>::value) {
         size_t qty = *((size_t*)qty_ptr);
         float res = 0;
         for (unsigned i = 0; i < qty; i++) {
@@ -16,7 +23,8 @@ Cosine(const void* pVect1, const void* pVect2, const void* qty_ptr) {
         }
         return res;
     } else {
-        return faiss::fvec_inner_product((const float*)pVect1, (const float*)pVect2, *((size_t*)qty_ptr));
+        auto param = (const FloatDistParam*)qty_ptr;
+        return param->kernels.inner_product((const float*)pVect1, (const float*)pVect2, param->dim);
     }
 }
 
@@ -36,13 +44,14 @@ class CosineSpace : public SpaceInterface<DistanceType> {
     DISTFUNC<DistanceType> fstdistfunc_;
     DISTFUNC<float> fstdistfunc_sq_;
     size_t data_size_;
-    size_t dim_;
+    FloatDistParam param_;
 
  public:
     CosineSpace(size_t dim) {
         fstdistfunc_ = CosineDistance<DataType, DistanceType>;
         fstdistfunc_sq_ = CosineSQ8Distance;
-        dim_ = dim;
+        param_.dim = dim;
+        param_.kernels = faiss::fvec_kernels(faiss::patch_for_fp32_bf16_enabled(), dim);
         data_size_ = dim * sizeof(DataType);
     }
 
@@ -63,7 +72,12 @@ class CosineSpace : public SpaceInterface<DistanceType> {
 
     void*
     get_dist_func_param() {
-        return &dim_;
+        return &param_;
+    }
+
+    void
+    set_fvec_kernels(const faiss::FvecKernels& kernels) override {
+        param_.kernels = kernels;
     }
 
     ~CosineSpace() {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hnswlib.h"
+#include "knowhere/operands.h"
 #include "simd/hook.h"
 
 namespace hnswlib {
@@ -8,7 +9,13 @@ namespace hnswlib {
 template <typename DataType, typename DistanceType>
 static DistanceType
 InnerProduct(const void* pVect1, const void* pVect2, const void* qty_ptr) {
-    if constexpr (!std::is_same_v<DataType, float>) {
+    if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
+        return faiss::fp16_vec_inner_product((const knowhere::fp16*)pVect1, (const knowhere::fp16*)pVect2,
+                                             *((size_t*)qty_ptr));
+    } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
+        return faiss::bf16_vec_inner_product((const knowhere::bf16*)pVect1, (const knowhere::bf16*)pVect2,
+                                             *((size_t*)qty_ptr));
+    } else if constexpr (!std::is_same_v<DataType, float>) {
         size_t qty = *((size_t*)qty_ptr);
         float res = 0;
         for (unsigned i = 0; i < qty; i++) {
@@ -16,7 +23,8 @@ InnerProduct(const void* pVect1, const void* pVect2, const void* qty_ptr) {
         }
         return res;
     } else {
-        return faiss::fvec_inner_product((const float*)pVect1, (const float*)pVect2, *((size_t*)qty_ptr));
+        auto param = (const FloatDistParam*)qty_ptr;
+        return param->kernels.inner_product((const float*)pVect1, (const float*)pVect2, param->dim);
     }
 }
 
@@ -296,34 +304,6 @@ DISTFUNC<float> InnerProductSIMD16Ext = InnerProductSIMD16ExtSSE;
 DISTFUNC<float> InnerProductSIMD4Ext = InnerProductSIMD4ExtSSE;
 DISTFUNC<float> InnerProductDistanceSIMD16Ext = InnerProductDistanceSIMD16ExtSSE;
 DISTFUNC<float> InnerProductDistanceSIMD4Ext = InnerProductDistanceSIMD4ExtSSE;
-
-static float
-InnerProductDistanceSIMD16ExtResiduals(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    size_t qty = *((size_t*)qty_ptr);
-    size_t qty16 = qty >> 4 << 4;
-    float res = InnerProductSIMD16Ext(pVect1v, pVect2v, &qty16);
-    float* pVect1 = (float*)pVect1v + qty16;
-    float* pVect2 = (float*)pVect2v + qty16;
-
-    size_t qty_left = qty - qty16;
-    float res_tail = InnerProduct(pVect1, pVect2, &qty_left);
-    return 1.0f - (res + res_tail);
-}
-
-static float
-InnerProductDistanceSIMD4ExtResiduals(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    size_t qty = *((size_t*)qty_ptr);
-    size_t qty4 = qty >> 2 << 2;
-
-    float res = InnerProductSIMD4Ext(pVect1v, pVect2v, &qty4);
-    size_t qty_left = qty - qty4;
-
-    float* pVect1 = (float*)pVect1v + qty4;
-    float* pVect2 = (float*)pVect2v + qty4;
-    float res_tail = InnerProduct(pVect1, pVect2, &qty_left);
-
-    return 1.0f - (res + res_tail);
-}
 #endif
 
 template <typename DataType, typename DistanceType>
@@ -331,7 +311,7 @@ class InnerProductSpace : public SpaceInterface<DistanceType> {
     DISTFUNC<DistanceType> fstdistfunc_;
     DISTFUNC<DistanceType> fstdistfunc_sq_;
     size_t data_size_;
-    size_t dim_;
+    FloatDistParam param_;
 
  public:
     InnerProductSpace(size_t dim) {
@@ -364,13 +344,10 @@ class InnerProductSpace : public SpaceInterface<DistanceType> {
             fstdistfunc_ = InnerProductDistanceSIMD16Ext;
         else if (dim % 4 == 0)
             fstdistfunc_ = InnerProductDistanceSIMD4Ext;
-        else if (dim > 16)
-            fstdistfunc_ = InnerProductDistanceSIMD16ExtResiduals;
-        else if (dim > 4)
-            fstdistfunc_ = InnerProductDistanceSIMD4ExtResiduals;
 #endif
 #endif
-        dim_ = dim;
+        param_.dim = dim;
+        param_.kernels = faiss::fvec_kernels(faiss::patch_for_fp32_bf16_enabled(), dim);
         data_size_ = dim * sizeof(DataType);
     }
 
@@ -391,7 +368,12 @@ class InnerProductSpace : public SpaceInterface<DistanceType> {
 
     void*
     get_dist_func_param() {
-        return &dim_;
+        return &param_;
+    }
+
+    void
+    set_fvec_kernels(const faiss::FvecKernels& kernels) override {
+        param_.kernels = kernels;
     }
 
     ~InnerProductSpace() {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hnswlib.h"
+#include "knowhere/operands.h"
 #include "simd/hook.h"
 
 namespace hnswlib {
@@ -8,7 +9,11 @@ namespace hnswlib {
 template <typename DataType, typename DistanceType>
 static DistanceType
 NormSqr(const void* pVect1v, const void* qty_ptr) {
-    if constexpr (!std::is_same_v<DataType, float>) {
+    if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
+        return faiss::fp16_vec_norm_L2sqr((const knowhere::fp16*)pVect1v, *((size_t*)qty_ptr));
+    } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
+        return faiss::bf16_vec_norm_L2sqr((const knowhere::bf16*)pVect1v, *((size_t*)qty_ptr));
+    } else if constexpr (!std::is_same_v<DataType, float>) {
         auto pVect1 = (DataType*)pVect1v;
         size_t qty = *((size_t*)qty_ptr);
 
@@ -19,14 +24,21 @@ NormSqr(const void* pVect1v, const void* qty_ptr) {
         }
         return (res);
     } else {
-        return faiss::fvec_norm_L2sqr((const float*)pVect1v, *(size_t*)(qty_ptr));
+        auto param = (const FloatDistParam*)qty_ptr;
+        return param->kernels.norm_L2sqr((const float*)pVect1v, param->dim);
     }
 }
 
 template <typename DataType, typename DistanceType>
 static DistanceType
 L2Sqr(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    if constexpr (!std::is_same_v<DataType, float>) {
+    if constexpr (std::is_same_v<DataType, knowhere::fp16>) {
+        return faiss::fp16_vec_L2sqr((const knowhere::fp16*)pVect1v, (const knowhere::fp16*)pVect2v,
+                                     *((size_t*)qty_ptr));
+    } else if constexpr (std::is_same_v<DataType, knowhere::bf16>) {
+        return faiss::bf16_vec_L2sqr((const knowhere::bf16*)pVect1v, (const knowhere::bf16*)pVect2v,
+                                     *((size_t*)qty_ptr));
+    } else if constexpr (!std::is_same_v<DataType, float>) {
         auto pVect1 = (DataType*)pVect1v;
         auto pVect2 = (DataType*)pVect2v;
         size_t qty = *((size_t*)qty_ptr);
@@ -40,7 +52,8 @@ L2Sqr(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
         }
         return (res);
     } else {
-        return faiss::fvec_L2sqr((const float*)pVect1v, (const float*)pVect2v, *((size_t*)qty_ptr));
+        auto param = (const FloatDistParam*)qty_ptr;
+        return param->kernels.L2sqr((const float*)pVect1v, (const float*)pVect2v, param->dim);
     }
 }
 
@@ -174,19 +187,6 @@ L2SqrSIMD16ExtSSE(const void* pVect1v, const void* pVect2v, const void* qty_ptr)
 
 #if defined(USE_SSE) || defined(USE_AVX) || defined(USE_AVX512)
 DISTFUNC<float> L2SqrSIMD16Ext = L2SqrSIMD16ExtSSE;
-
-static float
-L2SqrSIMD16ExtResiduals(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    size_t qty = *((size_t*)qty_ptr);
-    size_t qty16 = qty >> 4 << 4;
-    float res = L2SqrSIMD16Ext(pVect1v, pVect2v, &qty16);
-    float* pVect1 = (float*)pVect1v + qty16;
-    float* pVect2 = (float*)pVect2v + qty16;
-
-    size_t qty_left = qty - qty16;
-    float res_tail = L2Sqr(pVect1, pVect2, &qty_left);
-    return (res + res_tail);
-}
 #endif
 
 #if defined(USE_SSE)
@@ -215,21 +215,6 @@ L2SqrSIMD4Ext(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
     _mm_store_ps(TmpRes, sum);
     return TmpRes[0] + TmpRes[1] + TmpRes[2] + TmpRes[3];
 }
-
-static float
-L2SqrSIMD4ExtResiduals(const void* pVect1v, const void* pVect2v, const void* qty_ptr) {
-    size_t qty = *((size_t*)qty_ptr);
-    size_t qty4 = qty >> 2 << 2;
-
-    float res = L2SqrSIMD4Ext(pVect1v, pVect2v, &qty4);
-    size_t qty_left = qty - qty4;
-
-    float* pVect1 = (float*)pVect1v + qty4;
-    float* pVect2 = (float*)pVect2v + qty4;
-    float res_tail = L2Sqr(pVect1, pVect2, &qty_left);
-
-    return (res + res_tail);
-}
 #endif
 
 template <typename DataType, typename DistanceType>
@@ -237,7 +222,7 @@ class L2Space : public SpaceInterface<DistanceType> {
     DISTFUNC<DistanceType> fstdistfunc_;
     DISTFUNC<DistanceType> fstdistfunc_sq_;
     size_t data_size_;
-    size_t dim_;
+    FloatDistParam param_;
 
  public:
     L2Space(size_t dim) {
@@ -259,13 +244,10 @@ class L2Space : public SpaceInterface<DistanceType> {
             fstdistfunc_ = L2SqrSIMD16Ext;
         else if (dim % 4 == 0)
             fstdistfunc_ = L2SqrSIMD4Ext;
-        else if (dim > 16)
-            fstdistfunc_ = L2SqrSIMD16ExtResiduals;
-        else if (dim > 4)
-            fstdistfunc_ = L2SqrSIMD4ExtResiduals;
 #endif
 #endif
-        dim_ = dim;
+        param_.dim = dim;
+        param_.kernels = faiss::fvec_kernels(faiss::patch_for_fp32_bf16_enabled(), dim);
         data_size_ = dim * sizeof(DataType);
     }
 
@@ -286,7 +268,12 @@ class L2Space : public SpaceInterface<DistanceType> {
 
     void*
     get_dist_func_param() {
-        return &dim_;
+        return &param_;
+    }
+
+    void
+    set_fvec_kernels(const faiss::FvecKernels& kernels) override {
+        param_.kernels = kernels;
     }
 
     ~L2Space() {